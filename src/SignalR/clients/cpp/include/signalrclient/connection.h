@@ -7,6 +7,7 @@
 #include <memory>
 #include <functional>
 #include "pplx/pplxtasks.h"
+#include "connection_metrics.h"
 #include "connection_state.h"
 #include "trace_level.h"
 #include "log_writer.h"
@@ -33,9 +34,27 @@ namespace signalr
 
         SIGNALRCLIENT_API pplx::task<void> __cdecl send(const std::string& data);
 
+        // Sends the messages queued when batching is enabled with `signalr_client_config::set_send_batch_threshold`.
+        SIGNALRCLIENT_API pplx::task<void> __cdecl flush();
+
+        // Completes when fewer bytes than `signalr_client_config::set_send_backpressure_threshold` wait to be sent.
+        // Senders producing data faster than it can be sent should wait for it before sending more.
+        SIGNALRCLIENT_API pplx::task<void> __cdecl wait_for_send_capacity();
+        // The largest number of bytes that have been waiting to be sent at the same time.
+        SIGNALRCLIENT_API size_t __cdecl get_send_queue_high_water_mark() const noexcept;
+
+        // Counters and latency histograms maintained for the lifetime of the connection. They are cheap enough to be
+        // always on, unlike logging.
+        SIGNALRCLIENT_API connection_metrics __cdecl get_metrics() const;
+
         SIGNALRCLIENT_API void __cdecl set_message_received(const message_received_handler& message_received_callback);
         SIGNALRCLIENT_API void __cdecl set_disconnected(const std::function<void __cdecl()>& disconnected_callback);
 
+        // Invoked when the connection was lost and automatic reconnect (see `signalr_client_config::set_automatic_reconnect`)
+        // starts reconnecting and when the connection has been reestablished.
+        SIGNALRCLIENT_API void __cdecl set_reconnecting(const std::function<void __cdecl()>& reconnecting_callback);
+        SIGNALRCLIENT_API void __cdecl set_reconnected(const std::function<void __cdecl()>& reconnected_callback);
+
         SIGNALRCLIENT_API void __cdecl set_client_config(const signalr_client_config& config);
 
         SIGNALRCLIENT_API pplx::task<void> __cdecl stop();
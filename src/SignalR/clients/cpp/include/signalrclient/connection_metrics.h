@@ -0,0 +1,61 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "_exports.h"
+
+namespace signalr
+{
+    // The distribution of the values recorded by a histogram. Values are counted in buckets whose width grows with
+    // the value, so values are only known to within 12.5%.
+    struct histogram_snapshot
+    {
+        histogram_snapshot() noexcept
+            : count(0), sum(0), min(0), max(0)
+        { }
+
+        uint64_t count;
+        uint64_t sum;
+        uint64_t min;
+        uint64_t max;
+        // the largest value of each bucket paired with the number of values counted in the bucket. Empty buckets are
+        // left out and buckets are sorted by value.
+        std::vector<std::pair<uint64_t, uint64_t>> buckets;
+
+        // returns 0 if no value has been recorded, `percentile` ranges from 0 to 100
+        SIGNALRCLIENT_API uint64_t __cdecl value_at_percentile(double percentile) const;
+    };
+
+    // Counters of a connection since it was created. Taken while the connection is in use so the values are not
+    // necessarily consistent with each other. Durations are in microseconds.
+    struct connection_metrics
+    {
+        connection_metrics() noexcept
+            : messages_sent(0), bytes_sent(0), messages_received(0), bytes_received(0), reconnects(0),
+            outstanding_invocations(0), queued_invocations(0)
+        { }
+
+        uint64_t messages_sent;
+        uint64_t bytes_sent;
+        // messages received from the transport, one of which may hold several hub messages
+        uint64_t messages_received;
+        uint64_t bytes_received;
+        uint64_t reconnects;
+        // the number of messages sent with each write to the transport, greater than 1 when batching is enabled
+        histogram_snapshot frames_per_batch;
+        // from queueing the message for the transport until it has been sent
+        histogram_snapshot send_latency;
+
+        // only set for hub connections
+        uint64_t outstanding_invocations;
+        // invocations waiting to be sent, see `signalr_client_config::set_max_queued_invocations`
+        uint64_t queued_invocations;
+        // from sending the invocation until its result, an error or the connection being closed has been received
+        histogram_snapshot invocation_round_trip;
+        histogram_snapshot handler_execution_time;
+    };
+}
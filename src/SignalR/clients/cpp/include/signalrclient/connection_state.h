@@ -10,6 +10,7 @@ namespace signalr
         connecting,
         connected,
         disconnecting,
-        disconnected
+        disconnected,
+        reconnecting
     };
 }
@@ -0,0 +1,21 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+namespace signalr
+{
+    // Selects how handlers registered with `hub_connection::on` are invoked for received invocations.
+    enum class handler_dispatch_mode
+    {
+        // handlers run inline on the thread receiving messages and no message is read until the handler returned
+        synchronous,
+        // handlers run one at a time in the order the invocations were received, on the handler executor
+        serial,
+        // handlers run concurrently on the handler executor
+        parallel,
+        // handlers of the same hub method run one at a time in the order the invocations were received, handlers of
+        // different hub methods run concurrently
+        keyed_serial
+    };
+}
@@ -4,14 +4,21 @@
 #pragma once
 
 #include "_exports.h"
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <vector>
 #include "pplx/pplxtasks.h"
 #include "cpprest/json.h"
+#include "connection_metrics.h"
 #include "connection_state.h"
 #include "trace_level.h"
 #include "log_writer.h"
+#include "prepared_invocation.h"
+#include "serializer.h"
 #include "signalr_client_config.h"
+#include "stream_reader.h"
+#include "stream_writer.h"
 
 namespace signalr
 {
@@ -22,6 +29,9 @@ namespace signalr
     public:
         typedef std::function<void __cdecl (const web::json::value&)> method_invoked_handler;
 
+        // receives the arguments of an invocation as a serialized json array
+        typedef std::function<void __cdecl (const std::string&)> serialized_method_invoked_handler;
+
         SIGNALRCLIENT_API explicit hub_connection(const std::string& url, trace_level trace_level = trace_level::all,
             std::shared_ptr<log_writer> log_writer = nullptr);
 
@@ -39,6 +49,12 @@ namespace signalr
 
         SIGNALRCLIENT_API void __cdecl set_disconnected(const std::function<void __cdecl()>& disconnected_callback);
 
+        // Invoked when the connection was lost and automatic reconnect (see `signalr_client_config::set_automatic_reconnect`)
+        // starts reconnecting and when the connection has been reestablished. Pending invocations fail when the connection
+        // is lost while handlers registered with `on` are kept.
+        SIGNALRCLIENT_API void __cdecl set_reconnecting(const std::function<void __cdecl()>& reconnecting_callback);
+        SIGNALRCLIENT_API void __cdecl set_reconnected(const std::function<void __cdecl()>& reconnected_callback);
+
         SIGNALRCLIENT_API void __cdecl set_client_config(const signalr_client_config& config);
 
         SIGNALRCLIENT_API void __cdecl on(const std::string& event_name, const method_invoked_handler& handler);
@@ -47,6 +63,82 @@ namespace signalr
 
         SIGNALRCLIENT_API pplx::task<void> send(const std::string& method_name, const web::json::value& arguments = web::json::value::array());
 
+        // Invokes a hub method whose trailing parameters are streams uploaded by the client. `arguments` contains the
+        // remaining arguments and each writer in `streams` provides one stream parameter.
+        SIGNALRCLIENT_API pplx::task<web::json::value> invoke(const std::string& method_name, const web::json::value& arguments,
+            const std::vector<stream_writer>& streams);
+
+        SIGNALRCLIENT_API pplx::task<void> send(const std::string& method_name, const web::json::value& arguments,
+            const std::vector<stream_writer>& streams);
+
+        // Fails the invocation with a `signalr_exception` if its result has not been received within `timeout` (0 means
+        // no timeout) and with `pplx::task_canceled` when `cancellation_token` is canceled. Either way the server is sent
+        // a CancelInvocation message and a result received later is ignored.
+        SIGNALRCLIENT_API pplx::task<web::json::value> invoke(const std::string& method_name, const web::json::value& arguments,
+            std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none());
+
+        // Sends the messages queued when batching is enabled with `signalr_client_config::set_send_batch_threshold`.
+        SIGNALRCLIENT_API pplx::task<void> __cdecl flush();
+
+        // Completes when fewer bytes than `signalr_client_config::set_send_backpressure_threshold` wait to be sent.
+        // Senders producing data faster than it can be sent should wait for it before sending more.
+        SIGNALRCLIENT_API pplx::task<void> __cdecl wait_for_send_capacity();
+        // The largest number of bytes that have been waiting to be sent at the same time.
+        SIGNALRCLIENT_API size_t __cdecl get_send_queue_high_water_mark() const;
+        // The number of invocations waiting for their result, see `signalr_client_config::set_max_outstanding_invocations`.
+        SIGNALRCLIENT_API size_t __cdecl get_outstanding_invocations() const;
+        // Counters and latency histograms of the connection including the invocation round trips and the time spent in
+        // handlers. They are cheap enough to be always on, unlike logging.
+        SIGNALRCLIENT_API connection_metrics __cdecl get_metrics() const;
+
+        // Invokes a hub method returning a stream. Items are read with the returned reader as they arrive.
+        //
+        // Items are buffered by the reader until `move_next` is called. If an item arrives while the buffer is full
+        // the stream fails with a `signalr_exception` once the buffered items have been read and it is canceled on the
+        // server. Other invocations and streams of the connection are not affected by a slow reader.
+        SIGNALRCLIENT_API stream_reader stream(const std::string& method_name, const web::json::value& arguments = web::json::value::array());
+
+        // Typed overloads. Arguments are written directly as json and received arguments and results are decoded
+        // directly into the given types using `serializer<T>`, without creating `web::json::value`s. Note that a
+        // single `web::json::value` argument is passed to the overloads above, which treat it as the array of
+        // arguments, unless the result type is given explicitly.
+        template<typename R, typename... Args>
+        pplx::task<R> invoke(const std::string& method_name, const Args&... args)
+        {
+            return invoke_serialized(method_name, details::serialize_arguments(args...))
+                .then([](const std::string& result)
+                {
+                    return details::result_reader<R>::read(result);
+                });
+        }
+
+        template<typename... Args>
+        pplx::task<void> send(const std::string& method_name, const Args&... args)
+        {
+            return send_serialized(method_name, details::serialize_arguments(args...));
+        }
+
+        // The argument types have to be given explicitly e.g. `on<std::string, int>("method", handler)`. Invocations
+        // with fewer arguments than the handler expects are logged as errors and not passed to the handler.
+        template<typename... Args>
+        void on(const std::string& event_name, const typename details::non_deduced<std::function<void(Args...)>>::type& handler)
+        {
+            on_serialized(event_name, [handler](const std::string& arguments)
+            {
+                details::invoke_handler(handler, arguments);
+            });
+        }
+
+        // Prepares invocations of a hub method that is invoked often. See `prepared_invocation`.
+        SIGNALRCLIENT_API prepared_invocation __cdecl prepare(const std::string& method_name);
+
+        // Used by the typed overloads. `arguments` must be a serialized json array and results are serialized json.
+        SIGNALRCLIENT_API void __cdecl on_serialized(const std::string& event_name, const serialized_method_invoked_handler& handler);
+        SIGNALRCLIENT_API pplx::task<std::string> __cdecl invoke_serialized(const std::string& method_name, const std::string& arguments);
+        SIGNALRCLIENT_API pplx::task<std::string> __cdecl invoke_serialized(const std::string& method_name, const std::string& arguments,
+            std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none());
+        SIGNALRCLIENT_API pplx::task<void> __cdecl send_serialized(const std::string& method_name, const std::string& arguments);
+
     private:
         std::shared_ptr<hub_connection_impl> m_pImpl;
     };
@@ -0,0 +1,18 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+namespace signalr
+{
+    // Selects what happens to a new invocation when the maximum number of outstanding invocations has been reached.
+    enum class invocation_admission_policy
+    {
+        // the new invocation fails with a `signalr_exception`
+        reject,
+        // the new invocation is queued and sent once an outstanding invocation completes, the caller is not blocked
+        wait,
+        // the oldest outstanding invocation fails with a `hub_exception` to make room for the new invocation
+        shed_oldest
+    };
+}
@@ -0,0 +1,49 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include "_exports.h"
+#include <memory>
+#include <string>
+#include "pplx/pplxtasks.h"
+#include "serializer.h"
+
+namespace signalr
+{
+    class hub_connection_impl;
+    class prepared_invocation_impl;
+
+    // An invocation of a hub method returned by `hub_connection::prepare`. The parts of the message that are the same
+    // for every call are serialized once when the invocation is prepared so each call only writes the invocation id
+    // and the arguments. Copies share the prepared message and the handle does not keep the connection alive.
+    class prepared_invocation
+    {
+    public:
+        prepared_invocation(std::weak_ptr<hub_connection_impl> connection, std::shared_ptr<const prepared_invocation_impl> impl);
+
+        template<typename R, typename... Args>
+        pplx::task<R> invoke(const Args&... args) const
+        {
+            return invoke_serialized(details::serialize_arguments_reusing_buffer(args...))
+                .then([](const std::string& result)
+                {
+                    return details::result_reader<R>::read(result);
+                });
+        }
+
+        template<typename... Args>
+        pplx::task<void> send(const Args&... args) const
+        {
+            return send_serialized(details::serialize_arguments_reusing_buffer(args...));
+        }
+
+        // `arguments` must be a serialized json array. The result is returned as serialized json.
+        SIGNALRCLIENT_API pplx::task<std::string> __cdecl invoke_serialized(const std::string& arguments) const;
+        SIGNALRCLIENT_API pplx::task<void> __cdecl send_serialized(const std::string& arguments) const;
+
+    private:
+        std::weak_ptr<hub_connection_impl> m_connection;
+        std::shared_ptr<const prepared_invocation_impl> m_pImpl;
+    };
+}
@@ -0,0 +1,304 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include "_exports.h"
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "cpprest/json.h"
+#include "signalr_exception.h"
+
+namespace signalr
+{
+    // Writes json directly to a string. Used by `serializer` specializations to write hub method arguments without
+    // creating a `web::json::value` first. Separators are inserted automatically.
+    class argument_writer
+    {
+    public:
+        SIGNALRCLIENT_API explicit argument_writer(std::string& buffer);
+
+        SIGNALRCLIENT_API void __cdecl write_null();
+        SIGNALRCLIENT_API void __cdecl write_bool(bool value);
+        SIGNALRCLIENT_API void __cdecl write_int64(long long value);
+        SIGNALRCLIENT_API void __cdecl write_uint64(unsigned long long value);
+        // non-finite values are written as null since json cannot represent them
+        SIGNALRCLIENT_API void __cdecl write_double(double value);
+        // `value` must be utf8 encoded
+        SIGNALRCLIENT_API void __cdecl write_string(const char* value, size_t length);
+        SIGNALRCLIENT_API void __cdecl write_string(const std::string& value);
+        // writes a value that has already been serialized as json
+        SIGNALRCLIENT_API void __cdecl write_raw(const char* json, size_t length);
+
+        SIGNALRCLIENT_API void __cdecl begin_array();
+        SIGNALRCLIENT_API void __cdecl end_array();
+        SIGNALRCLIENT_API void __cdecl begin_object();
+        SIGNALRCLIENT_API void __cdecl end_object();
+        // writes the name of the next field of an object, followed by a call writing its value
+        SIGNALRCLIENT_API void __cdecl write_name(const std::string& name);
+
+    private:
+        std::string& m_buffer;
+        bool m_needs_separator;
+
+        void begin_value();
+    };
+
+    // Reads json values from serialized text in order. Used by `serializer` specializations to decode hub method
+    // arguments without creating a `web::json::value` first. Throws signalr_exception if the json does not have the
+    // expected shape.
+    class argument_reader
+    {
+    public:
+        SIGNALRCLIENT_API argument_reader(const char* data, size_t length);
+
+        // returns true and consumes the value if the next value is null
+        SIGNALRCLIENT_API bool __cdecl read_null();
+        SIGNALRCLIENT_API bool __cdecl read_bool();
+        SIGNALRCLIENT_API long long __cdecl read_int64();
+        SIGNALRCLIENT_API unsigned long long __cdecl read_uint64();
+        SIGNALRCLIENT_API double __cdecl read_double();
+        SIGNALRCLIENT_API std::string __cdecl read_string();
+        // returns the next value as serialized json
+        SIGNALRCLIENT_API std::string __cdecl read_raw();
+        SIGNALRCLIENT_API void __cdecl skip_value();
+
+        // arrays are read with `begin_array(); while (next_element()) { /* read the element */ }`
+        SIGNALRCLIENT_API void __cdecl begin_array();
+        SIGNALRCLIENT_API bool __cdecl next_element();
+
+        // objects are read with `begin_object(); while (next_field(name)) { /* read or skip the value */ }`
+        SIGNALRCLIENT_API void __cdecl begin_object();
+        SIGNALRCLIENT_API bool __cdecl next_field(std::string& name);
+
+    private:
+        const char* m_position;
+        const char* m_end;
+        // whether the next element or field is the first one of the current array or object
+        bool m_first;
+
+        void skip_whitespace() noexcept;
+        char peek();
+        const char* number_end() const noexcept;
+    };
+
+    // Converts values of type T to and from json. Specialize this template with
+    //
+    //     static void write(argument_writer& writer, const T& value);
+    //     static T read(argument_reader& reader);
+    //
+    // to use your own types as arguments and results of the typed `hub_connection::invoke`, `send` and `on` overloads.
+    template<typename T, typename Enable = void>
+    struct serializer;
+
+    template<>
+    struct serializer<bool>
+    {
+        static void write(argument_writer& writer, bool value) { writer.write_bool(value); }
+        static bool read(argument_reader& reader) { return reader.read_bool(); }
+    };
+
+    template<typename T>
+    struct serializer<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+    {
+        static void write(argument_writer& writer, T value) { writer.write_int64(value); }
+
+        static T read(argument_reader& reader)
+        {
+            const auto value = reader.read_int64();
+            if (static_cast<long long>(static_cast<T>(value)) != value)
+            {
+                throw signalr_exception("number out of range");
+            }
+            return static_cast<T>(value);
+        }
+    };
+
+    template<typename T>
+    struct serializer<T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value
+        && !std::is_same<T, bool>::value>::type>
+    {
+        static void write(argument_writer& writer, T value) { writer.write_uint64(value); }
+
+        static T read(argument_reader& reader)
+        {
+            const auto value = reader.read_uint64();
+            if (static_cast<unsigned long long>(static_cast<T>(value)) != value)
+            {
+                throw signalr_exception("number out of range");
+            }
+            return static_cast<T>(value);
+        }
+    };
+
+    template<typename T>
+    struct serializer<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+    {
+        static void write(argument_writer& writer, T value) { writer.write_double(value); }
+        static T read(argument_reader& reader) { return static_cast<T>(reader.read_double()); }
+    };
+
+    template<>
+    struct serializer<std::string>
+    {
+        static void write(argument_writer& writer, const std::string& value) { writer.write_string(value); }
+        static std::string read(argument_reader& reader) { return reader.read_string(); }
+    };
+
+    // string literals are passed as `const char*`. Reading them is not supported since nobody would own the memory.
+    template<>
+    struct serializer<const char*>
+    {
+        static void write(argument_writer& writer, const char* value) { writer.write_string(value, std::char_traits<char>::length(value)); }
+    };
+
+    template<typename T>
+    struct serializer<std::vector<T>>
+    {
+        static void write(argument_writer& writer, const std::vector<T>& value)
+        {
+            writer.begin_array();
+            for (const auto& element : value)
+            {
+                serializer<T>::write(writer, element);
+            }
+            writer.end_array();
+        }
+
+        static std::vector<T> read(argument_reader& reader)
+        {
+            std::vector<T> value;
+            reader.begin_array();
+            while (reader.next_element())
+            {
+                value.push_back(serializer<T>::read(reader));
+            }
+            return value;
+        }
+    };
+
+    // allows mixing typed arguments with values that only exist as json
+    template<>
+    struct serializer<web::json::value>
+    {
+        static void write(argument_writer& writer, const web::json::value& value)
+        {
+            const auto json = utility::conversions::to_utf8string(value.serialize());
+            writer.write_raw(json.data(), json.size());
+        }
+
+        static web::json::value read(argument_reader& reader)
+        {
+            return web::json::value::parse(utility::conversions::to_string_t(reader.read_raw()));
+        }
+    };
+
+    namespace details
+    {
+        inline void write_arguments(argument_writer&)
+        { }
+
+        template<typename T, typename... Rest>
+        void write_arguments(argument_writer& writer, const T& value, const Rest&... rest)
+        {
+            // decaying `const T` turns string literals into `const char*`
+            serializer<typename std::decay<const T>::type>::write(writer, value);
+            write_arguments(writer, rest...);
+        }
+
+        // serializes the arguments as the json array sent to the server
+        template<typename... Args>
+        std::string serialize_arguments(const Args&... args)
+        {
+            std::string arguments;
+            argument_writer writer(arguments);
+            writer.begin_array();
+            write_arguments(writer, args...);
+            writer.end_array();
+            return arguments;
+        }
+
+        // serializes the arguments into a buffer owned by the calling thread so that only the first call on each thread
+        // allocates. The returned buffer is overwritten by the next call on the same thread.
+        template<typename... Args>
+        const std::string& serialize_arguments_reusing_buffer(const Args&... args)
+        {
+            static thread_local std::string arguments;
+            arguments.clear();
+            argument_writer writer(arguments);
+            writer.begin_array();
+            write_arguments(writer, args...);
+            writer.end_array();
+            return arguments;
+        }
+
+        template<typename T>
+        typename std::decay<T>::type read_argument(argument_reader& reader)
+        {
+            if (!reader.next_element())
+            {
+                throw signalr_exception("the invocation has fewer arguments than the handler");
+            }
+
+            return serializer<typename std::decay<T>::type>::read(reader);
+        }
+
+        template<size_t... Indices>
+        struct index_sequence
+        { };
+
+        template<size_t Count, size_t... Indices>
+        struct make_index_sequence : make_index_sequence<Count - 1, Count - 1, Indices...>
+        { };
+
+        template<size_t... Indices>
+        struct make_index_sequence<0, Indices...> : index_sequence<Indices...>
+        { };
+
+        template<typename Handler, typename Tuple, size_t... Indices>
+        void apply(const Handler& handler, Tuple& arguments, index_sequence<Indices...>)
+        {
+            handler(std::move(std::get<Indices>(arguments))...);
+        }
+
+        // decodes the json array of arguments and calls the handler with them
+        template<typename... Args>
+        void invoke_handler(const std::function<void(Args...)>& handler, const std::string& arguments)
+        {
+            argument_reader reader(arguments.data(), arguments.size());
+            reader.begin_array();
+
+            // arguments in a braced initializer list are evaluated in order
+            std::tuple<typename std::decay<Args>::type...> values{ read_argument<Args>(reader)... };
+
+            // additional arguments are ignored
+            apply(handler, values, make_index_sequence<sizeof...(Args)>());
+        }
+
+        template<typename R>
+        struct result_reader
+        {
+            static R read(const std::string& result)
+            {
+                argument_reader reader(result.data(), result.size());
+                return serializer<R>::read(reader);
+            }
+        };
+
+        template<>
+        struct result_reader<void>
+        {
+            static void read(const std::string&)
+            { }
+        };
+
+        // prevents deducing template arguments from the handler so that lambdas can be passed to `on<Args...>`
+        template<typename T>
+        struct non_deduced
+        {
+            typedef T type;
+        };
+    }
+}
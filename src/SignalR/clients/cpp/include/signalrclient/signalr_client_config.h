@@ -3,15 +3,25 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include "cpprest/http_client.h"
 #include "cpprest/ws_client.h"
 #include "_exports.h"
+#include "handler_dispatch_mode.h"
+#include "hub_protocol_type.h"
+#include "invocation_admission_policy.h"
 
 namespace signalr
 {
+    // Runs the given work, typically on another thread. Must not run the work inline.
+    typedef std::function<void(const std::function<void()>&)> handler_executor;
+
     class signalr_client_config
     {
     public:
+        SIGNALRCLIENT_API signalr_client_config();
+
         SIGNALRCLIENT_API void __cdecl set_proxy(const web::web_proxy &proxy);
         // Please note that setting credentials does not work in all cases.
         // For example, Basic Authentication fails under Win32.
@@ -22,15 +32,144 @@ namespace signalr
         SIGNALRCLIENT_API web::http::client::http_client_config __cdecl get_http_client_config() const;
         SIGNALRCLIENT_API void __cdecl set_http_client_config(const web::http::client::http_client_config& http_client_config);
 
+        // Requests to the same server share http clients and their connections with other connections using an
+        // equivalent http client config. Configs setting credentials, OAuth or an ssl context callback are never shared.
+        // Native handle options cannot be compared - disable pooling if they set per-connection state such as client
+        // certificates. Enabled by default.
+        SIGNALRCLIENT_API bool __cdecl get_http_client_pooling() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_http_client_pooling(bool http_client_pooling);
+
         SIGNALRCLIENT_API web::websockets::client::websocket_client_config __cdecl get_websocket_client_config() const noexcept;
         SIGNALRCLIENT_API void __cdecl set_websocket_client_config(const web::websockets::client::websocket_client_config& websocket_client_config);
 
         SIGNALRCLIENT_API web::http::http_headers __cdecl get_http_headers() const noexcept;
         SIGNALRCLIENT_API void __cdecl set_http_headers(const web::http::http_headers& http_headers);
 
+        // Selects the protocol used by hub connections. The json protocol is the default. The messagepack protocol
+        // uses binary frames and is only used if the server supports the binary transfer format.
+        SIGNALRCLIENT_API hub_protocol_type __cdecl get_hub_protocol() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_hub_protocol(hub_protocol_type hub_protocol);
+
+        // Maximum number of items buffered for each stream returned by `hub_connection::stream`. A stream receiving an
+        // item while its buffer is full fails with a `signalr_exception` and is canceled on the server. Defaults to 64.
+        SIGNALRCLIENT_API size_t __cdecl get_stream_buffer_capacity() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_stream_buffer_capacity(size_t capacity);
+
+        // Maximum number of items of each upload stream handed to the transport but not yet sent. Once the window is
+        // full `stream_writer::write` does not complete until an earlier item has been sent. Defaults to 16.
+        SIGNALRCLIENT_API size_t __cdecl get_stream_upload_window() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_stream_upload_window(size_t window);
+
+        // Opt-in batching of outgoing messages. When the threshold is greater than 0 sent messages are queued and
+        // sent together in a single frame once the queued messages reach the threshold (in bytes) or the batch window
+        // elapsed, whichever comes first. Messages are concatenated as is, which is only safe for self-delimiting
+        // messages such as hub protocol messages. Disabled by default.
+        SIGNALRCLIENT_API size_t __cdecl get_send_batch_threshold() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_send_batch_threshold(size_t threshold);
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_send_batch_window() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_send_batch_window(std::chrono::milliseconds window);
+
+        // Messages are queued per connection and sent by a single writer. Once the bytes queued or being sent reach
+        // the threshold the task returned by `wait_for_send_capacity` of the connection does not complete until they
+        // drop below it again, which lets senders throttle. Sending itself is never blocked. Defaults to 1 MiB.
+        SIGNALRCLIENT_API size_t __cdecl get_send_backpressure_threshold() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_send_backpressure_threshold(size_t threshold);
+
+        // Time to wait for the transport to connect before starting the connection fails. Defaults to 5 seconds.
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_transport_connect_timeout() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_transport_connect_timeout(std::chrono::milliseconds timeout);
+
+        // A hub connection sends a ping when it has not sent any message for the keep alive interval. Defaults to 15
+        // seconds.
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_keep_alive_interval() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_keep_alive_interval(std::chrono::milliseconds interval);
+
+        // A hub connection is stopped when it has not received any message from the server for the server timeout.
+        // Should be at least double the keep alive interval of the server. Defaults to 30 seconds.
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_server_timeout() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_server_timeout(std::chrono::milliseconds timeout);
+
+        // Invocations whose result has not been received within the timeout fail with a `signalr_exception` and the
+        // server is asked to cancel them. Applies to invocations that are not given their own timeout. 0 means no
+        // timeout, which is the default.
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_invocation_timeout() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_invocation_timeout(std::chrono::milliseconds timeout);
+
+        // Opt-in automatic reconnect. When enabled a connection whose transport was lost enters the reconnecting state
+        // and tries to reconnect instead of disconnecting. Attempts are delayed by a random time between 0 and a bound
+        // that starts at the initial delay and doubles with each failed attempt up to the maximum delay. The connection
+        // disconnects after the maximum number of failed attempts (0 means no limit). Disabled by default.
+        SIGNALRCLIENT_API bool __cdecl get_automatic_reconnect() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_automatic_reconnect(bool automatic_reconnect);
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_reconnect_initial_delay() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_reconnect_initial_delay(std::chrono::milliseconds delay);
+        SIGNALRCLIENT_API std::chrono::milliseconds __cdecl get_reconnect_max_delay() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_reconnect_max_delay(std::chrono::milliseconds delay);
+        SIGNALRCLIENT_API unsigned int __cdecl get_max_reconnect_attempts() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_max_reconnect_attempts(unsigned int max_attempts);
+
+        // Connects directly to the WebSockets endpoint of the server without sending the negotiate request first, which
+        // saves a round trip when starting the connection. Only works with servers that have the WebSockets transport
+        // enabled and do not redirect the negotiate request (e.g. Azure SignalR Service). Disabled by default.
+        SIGNALRCLIENT_API bool __cdecl get_skip_negotiation() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_skip_negotiation(bool skip_negotiation);
+
+        // Selects how handlers registered with `hub_connection::on` are invoked. In all modes but the synchronous
+        // one (the default) the connection keeps reading messages while handlers run, until the number of invocations
+        // queued or being handled reaches the maximum. No more messages are read from the connection until a handler
+        // finished after that - this includes results of invocations, stream items and pings, and the server timeout
+        // is paused meanwhile. Handlers waiting synchronously for the result of an invocation made on the same
+        // connection can therefore deadlock it once the maximum is reached. Handlers run on the handler executor, the
+        // pplx thread pool if none is set. The settings are applied when the connection starts.
+        SIGNALRCLIENT_API handler_dispatch_mode __cdecl get_handler_dispatch_mode() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_handler_dispatch_mode(handler_dispatch_mode mode);
+        SIGNALRCLIENT_API handler_executor __cdecl get_handler_executor() const;
+        SIGNALRCLIENT_API void __cdecl set_handler_executor(const handler_executor& executor);
+        // Defaults to 1024.
+        SIGNALRCLIENT_API size_t __cdecl get_max_pending_handlers() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_max_pending_handlers(size_t max_pending_handlers);
+
+        // Limits the number of invocations waiting for their result (0, the default, means no limit). The admission
+        // policy decides what happens to invocations exceeding the limit. Invocations queued by the `wait` policy do
+        // not count as outstanding until they are sent. Regardless of this limit at most 65536 invocations and
+        // streams can be waiting for their result at the same time, the tasks and stream readers of any further ones
+        // fail with a `signalr_exception`.
+        SIGNALRCLIENT_API size_t __cdecl get_max_outstanding_invocations() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_max_outstanding_invocations(size_t max_outstanding_invocations);
+        // Defaults to `invocation_admission_policy::reject`.
+        SIGNALRCLIENT_API invocation_admission_policy __cdecl get_invocation_admission_policy() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_invocation_admission_policy(invocation_admission_policy policy);
+        // Limits the number of invocations queued by the `wait` and `shed_oldest` policies while the maximum number of
+        // outstanding invocations has been reached. Further invocations fail with a `signalr_exception`. Queued
+        // invocations time out and can be canceled like outstanding ones. Defaults to 1024.
+        SIGNALRCLIENT_API size_t __cdecl get_max_queued_invocations() const noexcept;
+        SIGNALRCLIENT_API void __cdecl set_max_queued_invocations(size_t max_queued_invocations);
+
     private:
         web::http::client::http_client_config m_http_client_config;
+        bool m_http_client_pooling;
         web::websockets::client::websocket_client_config m_websocket_client_config;
         web::http::http_headers m_http_headers;
+        hub_protocol_type m_hub_protocol;
+        size_t m_stream_buffer_capacity;
+        size_t m_stream_upload_window;
+        size_t m_send_batch_threshold;
+        std::chrono::milliseconds m_send_batch_window;
+        size_t m_send_backpressure_threshold;
+        std::chrono::milliseconds m_transport_connect_timeout;
+        std::chrono::milliseconds m_keep_alive_interval;
+        std::chrono::milliseconds m_server_timeout;
+        std::chrono::milliseconds m_invocation_timeout;
+        bool m_automatic_reconnect;
+        std::chrono::milliseconds m_reconnect_initial_delay;
+        std::chrono::milliseconds m_reconnect_max_delay;
+        unsigned int m_max_reconnect_attempts;
+        bool m_skip_negotiation;
+        handler_dispatch_mode m_handler_dispatch_mode;
+        handler_executor m_handler_executor;
+        size_t m_max_pending_handlers;
+        size_t m_max_outstanding_invocations;
+        invocation_admission_policy m_invocation_admission_policy;
+        size_t m_max_queued_invocations;
     };
 }
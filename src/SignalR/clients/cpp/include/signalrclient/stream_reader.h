@@ -0,0 +1,49 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include "_exports.h"
+#include <memory>
+#include "pplx/pplxtasks.h"
+#include "cpprest/json.h"
+
+namespace signalr
+{
+    class stream_reader_impl;
+
+    // Reads the items of a stream returned by a hub method. Items sent by the server are buffered up to the
+    // capacity set with `signalr_client_config::set_stream_buffer_capacity`. An item arriving while the buffer is full
+    // fails the stream with a `signalr_exception` after the buffered items and cancels it on the server, so a consumer
+    // falling behind loses its stream rather than stalling the connection.
+    //
+    // Destroying the reader before the stream completed cancels the stream on the server.
+    class stream_reader
+    {
+    public:
+        explicit stream_reader(std::shared_ptr<stream_reader_impl> impl);
+
+        SIGNALRCLIENT_API stream_reader(stream_reader&& other);
+        SIGNALRCLIENT_API stream_reader& operator=(stream_reader&& other);
+
+        SIGNALRCLIENT_API ~stream_reader();
+
+        stream_reader(const stream_reader&) = delete;
+        stream_reader& operator=(const stream_reader&) = delete;
+
+        // Advances to the next item. The returned task completes with `true` once an item is available, with `false`
+        // when the server completed the stream, with a `hub_exception` if the server completed it with an error and
+        // with a `signalr_exception` if the buffer overflowed.
+        // Only one call can be outstanding at a time.
+        SIGNALRCLIENT_API pplx::task<bool> __cdecl move_next();
+
+        // The item read by the last successful `move_next` call.
+        SIGNALRCLIENT_API const web::json::value& __cdecl current() const;
+
+        // Cancels the stream on the server. Pending and subsequent `move_next` calls complete with `false`.
+        SIGNALRCLIENT_API void __cdecl cancel();
+
+    private:
+        std::shared_ptr<stream_reader_impl> m_pImpl;
+    };
+}
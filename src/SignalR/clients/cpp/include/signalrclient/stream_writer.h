@@ -0,0 +1,43 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include "_exports.h"
+#include <memory>
+#include "pplx/pplxtasks.h"
+#include "cpprest/json.h"
+
+namespace signalr
+{
+    class stream_writer_impl;
+
+    // Uploads a stream to the server. The writer is passed to `hub_connection::invoke` or `hub_connection::send`
+    // for the stream parameters of the hub method and items written to it are sent as they are written.
+    //
+    // At most `signalr_client_config::get_stream_upload_window` items are in flight at any time. Once the window
+    // is full the task returned by `write` does not complete until the transport has finished sending an earlier
+    // item, so awaiting each write keeps memory bounded regardless of the size of the upload.
+    //
+    // Copies of the writer refer to the same stream.
+    class stream_writer
+    {
+    public:
+        SIGNALRCLIENT_API stream_writer();
+
+        SIGNALRCLIENT_API stream_writer(const stream_writer& other);
+        SIGNALRCLIENT_API stream_writer& operator=(const stream_writer& other);
+
+        SIGNALRCLIENT_API ~stream_writer();
+
+        SIGNALRCLIENT_API pplx::task<void> __cdecl write(const web::json::value& item);
+
+        // Completes the stream. An empty error completes the stream successfully.
+        SIGNALRCLIENT_API pplx::task<void> __cdecl complete(const std::string& error = "");
+
+    private:
+        friend class hub_connection_impl;
+
+        std::shared_ptr<stream_writer_impl> m_pImpl;
+    };
+}
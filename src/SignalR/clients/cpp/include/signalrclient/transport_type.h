@@ -8,6 +8,7 @@ namespace signalr
     enum class transport_type
     {
         long_polling,
+        server_sent_events,
         websockets
     };
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "batching_sender.h"
+#include "constants.h"
+#include "signalrclient/signalr_exception.h"
+#include "signalrclient/web_exception.h"
+
+namespace signalr
+{
+    std::shared_ptr<batching_sender> batching_sender::create(const std::shared_ptr<web_request_factory>& web_request_factory,
+        const std::string& url, const signalr_client_config& signalr_client_config,
+        const std::shared_ptr<web::http::client::http_client>& http_client)
+    {
+        return std::shared_ptr<batching_sender>(
+            new batching_sender(web_request_factory, url, signalr_client_config, http_client));
+    }
+
+    batching_sender::batching_sender(const std::shared_ptr<web_request_factory>& web_request_factory, const std::string& url,
+        const signalr_client_config& signalr_client_config,
+        const std::shared_ptr<web::http::client::http_client>& http_client)
+        : m_web_request_factory(web_request_factory), m_url(url), m_signalr_client_config(signalr_client_config),
+        m_http_client(http_client), m_send_in_progress(false)
+    { }
+
+    pplx::task<void> batching_sender::send(const std::string& data, transfer_format transfer_format)
+    {
+        pplx::task_completion_event<void> sent;
+        bool start_sending = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_send_lock);
+
+            // data with different transfer formats cannot be sent in the same request
+            if (!m_pending_sends.empty() && m_pending_sends.back().format == transfer_format)
+            {
+                m_pending_sends.back().data.append(data);
+                sent = m_pending_sends.back().sent;
+            }
+            else
+            {
+                m_pending_sends.push_back(pending_send{ data, transfer_format, sent });
+            }
+
+            if (!m_send_in_progress)
+            {
+                m_send_in_progress = true;
+                start_sending = true;
+            }
+        }
+
+        if (start_sending)
+        {
+            send_pending();
+        }
+
+        return pplx::create_task(sent);
+    }
+
+    void batching_sender::send_pending()
+    {
+        pending_send pending;
+
+        {
+            std::lock_guard<std::mutex> lock(m_send_lock);
+            if (m_pending_sends.empty())
+            {
+                m_send_in_progress = false;
+                return;
+            }
+
+            pending = std::move(m_pending_sends.front());
+            m_pending_sends.pop_front();
+        }
+
+        auto request = m_web_request_factory->create_web_request(m_url);
+        request->set_method(utility::conversions::to_utf8string(web::http::methods::POST));
+        request->set_user_agent(USER_AGENT);
+        request->set_client_config(m_signalr_client_config);
+        request->set_http_client(m_http_client);
+        request->set_body(pending.data,
+            pending.format == transfer_format::binary ? "application/octet-stream" : "text/plain; charset=utf-8");
+
+        auto weak_sender = std::weak_ptr<batching_sender>(shared_from_this());
+        auto sent = pending.sent;
+
+        request->get_response()
+            .then([](web_response response)
+            {
+                if (response.status_code != 200)
+                {
+                    std::stringstream oss;
+                    oss << "web exception - " << response.status_code << " " << response.reason_phrase;
+                    throw web_exception(oss.str(), response.status_code);
+                }
+
+                return response.body;
+            })
+            .then([weak_sender, sent](pplx::task<std::string> send_task)
+            {
+                try
+                {
+                    send_task.get();
+                    sent.set();
+                }
+                catch (const std::exception&)
+                {
+                    sent.set_exception(std::current_exception());
+                }
+
+                // data sent in the meantime is sent with the next request
+                auto sender = weak_sender.lock();
+                if (sender)
+                {
+                    sender->send_pending();
+                }
+            });
+    }
+
+    void batching_sender::cancel_pending()
+    {
+        std::deque<pending_send> pending_sends;
+        {
+            std::lock_guard<std::mutex> lock(m_send_lock);
+            pending_sends.swap(m_pending_sends);
+        }
+
+        for (auto& pending : pending_sends)
+        {
+            pending.sent.set_exception(signalr_exception("the transport was disconnected before the data was sent"));
+        }
+    }
+}
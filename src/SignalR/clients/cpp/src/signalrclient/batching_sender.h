@@ -0,0 +1,58 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include "cpprest/http_client.h"
+#include "signalrclient/signalr_client_config.h"
+#include "transfer_format.h"
+#include "web_request_factory.h"
+
+namespace signalr
+{
+    // Sends data to the server with POST requests for the http based transports. Only one request is in progress at a
+    // time - data sent while a request is in progress is sent with a single request once the request in progress
+    // completes.
+    class batching_sender : public std::enable_shared_from_this<batching_sender>
+    {
+    public:
+        static std::shared_ptr<batching_sender> create(const std::shared_ptr<web_request_factory>& web_request_factory,
+            const std::string& url, const signalr_client_config& signalr_client_config,
+            const std::shared_ptr<web::http::client::http_client>& http_client);
+
+        batching_sender(const batching_sender&) = delete;
+
+        batching_sender& operator=(const batching_sender&) = delete;
+
+        pplx::task<void> send(const std::string& data, transfer_format transfer_format);
+
+        // fails the sends whose data has not been sent yet
+        void cancel_pending();
+
+    private:
+        // data sent while a POST request is in progress. `sent` is completed when the data has been sent
+        struct pending_send
+        {
+            std::string data;
+            transfer_format format;
+            pplx::task_completion_event<void> sent;
+        };
+
+        batching_sender(const std::shared_ptr<web_request_factory>& web_request_factory, const std::string& url,
+            const signalr_client_config& signalr_client_config,
+            const std::shared_ptr<web::http::client::http_client>& http_client);
+
+        std::shared_ptr<web_request_factory> m_web_request_factory;
+        const std::string m_url;
+        const signalr_client_config m_signalr_client_config;
+        std::shared_ptr<web::http::client::http_client> m_http_client;
+
+        std::mutex m_send_lock;
+        std::deque<pending_send> m_pending_sends;
+        bool m_send_in_progress;
+
+        void send_pending();
+    };
+}
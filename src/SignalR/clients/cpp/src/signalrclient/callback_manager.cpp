@@ -3,89 +3,272 @@
 
 #include "stdafx.h"
 #include "callback_manager.h"
+#include "signalrclient/signalr_exception.h"
 
 namespace signalr
 {
-    // dtor_clear_arguments will be passed when closing any pending callbacks when the `callback_manager` is
-    // destroyed (i.e. in the dtor)
-    callback_manager::callback_manager(const web::json::value& dtor_clear_arguments)
-        : m_dtor_clear_arguments(dtor_clear_arguments)
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        const uint64_t occupied_flag = 1ULL << 31;
+        const uint64_t removed_flag = 1ULL << 30;
+        const uint64_t users_mask = removed_flag - 1;
+        const uint64_t index_bits = 16;
+
+        uint32_t get_generation(uint64_t state)
+        {
+            return static_cast<uint32_t>(state >> 32);
+        }
+    }
+
+    callback_manager::slot::slot() noexcept
+        : state(0), next_free(0)
     { }
 
+    // dtor_error will be passed when closing any pending callbacks when the `callback_manager` is destroyed (i.e. in
+    // the dtor)
+    callback_manager::callback_manager(const std::string& dtor_error)
+        : m_chunk_count(0), m_free_list(0), m_dtor_error(dtor_error)
+    {
+        for (auto& chunk : m_chunks)
+        {
+            chunk.store(nullptr);
+        }
+
+        grow();
+    }
+
     callback_manager::~callback_manager()
     {
-        clear(m_dtor_clear_arguments);
+        clear(m_dtor_error);
     }
 
     // note: callback must not throw except for the `on_progress` callback which will never be invoked from the dtor
-    std::string callback_manager::register_callback(const std::function<void(const web::json::value&)>& callback)
+    std::string callback_manager::register_callback(std::function<void(const invocation_result&)> callback)
     {
-        auto callback_id = get_callback_id();
+        const auto index = allocate_slot();
+        auto& slot = *get_slot(index);
+
+        // the slot is owned exclusively until it is published as occupied
+        slot.callback = std::move(callback);
+        const auto generation = get_generation(slot.state.load(std::memory_order_relaxed));
+        slot.state.store((static_cast<uint64_t>(generation) << 32) | occupied_flag, std::memory_order_release);
 
+        return std::to_string((static_cast<uint64_t>(generation) << index_bits) | index);
+    }
+
+    // invokes a callback and stops tracking it if remove callback set to true
+    bool callback_manager::invoke_callback(const std::string& callback_id, const invocation_result& result, bool remove_callback)
+    {
+        uint64_t id;
+        uint32_t index;
+        slot* slot;
+        if (!try_parse_callback_id(callback_id, id) || !acquire(id, remove_callback, true, index, slot))
         {
-            std::lock_guard<std::mutex> lock(m_map_lock);
+            return false;
+        }
 
-            m_callbacks.insert(std::make_pair(callback_id, callback));
+        try
+        {
+            slot->callback(result);
+        }
+        catch (...)
+        {
+            release(index, *slot);
+            throw;
         }
 
-        return callback_id;
+        release(index, *slot);
+        return true;
     }
 
+    bool callback_manager::remove_callback(const std::string& callback_id)
+    {
+        uint64_t id;
+        uint32_t index;
+        slot* slot;
+        return try_parse_callback_id(callback_id, id) && acquire(id, true, false, index, slot);
+    }
 
-    // invokes a callback and stops tracking it if remove callback set to true
-    bool callback_manager::invoke_callback(const std::string& callback_id, const web::json::value& arguments, bool remove_callback)
+    // callbacks are invoked without holding any lock so they are free to register new callbacks or stop the connection
+    void callback_manager::clear(const std::string& error)
     {
-        std::function<void(const web::json::value& arguments)> callback;
+        const invocation_result result(error);
 
+        const auto chunk_count = m_chunk_count.load(std::memory_order_acquire);
+        for (uint32_t index = 0; index < chunk_count * slots_per_chunk; index++)
         {
-            std::lock_guard<std::mutex> lock(m_map_lock);
+            auto& slot = *get_slot(index);
+            const auto state = slot.state.load(std::memory_order_acquire);
+            if ((state & occupied_flag) == 0 || (state & removed_flag) != 0)
+            {
+                continue;
+            }
 
-            auto iter = m_callbacks.find(callback_id);
-            if (iter == m_callbacks.end())
+            uint32_t acquired_index;
+            callback_manager::slot* acquired_slot;
+            const auto id = (static_cast<uint64_t>(get_generation(state)) << index_bits) | index;
+            if (acquire(id, true, true, acquired_index, acquired_slot))
             {
-                return false;
+                acquired_slot->callback(result);
+                release(acquired_index, *acquired_slot);
             }
+        }
+    }
 
-            callback = iter->second;
+    // Marks the slot as being used and/or removed if it still holds the callback with the given id. A removed callback
+    // cannot be acquired anymore and the slot is released once the last caller using the callback is done with it.
+    bool callback_manager::acquire(uint64_t callback_id, bool remove, bool use, uint32_t& index, slot*& slot)
+    {
+        index = static_cast<uint32_t>(callback_id & ((1ULL << index_bits) - 1));
+        const auto generation = static_cast<uint32_t>(callback_id >> index_bits);
 
-            if (remove_callback)
+        slot = get_slot(index);
+        if (slot == nullptr || (callback_id >> index_bits) > UINT32_MAX)
+        {
+            return false;
+        }
+
+        auto state = slot->state.load(std::memory_order_acquire);
+        uint64_t new_state;
+        do
+        {
+            if (get_generation(state) != generation || (state & occupied_flag) == 0 || (state & removed_flag) != 0)
+            {
+                return false;
+            }
+
+            new_state = state | (remove ? removed_flag : 0);
+            if (use)
             {
-                m_callbacks.erase(callback_id);
+                new_state++;
             }
+        } while (!slot->state.compare_exchange_weak(state, new_state, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        if (!use && remove && (new_state & users_mask) == 0)
+        {
+            release_slot(index, *slot);
         }
 
-        callback(arguments);
         return true;
     }
 
-    bool callback_manager::remove_callback(const std::string& callback_id)
+    void callback_manager::release(uint32_t index, slot& slot)
     {
+        const auto state = slot.state.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        if ((state & removed_flag) != 0 && (state & users_mask) == 0)
         {
-            std::lock_guard<std::mutex> lock(m_map_lock);
-
-            return m_callbacks.erase(callback_id) != 0;
+            release_slot(index, slot);
         }
     }
 
-    void callback_manager::clear(const web::json::value& arguments)
+    // invoked by the last user of a removed callback - nobody else can acquire the slot at this point
+    void callback_manager::release_slot(uint32_t index, slot& slot)
     {
-        {
-            std::lock_guard<std::mutex> lock(m_map_lock);
+        slot.callback = nullptr;
+        const auto generation = get_generation(slot.state.load(std::memory_order_relaxed));
+        slot.state.store(static_cast<uint64_t>(generation + 1) << 32, std::memory_order_release);
+        push_free(index, index);
+    }
 
-            for (auto& kvp : m_callbacks)
+    uint32_t callback_manager::allocate_slot()
+    {
+        while (true)
+        {
+            auto head = m_free_list.load(std::memory_order_acquire);
+            while ((head & UINT32_MAX) != 0)
             {
-                kvp.second(arguments);
+                const auto index = static_cast<uint32_t>(head & UINT32_MAX) - 1;
+                const auto next = get_slot(index)->next_free.load(std::memory_order_relaxed);
+                const auto new_head = (((head >> 32) + 1) << 32) | next;
+                if (m_free_list.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    return index;
+                }
             }
 
-            m_callbacks.clear();
+            grow();
+        }
+    }
+
+    // slow path taken when all slots are in use
+    void callback_manager::grow()
+    {
+        std::lock_guard<std::mutex> lock(m_grow_lock);
+
+        // another thread may have added slots while this thread was waiting for the lock
+        if ((m_free_list.load(std::memory_order_acquire) & UINT32_MAX) != 0)
+        {
+            return;
+        }
+
+        const auto chunk_count = m_chunk_count.load(std::memory_order_relaxed);
+        if (chunk_count == max_chunks)
+        {
+            throw signalr_exception(std::string("the maximum number of pending invocations (")
+                .append(std::to_string(max_callbacks))
+                .append(") has been reached"));
+        }
+
+        m_chunks_storage[chunk_count].reset(new slot[slots_per_chunk]);
+        auto chunk = m_chunks_storage[chunk_count].get();
+
+        const auto first = static_cast<uint32_t>(chunk_count * slots_per_chunk);
+        for (uint32_t i = 0; i < slots_per_chunk - 1; i++)
+        {
+            chunk[i].next_free.store(first + i + 2, std::memory_order_relaxed);
+        }
+
+        m_chunks[chunk_count].store(chunk, std::memory_order_release);
+        m_chunk_count.store(chunk_count + 1, std::memory_order_release);
+
+        push_free(first, first + slots_per_chunk - 1);
+    }
+
+    // pushes the slots from first to last which must already be linked to each other
+    void callback_manager::push_free(uint32_t first, uint32_t last)
+    {
+        auto& last_slot = *get_slot(last);
+        auto head = m_free_list.load(std::memory_order_acquire);
+        uint64_t new_head;
+        do
+        {
+            last_slot.next_free.store(static_cast<uint32_t>(head & UINT32_MAX), std::memory_order_relaxed);
+            new_head = (((head >> 32) + 1) << 32) | (first + 1);
+        } while (!m_free_list.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire));
+    }
+
+    callback_manager::slot* callback_manager::get_slot(uint32_t index) const
+    {
+        const auto chunk_index = index / slots_per_chunk;
+        if (chunk_index >= max_chunks)
+        {
+            return nullptr;
         }
+
+        const auto chunk = m_chunks[chunk_index].load(std::memory_order_acquire);
+        return chunk == nullptr ? nullptr : chunk + index % slots_per_chunk;
     }
 
-    std::string callback_manager::get_callback_id()
+    bool callback_manager::try_parse_callback_id(const std::string& callback_id, uint64_t& value)
     {
-        const auto callback_id = m_id++;
-        std::stringstream ss;
-        ss << callback_id;
-        return ss.str();
+        // ids are generated by this class so anything else (including ids that would overflow) is simply unknown
+        if (callback_id.empty() || callback_id.size() > 19)
+        {
+            return false;
+        }
+
+        value = 0;
+        for (auto c : callback_id)
+        {
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+
+            value = value * 10 + (c - '0');
+        }
+
+        return true;
     }
 }
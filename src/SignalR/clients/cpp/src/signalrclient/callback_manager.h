@@ -4,33 +4,92 @@
 #pragma once
 
 #include <atomic>
-#include <unordered_map>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include "cpprest/json.h"
+#include <string>
+#include "lazy_json_value.h"
 
 namespace signalr
 {
+    // What the callback of a pending invocation is invoked with: a stream item, the completion of the invocation with
+    // an optional result or the error that failed the invocation. Values are passed on as received so a result is only
+    // parsed if the callback needs it parsed.
+    struct invocation_result
+    {
+        invocation_result()
+            : is_item(false), has_value(false), value(web::json::value::null())
+        { }
+
+        explicit invocation_result(std::string error)
+            : is_item(false), has_value(false), value(web::json::value::null()), error(std::move(error))
+        { }
+
+        // more items or the completion will follow a stream item
+        bool is_item;
+        bool has_value;
+        lazy_json_value value;
+        // not empty if the invocation failed
+        std::string error;
+    };
+
+    // Tracks the callbacks of pending invocations. Callbacks are stored in a table of preallocated slots which are
+    // claimed and released with atomic operations only, so registering and invoking callbacks does not take a lock.
+    // A lock is only taken on the slow path when all slots are in use and the table grows.
+    //
+    // Callback ids encode the slot index and the generation of the slot. The generation is bumped whenever a slot is
+    // released so ids of completed invocations never match the callback registered in the same slot later on.
     class callback_manager
     {
     public:
-        explicit callback_manager(const web::json::value& dtor_error);
+        // registering more callbacks throws a `signalr_exception`, see `signalr_client_config::set_max_outstanding_invocations`
+        static const size_t max_callbacks = 256 * 256;
+
+        explicit callback_manager(const std::string& dtor_error);
         ~callback_manager();
 
         callback_manager(const callback_manager&) = delete;
         callback_manager& operator=(const callback_manager&) = delete;
 
-        std::string register_callback(const std::function<void(const web::json::value&)>& callback);
-        bool invoke_callback(const std::string& callback_id, const web::json::value& arguments, bool remove_callback);
+        std::string register_callback(std::function<void(const invocation_result&)> callback);
+        bool invoke_callback(const std::string& callback_id, const invocation_result& result, bool remove_callback);
         bool remove_callback(const std::string& callback_id);
-        void clear(const web::json::value& arguments);
+        // fails all pending invocations with the error
+        void clear(const std::string& error);
 
     private:
-        std::atomic<int> m_id { 0 };
-        std::unordered_map<std::string, std::function<void(const web::json::value&)>> m_callbacks;
-        std::mutex m_map_lock;
-        const web::json::value m_dtor_clear_arguments;
+        static const size_t slots_per_chunk = 256;
+        static const size_t max_chunks = max_callbacks / slots_per_chunk;
+
+        struct slot
+        {
+            slot() noexcept;
+
+            // generation (upper 32 bits) | occupied flag | removed flag | number of callers using the callback
+            std::atomic<uint64_t> state;
+            // index + 1 of the next free slot, 0 terminates the list
+            std::atomic<uint32_t> next_free;
+            std::function<void(const invocation_result&)> callback;
+        };
+
+        std::unique_ptr<slot[]> m_chunks_storage[max_chunks];
+        std::atomic<slot*> m_chunks[max_chunks];
+        std::atomic<size_t> m_chunk_count;
+        // tag (upper 32 bits) to prevent ABA | index + 1 of the first free slot
+        std::atomic<uint64_t> m_free_list;
+        std::mutex m_grow_lock;
+        const std::string m_dtor_error;
+
+        slot* get_slot(uint32_t index) const;
+        uint32_t allocate_slot();
+        void grow();
+        void push_free(uint32_t first, uint32_t last);
+        void release_slot(uint32_t index, slot& slot);
+
+        bool acquire(uint64_t callback_id, bool remove, bool use, uint32_t& index, slot*& slot);
+        void release(uint32_t index, slot& slot);
 
-        std::string get_callback_id();
+        static bool try_parse_callback_id(const std::string& callback_id, uint64_t& value);
     };
 }
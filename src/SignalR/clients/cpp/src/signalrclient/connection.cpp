@@ -26,6 +26,26 @@ namespace signalr
         return m_pImpl->send(data);
     }
 
+    pplx::task<void> connection::flush()
+    {
+        return m_pImpl->flush();
+    }
+
+    pplx::task<void> connection::wait_for_send_capacity()
+    {
+        return m_pImpl->wait_for_send_capacity();
+    }
+
+    size_t connection::get_send_queue_high_water_mark() const noexcept
+    {
+        return m_pImpl->get_send_queue_high_water_mark();
+    }
+
+    connection_metrics connection::get_metrics() const
+    {
+        return m_pImpl->get_metrics();
+    }
+
     void connection::set_message_received(const message_received_handler& message_received_callback)
     {
         m_pImpl->set_message_received(message_received_callback);
@@ -36,6 +56,16 @@ namespace signalr
         m_pImpl->set_disconnected(disconnected_callback);
     }
 
+    void connection::set_reconnecting(const std::function<void()>& reconnecting_callback)
+    {
+        m_pImpl->set_reconnecting(reconnecting_callback);
+    }
+
+    void connection::set_reconnected(const std::function<void()>& reconnected_callback)
+    {
+        m_pImpl->set_reconnected(reconnected_callback);
+    }
+
     void connection::set_client_config(const signalr_client_config& config)
     {
         m_pImpl->set_client_config(config);
@@ -2,7 +2,6 @@
 // Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
 
 #include "stdafx.h"
-#include <thread>
 #include <algorithm>
 #include "constants.h"
 #include "connection_impl.h"
@@ -10,6 +9,7 @@
 #include "url_builder.h"
 #include "trace_log_writer.h"
 #include "make_unique.h"
+#include "timer_service.h"
 #include "signalrclient/signalr_exception.h"
 
 namespace signalr
@@ -19,6 +19,11 @@ namespace signalr
     {
         // this is a workaround for a compiler bug where mutable lambdas won't sometimes compile
         static void log(const logger& logger, trace_level level, const std::string& entry);
+
+        // returns the name of the transport used in the negotiate response
+        static std::string translate_transport_type(transport_type transport_type);
+
+        static std::string elapsed_milliseconds(std::chrono::steady_clock::time_point since);
     }
 
     std::shared_ptr<connection_impl> connection_impl::create(const std::string& url, trace_level trace_level, const std::shared_ptr<log_writer>& log_writer)
@@ -29,15 +34,33 @@ namespace signalr
     std::shared_ptr<connection_impl> connection_impl::create(const std::string& url, trace_level trace_level, const std::shared_ptr<log_writer>& log_writer,
         std::unique_ptr<web_request_factory> web_request_factory, std::unique_ptr<transport_factory> transport_factory)
     {
-        return std::shared_ptr<connection_impl>(new connection_impl(url, trace_level,
+        auto connection = std::shared_ptr<connection_impl>(new connection_impl(url, trace_level,
             log_writer ? log_writer : std::make_shared<trace_log_writer>(), std::move(web_request_factory), std::move(transport_factory)));
+
+        // weak_ptr prevents a circular dependency since the queue is owned by the connection
+        std::weak_ptr<connection_impl> weak_connection = connection;
+        connection->m_send_queue = send_queue::create([weak_connection](const std::string& data, transfer_format transfer_format)
+        {
+            auto connection = weak_connection.lock();
+            if (!connection)
+            {
+                return pplx::task_from_exception<void>(signalr_exception("the connection has been deconstructed"));
+            }
+
+            return connection->write_to_transport(data, transfer_format);
+        }, connection->m_signalr_client_config.get_send_backpressure_threshold());
+
+        return connection;
     }
 
     connection_impl::connection_impl(const std::string& url, trace_level trace_level, const std::shared_ptr<log_writer>& log_writer,
         std::unique_ptr<web_request_factory> web_request_factory, std::unique_ptr<transport_factory> transport_factory)
         : m_base_url(url), m_connection_state(connection_state::disconnected), m_logger(log_writer, trace_level),
         m_transport(nullptr), m_web_request_factory(std::move(web_request_factory)), m_transport_factory(std::move(transport_factory)),
-        m_message_received([](const std::string&) noexcept {}), m_disconnected([]() noexcept {})
+        m_message_received([](const message_buffer&) noexcept {}), m_disconnected([]() noexcept {}), m_reconnecting([]() noexcept {}),
+        m_reconnected([]() noexcept {}), m_transfer_format(transfer_format::text), m_reconnect_attempt(0), m_reconnect_generation(0),
+        m_reconnect_timer_id(0), m_batch_flush_scheduled(false), m_batch_flush_timer_id(0),
+        m_messages_sent(0), m_bytes_sent(0), m_messages_received(0), m_bytes_received(0), m_reconnects(0)
     { }
 
     connection_impl::~connection_impl()
@@ -65,7 +88,7 @@ namespace signalr
         change_state(connection_state::disconnected);
     }
 
-    pplx::task<void> connection_impl::start()
+    pplx::task<void> connection_impl::start(transfer_format transfer_format)
     {
         {
             std::lock_guard<std::mutex> lock(m_stop_lock);
@@ -81,9 +104,18 @@ namespace signalr
             m_disconnect_cts = pplx::cancellation_token_source();
             m_start_completed_event.reset();
             m_connection_id = "";
+            m_transfer_format = transfer_format;
         }
 
-        return start_negotiate(m_base_url, 0);
+        const auto start_time = std::chrono::steady_clock::now();
+        auto logger = m_logger;
+
+        return start_negotiate(m_base_url, 0)
+            .then([logger, start_time]()
+            {
+                logger.log(trace_level::info,
+                    std::string("connection started in ").append(elapsed_milliseconds(start_time)).append(" ms"));
+            });
     }
 
     pplx::task<void> connection_impl::start_negotiate(const std::string& url, int redirect_count)
@@ -95,7 +127,11 @@ namespace signalr
 
         pplx::task_completion_event<void> start_tce;
 
+        // either connecting or reconnecting
+        const auto starting_state = get_connection_state();
+
         std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+        const auto negotiate_start_time = std::chrono::steady_clock::now();
 
         pplx::task_from_result()
             .then([weak_connection, url]()
@@ -105,9 +141,18 @@ namespace signalr
             {
                 return pplx::task_from_exception<negotiation_response>("connection no longer exists");
             }
+
+            if (connection->m_signalr_client_config.get_skip_negotiation())
+            {
+                // the server is expected to accept WebSockets connections without a connection id
+                negotiation_response negotiation_response;
+                negotiation_response.availableTransports.push_back(available_transport{ "WebSockets", {} });
+                return pplx::task_from_result(negotiation_response);
+            }
+
             return request_sender::negotiate(*connection->m_web_request_factory, url, connection->m_signalr_client_config);
         }, m_disconnect_cts.get_token())
-            .then([weak_connection, start_tce, redirect_count, url](negotiation_response negotiation_response)
+            .then([weak_connection, start_tce, redirect_count, url, starting_state, negotiate_start_time](negotiation_response negotiation_response)
         {
             auto connection = weak_connection.lock();
             if (!connection)
@@ -115,6 +160,16 @@ namespace signalr
                 return pplx::task_from_exception<void>("connection no longer exists");
             }
 
+            if (connection->m_signalr_client_config.get_skip_negotiation())
+            {
+                connection->m_logger.log(trace_level::info, "negotiation skipped");
+            }
+            else
+            {
+                connection->m_logger.log(trace_level::info,
+                    std::string("negotiate request completed in ").append(elapsed_milliseconds(negotiate_start_time)).append(" ms"));
+            }
+
             if (!negotiation_response.error.empty())
             {
                 return pplx::task_from_exception<void>(signalr_exception(negotiation_response.error));
@@ -132,28 +187,50 @@ namespace signalr
             }
 
             connection->m_connection_id = std::move(negotiation_response.connectionId);
+            connection->m_negotiate_url = url;
 
-            // TODO: fallback logic
+            const auto required_format = connection->m_transfer_format == transfer_format::binary ? "Binary" : "Text";
 
-            bool foundWebsockets = false;
-            for (auto availableTransport : negotiation_response.availableTransports)
+            // transports supported by the server are tried in the order of preference
+            std::vector<transport_type> transport_types;
+            bool found_transport = false;
+            for (auto transport_type : { transport_type::websockets, transport_type::server_sent_events, transport_type::long_polling })
             {
-                if (availableTransport.transport == "WebSockets")
+                const auto transport_name = translate_transport_type(transport_type);
+                for (const auto& availableTransport : negotiation_response.availableTransports)
                 {
-                    foundWebsockets = true;
-                    break;
+                    if (availableTransport.transport == transport_name)
+                    {
+                        found_transport = true;
+
+                        // Server-Sent Events cannot carry binary data
+                        const auto supports_format =
+                            (transport_type != transport_type::server_sent_events || connection->m_transfer_format == transfer_format::text) &&
+                            (availableTransport.transfer_formats.empty() ||
+                            std::find(availableTransport.transfer_formats.begin(), availableTransport.transfer_formats.end(), required_format)
+                                != availableTransport.transfer_formats.end());
+
+                        if (supports_format)
+                        {
+                            transport_types.push_back(transport_type);
+                        }
+                        break;
+                    }
                 }
             }
 
-            if (!foundWebsockets)
+            if (!found_transport)
             {
-                return pplx::task_from_exception<void>(signalr_exception("The server does not support WebSockets which is currently the only transport supported by this client."));
+                return pplx::task_from_exception<void>(signalr_exception("The server does not support any of the transports supported by this client."));
             }
 
-            // TODO: use transfer format
+            if (transport_types.empty())
+            {
+                return pplx::task_from_exception<void>(signalr_exception("The server does not support the transfer format required by the selected hub protocol."));
+            }
 
-            return connection->start_transport(url)
-                .then([weak_connection, start_tce](std::shared_ptr<transport> transport)
+            return connection->start_transport(url, transport_types, 0)
+                .then([weak_connection, start_tce, starting_state](std::shared_ptr<transport> transport)
             {
                 auto connection = weak_connection.lock();
                 if (!connection)
@@ -162,10 +239,12 @@ namespace signalr
                 }
                 connection->m_transport = transport;
 
-                if (!connection->change_state(connection_state::connecting, connection_state::connected))
+                if (!connection->change_state(starting_state, connection_state::connected))
                 {
                     connection->m_logger.log(trace_level::errors,
-                        std::string("internal error - transition from an unexpected state. expected state: connecting, actual state: ")
+                        std::string("internal error - transition from an unexpected state. expected state: ")
+                        .append(translate_connection_state(starting_state))
+                        .append(", actual state: ")
                         .append(translate_connection_state(connection->get_connection_state())));
 
                     _ASSERTE(false);
@@ -174,7 +253,7 @@ namespace signalr
                 return pplx::task_from_result();
             });
         }, m_disconnect_cts.get_token())
-            .then([start_tce, weak_connection](pplx::task<void> previous_task)
+            .then([start_tce, weak_connection, starting_state](pplx::task<void> previous_task)
         {
             auto connection = weak_connection.lock();
             if (!connection)
@@ -203,7 +282,11 @@ namespace signalr
                 }
 
                 connection->m_transport = nullptr;
-                connection->change_state(connection_state::disconnected);
+                // a failed reconnect attempt is followed by another one unless the connection is being stopped
+                if (starting_state != connection_state::reconnecting || connection->m_disconnect_cts.get_token().is_canceled())
+                {
+                    connection->change_state(connection_state::disconnected);
+                }
                 connection->m_start_completed_event.set();
                 start_tce.set_exception(std::current_exception());
             }
@@ -214,7 +297,88 @@ namespace signalr
         return pplx::create_task(start_tce);
     }
 
-    pplx::task<std::shared_ptr<transport>> connection_impl::start_transport(const std::string& url)
+    pplx::task<std::shared_ptr<transport>> connection_impl::start_transport(const std::string& url,
+        const std::vector<transport_type>& transport_types, size_t index)
+    {
+        std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+        const auto transport_type = transport_types[index];
+
+        return pplx::task_from_result()
+            .then([weak_connection, url, transport_type]()
+        {
+            auto connection = weak_connection.lock();
+            if (!connection)
+            {
+                return pplx::task_from_exception<std::shared_ptr<transport>>(signalr_exception("connection no longer exists"));
+            }
+
+            return connection->start_transport(url, transport_type);
+        })
+            .then([weak_connection, url, transport_types, index](pplx::task<std::shared_ptr<transport>> start_task)
+        {
+            try
+            {
+                return pplx::task_from_result(start_task.get());
+            }
+            catch (const std::exception& e)
+            {
+                auto connection = weak_connection.lock();
+                if (!connection || index + 1 >= transport_types.size() || connection->m_disconnect_cts.get_token().is_canceled())
+                {
+                    throw;
+                }
+
+                connection->m_logger.log(trace_level::errors,
+                    std::string("the ").append(translate_transport_type(transport_types[index]))
+                    .append(" transport could not be started due to: ").append(e.what())
+                    .append(". falling back to the ").append(translate_transport_type(transport_types[index + 1]))
+                    .append(" transport"));
+
+                // the server ties the connection id to the first transport that used it, even if that transport did
+                // not connect, so the next transport needs a new connection id
+                return connection->renegotiate(url)
+                    .then([weak_connection, url, transport_types, index]()
+                    {
+                        auto connection = weak_connection.lock();
+                        if (!connection)
+                        {
+                            return pplx::task_from_exception<std::shared_ptr<transport>>(signalr_exception("connection no longer exists"));
+                        }
+
+                        return connection->start_transport(url, transport_types, index + 1);
+                    });
+            }
+        });
+    }
+
+    pplx::task<void> connection_impl::renegotiate(const std::string& url)
+    {
+        if (m_signalr_client_config.get_skip_negotiation())
+        {
+            // there is no connection id to replace
+            return pplx::task_from_result();
+        }
+
+        std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+        return request_sender::negotiate(*m_web_request_factory, url, m_signalr_client_config)
+            .then([weak_connection](negotiation_response negotiation_response)
+            {
+                auto connection = weak_connection.lock();
+                if (!connection)
+                {
+                    throw signalr_exception("connection no longer exists");
+                }
+
+                if (!negotiation_response.error.empty())
+                {
+                    throw signalr_exception(negotiation_response.error);
+                }
+
+                connection->m_connection_id = std::move(negotiation_response.connectionId);
+            }, m_disconnect_cts.get_token());
+    }
+
+    pplx::task<std::shared_ptr<transport>> connection_impl::start_transport(const std::string& url, transport_type transport_type)
     {
         auto connection = shared_from_this();
 
@@ -225,7 +389,7 @@ namespace signalr
         const auto& logger = m_logger;
 
         auto process_response_callback =
-            [weak_connection, disconnect_cts, logger](const std::string& response) mutable
+            [weak_connection, disconnect_cts, logger](const message_buffer& response) mutable
             {
                 // When a connection is stopped we don't wait for its transport to stop. As a result if the same connection
                 // is immediately re-started the old transport can still invoke this callback. To prevent this we capture
@@ -235,7 +399,7 @@ namespace signalr
                 {
                     logger.log(trace_level::info,
                         std::string{ "ignoring stray message received after connection was restarted. message: " }
-                        .append(response));
+                        .append(response.str()));
                     return;
                 }
 
@@ -265,17 +429,23 @@ namespace signalr
 
                 // no op after connection started successfully
                 connect_request_tce.set_exception(e);
+
+                auto connection = weak_connection.lock();
+                if (connection)
+                {
+                    // no op if the connection is not connected yet
+                    connection->connection_lost(e);
+                }
             };
 
         auto transport = connection->m_transport_factory->create_transport(
-            transport_type::websockets, connection->m_logger, connection->m_signalr_client_config,
+            transport_type, connection->m_logger, connection->m_signalr_client_config,
             process_response_callback, error_callback);
 
-        pplx::create_task([connect_request_tce, disconnect_cts, weak_connection]()
+        auto& timer_service = timer_service::get_default();
+        const auto timeout_timer_id = timer_service.schedule(connection->m_signalr_client_config.get_transport_connect_timeout(),
+            [connect_request_tce, disconnect_cts]()
         {
-            // TODO? std::this_thread::sleep_for(std::chrono::milliseconds(negotiation_response.transport_connect_timeout));
-            std::this_thread::sleep_for(std::chrono::milliseconds(5000));
-
             // if the disconnect_cts is canceled it means that the connection has been stopped or went out of scope in
             // which case we should not throw due to timeout. Instead we need to set the tce prevent the task that is
             // using this tce from hanging indifinitely. (This will eventually result in throwing the pplx::task_canceled
@@ -290,14 +460,50 @@ namespace signalr
             }
         });
 
+        const auto connect_start_time = std::chrono::steady_clock::now();
+
         return connection->send_connect_request(transport, url, connect_request_tce)
-            .then([transport](){ return pplx::task_from_result(transport); });
+            .then([transport, &timer_service, timeout_timer_id, transport_type, connect_start_time, logger](pplx::task<void> connect_task)
+            {
+                timer_service.cancel(timeout_timer_id);
+
+                try
+                {
+                    connect_task.get();
+                }
+                catch (const std::exception&)
+                {
+                    // a transport that timed out may still connect later and must not stay connected to the server
+                    transport->disconnect()
+                        .then([logger](pplx::task<void> disconnect_task)
+                        {
+                            try
+                            {
+                                disconnect_task.get();
+                            }
+                            catch (const std::exception& e)
+                            {
+                                logger.log(trace_level::errors,
+                                    std::string("error when closing the transport that failed to connect: ").append(e.what()));
+                            }
+                        });
+
+                    throw;
+                }
+
+                logger.log(trace_level::info,
+                    std::string("the ").append(translate_transport_type(transport_type)).append(" transport connected in ")
+                    .append(elapsed_milliseconds(connect_start_time)).append(" ms"));
+
+                return transport;
+            });
     }
 
     pplx::task<void> connection_impl::send_connect_request(const std::shared_ptr<transport>& transport, const std::string& url, const pplx::task_completion_event<void>& connect_request_tce)
     {
         auto logger = m_logger;
-        auto query_string = "id=" + m_connection_id;
+        // there is no connection id if the negotiation was skipped
+        auto query_string = m_connection_id.empty() ? std::string() : "id=" + m_connection_id;
         auto connect_url = url_builder::build_connect(url, transport->get_transport_type(), query_string);
 
         transport->connect(connect_url)
@@ -322,15 +528,190 @@ namespace signalr
         return pplx::create_task(connect_request_tce);
     }
 
-    void connection_impl::process_response(const std::string& response)
+    void connection_impl::process_response(const message_buffer& response)
     {
-        m_logger.log(trace_level::messages,
-            std::string("processing message: ").append(response));
+        m_messages_received.fetch_add(1, std::memory_order_relaxed);
+        m_bytes_received.fetch_add(response.size(), std::memory_order_relaxed);
+
+        // the message is only copied into the log entry if it will be written
+        if (m_logger.is_enabled(trace_level::messages))
+        {
+            m_logger.log(trace_level::messages,
+                std::string("processing message: ").append(response.str()));
+        }
 
         invoke_message_received(response);
     }
 
-    void connection_impl::invoke_message_received(const std::string& message)
+    void connection_impl::connection_lost(const std::exception& error)
+    {
+        const auto automatic_reconnect = m_signalr_client_config.get_automatic_reconnect();
+        std::shared_ptr<transport> transport;
+        unsigned int reconnect_generation;
+
+        {
+            std::lock_guard<std::mutex> lock(m_stop_lock);
+            if (!change_state(connection_state::connected,
+                automatic_reconnect ? connection_state::reconnecting : connection_state::disconnected))
+            {
+                // the connection is being started or stopped
+                return;
+            }
+
+            // messages and errors from the lost transport have to be ignored from now on
+            m_disconnect_cts.cancel();
+            m_disconnect_cts = pplx::cancellation_token_source();
+            transport = m_transport;
+            m_transport = nullptr;
+
+            // attempts scheduled before the connection was stopped and started again must not run
+            reconnect_generation = ++m_reconnect_generation;
+            m_reconnect_attempt = 0;
+            m_reconnect_backoff = std::make_unique<reconnect_backoff>(
+                m_signalr_client_config.get_reconnect_initial_delay(), m_signalr_client_config.get_reconnect_max_delay());
+        }
+
+        discard_batch(std::string("the connection was lost before the message was sent: ").append(error.what()));
+
+        m_logger.log(trace_level::errors, std::string("connection lost: ").append(error.what()));
+
+        auto logger = m_logger;
+        transport->disconnect()
+            .then([logger](pplx::task<void> disconnect_task)
+            mutable {
+                try
+                {
+                    disconnect_task.get();
+                }
+                catch (const std::exception& e)
+                {
+                    logger.log(trace_level::errors, std::string("error when closing the lost transport: ").append(e.what()));
+                }
+            });
+
+        if (!automatic_reconnect)
+        {
+            invoke_callback(m_disconnected, "disconnected");
+            return;
+        }
+
+        invoke_callback(m_reconnecting, "reconnecting");
+        schedule_reconnect(reconnect_generation);
+    }
+
+    void connection_impl::schedule_reconnect(unsigned int generation)
+    {
+        std::chrono::milliseconds delay(0);
+        unsigned int attempt;
+        bool give_up = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_stop_lock);
+            if (generation != m_reconnect_generation)
+            {
+                // the connection was stopped while the previous attempt was running
+                return;
+            }
+
+            attempt = m_reconnect_attempt;
+            const auto max_attempts = m_signalr_client_config.get_max_reconnect_attempts();
+            if (max_attempts == 0 || attempt < max_attempts)
+            {
+                delay = m_reconnect_backoff->next_delay(m_reconnect_attempt++);
+                attempt = m_reconnect_attempt;
+            }
+            else if (!change_state(connection_state::reconnecting, connection_state::disconnected))
+            {
+                // the connection is being stopped which will invoke the disconnected callback
+                return;
+            }
+            else
+            {
+                m_logger.log(trace_level::errors, std::string("giving up reconnecting after ")
+                    .append(std::to_string(attempt))
+                    .append(" failed attempts"));
+
+                give_up = true;
+            }
+        }
+
+        if (give_up)
+        {
+            invoke_callback(m_disconnected, "disconnected");
+            return;
+        }
+
+        m_logger.log(trace_level::info, std::string("reconnect attempt ")
+            .append(std::to_string(attempt))
+            .append(" in ")
+            .append(std::to_string(delay.count()))
+            .append(" ms"));
+
+        std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+        const auto timer_id = timer_service::get_default().schedule(delay, [weak_connection, generation]()
+        {
+            // reconnecting must not block the timer thread shared by all connections
+            pplx::create_task([weak_connection, generation]()
+            {
+                auto connection = weak_connection.lock();
+                if (connection)
+                {
+                    connection->reconnect(generation);
+                }
+            });
+        });
+
+        std::lock_guard<std::mutex> lock(m_stop_lock);
+        m_reconnect_timer_id = timer_id;
+    }
+
+    void connection_impl::reconnect(unsigned int generation)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stop_lock);
+            if (generation != m_reconnect_generation || get_connection_state() != connection_state::reconnecting ||
+                m_disconnect_cts.get_token().is_canceled())
+            {
+                // the connection was stopped while waiting for the attempt
+                return;
+            }
+
+            m_start_completed_event.reset();
+        }
+
+        // every attempt costs a negotiate round trip (unless negotiation is skipped) because the previous connection id
+        // is no longer known to the server
+        std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+        start_negotiate(m_negotiate_url, 0)
+            .then([weak_connection, generation](pplx::task<void> reconnect_task)
+            {
+                auto connection = weak_connection.lock();
+                if (!connection)
+                {
+                    return;
+                }
+
+                try
+                {
+                    reconnect_task.get();
+                }
+                catch (const std::exception&)
+                {
+                    // the error has already been logged
+                    if (connection->get_connection_state() == connection_state::reconnecting)
+                    {
+                        connection->schedule_reconnect(generation);
+                    }
+                    return;
+                }
+
+                connection->m_reconnects.fetch_add(1, std::memory_order_relaxed);
+                connection->m_logger.log(trace_level::info, "connection reconnected");
+                connection->invoke_callback(connection->m_reconnected, "reconnected");
+            });
+    }
+
+    void connection_impl::invoke_message_received(const message_buffer& message)
     {
         try
         {
@@ -349,7 +730,192 @@ namespace signalr
         }
     }
 
-    pplx::task<void> connection_impl::send(const std::string& data)
+    pplx::task<void> connection_impl::send(const std::string& data, transfer_format transfer_format)
+    {
+        const auto batch_threshold = m_signalr_client_config.get_send_batch_threshold();
+        if (batch_threshold == 0)
+        {
+            return send_data(data, transfer_format, 1);
+        }
+
+        const auto connection_state = get_connection_state();
+        if (connection_state != signalr::connection_state::connected)
+        {
+            return pplx::task_from_exception<void>(signalr_exception(
+                std::string("cannot send data when the connection is not in the connected state. current connection state: ")
+                    .append(translate_connection_state(connection_state))));
+        }
+
+        std::vector<outgoing_batch> batches;
+        pplx::task<void> sent;
+        bool schedule_flush = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_lock);
+
+            // messages with different transfer formats cannot share a frame
+            if (!m_batch.data.empty() && m_batch.format != transfer_format)
+            {
+                batches.push_back(take_batch());
+            }
+
+            m_batch.data.append(data);
+            m_batch.format = transfer_format;
+            m_batch.frames++;
+            sent = pplx::create_task(m_batch.sent);
+
+            if (m_batch.data.size() >= batch_threshold)
+            {
+                batches.push_back(take_batch());
+            }
+            else if (!m_batch_flush_scheduled)
+            {
+                m_batch_flush_scheduled = true;
+                schedule_flush = true;
+            }
+        }
+
+        for (const auto& batch : batches)
+        {
+            send_batch(batch);
+        }
+
+        if (schedule_flush)
+        {
+            schedule_batch_flush();
+        }
+
+        return sent;
+    }
+
+    pplx::task<void> connection_impl::flush()
+    {
+        outgoing_batch batch;
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_lock);
+
+            if (m_batch.data.empty())
+            {
+                return pplx::task_from_result();
+            }
+
+            batch = take_batch();
+        }
+
+        send_batch(batch);
+        return pplx::create_task(batch.sent);
+    }
+
+    // must be called with the m_batch_lock held
+    connection_impl::outgoing_batch connection_impl::take_batch()
+    {
+        auto batch = std::move(m_batch);
+        m_batch.data.clear();
+        m_batch.sent = pplx::task_completion_event<void>();
+        m_batch.frames = 0;
+        return batch;
+    }
+
+    void connection_impl::send_batch(const outgoing_batch& batch)
+    {
+        auto sent = batch.sent;
+        send_data(batch.data, batch.format, batch.frames)
+            .then([sent](pplx::task<void> send_task)
+            {
+                try
+                {
+                    send_task.get();
+                    sent.set();
+                }
+                catch (const std::exception&)
+                {
+                    sent.set_exception(std::current_exception());
+                }
+            });
+    }
+
+    // the batch is sent at the latest when the window elapsed after the first message was queued
+    void connection_impl::schedule_batch_flush()
+    {
+        std::weak_ptr<connection_impl> weak_connection = shared_from_this();
+
+        const auto timer_id = timer_service::get_default().schedule(m_signalr_client_config.get_send_batch_window(),
+            [weak_connection]()
+        {
+            auto connection = weak_connection.lock();
+            if (connection)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(connection->m_batch_lock);
+                    connection->m_batch_flush_scheduled = false;
+                }
+
+                connection->flush();
+            }
+        });
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_lock);
+            if (m_batch_flush_scheduled)
+            {
+                m_batch_flush_timer_id = timer_id;
+                return;
+            }
+        }
+
+        // the batch was discarded while the timer was being scheduled
+        timer_service::get_default().cancel(timer_id);
+    }
+
+    // fails the messages that have been batched but not sent yet, e.g. because the connection was lost or stopped
+    void connection_impl::discard_batch(const std::string& error)
+    {
+        outgoing_batch batch;
+        bool cancel_flush;
+        timer_service::timer_id flush_timer_id;
+
+        {
+            std::lock_guard<std::mutex> lock(m_batch_lock);
+            batch = take_batch();
+            cancel_flush = m_batch_flush_scheduled;
+            flush_timer_id = m_batch_flush_timer_id;
+            m_batch_flush_scheduled = false;
+        }
+
+        if (cancel_flush)
+        {
+            timer_service::get_default().cancel(flush_timer_id);
+        }
+
+        if (batch.frames > 0)
+        {
+            batch.sent.set_exception(signalr_exception(error));
+        }
+    }
+
+    // `frames` is the number of messages batched in `data`
+    pplx::task<void> connection_impl::send_data(const std::string& data, transfer_format transfer_format, size_t frames)
+    {
+        // checked when queueing so that sending on a connection that is not connected fails right away. The transport
+        // is checked again when the message is written.
+        const auto connection_state = get_connection_state();
+        if (connection_state != signalr::connection_state::connected)
+        {
+            return pplx::task_from_exception<void>(signalr_exception(
+                std::string("cannot send data when the connection is not in the connected state. current connection state: ")
+                    .append(translate_connection_state(connection_state))));
+        }
+
+        m_messages_sent.fetch_add(frames, std::memory_order_relaxed);
+        m_bytes_sent.fetch_add(data.size(), std::memory_order_relaxed);
+        m_frames_per_batch.record(frames);
+
+        return m_send_queue->enqueue(data, transfer_format);
+    }
+
+    // invoked by the send queue, from one thread at a time
+    pplx::task<void> connection_impl::write_to_transport(const std::string& data, transfer_format transfer_format)
     {
         // To prevent an (unlikely) condition where the transport is nulled out after we checked the connection_state
         // and before sending data we store the pointer in the local variable. In this case `send()` will throw but
@@ -368,7 +934,7 @@ namespace signalr
 
         logger.log(trace_level::info, std::string("sending data: ").append(data));
 
-        return transport->send(data)
+        return transport->send(data, transfer_format)
             .then([logger](pplx::task<void> send_task)
             mutable {
                 try
@@ -387,6 +953,29 @@ namespace signalr
             });
     }
 
+    pplx::task<void> connection_impl::wait_for_send_capacity()
+    {
+        return m_send_queue->wait_for_capacity();
+    }
+
+    size_t connection_impl::get_send_queue_high_water_mark() const noexcept
+    {
+        return m_send_queue->high_water_mark();
+    }
+
+    connection_metrics connection_impl::get_metrics() const
+    {
+        connection_metrics metrics;
+        metrics.messages_sent = m_messages_sent.load(std::memory_order_relaxed);
+        metrics.bytes_sent = m_bytes_sent.load(std::memory_order_relaxed);
+        metrics.messages_received = m_messages_received.load(std::memory_order_relaxed);
+        metrics.bytes_received = m_bytes_received.load(std::memory_order_relaxed);
+        metrics.reconnects = m_reconnects.load(std::memory_order_relaxed);
+        metrics.frames_per_batch = m_frames_per_batch.snapshot();
+        metrics.send_latency = m_send_queue->send_latency().snapshot();
+        return metrics;
+    }
+
     pplx::task<void> connection_impl::stop()
     {
         m_logger.log(trace_level::info, "stopping connection");
@@ -407,26 +996,33 @@ namespace signalr
                     }
                 }
 
-                try
-                {
-                    connection->m_disconnected();
-                }
-                catch (const std::exception &e)
-                {
-                    connection->m_logger.log(
-                        trace_level::errors,
-                        std::string("disconnected callback threw an exception: ")
-                        .append(e.what()));
-                }
-                catch (...)
-                {
-                    connection->m_logger.log(
-                        trace_level::errors,
-                        std::string("disconnected callback threw an unknown exception"));
-                }
+                connection->invoke_callback(connection->m_disconnected, "disconnected");
             });
     }
 
+    void connection_impl::invoke_callback(const std::function<void()>& callback, const std::string& callback_name)
+    {
+        try
+        {
+            callback();
+        }
+        catch (const std::exception &e)
+        {
+            m_logger.log(
+                trace_level::errors,
+                std::string(callback_name)
+                .append(" callback threw an exception: ")
+                .append(e.what()));
+        }
+        catch (...)
+        {
+            m_logger.log(
+                trace_level::errors,
+                std::string(callback_name)
+                .append(" callback threw an unknown exception"));
+        }
+    }
+
     // This function is called from the dtor so you must not use `shared_from_this` here (it will throw).
     pplx::task<void> connection_impl::shutdown()
     {
@@ -466,11 +1062,23 @@ namespace signalr
                 return pplx::task_from_result();
             }
 
+            // there is no transport to stop when waiting for the next reconnect attempt
+            if (m_connection_state == connection_state::reconnecting)
+            {
+                // the pending attempt must not run if the connection is started again and lost before it fires
+                m_reconnect_generation++;
+                timer_service::get_default().cancel(m_reconnect_timer_id);
+                change_state(connection_state::disconnecting);
+                return pplx::task_from_result();
+            }
+
             _ASSERTE(m_connection_state == connection_state::connected);
 
             change_state(connection_state::disconnecting);
         }
 
+        discard_batch("the connection was stopped before the message was sent");
+
         return m_transport->disconnect();
     }
 
@@ -489,7 +1097,7 @@ namespace signalr
         return m_connection_id;
     }
 
-    void connection_impl::set_message_received(const std::function<void(const std::string&)>& message_received)
+    void connection_impl::set_message_received(const std::function<void(const message_buffer&)>& message_received)
     {
         ensure_disconnected("cannot set the callback when the connection is not in the disconnected state. ");
         m_message_received = message_received;
@@ -499,6 +1107,7 @@ namespace signalr
     {
         ensure_disconnected("cannot set client config when the connection is not in the disconnected state. ");
         m_signalr_client_config = config;
+        m_send_queue->set_backpressure_threshold(config.get_send_backpressure_threshold());
     }
 
     void connection_impl::set_disconnected(const std::function<void()>& disconnected)
@@ -507,6 +1116,18 @@ namespace signalr
         m_disconnected = disconnected;
     }
 
+    void connection_impl::set_reconnecting(const std::function<void()>& reconnecting)
+    {
+        ensure_disconnected("cannot set the reconnecting callback when the connection is not in the disconnected state. ");
+        m_reconnecting = reconnecting;
+    }
+
+    void connection_impl::set_reconnected(const std::function<void()>& reconnected)
+    {
+        ensure_disconnected("cannot set the reconnected callback when the connection is not in the disconnected state. ");
+        m_reconnected = reconnected;
+    }
+
     void connection_impl::ensure_disconnected(const std::string& error_message) const
     {
         const auto state = get_connection_state();
@@ -565,9 +1186,37 @@ namespace signalr
             return "disconnecting";
         case connection_state::disconnected:
             return "disconnected";
+        case connection_state::reconnecting:
+            return "reconnecting";
         default:
             _ASSERTE(false);
             return "(unknown)";
         }
     }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        static std::string translate_transport_type(transport_type transport_type)
+        {
+            switch (transport_type)
+            {
+            case transport_type::websockets:
+                return "WebSockets";
+            case transport_type::server_sent_events:
+                return "ServerSentEvents";
+            case transport_type::long_polling:
+                return "LongPolling";
+            default:
+                _ASSERTE(false);
+                return "(unknown)";
+            }
+        }
+
+        static std::string elapsed_milliseconds(std::chrono::steady_clock::time_point since)
+        {
+            return std::to_string(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count());
+        }
+    }
 }
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <mutex>
 #include "cpprest/http_client.h"
+#include "signalrclient/connection_metrics.h"
 #include "signalrclient/trace_level.h"
 #include "signalrclient/connection_state.h"
 #include "signalrclient/signalr_client_config.h"
@@ -13,6 +14,10 @@
 #include "transport_factory.h"
 #include "logger.h"
 #include "negotiation_response.h"
+#include "reconnect_backoff.h"
+#include "send_queue.h"
+#include "timer_service.h"
+#include "transfer_format.h"
 #include "event.h"
 
 namespace signalr
@@ -36,18 +41,46 @@ namespace signalr
 
         ~connection_impl();
 
-        pplx::task<void> start();
-        pplx::task<void> send(const std::string &data);
+        pplx::task<void> start(transfer_format transfer_format = transfer_format::text);
+        pplx::task<void> send(const std::string &data, transfer_format transfer_format = transfer_format::text);
+        pplx::task<void> flush();
         pplx::task<void> stop();
 
+        // completes when fewer bytes than `signalr_client_config::get_send_backpressure_threshold` wait to be sent
+        pplx::task<void> wait_for_send_capacity();
+        size_t get_send_queue_high_water_mark() const noexcept;
+
+        connection_metrics get_metrics() const;
+
         connection_state get_connection_state() const noexcept;
         std::string get_connection_id() const noexcept;
 
-        void set_message_received(const std::function<void(const std::string&)>& message_received);
+        // Messages are passed as reference counted buffers which can be kept without copying the data. Callbacks taking
+        // `const std::string&` can be used as well.
+        void set_message_received(const std::function<void(const message_buffer&)>& message_received);
         void set_disconnected(const std::function<void()>& disconnected);
+        void set_reconnecting(const std::function<void()>& reconnecting);
+        void set_reconnected(const std::function<void()>& reconnected);
         void set_client_config(const signalr_client_config& config);
 
+        // Handles losing the connection without it being stopped, e.g. because the server stopped responding. The
+        // connection starts reconnecting if automatic reconnect is enabled, otherwise it becomes disconnected.
+        void connection_lost(const std::exception& error);
+
     private:
+        // messages queued when batching is enabled. `sent` is completed once the batch has been sent
+        struct outgoing_batch
+        {
+            outgoing_batch() noexcept
+                : format(signalr::transfer_format::text), frames(0)
+            { }
+
+            std::string data;
+            signalr::transfer_format format;
+            pplx::task_completion_event<void> sent;
+            size_t frames;
+        };
+
         std::string m_base_url;
         std::atomic<connection_state> m_connection_state;
         logger m_logger;
@@ -55,31 +88,75 @@ namespace signalr
         std::unique_ptr<web_request_factory> m_web_request_factory;
         std::unique_ptr<transport_factory> m_transport_factory;
 
-        std::function<void(const std::string&)> m_message_received;
+        std::function<void(const message_buffer&)> m_message_received;
         std::function<void()> m_disconnected;
+        std::function<void()> m_reconnecting;
+        std::function<void()> m_reconnected;
         signalr_client_config m_signalr_client_config;
+        transfer_format m_transfer_format;
 
         pplx::cancellation_token_source m_disconnect_cts;
         std::mutex m_stop_lock;
         event m_start_completed_event;
         std::string m_connection_id;
+        // the url the last successful negotiation was sent to after following redirects. Reconnects negotiate with this
+        // url directly to skip the redirects. They still negotiate once since the server drops the connection id
+        // together with the lost transport, so the previous negotiate response cannot be reused
+        std::string m_negotiate_url;
+        std::unique_ptr<reconnect_backoff> m_reconnect_backoff;
+        unsigned int m_reconnect_attempt;
+        // bumped when the connection is lost or stopped, attempts of an earlier generation are dropped
+        unsigned int m_reconnect_generation;
+        timer_service::timer_id m_reconnect_timer_id;
+
+        // every message is sent through the queue so that only one thread at a time writes to the transport
+        std::shared_ptr<send_queue> m_send_queue;
+
+        std::mutex m_batch_lock;
+        outgoing_batch m_batch;
+        bool m_batch_flush_scheduled;
+        timer_service::timer_id m_batch_flush_timer_id;
+
+        // relaxed counters updated on every message, see `get_metrics`
+        std::atomic<uint64_t> m_messages_sent;
+        std::atomic<uint64_t> m_bytes_sent;
+        std::atomic<uint64_t> m_messages_received;
+        std::atomic<uint64_t> m_bytes_received;
+        std::atomic<uint64_t> m_reconnects;
+        histogram m_frames_per_batch;
 
         connection_impl(const std::string& url, trace_level trace_level, const std::shared_ptr<log_writer>& log_writer,
             std::unique_ptr<web_request_factory> web_request_factory, std::unique_ptr<transport_factory> transport_factory);
 
-        pplx::task<std::shared_ptr<transport>> start_transport(const std::string& url);
+        // starts the transport at `index` and falls back to the next transports if it cannot be started
+        pplx::task<std::shared_ptr<transport>> start_transport(const std::string& url,
+            const std::vector<transport_type>& transport_types, size_t index);
+        pplx::task<std::shared_ptr<transport>> start_transport(const std::string& url, transport_type transport_type);
+        // replaces the connection id before falling back to the next transport
+        pplx::task<void> renegotiate(const std::string& url);
         pplx::task<void> send_connect_request(const std::shared_ptr<transport>& transport,
             const std::string& url, const pplx::task_completion_event<void>& connect_request_tce);
         pplx::task<void> start_negotiate(const std::string& url, int redirect_count);
 
-        void process_response(const std::string& response);
+        void process_response(const message_buffer& response);
+
+        void schedule_reconnect(unsigned int generation);
+        void reconnect(unsigned int generation);
+
+        pplx::task<void> send_data(const std::string& data, transfer_format transfer_format, size_t frames);
+        pplx::task<void> write_to_transport(const std::string& data, transfer_format transfer_format);
+        outgoing_batch take_batch();
+        void send_batch(const outgoing_batch& batch);
+        void schedule_batch_flush();
+        void discard_batch(const std::string& error);
 
         pplx::task<void> shutdown();
 
         bool change_state(connection_state old_state, connection_state new_state);
         connection_state change_state(connection_state new_state);
         void handle_connection_state_change(connection_state old_state, connection_state new_state);
-        void invoke_message_received(const std::string& message);
+        void invoke_message_received(const message_buffer& message);
+        void invoke_callback(const std::function<void()>& callback, const std::string& callback_name);
 
         static std::string translate_connection_state(connection_state state);
         void ensure_disconnected(const std::string& error_message) const;
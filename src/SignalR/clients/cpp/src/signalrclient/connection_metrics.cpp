@@ -0,0 +1,33 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <cmath>
+#include "signalrclient/connection_metrics.h"
+
+namespace signalr
+{
+    uint64_t histogram_snapshot::value_at_percentile(double percentile) const
+    {
+        if (count == 0 || buckets.empty())
+        {
+            return 0;
+        }
+
+        const auto clamped = (std::min)((std::max)(percentile, 0.0), 100.0);
+        const auto rank = (std::max)(static_cast<uint64_t>(std::ceil(clamped / 100.0 * count)), static_cast<uint64_t>(1));
+
+        uint64_t counted = 0;
+        for (const auto& bucket : buckets)
+        {
+            counted += bucket.second;
+            if (counted >= rank)
+            {
+                // the bucket bound may exceed the largest value actually recorded
+                return (std::min)(bucket.first, max);
+            }
+        }
+
+        return max;
+    }
+}
@@ -3,6 +3,8 @@
 
 #include "stdafx.h"
 #include "default_websocket_client.h"
+#include "cpprest/containerstream.h"
+#include "cpprest/rawptrstream.h"
 
 namespace signalr
 {
@@ -26,20 +28,39 @@ namespace signalr
         return m_underlying_client.connect(utility::conversions::to_string_t(url));
     }
 
-    pplx::task<void> default_websocket_client::send(const std::string &message)
+    pplx::task<void> default_websocket_client::send(const std::string &message, transfer_format transfer_format)
     {
         web::websockets::client::websocket_outgoing_message msg;
-        msg.set_utf8_message(message);
+        if (transfer_format == transfer_format::binary)
+        {
+            // the outgoing message reads from the stream asynchronously so the stream needs to own a copy of the payload
+            msg.set_binary_message(Concurrency::streams::container_stream<std::vector<uint8_t>>::open_istream(
+                std::vector<uint8_t>(message.begin(), message.end())), message.size());
+        }
+        else
+        {
+            msg.set_utf8_message(message);
+        }
         return m_underlying_client.send(msg);
     }
 
-    pplx::task<std::string> default_websocket_client::receive()
+    pplx::task<message_buffer> default_websocket_client::receive()
     {
         // the caller is responsible for observing exceptions
         return m_underlying_client.receive()
             .then([](web::websockets::client::websocket_incoming_message msg)
             {
-                return msg.extract_string();
+                // the body is read directly into the buffer handed to the transport. This works for both text and
+                // binary messages (extract_string() only works for text messages) and avoids copying the message
+                const auto length = msg.length();
+                auto payload = std::make_shared<std::string>(length, '\0');
+                Concurrency::streams::rawptr_buffer<uint8_t> buffer(reinterpret_cast<uint8_t*>(&(*payload)[0]), length, std::ios::out);
+                return msg.body().read(buffer, length)
+                    .then([payload](size_t bytes_read)
+                    {
+                        payload->resize(bytes_read);
+                        return message_buffer(std::move(*payload));
+                    });
             });
     }
 
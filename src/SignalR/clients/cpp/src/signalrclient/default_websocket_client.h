@@ -16,9 +16,9 @@ namespace signalr
 
         pplx::task<void> connect(const std::string& url) override;
 
-        pplx::task<void> send(const std::string& message) override;
+        pplx::task<void> send(const std::string& message, transfer_format transfer_format) override;
 
-        pplx::task<std::string> receive() override;
+        pplx::task<message_buffer> receive() override;
 
         pplx::task<void> close() override;
 
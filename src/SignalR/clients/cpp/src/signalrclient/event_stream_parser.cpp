@@ -0,0 +1,73 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "event_stream_parser.h"
+
+namespace signalr
+{
+    event_stream_parser::event_stream_parser()
+        : m_has_data(false)
+    { }
+
+    std::vector<std::string> event_stream_parser::parse(const std::string& chunk)
+    {
+        std::vector<std::string> events;
+
+        size_t line_start = 0;
+        size_t line_end;
+        while ((line_end = chunk.find('\n', line_start)) != std::string::npos)
+        {
+            m_line.append(chunk, line_start, line_end - line_start);
+            process_line(events);
+            m_line.clear();
+            line_start = line_end + 1;
+        }
+
+        m_line.append(chunk, line_start, std::string::npos);
+
+        return events;
+    }
+
+    void event_stream_parser::process_line(std::vector<std::string>& events)
+    {
+        if (!m_line.empty() && m_line.back() == '\r')
+        {
+            m_line.pop_back();
+        }
+
+        // an empty line completes the event
+        if (m_line.empty())
+        {
+            if (m_has_data)
+            {
+                events.push_back(std::move(m_data));
+                m_data.clear();
+                m_has_data = false;
+            }
+
+            return;
+        }
+
+        // lines starting with a colon are comments (e.g. used by servers to keep the connection alive)
+        const auto colon = m_line.find(':');
+        if (colon == 0 || m_line.compare(0, colon, "data") != 0)
+        {
+            return;
+        }
+
+        auto value_start = colon == std::string::npos ? m_line.size() : colon + 1;
+        if (value_start < m_line.size() && m_line[value_start] == ' ')
+        {
+            value_start++;
+        }
+
+        if (m_has_data)
+        {
+            m_data.push_back('\n');
+        }
+
+        m_data.append(m_line, value_start, std::string::npos);
+        m_has_data = true;
+    }
+}
@@ -0,0 +1,29 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace signalr
+{
+    // Incrementally parses a text/event-stream (Server-Sent Events) body. The body can be split into chunks at any
+    // position. Only the `data` field is used - the data of an event sent in multiple `data` lines is joined with "\n".
+    class event_stream_parser
+    {
+    public:
+        event_stream_parser();
+
+        // returns the data of the events completed by the chunk. Incomplete lines and events are kept until the
+        // chunks completing them are parsed
+        std::vector<std::string> parse(const std::string& chunk);
+
+    private:
+        std::string m_line;
+        std::string m_data;
+        bool m_has_data;
+
+        void process_line(std::vector<std::string>& events);
+    };
+}
@@ -0,0 +1,165 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "handler_dispatcher.h"
+
+namespace signalr
+{
+    std::shared_ptr<handler_dispatcher> handler_dispatcher::create(handler_dispatch_mode mode, const handler_executor& executor,
+        size_t max_pending, const logger& logger)
+    {
+        return std::shared_ptr<handler_dispatcher>(new handler_dispatcher(mode, executor, max_pending, logger));
+    }
+
+    handler_dispatcher::handler_dispatcher(handler_dispatch_mode mode, const handler_executor& executor, size_t max_pending,
+        const logger& logger)
+        : m_mode(mode), m_executor(executor ? executor : [](const std::function<void()>& work) { pplx::create_task(work); }),
+        m_max_pending(max_pending > 0 ? max_pending : 1), m_logger(logger), m_pending(0)
+    {
+        _ASSERTE(mode != handler_dispatch_mode::synchronous);
+    }
+
+    void handler_dispatcher::dispatch(const void* key, std::function<void()> handler)
+    {
+        // all handlers share a single queue in the serial mode
+        if (m_mode != handler_dispatch_mode::keyed_serial)
+        {
+            key = nullptr;
+        }
+
+        bool start_draining = false;
+
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_handler_finished.wait(lock, [this]() { return m_pending < m_max_pending; });
+            ++m_pending;
+
+            if (m_mode != handler_dispatch_mode::parallel)
+            {
+                auto& queue = m_queues[key];
+                queue.push_back(std::move(handler));
+                start_draining = queue.size() == 1;
+            }
+        }
+
+        // the executor is provided by the user and may throw, in which case the handlers it did not accept are dropped
+        // so that they do not count against the maximum forever
+        try
+        {
+            if (m_mode == handler_dispatch_mode::parallel)
+            {
+                auto dispatcher = shared_from_this();
+                m_executor([dispatcher, handler]()
+                {
+                    dispatcher->run(handler);
+                    dispatcher->handler_completed();
+                });
+            }
+            else if (start_draining)
+            {
+                // the queue is drained by a single task at a time, a new one is started when the queue was empty
+                auto dispatcher = shared_from_this();
+                m_executor([dispatcher, key]()
+                {
+                    dispatcher->drain(key);
+                });
+            }
+        }
+        catch (const std::exception& e)
+        {
+            executor_failed(key, e.what());
+        }
+        catch (...)
+        {
+            executor_failed(key, "unknown exception");
+        }
+    }
+
+    size_t handler_dispatcher::pending() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_pending;
+    }
+
+    void handler_dispatcher::drain(const void* key)
+    {
+        std::function<void()> handler;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            handler = std::move(m_queues[key].front());
+        }
+
+        while (true)
+        {
+            run(handler);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            --m_pending;
+            m_handler_finished.notify_one();
+
+            auto queue = m_queues.find(key);
+            queue->second.pop_front();
+            if (queue->second.empty())
+            {
+                m_queues.erase(queue);
+                return;
+            }
+
+            handler = std::move(queue->second.front());
+        }
+    }
+
+    void handler_dispatcher::run(const std::function<void()>& handler) const
+    {
+        // an exception thrown by one handler must not prevent running the next ones
+        try
+        {
+            handler();
+        }
+        catch (const std::exception& e)
+        {
+            m_logger.log(trace_level::errors, std::string("hub method handler threw an exception: ")
+                .append(e.what()));
+        }
+        catch (...)
+        {
+            m_logger.log(trace_level::errors, "hub method handler threw an unknown exception");
+        }
+    }
+
+    void handler_dispatcher::executor_failed(const void* key, const char* error)
+    {
+        size_t dropped = 1;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_mode != handler_dispatch_mode::parallel)
+            {
+                // nothing drains the queue since the task draining it could not be started
+                auto queue = m_queues.find(key);
+                dropped = queue->second.size();
+                m_queues.erase(queue);
+            }
+
+            m_pending -= dropped;
+        }
+
+        m_handler_finished.notify_all();
+
+        m_logger.log(trace_level::errors, std::string("handler executor threw an exception, ")
+            .append(std::to_string(dropped))
+            .append(dropped == 1 ? " hub method invocation was" : " hub method invocations were")
+            .append(" not handled: ")
+            .append(error));
+    }
+
+    void handler_dispatcher::handler_completed()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        --m_pending;
+        m_handler_finished.notify_one();
+    }
+}
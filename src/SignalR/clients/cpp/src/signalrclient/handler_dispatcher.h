@@ -0,0 +1,56 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "logger.h"
+#include "signalrclient/signalr_client_config.h"
+
+namespace signalr
+{
+    // Runs hub method handlers off the receive loop according to a `handler_dispatch_mode` other than synchronous.
+    // Handlers that have to run in order are queued per key and a single task drains each queue, so ordering does not
+    // depend on the executor. `dispatch` blocks while the maximum number of handlers are queued or running, which
+    // stops reading from the transport until a handler finished. The hub connection pauses the server timeout while
+    // dispatching.
+    class handler_dispatcher : public std::enable_shared_from_this<handler_dispatcher>
+    {
+    public:
+        static std::shared_ptr<handler_dispatcher> create(handler_dispatch_mode mode, const handler_executor& executor,
+            size_t max_pending, const logger& logger);
+
+        handler_dispatcher(const handler_dispatcher&) = delete;
+        handler_dispatcher& operator=(const handler_dispatcher&) = delete;
+
+        // handlers dispatched with the same key run in order in the keyed_serial mode. The key is ignored otherwise.
+        void dispatch(const void* key, std::function<void()> handler);
+
+        // number of handlers queued or running
+        size_t pending() const;
+
+    private:
+        handler_dispatcher(handler_dispatch_mode mode, const handler_executor& executor, size_t max_pending,
+            const logger& logger);
+
+        const handler_dispatch_mode m_mode;
+        const handler_executor m_executor;
+        const size_t m_max_pending;
+        const logger m_logger;
+        // the handler at the front of each queue is the one running, queues are removed once they are empty
+        std::unordered_map<const void*, std::deque<std::function<void()>>> m_queues;
+        size_t m_pending;
+        mutable std::mutex m_lock;
+        std::condition_variable m_handler_finished;
+
+        void drain(const void* key);
+        void run(const std::function<void()>& handler) const;
+        void executor_failed(const void* key, const char* error);
+        void handler_completed();
+    };
+}
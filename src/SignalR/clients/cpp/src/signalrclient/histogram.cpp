@@ -0,0 +1,107 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "histogram.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        unsigned int highest_bit(uint64_t value) noexcept
+        {
+            unsigned int bit = 0;
+            for (unsigned int shift = 32; shift > 0; shift >>= 1)
+            {
+                if (value >> shift)
+                {
+                    value >>= shift;
+                    bit += shift;
+                }
+            }
+
+            return bit;
+        }
+    }
+
+    histogram::histogram() noexcept
+        : m_count(0), m_sum(0), m_min(UINT64_MAX), m_max(0)
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void histogram::record(uint64_t value) noexcept
+    {
+        m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+
+        // the extremes rarely change so this is usually a single load each
+        auto min = m_min.load(std::memory_order_relaxed);
+        while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        { }
+
+        auto max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        { }
+    }
+
+    void histogram::record_since(std::chrono::steady_clock::time_point start) noexcept
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        record(elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0);
+    }
+
+    histogram_snapshot histogram::snapshot() const
+    {
+        histogram_snapshot snapshot;
+
+        for (unsigned int index = 0; index < bucket_count; index++)
+        {
+            const auto count = m_buckets[index].load(std::memory_order_relaxed);
+            if (count > 0)
+            {
+                snapshot.buckets.push_back(std::make_pair(bucket_max_value(index), count));
+                snapshot.count += count;
+            }
+        }
+
+        // the count is taken from the buckets so that it matches them even if values are recorded concurrently
+        snapshot.sum = m_sum.load(std::memory_order_relaxed);
+        if (snapshot.count > 0)
+        {
+            snapshot.min = m_min.load(std::memory_order_relaxed);
+            snapshot.max = m_max.load(std::memory_order_relaxed);
+        }
+
+        return snapshot;
+    }
+
+    unsigned int histogram::bucket_index(uint64_t value) noexcept
+    {
+        if (value < sub_bucket_count)
+        {
+            return static_cast<unsigned int>(value);
+        }
+
+        const auto shift = highest_bit(value) - sub_bucket_bits;
+        // the highest bit is implied by the shift so only the bits below it select the sub bucket
+        return sub_bucket_count * (shift + 1) + static_cast<unsigned int>((value >> shift) & (sub_bucket_count - 1));
+    }
+
+    uint64_t histogram::bucket_max_value(unsigned int index) noexcept
+    {
+        if (index < sub_bucket_count)
+        {
+            return index;
+        }
+
+        const auto shift = index / sub_bucket_count - 1;
+        const auto sub_bucket = static_cast<uint64_t>(sub_bucket_count + index % sub_bucket_count);
+        return (sub_bucket << shift) + ((1ULL << shift) - 1);
+    }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "signalrclient/connection_metrics.h"
+
+namespace signalr
+{
+    // Lock-free histogram with logarithmic buckets in the style of HdrHistogram. Values below 8 have a bucket each,
+    // larger values share a bucket with the values having the same highest bit and the same 3 bits below it, which
+    // bounds the relative error to 12.5% for all values. Recording takes a handful of relaxed atomic increments so
+    // histograms can be kept on in production.
+    class histogram
+    {
+    public:
+        histogram() noexcept;
+
+        histogram(const histogram&) = delete;
+        histogram& operator=(const histogram&) = delete;
+
+        // may be called concurrently from any number of threads
+        void record(uint64_t value) noexcept;
+        void record_since(std::chrono::steady_clock::time_point start) noexcept;
+
+        histogram_snapshot snapshot() const;
+
+    private:
+        static const unsigned int sub_bucket_bits = 3;
+        static const unsigned int sub_bucket_count = 1 << sub_bucket_bits;
+        static const unsigned int bucket_count = sub_bucket_count * (64 - sub_bucket_bits + 1);
+
+        std::atomic<uint64_t> m_buckets[bucket_count];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_min;
+        std::atomic<uint64_t> m_max;
+
+        static unsigned int bucket_index(uint64_t value) noexcept;
+        static uint64_t bucket_max_value(unsigned int index) noexcept;
+    };
+}
@@ -0,0 +1,138 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "http_client_pool.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        // returns false if requests using the configuration cannot share a client
+        static bool create_key(const web::uri& base_url, const web::http::client::http_client_config& http_client_config,
+            std::string& key);
+    }
+
+    http_client_pool::http_client_pool(size_t max_size, std::chrono::milliseconds idle_timeout)
+        : m_max_size(max_size), m_idle_timeout(idle_timeout)
+    { }
+
+    std::shared_ptr<web::http::client::http_client> http_client_pool::get_client(const std::string& url,
+        const signalr_client_config& signalr_client_config)
+    {
+        const auto base_url = web::uri(utility::conversions::to_string_t(url)).authority();
+        const auto http_client_config = signalr_client_config.get_http_client_config();
+
+        std::string key;
+        if (m_max_size == 0 || !signalr_client_config.get_http_client_pooling() ||
+            !create_key(base_url, http_client_config, key))
+        {
+            return std::make_shared<web::http::client::http_client>(base_url, http_client_config);
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        const auto now = clock::now();
+        evict(now);
+
+        auto pooled = m_clients.find(key);
+        if (pooled != m_clients.end())
+        {
+            pooled->second.last_used = now;
+            return pooled->second.client;
+        }
+
+        if (m_clients.size() >= m_max_size)
+        {
+            auto least_recently_used = m_clients.begin();
+            for (auto client = m_clients.begin(); client != m_clients.end(); ++client)
+            {
+                if (client->second.last_used < least_recently_used->second.last_used)
+                {
+                    least_recently_used = client;
+                }
+            }
+
+            m_clients.erase(least_recently_used);
+        }
+
+        auto client = std::make_shared<web::http::client::http_client>(base_url, http_client_config);
+        m_clients.insert(std::make_pair(key, pooled_client{ client, now }));
+        return client;
+    }
+
+    size_t http_client_pool::size()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        evict(clock::now());
+        return m_clients.size();
+    }
+
+    void http_client_pool::evict(clock::time_point now)
+    {
+        for (auto client = m_clients.begin(); client != m_clients.end();)
+        {
+            if (now - client->second.last_used >= m_idle_timeout)
+            {
+                client = m_clients.erase(client);
+            }
+            else
+            {
+                ++client;
+            }
+        }
+    }
+
+    http_client_pool& http_client_pool::get_default()
+    {
+        // cpprest closes idle connections of a client after a while - clients are kept a bit longer so that
+        // connections can be reused during reconnect attempts
+        static http_client_pool default_http_client_pool(32, std::chrono::minutes(2));
+        return default_http_client_pool;
+    }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        static bool create_key(const web::uri& base_url, const web::http::client::http_client_config& http_client_config,
+            std::string& key)
+        {
+            // credentials cannot be compared since passwords are not readable so clients using them are not shared
+            if (http_client_config.credentials().is_set() || http_client_config.proxy().credentials().is_set())
+            {
+                return false;
+            }
+
+#if !defined(CPPREST_TARGET_XP)
+            // clients sign or authorize their requests with the tokens of the connection
+            if (http_client_config.oauth1() || http_client_config.oauth2())
+            {
+                return false;
+            }
+#endif
+
+#if !defined(_WIN32) || defined(CPPREST_FORCE_HTTP_CLIENT_ASIO)
+            // the callback may load client certificates of the connection
+            if (http_client_config.get_ssl_context_callback())
+            {
+                return false;
+            }
+#endif
+
+            const auto& proxy = http_client_config.proxy();
+
+            std::stringstream oss;
+            oss << utility::conversions::to_utf8string(base_url.to_string())
+                << "|" << std::chrono::duration_cast<std::chrono::milliseconds>(http_client_config.timeout()).count()
+                << "|" << http_client_config.chunksize()
+                << "|" << http_client_config.validate_certificates()
+                << "|" << http_client_config.request_compressed_response()
+                << "|" << proxy.is_default() << proxy.is_disabled() << proxy.is_auto_discovery()
+                << "|" << utility::conversions::to_utf8string(proxy.address().to_string());
+
+            key = oss.str();
+            return true;
+        }
+    }
+}
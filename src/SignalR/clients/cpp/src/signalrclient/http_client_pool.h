@@ -0,0 +1,56 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "cpprest/http_client.h"
+#include "signalrclient/signalr_client_config.h"
+
+namespace signalr
+{
+    // Caches http clients per base url (scheme, host and port) so that requests to the same server reuse the keep-alive
+    // connections and TLS sessions of a single client instead of connecting again. Requests are only sent with the same
+    // client if they use equivalent client configurations. The number of cached clients is bounded - the least recently
+    // used client is evicted when the pool is full. Clients that have not been used for the idle timeout are evicted
+    // the next time a client is requested. Evicted clients stay usable for requests still holding them.
+    class http_client_pool
+    {
+    public:
+        http_client_pool(size_t max_size, std::chrono::milliseconds idle_timeout);
+
+        http_client_pool(const http_client_pool&) = delete;
+        http_client_pool& operator=(const http_client_pool&) = delete;
+
+        // returns a client for the base url of the `url` using the http client config of the `signalr_client_config`.
+        // Requests sent with the client must use the resource of the url (i.e. the path, query and fragment) as the
+        // request uri
+        std::shared_ptr<web::http::client::http_client> get_client(const std::string& url,
+            const signalr_client_config& signalr_client_config);
+
+        size_t size();
+
+        // the instance shared by all connections in the process
+        static http_client_pool& get_default();
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        struct pooled_client
+        {
+            std::shared_ptr<web::http::client::http_client> client;
+            clock::time_point last_used;
+        };
+
+        const size_t m_max_size;
+        const std::chrono::milliseconds m_idle_timeout;
+        std::mutex m_lock;
+        std::unordered_map<std::string, pooled_client> m_clients;
+
+        void evict(clock::time_point now);
+    };
+}
@@ -4,6 +4,7 @@
 #include "stdafx.h"
 #include "signalrclient/hub_connection.h"
 #include "hub_connection_impl.h"
+#include "prepared_invocation_impl.h"
 #include "signalrclient/signalr_exception.h"
 
 namespace signalr
@@ -47,6 +48,28 @@ namespace signalr
         return m_pImpl->invoke(method_name, arguments);
     }
 
+    pplx::task<web::json::value> hub_connection::invoke(const std::string& method_name, const web::json::value& arguments,
+        const std::vector<stream_writer>& streams)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("invoke() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->invoke(method_name, arguments, streams);
+    }
+
+    pplx::task<web::json::value> hub_connection::invoke(const std::string& method_name, const web::json::value& arguments,
+        std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("invoke() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->invoke(method_name, arguments, std::vector<stream_writer>(), timeout, cancellation_token);
+    }
+
     pplx::task<void> hub_connection::send(const std::string& method_name, const web::json::value& arguments)
     {
         if (!m_pImpl)
@@ -57,6 +80,113 @@ namespace signalr
         return m_pImpl->send(method_name, arguments);
     }
 
+    pplx::task<void> hub_connection::send(const std::string& method_name, const web::json::value& arguments,
+        const std::vector<stream_writer>& streams)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("send() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->send(method_name, arguments, streams);
+    }
+
+    pplx::task<void> hub_connection::flush()
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("flush() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->flush();
+    }
+
+    pplx::task<void> hub_connection::wait_for_send_capacity()
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("wait_for_send_capacity() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->wait_for_send_capacity();
+    }
+
+    size_t hub_connection::get_send_queue_high_water_mark() const
+    {
+        return m_pImpl->get_send_queue_high_water_mark();
+    }
+
+    size_t hub_connection::get_outstanding_invocations() const
+    {
+        return m_pImpl->get_outstanding_invocations();
+    }
+
+    connection_metrics hub_connection::get_metrics() const
+    {
+        return m_pImpl->get_metrics();
+    }
+
+    stream_reader hub_connection::stream(const std::string& method_name, const web::json::value& arguments)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("stream() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->stream(method_name, arguments);
+    }
+
+    void hub_connection::on_serialized(const std::string& event_name, const serialized_method_invoked_handler& handler)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("on() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->on_serialized(event_name, handler);
+    }
+
+    pplx::task<std::string> hub_connection::invoke_serialized(const std::string& method_name, const std::string& arguments)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("invoke() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->invoke_serialized(method_name, arguments);
+    }
+
+    pplx::task<std::string> hub_connection::invoke_serialized(const std::string& method_name, const std::string& arguments,
+        std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("invoke() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->invoke_serialized(method_name, arguments, timeout, cancellation_token);
+    }
+
+    pplx::task<void> hub_connection::send_serialized(const std::string& method_name, const std::string& arguments)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("send() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return m_pImpl->send_serialized(method_name, arguments);
+    }
+
+    prepared_invocation hub_connection::prepare(const std::string& method_name)
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("prepare() cannot be called on uninitialized hub_connection instance");
+        }
+
+        return prepared_invocation(m_pImpl, std::make_shared<prepared_invocation_impl>(method_name));
+    }
+
     connection_state hub_connection::get_connection_state() const
     {
         return m_pImpl->get_connection_state();
@@ -72,6 +202,16 @@ namespace signalr
         m_pImpl->set_disconnected(disconnected_callback);
     }
 
+    void hub_connection::set_reconnecting(const std::function<void()>& reconnecting_callback)
+    {
+        m_pImpl->set_reconnecting(reconnecting_callback);
+    }
+
+    void hub_connection::set_reconnected(const std::function<void()>& reconnected_callback)
+    {
+        m_pImpl->set_reconnected(reconnected_callback);
+    }
+
     void hub_connection::set_client_config(const signalr_client_config& config)
     {
         m_pImpl->set_client_config(config);
@@ -3,6 +3,7 @@
 
 #include "stdafx.h"
 #include "hub_connection_impl.h"
+#include "json_hub_protocol.h"
 #include "signalrclient/hub_exception.h"
 #include "trace_log_writer.h"
 #include "make_unique.h"
@@ -15,9 +16,23 @@ namespace signalr
     // unnamed namespace makes it invisble outside this translation unit
     namespace
     {
-        static std::function<void(const json::value&)> create_hub_invocation_callback(const logger& logger,
+        static std::function<void(const invocation_result&)> create_hub_invocation_callback(const logger& logger,
             const std::function<void(const json::value&)>& set_result,
             const std::function<void(const std::exception_ptr e)>& set_exception);
+
+        static std::function<void(const invocation_result&)> create_serialized_invocation_callback(
+            const std::function<void(const std::string&)>& set_result,
+            const std::function<void(const std::exception_ptr e)>& set_exception);
+
+        static std::function<void(const invocation_result&)> create_stream_callback(const std::shared_ptr<stream_reader_impl>& reader);
+
+        static std::function<void(const invocation_result&)> own_invocation_state(const std::function<void(const invocation_result&)>& callback,
+            const std::shared_ptr<invocation_deadline>& deadline, const std::shared_ptr<invocation_limiter::admission>& admission,
+            const std::shared_ptr<histogram>& round_trip);
+
+        static hub_exception create_hub_exception(const std::string& error);
+
+        static long long steady_clock_milliseconds();
     }
 
     std::shared_ptr<hub_connection_impl> hub_connection_impl::create(const std::string& url, trace_level trace_level,
@@ -44,8 +59,13 @@ namespace signalr
         std::unique_ptr<transport_factory> transport_factory)
         : m_connection(connection_impl::create(url, trace_level, log_writer,
         std::move(web_request_factory), std::move(transport_factory))), m_logger(log_writer, trace_level),
-        m_callback_manager(json::value::parse(_XPLATSTR("{ \"error\" : \"connection went out of scope before invocation result was received\"}"))),
-        m_disconnected([]() noexcept {}), m_handshakeReceived(false)
+        m_callback_manager("connection went out of scope before invocation result was received"),
+        m_subscription_table(std::make_shared<subscription_table>()), m_handshakeReceived(false), m_transport_generation(0),
+        m_received_generation(0), m_disconnected([]() noexcept {}), m_reconnecting([]() noexcept {}),
+        m_reconnected([]() noexcept {}), m_protocol(hub_protocol::create(hub_protocol_type::json)), m_stream_id(0),
+        m_last_message_sent(0), m_last_message_received(0), m_server_timeout_paused(0), m_heartbeat_generation(0), m_heartbeat_timer_id(0),
+        m_invocation_limiter(invocation_limiter::create(0, invocation_admission_policy::reject, 0)),
+        m_invocation_round_trip(std::make_shared<histogram>()), m_handler_execution_time(std::make_shared<histogram>())
     { }
 
     void hub_connection_impl::initialize()
@@ -53,7 +73,7 @@ namespace signalr
         // weak_ptr prevents a circular dependency leading to memory leak and other problems
         std::weak_ptr<hub_connection_impl> weak_hub_connection = shared_from_this();
 
-        m_connection->set_message_received([weak_hub_connection](const std::string& message)
+        m_connection->set_message_received([weak_hub_connection](const message_buffer& message)
         {
             auto connection = weak_hub_connection.lock();
             if (connection)
@@ -67,13 +87,92 @@ namespace signalr
             auto connection = weak_hub_connection.lock();
             if (connection)
             {
-                connection->m_handshakeTask.set_exception(signalr_exception("connection closed while handshake was in progress."));
+                connection->stop_heartbeat();
+                connection->get_handshake_task().set_exception(signalr_exception("connection closed while handshake was in progress."));
+                // no-op if the connection was stopped by the user but not if it was lost
+                connection->m_callback_manager.clear("connection was stopped before invocation result was received");
                 connection->m_disconnected();
             }
         });
+
+        m_connection->set_reconnecting([weak_hub_connection]()
+        {
+            auto connection = weak_hub_connection.lock();
+            if (connection)
+            {
+                connection->stop_heartbeat();
+                connection->m_callback_manager.clear("connection was lost before invocation result was received");
+
+                // the handshake has to be repeated on the new transport. Subscriptions are kept. The receive thread of
+                // the lost transport may still be processing a message so the framer is reset by the receive path.
+                connection->reset_handshake();
+                connection->m_reconnecting();
+            }
+        });
+
+        m_connection->set_reconnected([weak_hub_connection]()
+        {
+            auto connection = weak_hub_connection.lock();
+            if (!connection)
+            {
+                return;
+            }
+
+            connection->send_handshake()
+                .then([weak_hub_connection](pplx::task<void> handshake_task)
+                {
+                    auto connection = weak_hub_connection.lock();
+                    if (!connection)
+                    {
+                        return;
+                    }
+
+                    try
+                    {
+                        handshake_task.get();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        connection->m_logger.log(trace_level::errors, std::string("handshake failed after reconnecting: ")
+                            .append(e.what()));
+                        connection->stop_in_background();
+                        return;
+                    }
+
+                    try
+                    {
+                        connection->m_reconnected();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        connection->m_logger.log(trace_level::errors, std::string("reconnected callback threw an exception: ")
+                            .append(e.what()));
+                    }
+                    catch (...)
+                    {
+                        connection->m_logger.log(trace_level::errors, "reconnected callback threw an unknown exception");
+                    }
+                });
+        });
     }
 
     void hub_connection_impl::on(const std::string& event_name, const std::function<void(const json::value &)>& handler)
+    {
+        register_handler(event_name, [handler](const lazy_json_value& arguments)
+        {
+            handler(arguments.get());
+        });
+    }
+
+    void hub_connection_impl::on_serialized(const std::string& event_name, const std::function<void(const std::string&)>& handler)
+    {
+        register_handler(event_name, [handler](const lazy_json_value& arguments)
+        {
+            handler(arguments.serialized());
+        });
+    }
+
+    void hub_connection_impl::register_handler(const std::string& event_name, std::function<void(const lazy_json_value&)> handler)
     {
         if (event_name.length() == 0)
         {
@@ -93,7 +192,7 @@ namespace signalr
                 "an action for this event has already been registered. event name: " + event_name);
         }
 
-        m_subscriptions.insert(std::pair<std::string, std::function<void(const json::value &)>> {event_name, handler});
+        m_subscriptions.insert(std::make_pair(event_name, std::move(handler)));
     }
 
     pplx::task<void> hub_connection_impl::start()
@@ -105,10 +204,15 @@ namespace signalr
         }
 
         m_connection->set_client_config(m_signalr_client_config);
-        m_handshakeTask = pplx::task_completion_event<void>();
-        m_handshakeReceived = false;
+        m_subscription_table = std::make_shared<subscription_table>(
+            std::vector<std::pair<std::string, subscription_table::handler>>(m_subscriptions.begin(), m_subscriptions.end()));
+        m_handler_dispatcher = m_signalr_client_config.get_handler_dispatch_mode() == handler_dispatch_mode::synchronous
+            ? nullptr
+            : handler_dispatcher::create(m_signalr_client_config.get_handler_dispatch_mode(),
+                m_signalr_client_config.get_handler_executor(), m_signalr_client_config.get_max_pending_handlers(), m_logger);
+        reset_handshake();
         std::weak_ptr<hub_connection_impl> weak_connection = shared_from_this();
-        return m_connection->start()
+        return m_connection->start(m_protocol->transfer_format())
             .then([weak_connection](pplx::task<void> startTask)
             {
                 startTask.get();
@@ -118,18 +222,8 @@ namespace signalr
                     // The connection has been destructed
                     return pplx::task_from_exception<void>(signalr_exception("the hub connection has been deconstructed"));
                 }
-                return connection->m_connection->send("{\"protocol\":\"json\",\"version\":1}\x1e")
-                    .then([weak_connection](pplx::task<void> previous_task)
-                    {
-                        auto connection = weak_connection.lock();
-                        if (!connection)
-                        {
-                            // The connection has been destructed
-                            return pplx::task_from_exception<void>(signalr_exception("the hub connection has been deconstructed"));
-                        }
-                        previous_task.get();
-                        return pplx::task<void>(connection->m_handshakeTask);
-                    })
+
+                return connection->send_handshake()
                     .then([weak_connection](pplx::task<void> previous_task)
                     {
                         try
@@ -153,174 +247,570 @@ namespace signalr
             });
     }
 
+    pplx::task<void> hub_connection_impl::send_handshake()
+    {
+        // the handshake is always json regardless of the selected hub protocol
+        auto handshake_request = std::string("{\"protocol\":\"")
+            .append(m_protocol->name())
+            .append("\",\"version\":")
+            .append(std::to_string(m_protocol->version()))
+            .append("}\x1e");
+
+        auto send_task = m_connection->send(handshake_request);
+        // the handshake must not wait for the batch window if batching is enabled
+        m_connection->flush();
+
+        std::weak_ptr<hub_connection_impl> weak_connection = shared_from_this();
+        const auto handshake_start = steady_clock_milliseconds();
+        auto logger = m_logger;
+
+        return send_task
+            .then([weak_connection](pplx::task<void> previous_task)
+            {
+                auto connection = weak_connection.lock();
+                if (!connection)
+                {
+                    // The connection has been destructed
+                    return pplx::task_from_exception<void>(signalr_exception("the hub connection has been deconstructed"));
+                }
+                previous_task.get();
+                return pplx::task<void>(connection->get_handshake_task());
+            })
+            .then([logger, handshake_start]()
+            {
+                logger.log(trace_level::info, std::string("handshake completed in ")
+                    .append(std::to_string(steady_clock_milliseconds() - handshake_start))
+                    .append(" ms"));
+            });
+    }
+
+    void hub_connection_impl::reset_handshake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_handshake_lock);
+            m_handshakeTask = pplx::task_completion_event<void>();
+        }
+
+        // picked up by the next message received
+        m_transport_generation++;
+    }
+
+    pplx::task_completion_event<void> hub_connection_impl::get_handshake_task()
+    {
+        std::lock_guard<std::mutex> lock(m_handshake_lock);
+        return m_handshakeTask;
+    }
+
     pplx::task<void> hub_connection_impl::stop()
     {
-        m_callback_manager.clear(json::value::parse(_XPLATSTR("{ \"error\" : \"connection was stopped before invocation result was received\"}")));
+        stop_heartbeat();
+        m_callback_manager.clear("connection was stopped before invocation result was received");
         return m_connection->stop();
     }
 
-    enum MessageType
+    void hub_connection_impl::process_message(const message_buffer& response)
     {
-        Invocation = 1,
-        StreamItem,
-        Completion,
-        StreamInvocation,
-        CancelInvocation,
-        Ping,
-        Close,
-    };
+        // the handshake response is always json regardless of the selected hub protocol
+        static const json_hub_protocol handshake_json_protocol;
+        const hub_protocol& handshake_protocol = handshake_json_protocol;
 
-    void hub_connection_impl::process_message(const std::string& response)
-    {
-        try
-        {
-            auto pos = response.find('\x1e');
-            std::size_t lastPos = 0;
-            while (pos != std::string::npos)
-            {
-                auto message = response.substr(lastPos, pos - lastPos);
-                const auto result = web::json::value::parse(utility::conversions::to_string_t(message));
+        m_last_message_received = steady_clock_milliseconds();
 
-                if (!result.is_object())
-                {
-                    m_logger.log(trace_level::info, std::string("unexpected response received from the server: ")
-                        .append(message));
+        // messages are processed one at a time even if the receive thread of a lost transport has not finished yet
+        std::lock_guard<std::mutex> lock(m_receive_lock);
 
-                    return;
-                }
+        // the first message from a new transport starts with the handshake response and no partial message
+        const auto transport_generation = m_transport_generation.load();
+        if (m_received_generation != transport_generation)
+        {
+            m_received_generation = transport_generation;
+            m_handshakeReceived = false;
+            m_framer.reset();
+        }
+
+        m_framer.begin(response.data(), response.size());
 
-                if (!m_handshakeReceived)
+        const char* message;
+        size_t message_length;
+        try
+        {
+            while (m_framer.try_read_message(m_handshakeReceived ? *m_protocol : handshake_protocol, message, message_length))
+            {
+                // a malformed message must not prevent processing the remaining messages in the batch
+                try
                 {
-                    if (result.has_field(_XPLATSTR("error")))
-                    {
-                        auto error = utility::conversions::to_utf8string(result.at(_XPLATSTR("error")).as_string());
-                        m_logger.log(trace_level::errors, std::string("handshake error: ")
-                            .append(error));
-                        m_handshakeTask.set_exception(signalr_exception(std::string("Received an error during handshake: ").append(error)));
-                        return;
-                    }
-                    else
+                    if (m_handshakeReceived)
                     {
-                        if (result.has_field(_XPLATSTR("type")))
+                        auto hub_message = m_protocol->parse_message(message, message_length);
+                        if (hub_message)
                         {
-                            m_handshakeTask.set_exception(signalr_exception(std::string("Received unexpected message while waiting for the handshake response.")));
+                            process_hub_message(*hub_message);
                         }
-                        m_handshakeReceived = true;
-                        m_handshakeTask.set();
-                        return;
                     }
-                }
-
-                auto messageType = result.at(_XPLATSTR("type"));
-                switch (messageType.as_integer())
-                {
-                case MessageType::Invocation:
-                {
-                    auto method = utility::conversions::to_utf8string(result.at(_XPLATSTR("target")).as_string());
-                    auto event = m_subscriptions.find(method);
-                    if (event != m_subscriptions.end())
+                    else
                     {
-                        event->second(result.at(_XPLATSTR("arguments")));
+                        process_handshake_response(std::string(message, message_length));
                     }
-                    break;
                 }
-                case MessageType::StreamInvocation:
-                    // Sent to server only, should not be received by client
-                    throw std::runtime_error("Received unexpected message type 'StreamInvocation'.");
-                case MessageType::StreamItem:
-                    // TODO
-                    break;
-                case MessageType::Completion:
+                catch (const std::exception &e)
                 {
-                    if (result.has_field(_XPLATSTR("error")) && result.has_field(_XPLATSTR("result")))
-                    {
-                        // TODO: error
-                    }
-                    invoke_callback(result);
-                    break;
-                }
-                case MessageType::CancelInvocation:
-                    // Sent to server only, should not be received by client
-                    throw std::runtime_error("Received unexpected message type 'CancelInvocation'.");
-                case MessageType::Ping:
-                    // TODO
-                    break;
-                case MessageType::Close:
-                    // TODO
-                    break;
+                    m_logger.log(trace_level::errors, std::string("error occured when parsing response: ")
+                        .append(e.what())
+                        .append(". response: ")
+                        .append(message, message_length));
                 }
-
-                lastPos = pos + 1;
-                pos = response.find('\x1e', lastPos);
             }
         }
         catch (const std::exception &e)
         {
+            // the data cannot be split into messages so there is no way to tell where the next message starts
             m_logger.log(trace_level::errors, std::string("error occured when parsing response: ")
                 .append(e.what())
                 .append(". response: ")
+                .append(response.str()));
+
+            m_framer.reset();
+            return;
+        }
+
+        m_framer.end();
+    }
+
+    void hub_connection_impl::process_handshake_response(const std::string& response)
+    {
+        const auto result = web::json::value::parse(utility::conversions::to_string_t(response));
+
+        if (!result.is_object())
+        {
+            m_logger.log(trace_level::info, std::string("unexpected response received from the server: ")
                 .append(response));
+
+            return;
+        }
+
+        if (result.has_field(_XPLATSTR("error")))
+        {
+            auto error = utility::conversions::to_utf8string(result.at(_XPLATSTR("error")).as_string());
+            m_logger.log(trace_level::errors, std::string("handshake error: ")
+                .append(error));
+            get_handshake_task().set_exception(signalr_exception(std::string("Received an error during handshake: ").append(error)));
+            return;
+        }
+
+        if (result.has_field(_XPLATSTR("type")))
+        {
+            get_handshake_task().set_exception(signalr_exception(std::string("Received unexpected message while waiting for the handshake response.")));
+        }
+        m_handshakeReceived = true;
+        start_heartbeat();
+        get_handshake_task().set();
+    }
+
+    void hub_connection_impl::process_hub_message(hub_message& message)
+    {
+        switch (message.message_type)
+        {
+        case message_type::invocation:
+        {
+            auto& invocation = static_cast<hub_invocation_message&>(message);
+            const auto handler = m_subscription_table->find(invocation.target.data(), invocation.target.size());
+            if (handler == nullptr)
+            {
+                break;
+            }
+
+            if (!m_handler_dispatcher)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                (*handler)(invocation.arguments);
+                m_handler_execution_time->record_since(start);
+                break;
+            }
+
+            // the parsed message is discarded after processing so the arguments are moved to the queued handler. The
+            // table keeps the handler alive even if the connection is restarted before the handler ran. Handlers
+            // are keyed by their method which makes the keyed_serial mode preserve the order per method. Dispatching
+            // blocks while the maximum number of handlers are pending, nothing is received from the server during
+            // that time.
+            auto subscriptions = m_subscription_table;
+            auto execution_time = m_handler_execution_time;
+            pause_server_timeout();
+            try
+            {
+                m_handler_dispatcher->dispatch(handler, std::bind(
+                    [subscriptions, handler, execution_time](const lazy_json_value& arguments)
+                    {
+                        const auto start = std::chrono::steady_clock::now();
+                        (*handler)(arguments);
+                        execution_time->record_since(start);
+                    },
+                    std::move(invocation.arguments)));
+            }
+            catch (...)
+            {
+                resume_server_timeout();
+                throw;
+            }
+            resume_server_timeout();
+            break;
+        }
+        case message_type::stream_item:
+            invoke_callback(static_cast<stream_item_message&>(message));
+            break;
+        case message_type::completion:
+            invoke_callback(static_cast<completion_message&>(message));
+            break;
+        case message_type::ping:
+            // receiving the ping already reset the server timeout
+            break;
+        case message_type::close:
+        {
+            const auto& close = static_cast<const close_message&>(message);
+            if (close.error.empty())
+            {
+                m_logger.log(trace_level::info, "close message received from the server");
+            }
+            else
+            {
+                m_logger.log(trace_level::errors, std::string("close message received from the server with error: ")
+                    .append(close.error));
+            }
+
+            // the transport which is calling us has to be stopped asynchronously
+            if (close.allow_reconnect)
+            {
+                connection_lost_in_background(close.error.empty()
+                    ? std::string("the server closed the connection")
+                    : std::string("the server closed the connection with error: ").append(close.error));
+            }
+            else
+            {
+                stop_in_background();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    bool hub_connection_impl::invoke_callback(completion_message& completion)
+    {
+        // the parsed message is discarded after processing so the result is moved to the callback as received
+        invocation_result result(std::move(completion.error));
+        if (result.error.empty() && completion.has_result)
+        {
+            result.has_value = true;
+            result.value = std::move(completion.result);
         }
+
+        if (!m_callback_manager.invoke_callback(completion.invocation_id, result, true))
+        {
+            m_logger.log(trace_level::info, std::string("no callback found for id: ").append(completion.invocation_id));
+            return false;
+        }
+
+        return true;
     }
 
-    bool hub_connection_impl::invoke_callback(const web::json::value& message)
+    bool hub_connection_impl::invoke_callback(stream_item_message& stream_item)
     {
-        auto id = utility::conversions::to_utf8string(message.at(_XPLATSTR("invocationId")).as_string());
-        if (!m_callback_manager.invoke_callback(id, message, true))
+        invocation_result item;
+        item.is_item = true;
+        item.has_value = true;
+        try
+        {
+            // stream readers buffer parsed items so the item is parsed here where a malformed item can fail the stream
+            stream_item.item.get();
+            item.value = std::move(stream_item.item);
+        }
+        catch (const std::exception& e)
+        {
+            // the item was not validated when the message was received. The stream fails since an item is missing.
+            if (!m_callback_manager.invoke_callback(stream_item.invocation_id,
+                invocation_result(std::string("the stream item could not be parsed: ").append(e.what())), true))
+            {
+                m_logger.log(trace_level::info, std::string("no callback found for id: ").append(stream_item.invocation_id));
+                return false;
+            }
+
+            send_cancel_invocation(stream_item.invocation_id);
+            return true;
+        }
+
+        // the callback is kept since more items or the completion will follow. Adding the item does not block, a
+        // stream reader whose buffer is full fails and cancels its stream on the server.
+        if (!m_callback_manager.invoke_callback(stream_item.invocation_id, item, false))
         {
-            m_logger.log(trace_level::info, std::string("no callback found for id: ").append(id));
+            m_logger.log(trace_level::info, std::string("no callback found for id: ").append(stream_item.invocation_id));
             return false;
         }
 
         return true;
     }
 
-    pplx::task<json::value> hub_connection_impl::invoke(const std::string& method_name, const json::value& arguments)
+    pplx::task<json::value> hub_connection_impl::invoke(const std::string& method_name, const json::value& arguments,
+        const std::vector<stream_writer>& streams)
+    {
+        return invoke(method_name, arguments, streams, m_signalr_client_config.get_invocation_timeout(),
+            pplx::cancellation_token::none());
+    }
+
+    pplx::task<json::value> hub_connection_impl::invoke(const std::string& method_name, const json::value& arguments,
+        const std::vector<stream_writer>& streams, std::chrono::milliseconds timeout,
+        const pplx::cancellation_token& cancellation_token)
     {
         _ASSERTE(arguments.is_array());
 
+        // nothing is registered or sent for an invocation canceled before it was made
+        if (cancellation_token.is_canceled())
+        {
+            return pplx::task_from_exception<json::value>(pplx::task_canceled("the invocation was canceled"));
+        }
+
+        // shared with the callback sending the invocation once it is admitted by the invocation limiter
+        auto invocation = std::make_shared<hub_invocation_message>("", method_name, arguments);
+        invocation->stream_ids = create_stream_ids(streams);
+
         pplx::task_completion_event<json::value> tce;
+        const auto deadline = invocation_deadline::create(timeout, cancellation_token);
 
-        const auto callback_id = m_callback_manager.register_callback(
+        register_invocation_callback(
             create_hub_invocation_callback(m_logger, [tce](const json::value& result) { tce.set(result); },
-                [tce](const std::exception_ptr e) { tce.set_exception(e); }));
+                [tce](const std::exception_ptr e) { tce.set_exception(e); }), deadline,
+            [tce](const std::exception_ptr e) { tce.set_exception(e); },
+            [invocation, streams, tce](hub_connection_impl& connection, const std::string& callback_id)
+            {
+                invocation->invocation_id = callback_id;
+                connection.invoke_hub_method(*invocation, streams, nullptr,
+                    [tce](const std::exception_ptr e){ tce.set_exception(e); });
+            });
+
+        return pplx::create_task(tce);
+    }
+
+    pplx::task<void> hub_connection_impl::send(const std::string& method_name, const json::value& arguments,
+        const std::vector<stream_writer>& streams)
+    {
+        _ASSERTE(arguments.is_array());
+
+        hub_invocation_message invocation("", method_name, arguments);
+        invocation.stream_ids = create_stream_ids(streams);
 
-        invoke_hub_method(method_name, arguments, callback_id, nullptr,
+        pplx::task_completion_event<void> tce;
+
+        invoke_hub_method(invocation, streams,
+            [tce]() { tce.set(); },
             [tce](const std::exception_ptr e){ tce.set_exception(e); });
 
         return pplx::create_task(tce);
     }
 
-    pplx::task<void> hub_connection_impl::send(const std::string& method_name, const json::value& arguments)
+    pplx::task<std::string> hub_connection_impl::invoke_serialized(const std::string& method_name, const std::string& arguments)
     {
-        _ASSERTE(arguments.is_array());
+        return invoke_serialized(method_name, arguments, m_signalr_client_config.get_invocation_timeout(),
+            pplx::cancellation_token::none());
+    }
+
+    pplx::task<std::string> hub_connection_impl::invoke_serialized(const std::string& method_name, const std::string& arguments,
+        std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token)
+    {
+        if (cancellation_token.is_canceled())
+        {
+            return pplx::task_from_exception<std::string>(pplx::task_canceled("the invocation was canceled"));
+        }
+
+        // shared with the callback sending the invocation once it is admitted by the invocation limiter
+        auto invocation = std::make_shared<hub_invocation_message>("", method_name, lazy_json_value::from_text(arguments));
+
+        pplx::task_completion_event<std::string> tce;
+        const auto deadline = invocation_deadline::create(timeout, cancellation_token);
+
+        register_invocation_callback(
+            create_serialized_invocation_callback([tce](const std::string& result) { tce.set(result); },
+                [tce](const std::exception_ptr e) { tce.set_exception(e); }), deadline,
+            [tce](const std::exception_ptr e) { tce.set_exception(e); },
+            [invocation, tce](hub_connection_impl& connection, const std::string& callback_id)
+            {
+                invocation->invocation_id = callback_id;
+                connection.invoke_hub_method(*invocation, std::vector<stream_writer>(), nullptr,
+                    [tce](const std::exception_ptr e){ tce.set_exception(e); });
+            });
+
+        return pplx::create_task(tce);
+    }
+
+    pplx::task<void> hub_connection_impl::send_serialized(const std::string& method_name, const std::string& arguments)
+    {
+        pplx::task_completion_event<void> tce;
+
+        invoke_hub_method(hub_invocation_message("", method_name, lazy_json_value::from_text(arguments)),
+            std::vector<stream_writer>(),
+            [tce]() { tce.set(); },
+            [tce](const std::exception_ptr e){ tce.set_exception(e); });
+
+        return pplx::create_task(tce);
+    }
+
+    pplx::task<std::string> hub_connection_impl::invoke_prepared(const std::shared_ptr<const prepared_invocation_impl>& invocation,
+        const std::string& arguments)
+    {
+        pplx::task_completion_event<std::string> tce;
+        const auto deadline = invocation_deadline::create(m_signalr_client_config.get_invocation_timeout(),
+            pplx::cancellation_token::none());
+
+        register_invocation_callback(
+            create_serialized_invocation_callback([tce](const std::string& result) { tce.set(result); },
+                [tce](const std::exception_ptr e) { tce.set_exception(e); }), deadline,
+            [tce](const std::exception_ptr e) { tce.set_exception(e); },
+            [invocation, arguments, tce](hub_connection_impl& connection, const std::string& callback_id)
+            {
+                const auto payload = invocation->get_writer(connection.m_signalr_client_config.get_hub_protocol())
+                    .write(callback_id, arguments);
+                connection.track_invocation_send(connection.send_payload(payload), callback_id,
+                    std::vector<std::shared_ptr<stream_writer_impl>>(), nullptr,
+                    [tce](const std::exception_ptr e){ tce.set_exception(e); });
+            });
 
+        return pplx::create_task(tce);
+    }
+
+    pplx::task<void> hub_connection_impl::send_prepared(const prepared_invocation_impl& invocation, const std::string& arguments)
+    {
         pplx::task_completion_event<void> tce;
 
-        invoke_hub_method(method_name, arguments, "",
+        const auto payload = invocation.get_writer(m_signalr_client_config.get_hub_protocol()).write("", arguments);
+        track_invocation_send(send_payload(payload), "", std::vector<std::shared_ptr<stream_writer_impl>>(),
             [tce]() { tce.set(); },
             [tce](const std::exception_ptr e){ tce.set_exception(e); });
 
         return pplx::create_task(tce);
     }
 
-    void hub_connection_impl::invoke_hub_method(const std::string& method_name, const json::value& arguments,
-        const std::string& callback_id, std::function<void()> set_completion, std::function<void(const std::exception_ptr)> set_exception)
+    pplx::task<void> hub_connection_impl::flush()
+    {
+        return m_connection->flush();
+    }
+
+    pplx::task<void> hub_connection_impl::wait_for_send_capacity()
+    {
+        return m_connection->wait_for_send_capacity();
+    }
+
+    size_t hub_connection_impl::get_send_queue_high_water_mark() const noexcept
+    {
+        return m_connection->get_send_queue_high_water_mark();
+    }
+
+    stream_reader hub_connection_impl::stream(const std::string& method_name, const json::value& arguments)
     {
-        json::value request;
-        request[_XPLATSTR("type")] = json::value(1);
-        if (!callback_id.empty())
+        _ASSERTE(arguments.is_array());
+
+        auto reader = std::make_shared<stream_reader_impl>(m_signalr_client_config.get_stream_buffer_capacity());
+
+        // the reader fails like the invoke overloads fail their task if the callback cannot be registered
+        std::string callback_id;
+        try
+        {
+            callback_id = m_callback_manager.register_callback(create_stream_callback(reader));
+        }
+        catch (const signalr_exception& e)
         {
-            request[_XPLATSTR("invocationId")] = json::value::string(utility::conversions::to_string_t(callback_id));
+            m_logger.log(trace_level::errors, std::string("stream rejected: ").append(e.what()));
+            reader->complete(std::current_exception());
+            return stream_reader(reader);
         }
-        request[_XPLATSTR("target")] = json::value::string(utility::conversions::to_string_t(method_name));
-        request[_XPLATSTR("arguments")] = arguments;
 
+        // weak_ptr prevents a circular dependency leading to memory leak and other problems
+        std::weak_ptr<hub_connection_impl> weak_hub_connection = shared_from_this();
+        reader->set_cancel_handler([weak_hub_connection, callback_id]()
+        {
+            auto hub_connection = weak_hub_connection.lock();
+            // the callback is gone if the stream has already completed or the connection was stopped
+            if (hub_connection && hub_connection->m_callback_manager.remove_callback(callback_id))
+            {
+                hub_connection->send_hub_message(cancel_invocation_message(callback_id))
+                    .then([](pplx::task<void> send_task)
+                    {
+                        try
+                        {
+                            send_task.get();
+                        }
+                        catch (const std::exception&)
+                        {
+                            // the stream is cancelled locally regardless of whether the server was notified
+                        }
+                    });
+            }
+        });
+
+        invoke_hub_method(hub_invocation_message(callback_id, method_name, arguments, message_type::stream_invocation),
+            std::vector<stream_writer>(), nullptr,
+            [reader](const std::exception_ptr e) { reader->complete(e); });
+
+        return stream_reader(reader);
+    }
+
+    std::vector<std::string> hub_connection_impl::create_stream_ids(const std::vector<stream_writer>& streams)
+    {
+        std::vector<std::string> stream_ids;
+        for (const auto& stream : streams)
+        {
+            if (stream.m_pImpl->is_bound())
+            {
+                throw signalr_exception("the stream has already been used for an invocation");
+            }
+
+            stream_ids.push_back(std::to_string(m_stream_id++));
+        }
+
+        return stream_ids;
+    }
+
+    void hub_connection_impl::invoke_hub_method(const hub_invocation_message& invocation, const std::vector<stream_writer>& streams,
+        std::function<void()> set_completion, std::function<void(const std::exception_ptr)> set_exception)
+    {
+        const auto callback_id = invocation.invocation_id;
+
+        // weak_ptr prevents a circular dependency leading to memory leak and other problems
+        auto weak_hub_connection = std::weak_ptr<hub_connection_impl>(shared_from_this());
+
+        std::vector<std::shared_ptr<stream_writer_impl>> writers;
+        for (const auto& stream : streams)
+        {
+            writers.push_back(stream.m_pImpl);
+        }
+
+        auto send_task = send_hub_message(invocation);
+
+        // the invocation has been handed to the transport so stream items sent from now on will follow it
+        const auto upload_window = m_signalr_client_config.get_stream_upload_window();
+        for (size_t i = 0; i < writers.size(); i++)
+        {
+            writers[i]->bind(invocation.stream_ids[i], upload_window, [weak_hub_connection](const hub_message& message)
+            {
+                auto hub_connection = weak_hub_connection.lock();
+                if (!hub_connection)
+                {
+                    return pplx::task_from_exception<void>(signalr_exception("the hub connection has been deconstructed"));
+                }
+
+                return hub_connection->send_hub_message(message);
+            });
+        }
+
+        track_invocation_send(send_task, callback_id, writers, std::move(set_completion), std::move(set_exception));
+    }
+
+    void hub_connection_impl::track_invocation_send(pplx::task<void> send_task, const std::string& callback_id,
+        const std::vector<std::shared_ptr<stream_writer_impl>>& writers, std::function<void()> set_completion,
+        std::function<void(const std::exception_ptr)> set_exception)
+    {
         // weak_ptr prevents a circular dependency leading to memory leak and other problems
         auto weak_hub_connection = std::weak_ptr<hub_connection_impl>(shared_from_this());
 
-        m_connection->send(utility::conversions::to_utf8string(request.serialize() + _XPLATSTR('\x1e')))
-            .then([set_completion, set_exception, weak_hub_connection, callback_id](pplx::task<void> send_task)
+        send_task
+            .then([set_completion, set_exception, weak_hub_connection, callback_id, writers](pplx::task<void> send_task)
             {
                 try
                 {
@@ -333,6 +823,11 @@ namespace signalr
                 }
                 catch (const std::exception&)
                 {
+                    for (const auto& writer : writers)
+                    {
+                        writer->abort(std::current_exception());
+                    }
+
                     set_exception(std::current_exception());
                     auto hub_connection = weak_hub_connection.lock();
                     if (hub_connection)
@@ -343,6 +838,182 @@ namespace signalr
             });
     }
 
+    // fails the invocation if it has not completed when the deadline expires. A queued invocation is withdrawn from
+    // the invocation limiter, a sent one is canceled on the server
+    void hub_connection_impl::arm_deadline(const std::shared_ptr<invocation_deadline>& deadline,
+        const std::shared_ptr<pending_invocation>& pending, const std::weak_ptr<invocation_limiter>& limiter,
+        std::function<void(const std::exception_ptr)> set_exception)
+    {
+        // weak_ptr prevents a circular dependency leading to memory leak and other problems
+        auto weak_hub_connection = std::weak_ptr<hub_connection_impl>(shared_from_this());
+
+        deadline->arm([weak_hub_connection, pending, limiter, set_exception](const std::exception_ptr& error)
+        {
+            std::string callback_id;
+            uint64_t ticket;
+            {
+                std::lock_guard<std::mutex> lock(pending->lock);
+                pending->expired = true;
+                callback_id = pending->callback_id;
+                ticket = pending->ticket;
+            }
+
+            if (callback_id.empty())
+            {
+                // still queued, or being admitted and sent in which case the admitted callback drops or cancels the
+                // invocation
+                auto invocation_limiter = limiter.lock();
+                if (invocation_limiter && ticket != 0)
+                {
+                    invocation_limiter->withdraw(ticket);
+                }
+
+                set_exception(error);
+                return;
+            }
+
+            auto hub_connection = weak_hub_connection.lock();
+            // the callback is gone if the invocation completed or failed in the meantime
+            if (!hub_connection || !hub_connection->m_callback_manager.remove_callback(callback_id))
+            {
+                return;
+            }
+
+            set_exception(error);
+            hub_connection->send_cancel_invocation(callback_id);
+        });
+    }
+
+    // registers the callback and sends the invocation with `send` once the invocation limiter admits it, which happens
+    // right away unless the limit has been reached. Fails the invocation if it is rejected by the invocation limiter
+    // or if it cannot be registered or written. The deadline is armed right away so that it also covers the time the
+    // invocation is queued.
+    void hub_connection_impl::register_invocation_callback(const std::function<void(const invocation_result&)>& callback,
+        const std::shared_ptr<invocation_deadline>& deadline, const std::function<void(const std::exception_ptr)>& set_exception,
+        const std::function<void(hub_connection_impl&, const std::string&)>& send)
+    {
+        // weak_ptr prevents a circular dependency leading to memory leak and other problems
+        std::weak_ptr<hub_connection_impl> weak_hub_connection = shared_from_this();
+        // the limiter is replaced when the config is set
+        const auto limiter = m_invocation_limiter;
+        const auto pending = std::make_shared<pending_invocation>();
+
+        uint64_t ticket;
+        try
+        {
+            ticket = limiter->admit([weak_hub_connection, callback, deadline, set_exception, send, pending](
+                const std::shared_ptr<invocation_limiter::admission>& admission, const std::string& shed_invocation_id)
+            {
+                auto hub_connection = weak_hub_connection.lock();
+                if (!hub_connection)
+                {
+                    set_exception(std::make_exception_ptr(signalr_exception("the hub connection has been deconstructed")));
+                    return;
+                }
+
+                if (!shed_invocation_id.empty() && hub_connection->m_callback_manager.invoke_callback(shed_invocation_id,
+                    invocation_result("invocation was shed to make room for a newer invocation"), true))
+                {
+                    hub_connection->send_cancel_invocation(shed_invocation_id);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(pending->lock);
+                    if (pending->expired)
+                    {
+                        // the deadline has already failed the invocation while it was queued
+                        return;
+                    }
+                }
+
+                std::string callback_id;
+                try
+                {
+                    callback_id = hub_connection->m_callback_manager.register_callback(own_invocation_state(callback,
+                        deadline, admission, hub_connection->m_invocation_round_trip));
+                    send(*hub_connection, callback_id);
+                }
+                catch (const std::exception&)
+                {
+                    // the callback is gone if the invocation has already failed
+                    if (callback_id.empty() || hub_connection->m_callback_manager.remove_callback(callback_id))
+                    {
+                        set_exception(std::current_exception());
+                    }
+                    return;
+                }
+
+                // the deadline only cancels the invocation on the server once it has been sent
+                bool expired;
+                {
+                    std::lock_guard<std::mutex> lock(pending->lock);
+                    expired = pending->expired;
+                    pending->callback_id = callback_id;
+                }
+
+                if (expired)
+                {
+                    if (hub_connection->m_callback_manager.remove_callback(callback_id))
+                    {
+                        hub_connection->send_cancel_invocation(callback_id);
+                    }
+                    return;
+                }
+
+                // the invocation can be shed once it has been sent
+                admission->set_invocation_id(callback_id);
+            });
+        }
+        catch (const signalr_exception& e)
+        {
+            m_logger.log(trace_level::errors, std::string("invocation rejected: ").append(e.what()));
+            set_exception(std::current_exception());
+            return;
+        }
+
+        if (!deadline)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pending->lock);
+            pending->ticket = ticket;
+        }
+
+        arm_deadline(deadline, pending, limiter, set_exception);
+    }
+
+    // the invocation fails locally regardless of whether the server was notified
+    void hub_connection_impl::send_cancel_invocation(const std::string& invocation_id)
+    {
+        send_hub_message(cancel_invocation_message(invocation_id))
+            .then([](pplx::task<void> send_task)
+            {
+                try
+                {
+                    send_task.get();
+                }
+                catch (const std::exception&)
+                { }
+            });
+    }
+
+    size_t hub_connection_impl::get_outstanding_invocations() const noexcept
+    {
+        return m_invocation_limiter->outstanding();
+    }
+
+    connection_metrics hub_connection_impl::get_metrics() const
+    {
+        auto metrics = m_connection->get_metrics();
+        metrics.outstanding_invocations = m_invocation_limiter->outstanding();
+        metrics.queued_invocations = m_invocation_limiter->queued();
+        metrics.invocation_round_trip = m_invocation_round_trip->snapshot();
+        metrics.handler_execution_time = m_handler_execution_time->snapshot();
+        return metrics;
+    }
+
     connection_state hub_connection_impl::get_connection_state() const noexcept
     {
         return m_connection->get_connection_state();
@@ -355,8 +1026,12 @@ namespace signalr
 
     void hub_connection_impl::set_client_config(const signalr_client_config& config)
     {
-        m_signalr_client_config = config;
         m_connection->set_client_config(config);
+        m_signalr_client_config = config;
+        m_protocol = hub_protocol::create(config.get_hub_protocol());
+        // invocations admitted by the previous limiter keep it alive until they complete
+        m_invocation_limiter = invocation_limiter::create(config.get_max_outstanding_invocations(),
+            config.get_invocation_admission_policy(), config.get_max_queued_invocations());
     }
 
     void hub_connection_impl::set_disconnected(const std::function<void()>& disconnected)
@@ -364,28 +1039,261 @@ namespace signalr
         m_disconnected = disconnected;
     }
 
+    void hub_connection_impl::set_reconnecting(const std::function<void()>& reconnecting)
+    {
+        m_reconnecting = reconnecting;
+    }
+
+    void hub_connection_impl::set_reconnected(const std::function<void()>& reconnected)
+    {
+        m_reconnected = reconnected;
+    }
+
+    void hub_connection_impl::stop_in_background()
+    {
+        std::weak_ptr<hub_connection_impl> weak_connection = shared_from_this();
+        pplx::create_task([weak_connection]()
+        {
+            auto connection = weak_connection.lock();
+            if (connection)
+            {
+                return connection->stop();
+            }
+            return pplx::task_from_result();
+        })
+        .then([](pplx::task<void> stop_task)
+        {
+            try
+            {
+                stop_task.get();
+            }
+            catch (...)
+            {
+                // the connection was already being stopped
+            }
+        });
+    }
+
+    void hub_connection_impl::connection_lost_in_background(const std::string& error)
+    {
+        // reconnecting resets the state used when processing messages so it must not run on the receiving thread
+        auto connection = m_connection;
+        pplx::create_task([connection, error]()
+        {
+            connection->connection_lost(signalr_exception(error));
+        });
+    }
+
+    pplx::task<void> hub_connection_impl::send_hub_message(const hub_message& message)
+    {
+        return send_payload(m_protocol->write_message(message));
+    }
+
+    pplx::task<void> hub_connection_impl::send_payload(const std::string& payload)
+    {
+        m_last_message_sent = steady_clock_milliseconds();
+        return m_connection->send(payload, m_protocol->transfer_format());
+    }
+
+    void hub_connection_impl::start_heartbeat()
+    {
+        const auto now = steady_clock_milliseconds();
+        m_last_message_sent = now;
+        m_last_message_received = now;
+
+        schedule_heartbeat(++m_heartbeat_generation);
+    }
+
+    void hub_connection_impl::stop_heartbeat()
+    {
+        ++m_heartbeat_generation;
+        timer_service::get_default().cancel(m_heartbeat_timer_id);
+    }
+
+    // the server timeout does not elapse while the receive thread is blocked by the client since the messages from the
+    // server are not read during that time
+    void hub_connection_impl::pause_server_timeout()
+    {
+        ++m_server_timeout_paused;
+    }
+
+    void hub_connection_impl::resume_server_timeout()
+    {
+        // the server timeout starts over as if a message was received when the receive thread was unblocked
+        m_last_message_received = steady_clock_milliseconds();
+        --m_server_timeout_paused;
+    }
+
+    void hub_connection_impl::schedule_heartbeat(unsigned int generation)
+    {
+        // the timer fires when either a ping is due or the server timeout would elapse, whichever comes first. The
+        // next ping is always due at some point so it covers the server timeout being paused.
+        const auto next_ping = m_last_message_sent + m_signalr_client_config.get_keep_alive_interval().count();
+        const auto server_timeout = m_server_timeout_paused.load() > 0
+            ? next_ping
+            : m_last_message_received + m_signalr_client_config.get_server_timeout().count();
+        const auto delay = (std::max)((std::min)(next_ping, server_timeout) - steady_clock_milliseconds(), 0LL);
+
+        std::weak_ptr<hub_connection_impl> weak_connection = shared_from_this();
+        m_heartbeat_timer_id = timer_service::get_default().schedule(std::chrono::milliseconds(delay),
+            [weak_connection, generation]()
+            {
+                auto connection = weak_connection.lock();
+                if (connection)
+                {
+                    connection->on_heartbeat(generation);
+                }
+            });
+    }
+
+    void hub_connection_impl::on_heartbeat(unsigned int generation)
+    {
+        if (generation != m_heartbeat_generation)
+        {
+            // the heartbeat was stopped or restarted after this timer was scheduled
+            return;
+        }
+
+        const auto now = steady_clock_milliseconds();
+        const auto server_timeout = m_signalr_client_config.get_server_timeout();
+        if (m_server_timeout_paused.load() == 0 && now - m_last_message_received >= server_timeout.count())
+        {
+            m_logger.log(trace_level::errors, std::string("server timeout (")
+                .append(std::to_string(server_timeout.count()))
+                .append(" ms) elapsed without receiving a message from the server."));
+
+            // handled like a lost transport so that the connection reconnects if automatic reconnect is enabled
+            connection_lost_in_background("server timeout elapsed");
+            return;
+        }
+
+        if (now - m_last_message_sent >= m_signalr_client_config.get_keep_alive_interval().count())
+        {
+            send_hub_message(ping_message())
+                .then([](pplx::task<void> send_task)
+                {
+                    try
+                    {
+                        send_task.get();
+                    }
+                    catch (const std::exception&)
+                    {
+                        // a failed ping will be noticed by the server timeout or the transport
+                    }
+                });
+        }
+
+        schedule_heartbeat(generation);
+    }
+
     // unnamed namespace makes it invisble outside this translation unit
     namespace
     {
-        static std::function<void(const json::value&)> create_hub_invocation_callback(const logger& logger,
+        static std::function<void(const invocation_result&)> create_hub_invocation_callback(const logger& logger,
             const std::function<void(const json::value&)>& set_result,
             const std::function<void(const std::exception_ptr)>& set_exception)
         {
-            return [logger, set_result, set_exception](const json::value& message)
+            return [logger, set_result, set_exception](const invocation_result& result)
             {
-                if (message.has_field(_XPLATSTR("result")))
+                if (!result.error.empty())
                 {
-                    set_result(message.at(_XPLATSTR("result")));
+                    set_exception(std::make_exception_ptr(create_hub_exception(result.error)));
+                    return;
                 }
-                else if (message.has_field(_XPLATSTR("error")))
+
+                if (!result.has_value)
                 {
-                    set_exception(
-                        std::make_exception_ptr(
-                            hub_exception(utility::conversions::to_utf8string(message.at(_XPLATSTR("error")).serialize()))));
+                    set_result(json::value::null());
+                    return;
+                }
+
+                // the result was not validated when the message was received
+                json::value value;
+                try
+                {
+                    value = result.value.get();
+                }
+                catch (const std::exception& e)
+                {
+                    set_exception(std::make_exception_ptr(
+                        signalr_exception(std::string("the invocation result could not be parsed: ").append(e.what()))));
+                    return;
                 }
 
-                set_result(json::value::null());
+                set_result(value);
             };
         }
+
+        static std::function<void(const invocation_result&)> create_serialized_invocation_callback(
+            const std::function<void(const std::string&)>& set_result,
+            const std::function<void(const std::exception_ptr)>& set_exception)
+        {
+            return [set_result, set_exception](const invocation_result& result)
+            {
+                if (!result.error.empty())
+                {
+                    set_exception(std::make_exception_ptr(create_hub_exception(result.error)));
+                }
+                else if (result.has_value)
+                {
+                    set_result(result.value.serialized());
+                }
+                else
+                {
+                    set_result("null");
+                }
+            };
+        }
+
+        static std::function<void(const invocation_result&)> create_stream_callback(const std::shared_ptr<stream_reader_impl>& reader)
+        {
+            return [reader](const invocation_result& result)
+            {
+                if (result.is_item)
+                {
+                    reader->add_item(result.value.get());
+                }
+                else if (!result.error.empty())
+                {
+                    reader->complete(std::make_exception_ptr(create_hub_exception(result.error)));
+                }
+                else
+                {
+                    reader->complete();
+                }
+            };
+        }
+
+        static std::function<void(const invocation_result&)> own_invocation_state(const std::function<void(const invocation_result&)>& callback,
+            const std::shared_ptr<invocation_deadline>& deadline, const std::shared_ptr<invocation_limiter::admission>& admission,
+            const std::shared_ptr<histogram>& round_trip)
+        {
+            // the callback owns the deadline and the admission so they are released when the invocation completes or
+            // its callback is removed
+            const auto start = std::chrono::steady_clock::now();
+            return [callback, deadline, admission, round_trip, start](const invocation_result& result)
+            {
+                if (deadline)
+                {
+                    deadline->disarm();
+                }
+
+                round_trip->record_since(start);
+                callback(result);
+            };
+        }
+
+        // errors are reported as json strings, which is how they were reported when they were passed as json
+        static hub_exception create_hub_exception(const std::string& error)
+        {
+            return hub_exception(utility::conversions::to_utf8string(
+                json::value::string(utility::conversions::to_string_t(error)).serialize()));
+        }
+
+        static long long steady_clock_milliseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
     }
 }
@@ -3,10 +3,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include "connection_impl.h"
 #include "callback_manager.h"
 #include "case_insensitive_comparison_utils.h"
+#include "handler_dispatcher.h"
+#include "histogram.h"
+#include "hub_protocol.h"
+#include "invocation_deadline.h"
+#include "invocation_limiter.h"
+#include "message_framer.h"
+#include "prepared_invocation_impl.h"
+#include "stream_reader_impl.h"
+#include "signalrclient/stream_reader.h"
+#include "signalrclient/stream_writer.h"
+#include "stream_writer_impl.h"
+#include "subscription_table.h"
+#include "timer_service.h"
 
 using namespace web;
 
@@ -31,9 +46,29 @@ namespace signalr
         hub_connection_impl& operator=(const hub_connection_impl&) = delete;
 
         void on(const std::string& event_name, const std::function<void(const json::value &)>& handler);
-
-        pplx::task<json::value> invoke(const std::string& method_name, const json::value& arguments);
-        pplx::task<void> send(const std::string& method_name, const json::value& arguments);
+        void on_serialized(const std::string& event_name, const std::function<void(const std::string&)>& handler);
+
+        pplx::task<json::value> invoke(const std::string& method_name, const json::value& arguments,
+            const std::vector<stream_writer>& streams = std::vector<stream_writer>());
+        // a timeout of 0 means no timeout, the overloads without a timeout use the timeout from the client config
+        pplx::task<json::value> invoke(const std::string& method_name, const json::value& arguments,
+            const std::vector<stream_writer>& streams, std::chrono::milliseconds timeout,
+            const pplx::cancellation_token& cancellation_token);
+        pplx::task<void> send(const std::string& method_name, const json::value& arguments,
+            const std::vector<stream_writer>& streams = std::vector<stream_writer>());
+        stream_reader stream(const std::string& method_name, const json::value& arguments);
+        pplx::task<std::string> invoke_serialized(const std::string& method_name, const std::string& arguments);
+        pplx::task<std::string> invoke_serialized(const std::string& method_name, const std::string& arguments,
+            std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token);
+        pplx::task<void> send_serialized(const std::string& method_name, const std::string& arguments);
+        pplx::task<std::string> invoke_prepared(const std::shared_ptr<const prepared_invocation_impl>& invocation,
+            const std::string& arguments);
+        pplx::task<void> send_prepared(const prepared_invocation_impl& invocation, const std::string& arguments);
+        pplx::task<void> flush();
+        pplx::task<void> wait_for_send_capacity();
+        size_t get_send_queue_high_water_mark() const noexcept;
+        size_t get_outstanding_invocations() const noexcept;
+        connection_metrics get_metrics() const;
 
         pplx::task<void> start();
         pplx::task<void> stop();
@@ -43,26 +78,101 @@ namespace signalr
 
         void set_client_config(const signalr_client_config& config);
         void set_disconnected(const std::function<void()>& disconnected);
+        void set_reconnecting(const std::function<void()>& reconnecting);
+        void set_reconnected(const std::function<void()>& reconnected);
 
     private:
+        // an invocation from the call until its callback has been registered. Lets its deadline fail it while it is
+        // still queued by the invocation limiter
+        struct pending_invocation
+        {
+            pending_invocation() noexcept
+                : expired(false), ticket(0)
+            { }
+
+            std::mutex lock;
+            bool expired;
+            // the ticket of the invocation queued by the limiter, 0 if it was admitted right away
+            uint64_t ticket;
+            // set once the callback has been registered
+            std::string callback_id;
+        };
+
         hub_connection_impl(const std::string& url, trace_level trace_level, const std::shared_ptr<log_writer>& log_writer,
             std::unique_ptr<web_request_factory> web_request_factory, std::unique_ptr<transport_factory> transport_factory);
 
         std::shared_ptr<connection_impl> m_connection;
         logger m_logger;
         callback_manager m_callback_manager;
-        std::unordered_map<std::string, std::function<void(const json::value &)>, case_insensitive_hash, case_insensitive_equals> m_subscriptions;
+        std::unordered_map<std::string, std::function<void(const lazy_json_value&)>, case_insensitive_hash, case_insensitive_equals> m_subscriptions;
+        // m_subscriptions frozen when the connection starts, used to dispatch invocations. Shared with the handlers
+        // still queued when the connection is restarted.
+        std::shared_ptr<const subscription_table> m_subscription_table;
+        // null if handlers are invoked synchronously
+        std::shared_ptr<handler_dispatcher> m_handler_dispatcher;
+        // serializes processing messages, guards the framer and the handshake state of the current transport
+        std::mutex m_receive_lock;
         bool m_handshakeReceived;
+        // bumped when a new transport is started, the receive path resets its state when it sees a new generation
+        std::atomic<unsigned int> m_transport_generation;
+        unsigned int m_received_generation;
+        std::mutex m_handshake_lock;
         pplx::task_completion_event<void> m_handshakeTask;
         std::function<void()> m_disconnected;
+        std::function<void()> m_reconnecting;
+        std::function<void()> m_reconnected;
         signalr_client_config m_signalr_client_config;
+        std::unique_ptr<hub_protocol> m_protocol;
+        std::atomic<int> m_stream_id;
+        message_framer m_framer;
+        // timestamps in milliseconds of the steady clock, updated from the transport and the heartbeat timer
+        std::atomic<long long> m_last_message_sent;
+        std::atomic<long long> m_last_message_received;
+        // greater than 0 while the receive thread is blocked, e.g. by the handler dispatcher being full
+        std::atomic<int> m_server_timeout_paused;
+        // bumped whenever the heartbeat is started or stopped so that timers scheduled before are ignored
+        std::atomic<unsigned int> m_heartbeat_generation;
+        std::atomic<timer_service::timer_id> m_heartbeat_timer_id;
+        std::shared_ptr<invocation_limiter> m_invocation_limiter;
+        // shared with invocation callbacks and queued handlers which may outlive the connection
+        std::shared_ptr<histogram> m_invocation_round_trip;
+        std::shared_ptr<histogram> m_handler_execution_time;
 
         void initialize();
-
-        void process_message(const std::string& message);
-
-        void invoke_hub_method(const std::string& method_name, const json::value& arguments, const std::string& callback_id,
+        void register_handler(const std::string& event_name, std::function<void(const lazy_json_value&)> handler);
+
+        pplx::task<void> send_handshake();
+        void reset_handshake();
+        pplx::task_completion_event<void> get_handshake_task();
+        void stop_in_background();
+        void connection_lost_in_background(const std::string& error);
+
+        void process_message(const message_buffer& message);
+        void process_handshake_response(const std::string& response);
+        void process_hub_message(hub_message& message);
+
+        pplx::task<void> send_hub_message(const hub_message& message);
+        pplx::task<void> send_payload(const std::string& payload);
+        void start_heartbeat();
+        void stop_heartbeat();
+        void pause_server_timeout();
+        void resume_server_timeout();
+        void schedule_heartbeat(unsigned int generation);
+        void on_heartbeat(unsigned int generation);
+
+        void invoke_hub_method(const hub_invocation_message& invocation, const std::vector<stream_writer>& streams,
             std::function<void()> set_completion, std::function<void(const std::exception_ptr)> set_exception);
-        bool invoke_callback(const web::json::value& message);
+        void track_invocation_send(pplx::task<void> send_task, const std::string& callback_id,
+            const std::vector<std::shared_ptr<stream_writer_impl>>& writers, std::function<void()> set_completion,
+            std::function<void(const std::exception_ptr)> set_exception);
+        std::vector<std::string> create_stream_ids(const std::vector<stream_writer>& streams);
+        void register_invocation_callback(const std::function<void(const invocation_result&)>& callback,
+            const std::shared_ptr<invocation_deadline>& deadline, const std::function<void(const std::exception_ptr)>& set_exception,
+            const std::function<void(hub_connection_impl&, const std::string&)>& send);
+        void send_cancel_invocation(const std::string& invocation_id);
+        void arm_deadline(const std::shared_ptr<invocation_deadline>& deadline, const std::shared_ptr<pending_invocation>& pending,
+            const std::weak_ptr<invocation_limiter>& limiter, std::function<void(const std::exception_ptr)> set_exception);
+        bool invoke_callback(completion_message& completion);
+        bool invoke_callback(stream_item_message& stream_item);
     };
 }
@@ -0,0 +1,94 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "lazy_json_value.h"
+
+namespace signalr
+{
+    enum class message_type
+    {
+        invocation = 1,
+        stream_item,
+        completion,
+        stream_invocation,
+        cancel_invocation,
+        ping,
+        close
+    };
+
+    struct hub_message
+    {
+        explicit hub_message(signalr::message_type message_type) noexcept
+            : message_type(message_type)
+        { }
+
+        virtual ~hub_message() = default;
+
+        const signalr::message_type message_type;
+    };
+
+    struct hub_invocation_message : hub_message
+    {
+        hub_invocation_message(const std::string& invocation_id, const std::string& target, const lazy_json_value& arguments,
+            signalr::message_type message_type = signalr::message_type::invocation)
+            : hub_message(message_type), invocation_id(invocation_id), target(target), arguments(arguments)
+        { }
+
+        std::string invocation_id;
+        std::string target;
+        lazy_json_value arguments;
+        std::vector<std::string> stream_ids;
+    };
+
+    struct stream_item_message : hub_message
+    {
+        stream_item_message(const std::string& invocation_id, const lazy_json_value& item)
+            : hub_message(signalr::message_type::stream_item), invocation_id(invocation_id), item(item)
+        { }
+
+        std::string invocation_id;
+        lazy_json_value item;
+    };
+
+    struct completion_message : hub_message
+    {
+        completion_message(const std::string& invocation_id, const std::string& error, const lazy_json_value& result, bool has_result)
+            : hub_message(signalr::message_type::completion), invocation_id(invocation_id), error(error), result(result), has_result(has_result)
+        { }
+
+        std::string invocation_id;
+        std::string error;
+        lazy_json_value result;
+        bool has_result;
+    };
+
+    struct cancel_invocation_message : hub_message
+    {
+        explicit cancel_invocation_message(const std::string& invocation_id)
+            : hub_message(signalr::message_type::cancel_invocation), invocation_id(invocation_id)
+        { }
+
+        std::string invocation_id;
+    };
+
+    struct ping_message : hub_message
+    {
+        ping_message() noexcept
+            : hub_message(signalr::message_type::ping)
+        { }
+    };
+
+    struct close_message : hub_message
+    {
+        close_message(const std::string& error, bool allow_reconnect)
+            : hub_message(signalr::message_type::close), error(error), allow_reconnect(allow_reconnect)
+        { }
+
+        std::string error;
+        bool allow_reconnect;
+    };
+}
@@ -0,0 +1,52 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "hub_protocol.h"
+#include "json_hub_protocol.h"
+#include "messagepack_hub_protocol.h"
+#include "make_unique.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    std::unique_ptr<hub_protocol> hub_protocol::create(hub_protocol_type hub_protocol_type)
+    {
+        if (hub_protocol_type == signalr::hub_protocol_type::messagepack)
+        {
+            return std::make_unique<messagepack_hub_protocol>();
+        }
+
+        return std::make_unique<json_hub_protocol>();
+    }
+
+    std::vector<std::unique_ptr<hub_message>> hub_protocol::parse_messages(const std::string& payload) const
+    {
+        std::vector<std::unique_ptr<hub_message>> messages;
+
+        size_t position = 0;
+        while (position < payload.size())
+        {
+            message_frame frame;
+            if (!try_read_frame(payload.data() + position, payload.size() - position, frame))
+            {
+                throw signalr_exception("incomplete message received from the server");
+            }
+
+            auto message = parse_message(payload.data() + position + frame.message_offset, frame.message_length);
+            if (message)
+            {
+                messages.push_back(std::move(message));
+            }
+            position += frame.frame_length;
+        }
+
+        return messages;
+    }
+
+    hub_protocol::~hub_protocol()
+    { }
+
+    invocation_writer::~invocation_writer()
+    { }
+}
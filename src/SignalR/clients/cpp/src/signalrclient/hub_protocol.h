@@ -0,0 +1,69 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "signalrclient/hub_protocol_type.h"
+#include "hub_message.h"
+#include "transfer_format.h"
+
+namespace signalr
+{
+    // describes the position of a single message within the received data
+    struct message_frame
+    {
+        // offset and length of the message payload i.e. without the framing
+        size_t message_offset;
+        size_t message_length;
+        // number of bytes taken by the message including the framing
+        size_t frame_length;
+    };
+
+    // Writes invocations of a single hub method. The parts of the message that are the same for every invocation are
+    // serialized once when the writer is created.
+    class invocation_writer
+    {
+    public:
+        // `arguments` is the serialized json array of arguments. The invocation id is empty for invocations without
+        // a result. The returned payload includes the framing.
+        virtual std::string write(const std::string& invocation_id, const std::string& arguments) const = 0;
+
+        virtual ~invocation_writer();
+    };
+
+    // Converts hub messages to and from the wire representation. Implementations must be stateless since the same
+    // instance is used from the receive loop and from any thread invoking hub methods.
+    class hub_protocol
+    {
+    public:
+        // the returned payload includes the protocol specific framing (i.e. the record separator for json or
+        // the length prefix for messagepack) so it can be sent as is or appended to other payloads
+        virtual std::string write_message(const hub_message& message) const = 0;
+
+        // the returned writer produces the same payload as `write_message` for invocations of `target` and does not
+        // depend on the protocol instance. The messagepack writer keeps the fields of objects in the arguments in the
+        // order they appear in the text instead of the order of `web::json::value`.
+        virtual std::unique_ptr<invocation_writer> create_invocation_writer(const std::string& target) const = 0;
+
+        // finds the first message at the beginning of the data. Returns false if the data does not contain a
+        // complete message yet.
+        virtual bool try_read_frame(const char* data, size_t length, message_frame& frame) const = 0;
+
+        // parses a single message without the framing. Returns nullptr for messages of unknown types.
+        virtual std::unique_ptr<hub_message> parse_message(const char* data, size_t length) const = 0;
+
+        // parses all messages contained in the payload. Messages of unknown types are skipped.
+        std::vector<std::unique_ptr<hub_message>> parse_messages(const std::string& payload) const;
+
+        virtual const std::string& name() const noexcept = 0;
+        virtual int version() const noexcept = 0;
+        virtual signalr::transfer_format transfer_format() const noexcept = 0;
+
+        virtual ~hub_protocol();
+
+        static std::unique_ptr<hub_protocol> create(hub_protocol_type hub_protocol_type);
+    };
+}
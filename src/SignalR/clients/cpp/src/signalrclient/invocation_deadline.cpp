@@ -0,0 +1,146 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "invocation_deadline.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    std::shared_ptr<invocation_deadline> invocation_deadline::create(std::chrono::milliseconds timeout,
+        const pplx::cancellation_token& cancellation_token)
+    {
+        if (timeout.count() <= 0 && !cancellation_token.is_cancelable())
+        {
+            return nullptr;
+        }
+
+        return std::shared_ptr<invocation_deadline>(new invocation_deadline(timeout, cancellation_token));
+    }
+
+    invocation_deadline::invocation_deadline(std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token)
+        : m_timeout(timeout), m_cancellation_token(cancellation_token), m_done(false), m_timer_scheduled(false),
+        m_timer_id(0), m_registered(false)
+    { }
+
+    invocation_deadline::~invocation_deadline()
+    {
+        disarm();
+    }
+
+    void invocation_deadline::arm(const std::function<void(const std::exception_ptr&)>& expire)
+    {
+        // the timer and the token only hold weak references so that a completed invocation releases the deadline
+        std::weak_ptr<invocation_deadline> weak_deadline = shared_from_this();
+        const auto timeout = m_timeout;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_done)
+            {
+                return;
+            }
+
+            m_expire = expire;
+
+            if (timeout.count() > 0)
+            {
+                m_timer_id = timer_service::get_default().schedule(timeout, [weak_deadline, timeout]()
+                {
+                    auto deadline = weak_deadline.lock();
+                    if (deadline)
+                    {
+                        deadline->expire(std::make_exception_ptr(signalr_exception(std::string("the invocation timed out after ")
+                            .append(std::to_string(timeout.count()))
+                            .append(" ms"))), false);
+                    }
+                });
+                m_timer_scheduled = true;
+            }
+        }
+
+        if (!m_cancellation_token.is_cancelable())
+        {
+            return;
+        }
+
+        // registered without holding the lock since the callback runs right away if the token is already canceled
+        auto registration = m_cancellation_token.register_callback([weak_deadline]()
+        {
+            auto deadline = weak_deadline.lock();
+            if (deadline)
+            {
+                deadline->expire(std::make_exception_ptr(pplx::task_canceled("the invocation was canceled")), true);
+            }
+        });
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_done)
+            {
+                m_registration = registration;
+                m_registered = true;
+                return;
+            }
+        }
+
+        // the invocation completed or expired in the meantime
+        m_cancellation_token.deregister_callback(registration);
+    }
+
+    void invocation_deadline::disarm()
+    {
+        bool cancel_timer;
+        bool deregister;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_done = true;
+            m_expire = nullptr;
+            cancel_timer = m_timer_scheduled;
+            deregister = m_registered;
+            m_timer_scheduled = false;
+            m_registered = false;
+        }
+
+        if (cancel_timer)
+        {
+            timer_service::get_default().cancel(m_timer_id);
+        }
+
+        // not done while holding the lock since deregistering waits for a callback running on another thread
+        if (deregister)
+        {
+            m_cancellation_token.deregister_callback(m_registration);
+        }
+    }
+
+    void invocation_deadline::expire(const std::exception_ptr& error, bool canceled)
+    {
+        std::function<void(const std::exception_ptr&)> expire;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_done)
+            {
+                return;
+            }
+
+            m_done = true;
+            expire.swap(m_expire);
+
+            // a token callback must not deregister itself and a fired timer does not need to be cancelled
+            if (canceled)
+            {
+                m_registered = false;
+            }
+            else
+            {
+                m_timer_scheduled = false;
+            }
+        }
+
+        expire(error);
+        disarm();
+    }
+}
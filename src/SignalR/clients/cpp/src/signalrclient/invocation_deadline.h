@@ -0,0 +1,52 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "pplx/pplxtasks.h"
+#include "timer_service.h"
+
+namespace signalr
+{
+    // Expires a pending invocation when its timeout elapses or its cancellation token is canceled, whichever comes
+    // first. Timeouts are served by the shared timer service so pending invocations do not occupy any thread. The
+    // deadline is disarmed when the invocation completes, which stops the timer and deregisters from the token.
+    class invocation_deadline : public std::enable_shared_from_this<invocation_deadline>
+    {
+    public:
+        // a timeout of 0 means no timeout. Returns nullptr if there is neither a timeout nor a cancelable token.
+        static std::shared_ptr<invocation_deadline> create(std::chrono::milliseconds timeout,
+            const pplx::cancellation_token& cancellation_token);
+
+        invocation_deadline(const invocation_deadline&) = delete;
+        invocation_deadline& operator=(const invocation_deadline&) = delete;
+
+        ~invocation_deadline();
+
+        // starts the timer and registers with the token. `expire` is invoked at most once, with the error the
+        // invocation should fail with, on the timer thread or the thread canceling the token. If the token has already
+        // been canceled `expire` is invoked before this returns.
+        void arm(const std::function<void(const std::exception_ptr&)>& expire);
+
+        void disarm();
+
+    private:
+        invocation_deadline(std::chrono::milliseconds timeout, const pplx::cancellation_token& cancellation_token);
+
+        const std::chrono::milliseconds m_timeout;
+        const pplx::cancellation_token m_cancellation_token;
+        std::function<void(const std::exception_ptr&)> m_expire;
+        bool m_done;
+        bool m_timer_scheduled;
+        timer_service::timer_id m_timer_id;
+        bool m_registered;
+        pplx::cancellation_token_registration m_registration;
+        std::mutex m_lock;
+
+        void expire(const std::exception_ptr& error, bool canceled);
+    };
+}
@@ -0,0 +1,219 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "invocation_limiter.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    std::shared_ptr<invocation_limiter> invocation_limiter::create(size_t max_outstanding, invocation_admission_policy policy,
+        size_t max_queued)
+    {
+        return std::shared_ptr<invocation_limiter>(new invocation_limiter(max_outstanding, policy, max_queued));
+    }
+
+    invocation_limiter::invocation_limiter(size_t max_outstanding, invocation_admission_policy policy, size_t max_queued)
+        : m_max_outstanding(max_outstanding), m_policy(policy), m_max_queued(max_queued), m_outstanding(0), m_queued(0),
+        m_next_ticket(1)
+    { }
+
+    uint64_t invocation_limiter::admit(admitted_callback admitted)
+    {
+        if (m_max_outstanding == 0)
+        {
+            m_outstanding.fetch_add(1, std::memory_order_relaxed);
+            admitted(std::shared_ptr<admission>(new admission(shared_from_this())), std::string());
+            return 0;
+        }
+
+        std::shared_ptr<admission> new_admission;
+        std::string shed_invocation_id;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            // invocations already waiting are admitted first
+            if (m_pending.empty())
+            {
+                new_admission = try_admit(shed_invocation_id);
+            }
+
+            if (!new_admission)
+            {
+                if (m_policy == invocation_admission_policy::reject)
+                {
+                    throw signalr_exception(std::string("the maximum number of outstanding invocations (")
+                        .append(std::to_string(m_max_outstanding))
+                        .append(") has been reached"));
+                }
+
+                if (m_pending.size() >= m_max_queued)
+                {
+                    throw signalr_exception(std::string("the maximum number of queued invocations (")
+                        .append(std::to_string(m_max_queued))
+                        .append(") has been reached"));
+                }
+
+                const auto ticket = m_next_ticket++;
+                m_pending.push_back(std::make_pair(ticket, std::move(admitted)));
+                m_queued.store(m_pending.size(), std::memory_order_relaxed);
+                return ticket;
+            }
+        }
+
+        admitted(new_admission, shed_invocation_id);
+        return 0;
+    }
+
+    bool invocation_limiter::withdraw(uint64_t ticket)
+    {
+        admitted_callback withdrawn;
+        bool found = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            for (auto pending = m_pending.begin(); pending != m_pending.end(); ++pending)
+            {
+                if (pending->first == ticket)
+                {
+                    withdrawn = std::move(pending->second);
+                    m_pending.erase(pending);
+                    m_queued.store(m_pending.size(), std::memory_order_relaxed);
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        // the callback is destroyed without holding the lock since it may own the last reference to the invocation
+        return found;
+    }
+
+    size_t invocation_limiter::outstanding() const noexcept
+    {
+        return m_outstanding.load(std::memory_order_relaxed);
+    }
+
+    size_t invocation_limiter::queued() const noexcept
+    {
+        return m_queued.load(std::memory_order_relaxed);
+    }
+
+    // must be called with the lock held. Returns nullptr if the limit has been reached and no invocation can be shed.
+    std::shared_ptr<invocation_limiter::admission> invocation_limiter::try_admit(std::string& shed_invocation_id)
+    {
+        // invocations that are still being registered cannot be shed so shedding may have to wait for them as well
+        if (m_admissions.size() >= m_max_outstanding &&
+            !(m_policy == invocation_admission_policy::shed_oldest && try_shed_oldest(shed_invocation_id)))
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<admission> new_admission(new admission(shared_from_this()));
+        new_admission->m_position = m_admissions.insert(m_admissions.end(), new_admission.get());
+        new_admission->m_linked = true;
+        m_outstanding.store(m_admissions.size(), std::memory_order_relaxed);
+
+        return new_admission;
+    }
+
+    // must be called with the lock held
+    bool invocation_limiter::try_shed_oldest(std::string& shed_invocation_id)
+    {
+        for (auto position = m_admissions.begin(); position != m_admissions.end(); ++position)
+        {
+            auto& oldest = **position;
+            if (!oldest.m_invocation_id.empty())
+            {
+                shed_invocation_id = oldest.m_invocation_id;
+                oldest.m_linked = false;
+                m_admissions.erase(position);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // the callbacks are invoked without holding the lock since they register and send the invocation
+    void invocation_limiter::admit_pending()
+    {
+        for (;;)
+        {
+            admitted_callback admitted;
+            std::shared_ptr<admission> new_admission;
+            std::string shed_invocation_id;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_pending.empty())
+                {
+                    return;
+                }
+
+                new_admission = try_admit(shed_invocation_id);
+                if (!new_admission)
+                {
+                    return;
+                }
+
+                admitted = std::move(m_pending.front().second);
+                m_pending.pop_front();
+                m_queued.store(m_pending.size(), std::memory_order_relaxed);
+            }
+
+            admitted(new_admission, shed_invocation_id);
+        }
+    }
+
+    void invocation_limiter::release(admission& admission)
+    {
+        if (m_max_outstanding == 0)
+        {
+            m_outstanding.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!admission.m_linked)
+            {
+                // the invocation has been shed and no longer counts
+                return;
+            }
+
+            admission.m_linked = false;
+            m_admissions.erase(admission.m_position);
+            m_outstanding.store(m_admissions.size(), std::memory_order_relaxed);
+        }
+
+        admit_pending();
+    }
+
+    invocation_limiter::admission::admission(const std::shared_ptr<invocation_limiter>& limiter)
+        : m_limiter(limiter), m_linked(false)
+    { }
+
+    invocation_limiter::admission::~admission()
+    {
+        m_limiter->release(*this);
+    }
+
+    void invocation_limiter::admission::set_invocation_id(const std::string& invocation_id)
+    {
+        if (m_limiter->m_max_outstanding == 0)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_limiter->m_lock);
+            m_invocation_id = invocation_id;
+        }
+
+        // invocations waiting to shed an invocation may be able to shed this one now
+        if (m_limiter->m_policy == invocation_admission_policy::shed_oldest)
+        {
+            m_limiter->admit_pending();
+        }
+    }
+}
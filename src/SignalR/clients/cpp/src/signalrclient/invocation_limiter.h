@@ -0,0 +1,93 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "signalrclient/invocation_admission_policy.h"
+
+namespace signalr
+{
+    // Bounds the number of outstanding invocations of a hub connection. Every invocation holds an admission until its
+    // callback is released, whichever way it completes. Without a limit only the number of admissions is counted, which
+    // takes no lock.
+    class invocation_limiter : public std::enable_shared_from_this<invocation_limiter>
+    {
+    public:
+        class admission
+        {
+        public:
+            ~admission();
+
+            admission(const admission&) = delete;
+            admission& operator=(const admission&) = delete;
+
+            // called once the invocation has been registered, makes it a candidate for being shed
+            void set_invocation_id(const std::string& invocation_id);
+
+        private:
+            friend class invocation_limiter;
+
+            explicit admission(const std::shared_ptr<invocation_limiter>& limiter);
+
+            const std::shared_ptr<invocation_limiter> m_limiter;
+            std::string m_invocation_id;
+            // set while the admission is counted against the limit, guarded by the lock of the limiter
+            bool m_linked;
+            std::list<admission*>::iterator m_position;
+        };
+
+        // invoked with the new admission and the id of the invocation shed to make room for it, which the callee has to
+        // fail. The id is empty unless an invocation was shed.
+        typedef std::function<void(const std::shared_ptr<admission>&, const std::string& shed_invocation_id)> admitted_callback;
+
+        // a max_outstanding of 0 means no limit, max_queued limits the invocations waiting to be admitted
+        static std::shared_ptr<invocation_limiter> create(size_t max_outstanding, invocation_admission_policy policy,
+            size_t max_queued);
+
+        invocation_limiter(const invocation_limiter&) = delete;
+        invocation_limiter& operator=(const invocation_limiter&) = delete;
+
+        // Invokes `admitted` on the calling thread if the limit has not been reached. Otherwise throws a
+        // `signalr_exception` if the policy is `reject` and sheds the oldest outstanding invocation if it is
+        // `shed_oldest`. With `wait`, or with `shed_oldest` while all outstanding invocations are still being
+        // registered, `admitted` is queued and invoked in order on the thread releasing an admission or registering
+        // an invocation. The caller is never blocked. Throws a `signalr_exception` if max_queued invocations are
+        // already queued. Returns 0 if `admitted` has been invoked, otherwise the ticket of the queued invocation.
+        uint64_t admit(admitted_callback admitted);
+
+        // removes a queued invocation, e.g. because it timed out or was canceled. Returns false if it has already been
+        // admitted.
+        bool withdraw(uint64_t ticket);
+
+        size_t outstanding() const noexcept;
+        size_t queued() const noexcept;
+
+    private:
+        invocation_limiter(size_t max_outstanding, invocation_admission_policy policy, size_t max_queued);
+
+        const size_t m_max_outstanding;
+        const invocation_admission_policy m_policy;
+        const size_t m_max_queued;
+        std::atomic<size_t> m_outstanding;
+        std::atomic<size_t> m_queued;
+        // admissions counted against the limit, oldest first
+        std::list<admission*> m_admissions;
+        // invocations waiting to be admitted and their tickets, oldest first
+        std::deque<std::pair<uint64_t, admitted_callback>> m_pending;
+        uint64_t m_next_ticket;
+        std::mutex m_lock;
+
+        std::shared_ptr<admission> try_admit(std::string& shed_invocation_id);
+        bool try_shed_oldest(std::string& shed_invocation_id);
+        void admit_pending();
+        void release(admission& admission);
+    };
+}
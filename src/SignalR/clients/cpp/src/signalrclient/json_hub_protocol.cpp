@@ -0,0 +1,332 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <cstring>
+#include "json_hub_protocol.h"
+#include "json_reader.h"
+#include "make_unique.h"
+#include "signalrclient/serializer.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        const char record_separator = '\x1e';
+
+        template<size_t N>
+        bool field_is(const json_reader::field& field, const char (&name)[N])
+        {
+            return field.name_equals(name, N - 1);
+        }
+
+        // non-string values are returned in their serialized form
+        std::string read_string(const json_reader::field& field)
+        {
+            return field.kind == json_reader::value_kind::string
+                ? json_reader::read_string(field.value, field.value_length)
+                : std::string(field.value, field.value_length);
+        }
+
+        int read_integer(const json_reader::field& field)
+        {
+            if (field.kind != json_reader::value_kind::number)
+            {
+                throw signalr_exception("field 'type' is not a number");
+            }
+
+            auto position = field.value;
+            const auto end = field.value + field.value_length;
+            const auto negative = *position == '-';
+            if (negative)
+            {
+                ++position;
+            }
+
+            int value = 0;
+            for (; position < end && *position >= '0' && *position <= '9'; ++position)
+            {
+                // large values only need to be recognized as unknown message types so they saturate instead of overflowing
+                if (value < 100000000)
+                {
+                    value = value * 10 + (*position - '0');
+                }
+            }
+
+            if (position != end)
+            {
+                throw signalr_exception("field 'type' is not an integer");
+            }
+
+            return negative ? -value : value;
+        }
+
+        lazy_json_value read_value(const json_reader::field& field)
+        {
+            return lazy_json_value::from_text(std::string(field.value, field.value_length));
+        }
+
+        void write_serialized(argument_writer& writer, const lazy_json_value& value)
+        {
+            const auto& json = value.serialized();
+            writer.write_raw(json.data(), json.size());
+        }
+
+        // since arguments are the first field only the invocation id has to be written between the arguments and the
+        // cached remainder of the message
+        class json_invocation_writer : public invocation_writer
+        {
+        public:
+            explicit json_invocation_writer(const std::string& target)
+            {
+                argument_writer writer(m_suffix);
+                writer.begin_object();
+                writer.write_name("target");
+                writer.write_string(target);
+                writer.write_name("type");
+                writer.write_int64(static_cast<int>(message_type::invocation));
+                writer.end_object();
+                m_suffix.push_back(record_separator);
+                // drop the opening brace, the suffix continues the object started with the arguments
+                m_suffix[0] = ',';
+            }
+
+            std::string write(const std::string& invocation_id, const std::string& arguments) const override
+            {
+                static const std::string prefix = "{\"arguments\":";
+                static const std::string invocation_id_prefix = ",\"invocationId\":";
+
+                std::string payload;
+                payload.reserve(prefix.size() + arguments.size() + invocation_id_prefix.size() + invocation_id.size() + 2
+                    + m_suffix.size());
+                payload.append(prefix).append(arguments);
+                if (!invocation_id.empty())
+                {
+                    payload.append(invocation_id_prefix);
+                    // callback ids are numbers so they never need to be escaped
+                    payload.push_back('"');
+                    payload.append(invocation_id);
+                    payload.push_back('"');
+                }
+                payload.append(m_suffix);
+                return payload;
+            }
+
+        private:
+            std::string m_suffix;
+        };
+    }
+
+    std::string json_hub_protocol::write_message(const hub_message& message) const
+    {
+        // fields are written in alphabetical order. Arguments, items and results are appended as serialized so that
+        // arguments written by the typed hub_connection overloads are never turned into a web::json::value.
+        std::string payload;
+        argument_writer writer(payload);
+        writer.begin_object();
+
+        switch (message.message_type)
+        {
+        case message_type::invocation:
+        case message_type::stream_invocation:
+        {
+            const auto& invocation = static_cast<const hub_invocation_message&>(message);
+            writer.write_name("arguments");
+            write_serialized(writer, invocation.arguments);
+            if (!invocation.invocation_id.empty())
+            {
+                writer.write_name("invocationId");
+                writer.write_string(invocation.invocation_id);
+            }
+            if (!invocation.stream_ids.empty())
+            {
+                writer.write_name("streamIds");
+                writer.begin_array();
+                for (const auto& stream_id : invocation.stream_ids)
+                {
+                    writer.write_string(stream_id);
+                }
+                writer.end_array();
+            }
+            writer.write_name("target");
+            writer.write_string(invocation.target);
+            break;
+        }
+        case message_type::stream_item:
+        {
+            const auto& stream_item = static_cast<const stream_item_message&>(message);
+            writer.write_name("invocationId");
+            writer.write_string(stream_item.invocation_id);
+            writer.write_name("item");
+            write_serialized(writer, stream_item.item);
+            break;
+        }
+        case message_type::completion:
+        {
+            const auto& completion = static_cast<const completion_message&>(message);
+            if (!completion.error.empty())
+            {
+                writer.write_name("error");
+                writer.write_string(completion.error);
+            }
+            writer.write_name("invocationId");
+            writer.write_string(completion.invocation_id);
+            if (completion.error.empty() && completion.has_result)
+            {
+                writer.write_name("result");
+                write_serialized(writer, completion.result);
+            }
+            break;
+        }
+        case message_type::cancel_invocation:
+        {
+            const auto& cancel_invocation = static_cast<const cancel_invocation_message&>(message);
+            writer.write_name("invocationId");
+            writer.write_string(cancel_invocation.invocation_id);
+            break;
+        }
+        case message_type::ping:
+            break;
+        case message_type::close:
+        {
+            const auto& close = static_cast<const close_message&>(message);
+            if (close.allow_reconnect)
+            {
+                writer.write_name("allowReconnect");
+                writer.write_bool(true);
+            }
+            if (!close.error.empty())
+            {
+                writer.write_name("error");
+                writer.write_string(close.error);
+            }
+            break;
+        }
+        }
+
+        writer.write_name("type");
+        writer.write_int64(static_cast<int>(message.message_type));
+        writer.end_object();
+
+        payload.push_back(record_separator);
+        return payload;
+    }
+
+    std::unique_ptr<invocation_writer> json_hub_protocol::create_invocation_writer(const std::string& target) const
+    {
+        return std::make_unique<json_invocation_writer>(target);
+    }
+
+    bool json_hub_protocol::try_read_frame(const char* data, size_t length, message_frame& frame) const
+    {
+        const auto separator = static_cast<const char*>(std::memchr(data, record_separator, length));
+        if (separator == nullptr)
+        {
+            return false;
+        }
+
+        frame.message_offset = 0;
+        frame.message_length = separator - data;
+        frame.frame_length = frame.message_length + 1;
+        return true;
+    }
+
+    std::unique_ptr<hub_message> json_hub_protocol::parse_message(const char* data, size_t length) const
+    {
+        // only the envelope is read here, the arguments, item and result are kept as text until they are used
+        json_reader reader(data, length);
+
+        bool has_type = false;
+        int type = 0;
+        std::string invocation_id;
+        std::string target;
+        std::string error;
+        bool allow_reconnect = false;
+        bool has_value = false;
+        json_reader::field value;
+        json_reader::field field;
+
+        while (reader.read_field(field))
+        {
+            if (field_is(field, "type"))
+            {
+                type = read_integer(field);
+                has_type = true;
+            }
+            else if (field_is(field, "invocationId"))
+            {
+                invocation_id = read_string(field);
+            }
+            else if (field_is(field, "target"))
+            {
+                target = read_string(field);
+            }
+            else if (field_is(field, "error"))
+            {
+                error = read_string(field);
+            }
+            else if (field_is(field, "allowReconnect"))
+            {
+                allow_reconnect = field.kind == json_reader::value_kind::literal && field.value[0] == 't';
+            }
+            else if (field_is(field, "arguments") || field_is(field, "item") || field_is(field, "result"))
+            {
+                // a message only has one of these depending on its type
+                value = field;
+                has_value = true;
+            }
+        }
+
+        if (!has_type)
+        {
+            throw signalr_exception("field 'type' not found");
+        }
+
+        switch (static_cast<message_type>(type))
+        {
+        case message_type::invocation:
+            return std::make_unique<hub_invocation_message>(invocation_id, target,
+                has_value && field_is(value, "arguments") ? read_value(value) : web::json::value::array());
+        case message_type::stream_item:
+            return std::make_unique<stream_item_message>(invocation_id,
+                has_value && field_is(value, "item") ? read_value(value) : web::json::value::null());
+        case message_type::completion:
+        {
+            const auto has_result = has_value && field_is(value, "result");
+            return std::make_unique<completion_message>(invocation_id, error,
+                has_result ? read_value(value) : web::json::value::null(), has_result);
+        }
+        case message_type::stream_invocation:
+            // Sent to server only, should not be received by client
+            throw signalr_exception("Received unexpected message type 'StreamInvocation'.");
+        case message_type::cancel_invocation:
+            // Sent to server only, should not be received by client
+            throw signalr_exception("Received unexpected message type 'CancelInvocation'.");
+        case message_type::ping:
+            return std::make_unique<ping_message>();
+        case message_type::close:
+            return std::make_unique<close_message>(error, allow_reconnect);
+        default:
+            // future message types are ignored to stay compatible with newer servers
+            return nullptr;
+        }
+    }
+
+    const std::string& json_hub_protocol::name() const noexcept
+    {
+        static const std::string name{ "json" };
+        return name;
+    }
+
+    int json_hub_protocol::version() const noexcept
+    {
+        return 1;
+    }
+
+    signalr::transfer_format json_hub_protocol::transfer_format() const noexcept
+    {
+        return signalr::transfer_format::text;
+    }
+}
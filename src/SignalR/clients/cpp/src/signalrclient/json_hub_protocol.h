@@ -0,0 +1,22 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include "hub_protocol.h"
+
+namespace signalr
+{
+    class json_hub_protocol : public hub_protocol
+    {
+    public:
+        std::string write_message(const hub_message& message) const override;
+        std::unique_ptr<invocation_writer> create_invocation_writer(const std::string& target) const override;
+        bool try_read_frame(const char* data, size_t length, message_frame& frame) const override;
+        std::unique_ptr<hub_message> parse_message(const char* data, size_t length) const override;
+
+        const std::string& name() const noexcept override;
+        int version() const noexcept override;
+        signalr::transfer_format transfer_format() const noexcept override;
+    };
+}
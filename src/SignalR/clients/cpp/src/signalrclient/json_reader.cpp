@@ -0,0 +1,433 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <cstring>
+#include "json_reader.h"
+#include "signalrclient/signalr_exception.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIGNALR_JSON_READER_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        const char* find_quote_or_backslash(const char* position, const char* end) noexcept;
+        const char* find_structural(const char* position, const char* end) noexcept;
+        unsigned int read_hex(const char* position);
+        void append_utf8(std::string& result, unsigned int code_point);
+        [[noreturn]] void throw_malformed(const char* reason);
+    }
+
+    bool json_reader::field::name_equals(const char* expected, size_t expected_length) const
+    {
+        if (!name_escaped)
+        {
+            return name_length == expected_length && std::memcmp(name, expected, expected_length) == 0;
+        }
+
+        // escaped names are rare enough to not warrant avoiding the allocation
+        const auto unescaped = read_string(name - 1, name_length + 2);
+        return unescaped.size() == expected_length && std::memcmp(unescaped.data(), expected, expected_length) == 0;
+    }
+
+    json_reader::json_reader(const char* data, size_t length)
+        : m_position(data), m_end(data + length), m_first_field(true), m_finished(false)
+    {
+        skip_whitespace();
+        if (m_position == m_end || *m_position != '{')
+        {
+            throw signalr_exception(std::string("unexpected response received from the server: ").append(data, length));
+        }
+        ++m_position;
+    }
+
+    bool json_reader::read_field(field& field)
+    {
+        if (m_finished)
+        {
+            return false;
+        }
+
+        skip_whitespace();
+        if (m_position == m_end)
+        {
+            throw_malformed("unterminated object");
+        }
+
+        if (*m_position == '}')
+        {
+            if (!m_first_field)
+            {
+                throw_malformed("trailing comma");
+            }
+
+            ++m_position;
+            m_finished = true;
+            return false;
+        }
+
+        if (*m_position != '"')
+        {
+            throw_malformed("expected a field name");
+        }
+
+        const auto name_end = skip_string(m_position, m_end);
+        field.name = m_position + 1;
+        field.name_length = name_end - m_position - 2;
+        field.name_escaped = std::memchr(field.name, '\\', field.name_length) != nullptr;
+        m_position = name_end;
+
+        skip_whitespace();
+        expect(':');
+        skip_whitespace();
+
+        field.value = m_position;
+        m_position = skip_value(m_position, m_end, field.kind);
+        field.value_length = m_position - field.value;
+
+        skip_whitespace();
+        if (m_position == m_end)
+        {
+            throw_malformed("unterminated object");
+        }
+
+        if (*m_position == '}')
+        {
+            ++m_position;
+            m_finished = true;
+        }
+        else
+        {
+            expect(',');
+        }
+
+        m_first_field = false;
+        return true;
+    }
+
+    std::string json_reader::read_string(const char* value, size_t length)
+    {
+        _ASSERTE(length >= 2 && value[0] == '"' && value[length - 1] == '"');
+
+        const auto end = value + length - 1;
+        auto position = value + 1;
+
+        std::string result;
+        result.reserve(end - position);
+
+        while (position < end)
+        {
+            const auto special = find_quote_or_backslash(position, end);
+            result.append(position, special);
+            if (special == end)
+            {
+                break;
+            }
+
+            // the closing quote is not part of the range so this must be a backslash
+            if (special + 1 == end)
+            {
+                throw_malformed("incomplete escape sequence");
+            }
+
+            position = special + 2;
+            switch (special[1])
+            {
+            case '"': result.push_back('"'); break;
+            case '\\': result.push_back('\\'); break;
+            case '/': result.push_back('/'); break;
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'u':
+            {
+                if (end - position < 4)
+                {
+                    throw_malformed("incomplete escape sequence");
+                }
+
+                auto code_point = read_hex(position);
+                position += 4;
+
+                // characters outside of the basic multilingual plane are encoded as surrogate pairs
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && end - position >= 6 && position[0] == '\\' && position[1] == 'u')
+                {
+                    const auto low_surrogate = read_hex(position + 2);
+                    if (low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF)
+                    {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                        position += 6;
+                    }
+                }
+
+                append_utf8(result, code_point);
+                break;
+            }
+            default:
+                throw_malformed("invalid escape sequence");
+            }
+        }
+
+        return result;
+    }
+
+    void json_reader::skip_whitespace() noexcept
+    {
+        while (m_position < m_end && (*m_position == ' ' || *m_position == '\t' || *m_position == '\n' || *m_position == '\r'))
+        {
+            ++m_position;
+        }
+    }
+
+    void json_reader::expect(char c)
+    {
+        if (m_position == m_end || *m_position != c)
+        {
+            throw_malformed(c == ':' ? "expected ':'" : "expected ',' or '}'");
+        }
+        ++m_position;
+    }
+
+    const char* json_reader::skip_value(const char* position, const char* end, value_kind& kind)
+    {
+        if (position == end)
+        {
+            throw_malformed("expected a value");
+        }
+
+        switch (*position)
+        {
+        case '"':
+            kind = value_kind::string;
+            return skip_string(position, end);
+        case '{':
+            kind = value_kind::object;
+            return skip_container(position, end);
+        case '[':
+            kind = value_kind::array;
+            return skip_container(position, end);
+        default:
+            break;
+        }
+
+        kind = (*position == '-' || (*position >= '0' && *position <= '9')) ? value_kind::number : value_kind::literal;
+
+        const auto start = position;
+        while (position < end && *position != ',' && *position != '}' && *position != ']' && *position != ' '
+            && *position != '\t' && *position != '\n' && *position != '\r')
+        {
+            ++position;
+        }
+
+        if (kind == value_kind::literal)
+        {
+            const auto length = static_cast<size_t>(position - start);
+            if (!(length == 4 && (std::memcmp(start, "true", 4) == 0 || std::memcmp(start, "null", 4) == 0))
+                && !(length == 5 && std::memcmp(start, "false", 5) == 0))
+            {
+                throw_malformed("unexpected value");
+            }
+        }
+
+        return position;
+    }
+
+    // returns the position after the closing quote of the string starting at `position`
+    const char* json_reader::skip_string(const char* position, const char* end)
+    {
+        ++position;
+        for (;;)
+        {
+            position = find_quote_or_backslash(position, end);
+            if (position == end)
+            {
+                throw_malformed("unterminated string");
+            }
+
+            if (*position == '"')
+            {
+                return position + 1;
+            }
+
+            // skip the escaped character which may be a quote
+            if (end - position < 2)
+            {
+                throw_malformed("unterminated string");
+            }
+            position += 2;
+        }
+    }
+
+    // returns the position after the bracket closing the object or array starting at `position`
+    const char* json_reader::skip_container(const char* position, const char* end)
+    {
+        size_t depth = 0;
+        for (;;)
+        {
+            position = find_structural(position, end);
+            if (position == end)
+            {
+                throw_malformed("unterminated object or array");
+            }
+
+            switch (*position)
+            {
+            case '"':
+                position = skip_string(position, end);
+                continue;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            default:
+                // whether the brackets match is checked when the value is parsed
+                if (--depth == 0)
+                {
+                    return position + 1;
+                }
+                break;
+            }
+            ++position;
+        }
+    }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+#ifdef SIGNALR_JSON_READER_SSE2
+        unsigned int count_trailing_zeros(unsigned int mask) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+#endif
+
+        const char* find_quote_or_backslash(const char* position, const char* end) noexcept
+        {
+#ifdef SIGNALR_JSON_READER_SSE2
+            const auto quotes = _mm_set1_epi8('"');
+            const auto backslashes = _mm_set1_epi8('\\');
+            while (end - position >= 16)
+            {
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+                const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslashes))));
+                if (mask != 0)
+                {
+                    return position + count_trailing_zeros(mask);
+                }
+                position += 16;
+            }
+#endif
+            while (position < end && *position != '"' && *position != '\\')
+            {
+                ++position;
+            }
+            return position;
+        }
+
+        // finds the next quote or bracket. Everything else is irrelevant for finding the end of an object or array.
+        const char* find_structural(const char* position, const char* end) noexcept
+        {
+#ifdef SIGNALR_JSON_READER_SSE2
+            const auto quotes = _mm_set1_epi8('"');
+            // '{' and '}' only differ from '[' and ']' in bit 0x20 so setting it covers both kinds of brackets
+            const auto bracket_case = _mm_set1_epi8(0x20);
+            const auto open_braces = _mm_set1_epi8('{');
+            const auto close_braces = _mm_set1_epi8('}');
+            while (end - position >= 16)
+            {
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+                const auto folded = _mm_or_si128(chunk, bracket_case);
+                const auto matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes),
+                    _mm_or_si128(_mm_cmpeq_epi8(folded, open_braces), _mm_cmpeq_epi8(folded, close_braces)));
+                const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(matches));
+                if (mask != 0)
+                {
+                    return position + count_trailing_zeros(mask);
+                }
+                position += 16;
+            }
+#endif
+            while (position < end && *position != '"' && *position != '{' && *position != '}' && *position != '['
+                && *position != ']')
+            {
+                ++position;
+            }
+            return position;
+        }
+
+        unsigned int read_hex(const char* position)
+        {
+            unsigned int value = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                const auto c = position[i];
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    value |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    value |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    value |= c - 'A' + 10;
+                }
+                else
+                {
+                    throw_malformed("invalid escape sequence");
+                }
+            }
+            return value;
+        }
+
+        void append_utf8(std::string& result, unsigned int code_point)
+        {
+            if (code_point < 0x80)
+            {
+                result.push_back(static_cast<char>(code_point));
+            }
+            else if (code_point < 0x800)
+            {
+                result.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+            else if (code_point < 0x10000)
+            {
+                result.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                result.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+            else
+            {
+                result.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                result.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+        }
+
+        void throw_malformed(const char* reason)
+        {
+            throw signalr_exception(std::string("malformed json: ").append(reason));
+        }
+    }
+}
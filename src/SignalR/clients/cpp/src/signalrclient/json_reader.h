@@ -0,0 +1,66 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+
+namespace signalr
+{
+    // Reads the top level fields of a json object on demand without building a DOM. Nested objects and arrays are
+    // skipped by scanning for structural characters (16 bytes at a time where SSE2 is available) and are returned as
+    // raw text so that the caller decides whether they need to be parsed at all. The reader only validates what it
+    // needs to find the field boundaries - skipped values are validated when they are parsed.
+    class json_reader
+    {
+    public:
+        enum class value_kind
+        {
+            string,
+            number,
+            object,
+            array,
+            literal
+        };
+
+        struct field
+        {
+            // name without the quotes, may contain escape sequences if `name_escaped` is set
+            const char* name;
+            size_t name_length;
+            bool name_escaped;
+
+            // raw text of the value, strings include the quotes
+            const char* value;
+            size_t value_length;
+            value_kind kind;
+
+            bool name_equals(const char* expected, size_t expected_length) const;
+        };
+
+        // throws signalr_exception if the data does not start with a json object
+        json_reader(const char* data, size_t length);
+
+        // reads the next top level field. Returns false after the last field. Throws signalr_exception if the
+        // object is malformed.
+        bool read_field(field& field);
+
+        // decodes a quoted json string including escape sequences to utf8
+        static std::string read_string(const char* value, size_t length);
+
+        // returns the position after the value starting at `position`. Nested values are not validated.
+        static const char* skip_value(const char* position, const char* end, value_kind& kind);
+
+    private:
+        const char* m_position;
+        const char* const m_end;
+        bool m_first_field;
+        bool m_finished;
+
+        void skip_whitespace() noexcept;
+        void expect(char c);
+
+        static const char* skip_string(const char* position, const char* end);
+        static const char* skip_container(const char* position, const char* end);
+    };
+}
@@ -0,0 +1,79 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+#include "cpprest/json.h"
+
+namespace signalr
+{
+    // A json value that may still be in its serialized form. The json hub protocol keeps the arguments, stream items
+    // and results of received messages as text and they are only parsed when they are read, so messages nobody
+    // handles are never turned into a DOM. Not thread safe - a received message is only used by the thread that
+    // processes it.
+    class lazy_json_value
+    {
+    public:
+        lazy_json_value(const web::json::value& value)
+            : m_value(value), m_parsed(true)
+        { }
+
+        lazy_json_value(web::json::value&& value)
+            : m_value(std::move(value)), m_parsed(true)
+        { }
+
+        // `text` must be utf8 encoded json. It is not validated until the value is read.
+        static lazy_json_value from_text(std::string text)
+        {
+            lazy_json_value value{ web::json::value::null() };
+            value.m_text = std::move(text);
+            value.m_parsed = false;
+            return value;
+        }
+
+        // parses the value on first use. Throws if the text is not valid json.
+        const web::json::value& get() const
+        {
+            if (!m_parsed)
+            {
+                m_value = web::json::value::parse(utility::conversions::to_string_t(m_text));
+                m_parsed = true;
+                std::string().swap(m_text);
+            }
+
+            return m_value;
+        }
+
+        // returns the value as utf8 encoded json without parsing it if it has not been parsed yet
+        const std::string& serialized() const
+        {
+            if (m_parsed && m_text.empty())
+            {
+                m_text = utility::conversions::to_utf8string(m_value.serialize());
+            }
+
+            return m_text;
+        }
+
+        // moves the value out, leaving null behind
+        web::json::value release()
+        {
+            get();
+            auto value = std::move(m_value);
+            m_value = web::json::value::null();
+            std::string().swap(m_text);
+            return value;
+        }
+
+        bool is_parsed() const noexcept
+        {
+            return m_parsed;
+        }
+
+    private:
+        mutable web::json::value m_value;
+        mutable std::string m_text;
+        mutable bool m_parsed;
+    };
+}
@@ -35,6 +35,11 @@ namespace signalr
         }
     }
 
+    bool logger::is_enabled(trace_level level) const noexcept
+    {
+        return (level & m_trace_level) != trace_level::none;
+    }
+
     std::string logger::translate_trace_level(trace_level trace_level)
     {
         switch (trace_level)
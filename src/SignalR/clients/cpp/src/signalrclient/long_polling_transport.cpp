@@ -0,0 +1,286 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "long_polling_transport.h"
+#include "constants.h"
+#include "signalrclient/signalr_exception.h"
+#include "signalrclient/web_exception.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        // the server completes a poll without messages after 90 seconds
+        static const std::chrono::seconds poll_timeout(100);
+
+        static pplx::task<std::string> get_response_body(web_request& request);
+    }
+
+    std::shared_ptr<transport> long_polling_transport::create(std::unique_ptr<web_request_factory> web_request_factory,
+        const signalr_client_config& signalr_client_config, const logger& logger,
+        const std::function<void(const message_buffer&)>& process_response_callback,
+        std::function<void(const std::exception&)> error_callback)
+    {
+        return std::shared_ptr<transport>(new long_polling_transport(std::move(web_request_factory), signalr_client_config,
+            logger, process_response_callback, error_callback));
+    }
+
+    long_polling_transport::long_polling_transport(std::unique_ptr<web_request_factory> web_request_factory,
+        const signalr_client_config& signalr_client_config, const logger& logger,
+        const std::function<void(const message_buffer&)>& process_response_callback,
+        std::function<void(const std::exception&)> error_callback)
+        : transport(logger, process_response_callback, error_callback), m_web_request_factory(std::move(web_request_factory)),
+        m_signalr_client_config(signalr_client_config), m_process_responses_task(pplx::task_from_result())
+    {
+        // we use this cts to check if the transport is polling so it should be
+        // initially cancelled to indicate that the transport is not polling
+        m_poll_cts.cancel();
+    }
+
+    long_polling_transport::~long_polling_transport()
+    {
+        try
+        {
+            disconnect().get();
+        }
+        catch (...) // must not throw from the destructor
+        {}
+    }
+
+    transport_type long_polling_transport::get_transport_type() const noexcept
+    {
+        return transport_type::long_polling;
+    }
+
+    pplx::task<void> long_polling_transport::connect(const std::string& url)
+    {
+        std::lock_guard<std::mutex> stop_lock(m_start_stop_lock);
+
+        if (!m_poll_cts.get_token().is_canceled())
+        {
+            throw signalr_exception("transport already connected");
+        }
+
+        m_logger.log(trace_level::info,
+            std::string("[long polling transport] connecting to: ")
+            .append(url));
+
+        auto poll_config = m_signalr_client_config;
+        auto http_client_config = poll_config.get_http_client_config();
+        if (std::chrono::duration_cast<std::chrono::seconds>(http_client_config.timeout()) < poll_timeout)
+        {
+            http_client_config.set_timeout(poll_timeout);
+            poll_config.set_http_client_config(http_client_config);
+        }
+
+        m_url = url;
+        m_http_client = http_client_pool::get_default().get_client(url, poll_config);
+        m_sender = batching_sender::create(m_web_request_factory, url, m_signalr_client_config, m_http_client);
+
+        pplx::cancellation_token_source poll_cts;
+        pplx::task_completion_event<void> connect_tce;
+
+        auto transport = shared_from_this();
+
+        // the server completes the first poll immediately which confirms that the connection can be used
+        get_response_body(*create_request(web::http::methods::GET, url))
+            .then([transport, connect_tce, poll_cts](pplx::task<std::string> connect_task)
+            {
+                try
+                {
+                    auto response = connect_task.get();
+                    if (!response.empty())
+                    {
+                        transport->queue_response(message_buffer(std::move(response)));
+                    }
+
+                    transport->poll(poll_cts);
+                    connect_tce.set();
+                }
+                catch (const std::exception &e)
+                {
+                    transport->m_logger.log(
+                        trace_level::errors,
+                        std::string("[long polling transport] exception when connecting to the server: ")
+                        .append(e.what()));
+
+                    poll_cts.cancel();
+                    connect_tce.set_exception(std::current_exception());
+                }
+            });
+
+        m_poll_cts = poll_cts;
+
+        return pplx::create_task(connect_tce);
+    }
+
+    void long_polling_transport::poll(pplx::cancellation_token_source cts)
+    {
+        auto weak_transport = std::weak_ptr<long_polling_transport>(shared_from_this());
+        auto logger = m_logger;
+
+        get_response_body(*create_request(web::http::methods::GET, m_url))
+            .then([weak_transport, cts](std::string response)
+            {
+                auto transport = weak_transport.lock();
+                if (transport && !cts.get_token().is_canceled())
+                {
+                    // The response is queued before the next poll is started to keep the responses in order. It is
+                    // processed while the next poll is already waiting for messages from the server.
+                    if (!response.empty())
+                    {
+                        transport->queue_response(message_buffer(std::move(response)));
+                    }
+
+                    transport->poll(cts);
+                }
+            }, cts.get_token())
+            // this continuation is used to observe exceptions from the previous tasks. It runs even if the previous
+            // continuation was not scheduled due to the cancellation token being canceled
+            .then([weak_transport, logger, cts](pplx::task<void> poll_task)
+            mutable {
+                try
+                {
+                    poll_task.get();
+                }
+                catch (const pplx::task_canceled&)
+                {
+                    logger.log(trace_level::info,
+                        std::string("[long polling transport] poll task canceled."));
+                }
+                catch (const std::exception& e)
+                {
+                    if (cts.get_token().is_canceled())
+                    {
+                        // the poll was completed by the server because the transport was disconnected
+                        return;
+                    }
+
+                    cts.cancel();
+
+                    logger.log(
+                        trace_level::errors,
+                        std::string("[long polling transport] error polling the server: ")
+                        .append(e.what()));
+
+                    auto transport = weak_transport.lock();
+                    if (transport)
+                    {
+                        transport->error(e);
+                    }
+                }
+            });
+    }
+
+    void long_polling_transport::queue_response(const message_buffer& response)
+    {
+        auto weak_transport = std::weak_ptr<long_polling_transport>(shared_from_this());
+
+        m_process_responses_task = m_process_responses_task
+            .then([weak_transport, response](pplx::task<void>)
+            {
+                auto transport = weak_transport.lock();
+                if (transport)
+                {
+                    transport->process_response(response);
+                }
+            });
+    }
+
+    pplx::task<void> long_polling_transport::send(const std::string &data, transfer_format transfer_format)
+    {
+        std::shared_ptr<batching_sender> sender;
+        {
+            std::lock_guard<std::mutex> lock(m_start_stop_lock);
+            sender = m_sender;
+        }
+
+        if (!sender)
+        {
+            return pplx::task_from_exception<void>(signalr_exception("cannot send data when the transport is not connected"));
+        }
+
+        return sender->send(data, transfer_format);
+    }
+
+    pplx::task<void> long_polling_transport::disconnect()
+    {
+        std::string url;
+
+        {
+            std::lock_guard<std::mutex> lock(m_start_stop_lock);
+
+            if (m_poll_cts.get_token().is_canceled())
+            {
+                return pplx::task_from_result();
+            }
+
+            m_poll_cts.cancel();
+            url = m_url;
+            m_sender->cancel_pending();
+        }
+
+        auto logger = m_logger;
+
+        // the server completes the outstanding poll when it receives the DELETE request
+        return create_request(web::http::methods::DEL, url)->get_response()
+            .then([logger](pplx::task<web_response> delete_task)
+            mutable {
+                try
+                {
+                    // depending on the version the server responds with 200, 202 or 204
+                    const auto response = delete_task.get();
+                    if (response.status_code < 200 || response.status_code >= 300)
+                    {
+                        std::stringstream oss;
+                        oss << "web exception - " << response.status_code << " " << response.reason_phrase;
+                        throw web_exception(oss.str(), response.status_code);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    logger.log(
+                        trace_level::errors,
+                        std::string("[long polling transport] exception when stopping the connection: ")
+                        .append(e.what()));
+                }
+            });
+    }
+
+    std::unique_ptr<web_request> long_polling_transport::create_request(const web::http::method& method, const std::string& url)
+    {
+        auto request = m_web_request_factory->create_web_request(url);
+        request->set_method(utility::conversions::to_utf8string(method));
+        request->set_user_agent(USER_AGENT);
+        request->set_client_config(m_signalr_client_config);
+        request->set_http_client(m_http_client);
+        return request;
+    }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        static pplx::task<std::string> get_response_body(web_request& request)
+        {
+            return request.get_response().then([](web_response response)
+            {
+                // the server responds with 204 (No Content) to polls after it has closed the connection
+                if (response.status_code == 204)
+                {
+                    throw signalr_exception("the server closed the connection");
+                }
+
+                if (response.status_code != 200)
+                {
+                    std::stringstream oss;
+                    oss << "web exception - " << response.status_code << " " << response.reason_phrase;
+                    throw web_exception(oss.str(), response.status_code);
+                }
+
+                return response.body;
+            });
+        }
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <mutex>
+#include "cpprest/http_client.h"
+#include "signalrclient/signalr_client_config.h"
+#include "batching_sender.h"
+#include "transport.h"
+#include "logger.h"
+#include "web_request_factory.h"
+
+namespace signalr
+{
+    // Receives messages by polling the server with GET requests which the server completes when it has messages to send
+    // or when the poll times out. Messages are sent with POST requests. All requests are sent with a single http client
+    // so that the connection to the server is kept alive between requests.
+    class long_polling_transport : public transport, public std::enable_shared_from_this<long_polling_transport>
+    {
+    public:
+        static std::shared_ptr<transport> create(std::unique_ptr<web_request_factory> web_request_factory,
+            const signalr_client_config& signalr_client_config, const logger& logger,
+            const std::function<void(const message_buffer&)>& process_response_callback,
+            std::function<void(const std::exception&)> error_callback);
+
+        ~long_polling_transport();
+
+        long_polling_transport(const long_polling_transport&) = delete;
+
+        long_polling_transport& operator=(const long_polling_transport&) = delete;
+
+        pplx::task<void> connect(const std::string& url) override;
+
+        pplx::task<void> send(const std::string &data, transfer_format transfer_format) override;
+
+        pplx::task<void> disconnect() override;
+
+        transport_type get_transport_type() const noexcept override;
+
+    private:
+        long_polling_transport(std::unique_ptr<web_request_factory> web_request_factory,
+            const signalr_client_config& signalr_client_config, const logger& logger,
+            const std::function<void(const message_buffer&)>& process_response_callback,
+            std::function<void(const std::exception&)> error_callback);
+
+        // shared with the sender
+        std::shared_ptr<web_request_factory> m_web_request_factory;
+        signalr_client_config m_signalr_client_config;
+        std::shared_ptr<web::http::client::http_client> m_http_client;
+        std::string m_url;
+        std::mutex m_start_stop_lock;
+
+        pplx::cancellation_token_source m_poll_cts;
+        // responses are processed one after another in the order they were received
+        pplx::task<void> m_process_responses_task;
+
+        std::shared_ptr<batching_sender> m_sender;
+
+        std::unique_ptr<web_request> create_request(const web::http::method& method, const std::string& url);
+        void poll(pplx::cancellation_token_source cts);
+        void queue_response(const message_buffer& response);
+    };
+}
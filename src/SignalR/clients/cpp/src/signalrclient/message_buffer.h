@@ -0,0 +1,58 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace signalr
+{
+    // Reference counted, immutable data received from the server. Copying the buffer only copies the reference so the
+    // data is passed from the websocket client to the protocol parser - and can be kept by a consumer after the
+    // receive callback returned - without copying it. Converts to `const std::string&` so that callbacks taking
+    // strings can consume it as well.
+    class message_buffer
+    {
+    public:
+        message_buffer() = default;
+
+        explicit message_buffer(std::string&& data)
+            : m_data(std::make_shared<const std::string>(std::move(data)))
+        { }
+
+        // copies the data
+        explicit message_buffer(const std::string& data)
+            : m_data(std::make_shared<const std::string>(data))
+        { }
+
+        const char* data() const noexcept
+        {
+            return str().data();
+        }
+
+        size_t size() const noexcept
+        {
+            return str().size();
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        const std::string& str() const noexcept
+        {
+            static const std::string empty_data;
+            return m_data ? *m_data : empty_data;
+        }
+
+        operator const std::string&() const noexcept
+        {
+            return str();
+        }
+
+    private:
+        std::shared_ptr<const std::string> m_data;
+    };
+}
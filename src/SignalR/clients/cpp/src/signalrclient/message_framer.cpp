@@ -0,0 +1,82 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "message_framer.h"
+
+namespace signalr
+{
+    message_framer::message_framer()
+        : m_data(nullptr), m_length(0), m_position(0), m_buffered(false)
+    { }
+
+    void message_framer::begin(const char* data, size_t length)
+    {
+        // in the common case there is nothing buffered and messages are read directly from the received data
+        if (m_buffer.empty())
+        {
+            m_data = data;
+            m_length = length;
+            m_buffered = false;
+        }
+        else
+        {
+            m_buffer.append(data, length);
+            m_data = m_buffer.data();
+            m_length = m_buffer.size();
+            m_buffered = true;
+        }
+
+        m_position = 0;
+    }
+
+    bool message_framer::try_read_message(const hub_protocol& protocol, const char*& message, size_t& message_length)
+    {
+        if (m_position >= m_length)
+        {
+            return false;
+        }
+
+        message_frame frame;
+        if (!protocol.try_read_frame(m_data + m_position, m_length - m_position, frame))
+        {
+            return false;
+        }
+
+        message = m_data + m_position + frame.message_offset;
+        message_length = frame.message_length;
+        m_position += frame.frame_length;
+        return true;
+    }
+
+    void message_framer::end()
+    {
+        if (m_buffered)
+        {
+            m_buffer.erase(0, m_position);
+        }
+        else if (m_position < m_length)
+        {
+            m_buffer.assign(m_data + m_position, m_length - m_position);
+        }
+
+        m_data = nullptr;
+        m_length = 0;
+        m_position = 0;
+        m_buffered = false;
+    }
+
+    void message_framer::reset()
+    {
+        m_buffer.clear();
+        m_data = nullptr;
+        m_length = 0;
+        m_position = 0;
+        m_buffered = false;
+    }
+
+    size_t message_framer::buffered_size() const noexcept
+    {
+        return m_buffer.size();
+    }
+}
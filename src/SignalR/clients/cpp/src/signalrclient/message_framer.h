@@ -0,0 +1,45 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <string>
+#include "hub_protocol.h"
+
+namespace signalr
+{
+    // Splits the data received from the transport into individual messages. Messages are returned as views into
+    // the received data so that they are not copied. Only when a message is split across multiple receive calls
+    // its data is buffered until the rest of the message arrives.
+    //
+    // Usage:
+    //     framer.begin(data, length);
+    //     while (framer.try_read_message(protocol, message, message_length)) { ... }
+    //     framer.end();
+    //
+    // Views returned by `try_read_message` are only valid until `end` is called.
+    class message_framer
+    {
+    public:
+        message_framer();
+
+        message_framer(const message_framer&) = delete;
+        message_framer& operator=(const message_framer&) = delete;
+
+        void begin(const char* data, size_t length);
+        bool try_read_message(const hub_protocol& protocol, const char*& message, size_t& message_length);
+        void end();
+
+        // drops any buffered data e.g. when the connection is restarted or the data can no longer be framed
+        void reset();
+
+        size_t buffered_size() const noexcept;
+
+    private:
+        std::string m_buffer;
+        const char* m_data;
+        size_t m_length;
+        size_t m_position;
+        bool m_buffered;
+    };
+}
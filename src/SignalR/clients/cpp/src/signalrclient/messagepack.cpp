@@ -0,0 +1,825 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "messagepack.h"
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <vector>
+#include "cpprest/asyncrt_utils.h"
+#include "json_reader.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    namespace messagepack
+    {
+        // unnamed namespace makes it invisble outside this translation unit
+        namespace
+        {
+            void write_big_endian(std::string& buffer, uint8_t type, uint64_t value, size_t size)
+            {
+                buffer.push_back(static_cast<char>(type));
+                for (auto i = size; i > 0; i--)
+                {
+                    buffer.push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xff));
+                }
+            }
+
+            void write_header(std::string& buffer, size_t size, uint8_t fix_type, size_t fix_max, uint8_t type16, uint8_t type32)
+            {
+                if (size <= fix_max)
+                {
+                    buffer.push_back(static_cast<char>(fix_type | size));
+                }
+                else if (size <= 0xffff)
+                {
+                    write_big_endian(buffer, type16, size, 2);
+                }
+                else
+                {
+                    write_big_endian(buffer, type32, size, 4);
+                }
+            }
+
+            void write_string_header(std::string& buffer, size_t size)
+            {
+                if (size <= 31)
+                {
+                    buffer.push_back(static_cast<char>(0xa0 | size));
+                }
+                else if (size <= UINT8_MAX)
+                {
+                    write_big_endian(buffer, 0xd9, size, 1);
+                }
+                else if (size <= UINT16_MAX)
+                {
+                    write_big_endian(buffer, 0xda, size, 2);
+                }
+                else
+                {
+                    write_big_endian(buffer, 0xdb, size, 4);
+                }
+            }
+
+            [[noreturn]] void throw_malformed_json(const char* reason)
+            {
+                throw signalr_exception(std::string("malformed json: ").append(reason));
+            }
+
+            const char* skip_json_whitespace(const char* position, const char* end) noexcept
+            {
+                while (position < end && (*position == ' ' || *position == '\t' || *position == '\n' || *position == '\r'))
+                {
+                    ++position;
+                }
+                return position;
+            }
+
+            // integers are written as integers if they fit in 64 bits, everything else as a double. This is how
+            // `write_value` writes numbers parsed by cpprest.
+            void write_json_number(std::string& buffer, const char* number, size_t length)
+            {
+                const auto negative = number[0] == '-';
+                auto position = number + (negative ? 1 : 0);
+                const auto end = number + length;
+
+                if (position == end)
+                {
+                    throw_malformed_json("invalid number");
+                }
+
+                uint64_t magnitude = 0;
+                auto fits = true;
+                for (; position < end && *position >= '0' && *position <= '9'; ++position)
+                {
+                    const auto digit = static_cast<uint64_t>(*position - '0');
+                    fits &= magnitude <= (UINT64_MAX - digit) / 10;
+                    magnitude = magnitude * 10 + digit;
+                }
+
+                if (position == end && fits && (!negative || magnitude <= static_cast<uint64_t>(INT64_MAX) + 1))
+                {
+                    if (negative)
+                    {
+                        // negating in unsigned arithmetic avoids overflowing for INT64_MIN
+                        write_integer(buffer, static_cast<int64_t>(0 - magnitude));
+                    }
+                    else
+                    {
+                        write_unsigned_integer(buffer, magnitude);
+                    }
+                    return;
+                }
+
+                // not using strtod since it depends on the global locale
+                std::istringstream stream(std::string(number, length));
+                stream.imbue(std::locale::classic());
+                double value;
+                stream >> value;
+                if (stream.fail() || stream.peek() != std::char_traits<char>::eof())
+                {
+                    throw_malformed_json("invalid number");
+                }
+
+                write_double(buffer, value);
+            }
+
+            // the headers of arrays and maps are written once the number of elements is known. Space for the largest
+            // header is reserved and the unused part is removed afterwards, which moves the elements written so far
+            // but never reallocates the buffer.
+            const size_t max_header_size = 5;
+
+            void write_container_header(std::string& buffer, size_t header_position, size_t count, bool is_map)
+            {
+                // the header fits in the small string buffer so this does not allocate
+                std::string header;
+                if (is_map)
+                {
+                    write_map_header(header, count);
+                }
+                else
+                {
+                    write_array_header(header, count);
+                }
+
+                buffer.replace(header_position, max_header_size, header);
+            }
+
+            const char* write_json_value(std::string& buffer, const char* position, const char* end)
+            {
+                if (position == end)
+                {
+                    throw_malformed_json("expected a value");
+                }
+
+                const auto is_map = *position == '{';
+                if (is_map || *position == '[')
+                {
+                    const auto closing = is_map ? '}' : ']';
+                    const auto header_position = buffer.size();
+                    buffer.append(max_header_size, '\0');
+
+                    size_t count = 0;
+                    position = skip_json_whitespace(position + 1, end);
+                    if (position < end && *position == closing)
+                    {
+                        write_container_header(buffer, header_position, count, is_map);
+                        return position + 1;
+                    }
+
+                    for (;;)
+                    {
+                        if (is_map)
+                        {
+                            if (position == end || *position != '"')
+                            {
+                                throw_malformed_json("expected a field name");
+                            }
+
+                            position = write_json_value(buffer, position, end);
+                            position = skip_json_whitespace(position, end);
+                            if (position == end || *position != ':')
+                            {
+                                throw_malformed_json("expected ':'");
+                            }
+                            position = skip_json_whitespace(position + 1, end);
+                        }
+
+                        position = skip_json_whitespace(write_json_value(buffer, position, end), end);
+                        ++count;
+
+                        if (position == end)
+                        {
+                            throw_malformed_json("unterminated object or array");
+                        }
+
+                        if (*position == closing)
+                        {
+                            write_container_header(buffer, header_position, count, is_map);
+                            return position + 1;
+                        }
+
+                        if (*position != ',')
+                        {
+                            throw_malformed_json(is_map ? "expected ',' or '}'" : "expected ',' or ']'");
+                        }
+                        position = skip_json_whitespace(position + 1, end);
+                    }
+                }
+
+                json_reader::value_kind kind;
+                const auto value_end = json_reader::skip_value(position, end, kind);
+                const auto length = static_cast<size_t>(value_end - position);
+                switch (kind)
+                {
+                case json_reader::value_kind::string:
+                    // strings without escape sequences are copied as they are
+                    if (std::memchr(position + 1, '\\', length - 2) == nullptr)
+                    {
+                        write_string_header(buffer, length - 2);
+                        buffer.append(position + 1, length - 2);
+                    }
+                    else
+                    {
+                        write_string(buffer, json_reader::read_string(position, length));
+                    }
+                    break;
+                case json_reader::value_kind::number:
+                    write_json_number(buffer, position, length);
+                    break;
+                default:
+                    // skip_value only accepts the three literals
+                    if (*position == 'n')
+                    {
+                        write_nil(buffer);
+                    }
+                    else
+                    {
+                        write_bool(buffer, *position == 't');
+                    }
+                    break;
+                }
+
+                return value_end;
+            }
+        }
+
+        void write_nil(std::string& buffer)
+        {
+            buffer.push_back(static_cast<char>(0xc0));
+        }
+
+        void write_bool(std::string& buffer, bool value)
+        {
+            buffer.push_back(static_cast<char>(value ? 0xc3 : 0xc2));
+        }
+
+        void write_integer(std::string& buffer, int64_t value)
+        {
+            if (value >= 0)
+            {
+                write_unsigned_integer(buffer, static_cast<uint64_t>(value));
+            }
+            else if (value >= -32)
+            {
+                buffer.push_back(static_cast<char>(value));
+            }
+            else if (value >= INT8_MIN)
+            {
+                write_big_endian(buffer, 0xd0, static_cast<uint8_t>(value), 1);
+            }
+            else if (value >= INT16_MIN)
+            {
+                write_big_endian(buffer, 0xd1, static_cast<uint16_t>(value), 2);
+            }
+            else if (value >= INT32_MIN)
+            {
+                write_big_endian(buffer, 0xd2, static_cast<uint32_t>(value), 4);
+            }
+            else
+            {
+                write_big_endian(buffer, 0xd3, static_cast<uint64_t>(value), 8);
+            }
+        }
+
+        void write_unsigned_integer(std::string& buffer, uint64_t value)
+        {
+            if (value <= 0x7f)
+            {
+                buffer.push_back(static_cast<char>(value));
+            }
+            else if (value <= UINT8_MAX)
+            {
+                write_big_endian(buffer, 0xcc, value, 1);
+            }
+            else if (value <= UINT16_MAX)
+            {
+                write_big_endian(buffer, 0xcd, value, 2);
+            }
+            else if (value <= UINT32_MAX)
+            {
+                write_big_endian(buffer, 0xce, value, 4);
+            }
+            else
+            {
+                write_big_endian(buffer, 0xcf, value, 8);
+            }
+        }
+
+        void write_double(std::string& buffer, double value)
+        {
+            uint64_t bits;
+            static_assert(sizeof(bits) == sizeof(value), "unexpected size of double");
+            std::memcpy(&bits, &value, sizeof(bits));
+            write_big_endian(buffer, 0xcb, bits, 8);
+        }
+
+        void write_string(std::string& buffer, const std::string& value)
+        {
+            write_string_header(buffer, value.size());
+            buffer.append(value);
+        }
+
+        void write_array_header(std::string& buffer, size_t size)
+        {
+            write_header(buffer, size, 0x90, 15, 0xdc, 0xdd);
+        }
+
+        void write_map_header(std::string& buffer, size_t size)
+        {
+            write_header(buffer, size, 0x80, 15, 0xde, 0xdf);
+        }
+
+        void write_value(std::string& buffer, const web::json::value& value)
+        {
+            switch (value.type())
+            {
+            case web::json::value::Null:
+                write_nil(buffer);
+                break;
+            case web::json::value::Boolean:
+                write_bool(buffer, value.as_bool());
+                break;
+            case web::json::value::Number:
+            {
+                const auto& number = value.as_number();
+                if (number.is_int64())
+                {
+                    write_integer(buffer, number.to_int64());
+                }
+                else if (number.is_uint64())
+                {
+                    write_unsigned_integer(buffer, number.to_uint64());
+                }
+                else
+                {
+                    write_double(buffer, number.to_double());
+                }
+                break;
+            }
+            case web::json::value::String:
+                write_string(buffer, utility::conversions::to_utf8string(value.as_string()));
+                break;
+            case web::json::value::Array:
+            {
+                const auto& array = value.as_array();
+                write_array_header(buffer, array.size());
+                for (const auto& element : array)
+                {
+                    write_value(buffer, element);
+                }
+                break;
+            }
+            case web::json::value::Object:
+            {
+                const auto& object = value.as_object();
+                write_map_header(buffer, object.size());
+                for (const auto& field : object)
+                {
+                    write_string(buffer, utility::conversions::to_utf8string(field.first));
+                    write_value(buffer, field.second);
+                }
+                break;
+            }
+            }
+        }
+
+        void write_json(std::string& buffer, const char* data, size_t length)
+        {
+            const auto end = data + length;
+            const auto position = skip_json_whitespace(write_json_value(buffer, skip_json_whitespace(data, end), end), end);
+            if (position != end)
+            {
+                throw_malformed_json("unexpected data after the value");
+            }
+        }
+
+        void write_length_prefix(std::string& buffer, size_t length)
+        {
+            do
+            {
+                auto current = static_cast<uint8_t>(length & 0x7f);
+                length >>= 7;
+                if (length > 0)
+                {
+                    current |= 0x80;
+                }
+                buffer.push_back(static_cast<char>(current));
+            } while (length > 0);
+        }
+
+        bool try_read_length_prefix(const char* data, size_t length, size_t& payload_length, size_t& prefix_length)
+        {
+            // the length is limited to 2GB so it will never take more than 5 bytes
+            const size_t max_length_prefix_size = 5;
+
+            size_t result = 0;
+            for (size_t i = 0; i < max_length_prefix_size; i++)
+            {
+                if (i >= length)
+                {
+                    return false;
+                }
+
+                const auto current = static_cast<uint8_t>(data[i]);
+                result |= static_cast<size_t>(current & 0x7f) << (i * 7);
+
+                if ((current & 0x80) == 0)
+                {
+                    if (i == max_length_prefix_size - 1 && current > 7)
+                    {
+                        throw signalr_exception("messages over 2GB in size are not supported");
+                    }
+
+                    payload_length = result;
+                    prefix_length = i + 1;
+                    return true;
+                }
+            }
+
+            throw signalr_exception("messages over 2GB in size are not supported");
+        }
+
+        reader::reader(const char* data, size_t length) noexcept
+            : m_position(reinterpret_cast<const uint8_t*>(data)), m_end(reinterpret_cast<const uint8_t*>(data) + length)
+        { }
+
+        bool reader::at_end() const noexcept
+        {
+            return m_position == m_end;
+        }
+
+        void reader::ensure_available(size_t size) const
+        {
+            if (static_cast<size_t>(m_end - m_position) < size)
+            {
+                throw signalr_exception("unexpected end of messagepack data");
+            }
+        }
+
+        uint8_t reader::read_byte()
+        {
+            ensure_available(1);
+            return *m_position++;
+        }
+
+        uint64_t reader::read_big_endian(size_t size)
+        {
+            ensure_available(size);
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; i++)
+            {
+                value = (value << 8) | *m_position++;
+            }
+            return value;
+        }
+
+        const char* reader::read_bytes(size_t size)
+        {
+            ensure_available(size);
+            auto bytes = reinterpret_cast<const char*>(m_position);
+            m_position += size;
+            return bytes;
+        }
+
+        size_t reader::read_count(size_t size, size_t values_per_element)
+        {
+            const auto count = static_cast<size_t>(read_big_endian(size));
+
+            // every value takes at least one byte so a count the remaining data cannot hold is malformed and must not
+            // be used to size anything
+            if (count > static_cast<size_t>(m_end - m_position) / values_per_element)
+            {
+                throw signalr_exception("messagepack container length exceeds the remaining data");
+            }
+            return count;
+        }
+
+        bool reader::try_read_nil()
+        {
+            ensure_available(1);
+            if (*m_position == 0xc0)
+            {
+                m_position++;
+                return true;
+            }
+            return false;
+        }
+
+        size_t reader::read_array_header()
+        {
+            const auto type = read_byte();
+            if ((type & 0xf0) == 0x90)
+            {
+                return type & 0x0f;
+            }
+
+            switch (type)
+            {
+            case 0xdc:
+                return read_count(2, 1);
+            case 0xdd:
+                return read_count(4, 1);
+            default:
+                throw signalr_exception("expected a messagepack array");
+            }
+        }
+
+        size_t reader::read_map_header()
+        {
+            const auto type = read_byte();
+            if ((type & 0xf0) == 0x80)
+            {
+                return type & 0x0f;
+            }
+
+            switch (type)
+            {
+            case 0xde:
+                return read_count(2, 2);
+            case 0xdf:
+                return read_count(4, 2);
+            default:
+                throw signalr_exception("expected a messagepack map");
+            }
+        }
+
+        int64_t reader::read_integer()
+        {
+            const auto type = read_byte();
+            if (type <= 0x7f)
+            {
+                return type;
+            }
+
+            if (type >= 0xe0)
+            {
+                return static_cast<int8_t>(type);
+            }
+
+            switch (type)
+            {
+            case 0xcc:
+                return static_cast<int64_t>(read_big_endian(1));
+            case 0xcd:
+                return static_cast<int64_t>(read_big_endian(2));
+            case 0xce:
+                return static_cast<int64_t>(read_big_endian(4));
+            case 0xcf:
+                return static_cast<int64_t>(read_big_endian(8));
+            case 0xd0:
+                return static_cast<int8_t>(read_big_endian(1));
+            case 0xd1:
+                return static_cast<int16_t>(read_big_endian(2));
+            case 0xd2:
+                return static_cast<int32_t>(read_big_endian(4));
+            case 0xd3:
+                return static_cast<int64_t>(read_big_endian(8));
+            default:
+                throw signalr_exception("expected a messagepack integer");
+            }
+        }
+
+        bool reader::read_bool()
+        {
+            const auto type = read_byte();
+            if (type == 0xc2 || type == 0xc3)
+            {
+                return type == 0xc3;
+            }
+
+            throw signalr_exception("expected a messagepack boolean");
+        }
+
+        std::string reader::read_string()
+        {
+            const auto type = read_byte();
+            size_t size;
+            if ((type & 0xe0) == 0xa0)
+            {
+                size = type & 0x1f;
+            }
+            else
+            {
+                switch (type)
+                {
+                case 0xd9:
+                    size = static_cast<size_t>(read_big_endian(1));
+                    break;
+                case 0xda:
+                    size = static_cast<size_t>(read_big_endian(2));
+                    break;
+                case 0xdb:
+                    size = static_cast<size_t>(read_big_endian(4));
+                    break;
+                default:
+                    throw signalr_exception("expected a messagepack string");
+                }
+            }
+
+            return std::string(read_bytes(size), size);
+        }
+
+        web::json::value reader::read_value()
+        {
+            return read_value(0);
+        }
+
+        web::json::value reader::read_value(size_t depth)
+        {
+            ensure_available(1);
+            const auto type = *m_position;
+
+            if (type <= 0x7f || type >= 0xe0 || (type >= 0xcc && type <= 0xd3))
+            {
+                // uint64 values that do not fit into int64 have to be handled separately
+                if (type == 0xcf)
+                {
+                    m_position++;
+                    return web::json::value::number(static_cast<uint64_t>(read_big_endian(8)));
+                }
+                return web::json::value::number(read_integer());
+            }
+
+            if ((type & 0xe0) == 0xa0 || (type >= 0xd9 && type <= 0xdb))
+            {
+                return web::json::value::string(utility::conversions::to_string_t(read_string()));
+            }
+
+            const auto is_array = (type & 0xf0) == 0x90 || type == 0xdc || type == 0xdd;
+            const auto is_map = (type & 0xf0) == 0x80 || type == 0xde || type == 0xdf;
+            if ((is_array || is_map) && depth >= max_depth)
+            {
+                throw signalr_exception("messagepack data is nested too deeply");
+            }
+
+            if (is_array)
+            {
+                // the elements are collected as they are read rather than preallocated from the count on the wire
+                const auto size = read_array_header();
+                std::vector<web::json::value> elements;
+                for (size_t i = 0; i < size; i++)
+                {
+                    elements.push_back(read_value(depth + 1));
+                }
+                return web::json::value::array(std::move(elements));
+            }
+
+            if (is_map)
+            {
+                const auto size = read_map_header();
+                auto object = web::json::value::object();
+                for (size_t i = 0; i < size; i++)
+                {
+                    auto key = read_value(depth + 1);
+                    auto name = key.is_string() ? key.as_string() : key.serialize();
+                    object[name] = read_value(depth + 1);
+                }
+                return object;
+            }
+
+            m_position++;
+            switch (type)
+            {
+            case 0xc0:
+                return web::json::value::null();
+            case 0xc2:
+                return web::json::value::boolean(false);
+            case 0xc3:
+                return web::json::value::boolean(true);
+            case 0xca:
+            {
+                const auto bits = static_cast<uint32_t>(read_big_endian(4));
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return web::json::value::number(static_cast<double>(value));
+            }
+            case 0xcb:
+            {
+                const auto bits = read_big_endian(8);
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return web::json::value::number(value);
+            }
+            case 0xc4:
+            case 0xc5:
+            case 0xc6:
+            {
+                // binary data is represented the same way the json protocol represents byte arrays - as base64 strings
+                const auto size = static_cast<size_t>(read_big_endian(type == 0xc4 ? 1 : type == 0xc5 ? 2 : 4));
+                auto bytes = reinterpret_cast<const unsigned char*>(read_bytes(size));
+                return web::json::value::string(utility::conversions::to_base64(std::vector<unsigned char>(bytes, bytes + size)));
+            }
+            default:
+                // extension types (e.g. timestamps) have no json representation
+                m_position--;
+                skip(depth);
+                return web::json::value::null();
+            }
+        }
+
+        void reader::skip()
+        {
+            skip(0);
+        }
+
+        void reader::skip(size_t depth)
+        {
+            const auto type = read_byte();
+
+            if (type <= 0x7f || type >= 0xe0 || type == 0xc0 || type == 0xc2 || type == 0xc3)
+            {
+                return;
+            }
+
+            if ((type & 0xe0) == 0xa0)
+            {
+                read_bytes(type & 0x1f);
+                return;
+            }
+
+            if ((type & 0xf0) == 0x90 || (type & 0xf0) == 0x80 || (type >= 0xdc && type <= 0xdf))
+            {
+                if (depth >= max_depth)
+                {
+                    throw signalr_exception("messagepack data is nested too deeply");
+                }
+
+                size_t count;
+                if ((type & 0xf0) == 0x90 || (type & 0xf0) == 0x80)
+                {
+                    count = (type & 0x0f) * ((type & 0xf0) == 0x80 ? 2 : 1);
+                }
+                else
+                {
+                    const auto is_map = type == 0xde || type == 0xdf;
+                    count = read_count(type == 0xdc || type == 0xde ? 2 : 4, is_map ? 2 : 1) * (is_map ? 2 : 1);
+                }
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    skip(depth + 1);
+                }
+                return;
+            }
+
+            size_t size;
+            switch (type)
+            {
+            case 0xcc:
+            case 0xd0:
+                size = 1;
+                break;
+            case 0xcd:
+            case 0xd1:
+                size = 2;
+                break;
+            case 0xca:
+            case 0xce:
+            case 0xd2:
+                size = 4;
+                break;
+            case 0xcb:
+            case 0xcf:
+            case 0xd3:
+                size = 8;
+                break;
+            case 0xc4:
+            case 0xd9:
+                size = static_cast<size_t>(read_big_endian(1));
+                break;
+            case 0xc5:
+            case 0xda:
+                size = static_cast<size_t>(read_big_endian(2));
+                break;
+            case 0xc6:
+            case 0xdb:
+                size = static_cast<size_t>(read_big_endian(4));
+                break;
+            case 0xd4:
+            case 0xd5:
+            case 0xd6:
+            case 0xd7:
+            case 0xd8:
+                // fixext - one byte of type followed by 1, 2, 4, 8 or 16 bytes of data
+                size = 1 + (static_cast<size_t>(1) << (type - 0xd4));
+                break;
+            case 0xc7:
+                size = static_cast<size_t>(read_big_endian(1)) + 1;
+                break;
+            case 0xc8:
+                size = static_cast<size_t>(read_big_endian(2)) + 1;
+                break;
+            case 0xc9:
+                size = static_cast<size_t>(read_big_endian(4)) + 1;
+                break;
+            default:
+                throw signalr_exception("invalid messagepack data");
+            }
+
+            read_bytes(size);
+        }
+    }
+}
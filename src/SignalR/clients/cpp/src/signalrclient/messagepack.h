@@ -0,0 +1,71 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "cpprest/json.h"
+
+namespace signalr
+{
+    // Minimal MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md) encoder/decoder. Values are mapped
+    // to and from `web::json::value` so that the rest of the client does not need to care about the wire format.
+    namespace messagepack
+    {
+        void write_nil(std::string& buffer);
+        void write_bool(std::string& buffer, bool value);
+        void write_integer(std::string& buffer, int64_t value);
+        void write_unsigned_integer(std::string& buffer, uint64_t value);
+        void write_double(std::string& buffer, double value);
+        void write_string(std::string& buffer, const std::string& value);
+        void write_array_header(std::string& buffer, size_t size);
+        void write_map_header(std::string& buffer, size_t size);
+        void write_value(std::string& buffer, const web::json::value& value);
+
+        // transcodes utf8 encoded json text without parsing it into a `web::json::value` first. Integers that fit in
+        // 64 bits are written as integers and other numbers as doubles, like `write_value` does. Fields of objects
+        // are written in the order they appear in the text. Throws signalr_exception if the text is not valid json.
+        void write_json(std::string& buffer, const char* data, size_t length);
+
+        // writes the length of a binary message as a 7-bit encoded integer (at most 5 bytes)
+        void write_length_prefix(std::string& buffer, size_t length);
+
+        // returns false if the data does not contain the complete length prefix yet. Throws if the prefix is malformed.
+        bool try_read_length_prefix(const char* data, size_t length, size_t& payload_length, size_t& prefix_length);
+
+        class reader
+        {
+        public:
+            reader(const char* data, size_t length) noexcept;
+
+            // throws if containers are nested more than max_depth levels deep
+            web::json::value read_value();
+            size_t read_array_header();
+            size_t read_map_header();
+            int64_t read_integer();
+            bool read_bool();
+            std::string read_string();
+
+            // returns true and consumes the value if the next value is nil
+            bool try_read_nil();
+            void skip();
+
+            bool at_end() const noexcept;
+
+            static const size_t max_depth = 64;
+
+        private:
+            const uint8_t* m_position;
+            const uint8_t* m_end;
+
+            web::json::value read_value(size_t depth);
+            void skip(size_t depth);
+            size_t read_count(size_t size, size_t values_per_element);
+            uint8_t read_byte();
+            uint64_t read_big_endian(size_t size);
+            const char* read_bytes(size_t size);
+            void ensure_available(size_t size) const;
+        };
+    }
+}
@@ -0,0 +1,279 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "messagepack_hub_protocol.h"
+#include "messagepack.h"
+#include "make_unique.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        enum completion_result_kind
+        {
+            error_result = 1,
+            void_result = 2,
+            non_void_result = 3
+        };
+
+        // invocation ids and close errors are written as nil when not set
+        void write_nullable_string(std::string& buffer, const std::string& value)
+        {
+            if (value.empty())
+            {
+                messagepack::write_nil(buffer);
+            }
+            else
+            {
+                messagepack::write_string(buffer, value);
+            }
+        }
+
+        std::string read_nullable_string(messagepack::reader& reader)
+        {
+            return reader.try_read_nil() ? "" : reader.read_string();
+        }
+
+        class messagepack_invocation_writer : public invocation_writer
+        {
+        public:
+            explicit messagepack_invocation_writer(const std::string& target)
+            {
+                messagepack::write_string(m_encoded_target, target);
+            }
+
+            // the arguments are transcoded from json text straight into the framed message. Space for the longest
+            // length prefix is reserved up front and the unused part is removed once the payload size is known.
+            std::string write(const std::string& invocation_id, const std::string& arguments) const override
+            {
+                const size_t max_length_prefix_size = 5;
+
+                // messagepack is rarely larger than the json it was transcoded from
+                std::string framed_message;
+                framed_message.reserve(max_length_prefix_size + 16 + invocation_id.size() + m_encoded_target.size() + arguments.size());
+                framed_message.append(max_length_prefix_size, '\0');
+
+                messagepack::write_array_header(framed_message, 5);
+                messagepack::write_integer(framed_message, static_cast<int>(message_type::invocation));
+                messagepack::write_map_header(framed_message, 0);
+                write_nullable_string(framed_message, invocation_id);
+                framed_message.append(m_encoded_target);
+                messagepack::write_json(framed_message, arguments.data(), arguments.size());
+
+                std::string length_prefix;
+                messagepack::write_length_prefix(length_prefix, framed_message.size() - max_length_prefix_size);
+                framed_message.replace(0, max_length_prefix_size, length_prefix);
+                return framed_message;
+            }
+
+        private:
+            std::string m_encoded_target;
+        };
+
+        void skip_headers(messagepack::reader& reader)
+        {
+            const auto count = reader.read_map_header();
+            for (size_t i = 0; i < count * 2; i++)
+            {
+                reader.skip();
+            }
+        }
+    }
+
+    std::string messagepack_hub_protocol::write_message(const hub_message& message) const
+    {
+        std::string payload;
+
+        switch (message.message_type)
+        {
+        case message_type::invocation:
+        case message_type::stream_invocation:
+        {
+            // [type, headers, invocationId, target, arguments, streamIds]
+            const auto& invocation = static_cast<const hub_invocation_message&>(message);
+            messagepack::write_array_header(payload, invocation.stream_ids.empty() ? 5 : 6);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            messagepack::write_map_header(payload, 0);
+            write_nullable_string(payload, invocation.invocation_id);
+            messagepack::write_string(payload, invocation.target);
+            messagepack::write_value(payload, invocation.arguments.get().is_null() ? web::json::value::array() : invocation.arguments.get());
+            if (!invocation.stream_ids.empty())
+            {
+                messagepack::write_array_header(payload, invocation.stream_ids.size());
+                for (const auto& stream_id : invocation.stream_ids)
+                {
+                    messagepack::write_string(payload, stream_id);
+                }
+            }
+            break;
+        }
+        case message_type::stream_item:
+        {
+            // [type, headers, invocationId, item]
+            const auto& stream_item = static_cast<const stream_item_message&>(message);
+            messagepack::write_array_header(payload, 4);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            messagepack::write_map_header(payload, 0);
+            messagepack::write_string(payload, stream_item.invocation_id);
+            messagepack::write_value(payload, stream_item.item.get());
+            break;
+        }
+        case message_type::completion:
+        {
+            // [type, headers, invocationId, resultKind, result?]
+            const auto& completion = static_cast<const completion_message&>(message);
+            const auto result_kind = !completion.error.empty()
+                ? error_result
+                : completion.has_result ? non_void_result : void_result;
+            messagepack::write_array_header(payload, result_kind == void_result ? 4 : 5);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            messagepack::write_map_header(payload, 0);
+            messagepack::write_string(payload, completion.invocation_id);
+            messagepack::write_integer(payload, result_kind);
+            if (result_kind == error_result)
+            {
+                messagepack::write_string(payload, completion.error);
+            }
+            else if (result_kind == non_void_result)
+            {
+                messagepack::write_value(payload, completion.result.get());
+            }
+            break;
+        }
+        case message_type::cancel_invocation:
+        {
+            // [type, headers, invocationId]
+            const auto& cancel_invocation = static_cast<const cancel_invocation_message&>(message);
+            messagepack::write_array_header(payload, 3);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            messagepack::write_map_header(payload, 0);
+            messagepack::write_string(payload, cancel_invocation.invocation_id);
+            break;
+        }
+        case message_type::ping:
+            // [type]
+            messagepack::write_array_header(payload, 1);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            break;
+        case message_type::close:
+        {
+            // [type, error, allowReconnect]
+            const auto& close = static_cast<const close_message&>(message);
+            messagepack::write_array_header(payload, 3);
+            messagepack::write_integer(payload, static_cast<int>(message.message_type));
+            write_nullable_string(payload, close.error);
+            messagepack::write_bool(payload, close.allow_reconnect);
+            break;
+        }
+        }
+
+        std::string framed_message;
+        framed_message.reserve(payload.size() + 5);
+        messagepack::write_length_prefix(framed_message, payload.size());
+        framed_message.append(payload);
+        return framed_message;
+    }
+
+    std::unique_ptr<invocation_writer> messagepack_hub_protocol::create_invocation_writer(const std::string& target) const
+    {
+        return std::make_unique<messagepack_invocation_writer>(target);
+    }
+
+    bool messagepack_hub_protocol::try_read_frame(const char* data, size_t length, message_frame& frame) const
+    {
+        size_t message_length, prefix_length;
+        if (!messagepack::try_read_length_prefix(data, length, message_length, prefix_length)
+            || length - prefix_length < message_length)
+        {
+            return false;
+        }
+
+        frame.message_offset = prefix_length;
+        frame.message_length = message_length;
+        frame.frame_length = prefix_length + message_length;
+        return true;
+    }
+
+    std::unique_ptr<hub_message> messagepack_hub_protocol::parse_message(const char* data, size_t length) const
+    {
+        messagepack::reader reader(data, length);
+
+        const auto item_count = reader.read_array_header();
+        if (item_count == 0)
+        {
+            throw signalr_exception("message type not found");
+        }
+
+        switch (static_cast<message_type>(reader.read_integer()))
+        {
+        case message_type::invocation:
+        {
+            skip_headers(reader);
+            auto invocation_id = read_nullable_string(reader);
+            auto target = reader.read_string();
+            auto arguments = reader.read_value();
+            return std::make_unique<hub_invocation_message>(invocation_id, target, arguments);
+        }
+        case message_type::stream_item:
+        {
+            skip_headers(reader);
+            auto invocation_id = reader.read_string();
+            auto item = reader.read_value();
+            return std::make_unique<stream_item_message>(invocation_id, item);
+        }
+        case message_type::completion:
+        {
+            skip_headers(reader);
+            auto invocation_id = reader.read_string();
+            const auto result_kind = reader.read_integer();
+            switch (result_kind)
+            {
+            case error_result:
+                return std::make_unique<completion_message>(invocation_id, reader.read_string(), web::json::value::null(), false);
+            case void_result:
+                return std::make_unique<completion_message>(invocation_id, "", web::json::value::null(), false);
+            case non_void_result:
+                return std::make_unique<completion_message>(invocation_id, "", reader.read_value(), true);
+            default:
+                throw signalr_exception("invalid invocation result kind");
+            }
+        }
+        case message_type::stream_invocation:
+            // Sent to server only, should not be received by client
+            throw signalr_exception("Received unexpected message type 'StreamInvocation'.");
+        case message_type::cancel_invocation:
+            // Sent to server only, should not be received by client
+            throw signalr_exception("Received unexpected message type 'CancelInvocation'.");
+        case message_type::ping:
+            return std::make_unique<ping_message>();
+        case message_type::close:
+        {
+            auto error = item_count > 1 ? read_nullable_string(reader) : "";
+            const auto allow_reconnect = item_count > 2 && reader.read_bool();
+            return std::make_unique<close_message>(error, allow_reconnect);
+        }
+        default:
+            // future message types are ignored to stay compatible with newer servers
+            return nullptr;
+        }
+    }
+
+    const std::string& messagepack_hub_protocol::name() const noexcept
+    {
+        static const std::string name{ "messagepack" };
+        return name;
+    }
+
+    int messagepack_hub_protocol::version() const noexcept
+    {
+        return 1;
+    }
+
+    signalr::transfer_format messagepack_hub_protocol::transfer_format() const noexcept
+    {
+        return signalr::transfer_format::binary;
+    }
+}
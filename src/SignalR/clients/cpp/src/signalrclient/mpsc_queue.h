@@ -0,0 +1,86 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace signalr
+{
+    // Unbounded lock-free queue for many producers and a single consumer. Producers link their node with a single
+    // atomic exchange of the tail, so they never wait for each other or for the consumer. The consumer owns the head,
+    // which is a node whose value has already been taken. A producer that swapped the tail but has not linked its
+    // node yet makes the queue appear empty until it finished - the consumer has to look again after the producer
+    // signalled that it pushed a value.
+    template<typename T>
+    class mpsc_queue
+    {
+    public:
+        mpsc_queue()
+            : m_head(new node()), m_tail(m_head)
+        { }
+
+        ~mpsc_queue()
+        {
+            while (m_head != nullptr)
+            {
+                auto next = m_head->next.load(std::memory_order_relaxed);
+                delete m_head;
+                m_head = next;
+            }
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        // may be called concurrently from any number of threads
+        void push(T value)
+        {
+            auto new_node = new node(std::move(value));
+            auto previous = m_tail.exchange(new_node, std::memory_order_acq_rel);
+            previous->next.store(new_node, std::memory_order_release);
+        }
+
+        // must only be called by the consumer. Returns false if the queue is empty.
+        bool try_pop(T& value)
+        {
+            auto next = m_head->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            delete m_head;
+            m_head = next;
+            value = std::move(next->value);
+            return true;
+        }
+
+        // must only be called by the consumer
+        bool empty() const noexcept
+        {
+            return m_head->next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        struct node
+        {
+            node()
+                : next(nullptr)
+            { }
+
+            explicit node(T&& value)
+                : value(std::move(value)), next(nullptr)
+            { }
+
+            T value;
+            std::atomic<node*> next;
+        };
+
+        node* m_head;
+        // keeps the head used by the consumer and the tail used by producers on different cache lines
+        char m_padding[64];
+        std::atomic<node*> m_tail;
+    };
+}
@@ -0,0 +1,38 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "signalrclient/prepared_invocation.h"
+#include "hub_connection_impl.h"
+#include "prepared_invocation_impl.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    prepared_invocation::prepared_invocation(std::weak_ptr<hub_connection_impl> connection,
+        std::shared_ptr<const prepared_invocation_impl> impl)
+        : m_connection(std::move(connection)), m_pImpl(std::move(impl))
+    { }
+
+    pplx::task<std::string> prepared_invocation::invoke_serialized(const std::string& arguments) const
+    {
+        auto connection = m_connection.lock();
+        if (!connection)
+        {
+            throw signalr_exception("invoke() cannot be called after the hub_connection has been destroyed");
+        }
+
+        return connection->invoke_prepared(m_pImpl, arguments);
+    }
+
+    pplx::task<void> prepared_invocation::send_serialized(const std::string& arguments) const
+    {
+        auto connection = m_connection.lock();
+        if (!connection)
+        {
+            throw signalr_exception("send() cannot be called after the hub_connection has been destroyed");
+        }
+
+        return connection->send_prepared(*m_pImpl, arguments);
+    }
+}
@@ -0,0 +1,42 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "hub_protocol.h"
+
+namespace signalr
+{
+    // Holds the writers for a prepared hub method. Writers for every protocol are created up front so that the
+    // prepared invocation stays immutable and can be used from any thread without synchronization, even if the
+    // protocol is changed with `hub_connection::set_client_config` after the invocation was prepared.
+    class prepared_invocation_impl
+    {
+    public:
+        explicit prepared_invocation_impl(const std::string& target)
+            : m_target(target),
+            m_json_writer(hub_protocol::create(hub_protocol_type::json)->create_invocation_writer(target)),
+            m_messagepack_writer(hub_protocol::create(hub_protocol_type::messagepack)->create_invocation_writer(target))
+        { }
+
+        prepared_invocation_impl(const prepared_invocation_impl&) = delete;
+        prepared_invocation_impl& operator=(const prepared_invocation_impl&) = delete;
+
+        const std::string& target() const noexcept
+        {
+            return m_target;
+        }
+
+        const invocation_writer& get_writer(hub_protocol_type hub_protocol_type) const noexcept
+        {
+            return hub_protocol_type == hub_protocol_type::messagepack ? *m_messagepack_writer : *m_json_writer;
+        }
+
+    private:
+        const std::string m_target;
+        const std::unique_ptr<invocation_writer> m_json_writer;
+        const std::unique_ptr<invocation_writer> m_messagepack_writer;
+    };
+}
@@ -0,0 +1,35 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <algorithm>
+#include "reconnect_backoff.h"
+
+namespace signalr
+{
+    reconnect_backoff::reconnect_backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay)
+        : reconnect_backoff(initial_delay, max_delay, std::random_device()())
+    { }
+
+    reconnect_backoff::reconnect_backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay, unsigned int seed)
+        : m_initial_delay(initial_delay), m_max_delay(max_delay), m_random(seed)
+    { }
+
+    std::chrono::milliseconds reconnect_backoff::get_delay_bound(unsigned int attempt) const noexcept
+    {
+        auto bound = m_initial_delay;
+        // doubling one step at a time avoids overflowing for large attempt numbers
+        for (unsigned int i = 0; i < attempt && bound < m_max_delay; i++)
+        {
+            bound *= 2;
+        }
+
+        return (std::min)(bound, m_max_delay);
+    }
+
+    std::chrono::milliseconds reconnect_backoff::next_delay(unsigned int attempt)
+    {
+        std::uniform_int_distribution<long long> distribution(0, get_delay_bound(attempt).count());
+        return std::chrono::milliseconds(distribution(m_random));
+    }
+}
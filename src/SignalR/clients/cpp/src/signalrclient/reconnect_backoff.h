@@ -0,0 +1,31 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+#include <random>
+
+namespace signalr
+{
+    // Computes the delays between reconnect attempts. The bound grows exponentially with each failed attempt up to the
+    // maximum delay and the actual delay is picked at random below the bound ("full jitter") so that clients which lost
+    // their connections at the same time (e.g. when the server restarts) don't reconnect in lockstep.
+    // Not thread safe - a connection only runs one reconnect loop at a time.
+    class reconnect_backoff
+    {
+    public:
+        reconnect_backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay);
+        reconnect_backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay, unsigned int seed);
+
+        // the upper bound of the delay before the given (0 based) attempt
+        std::chrono::milliseconds get_delay_bound(unsigned int attempt) const noexcept;
+
+        std::chrono::milliseconds next_delay(unsigned int attempt);
+
+    private:
+        std::chrono::milliseconds m_initial_delay;
+        std::chrono::milliseconds m_max_delay;
+        std::mt19937 m_random;
+    };
+}
@@ -0,0 +1,208 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <thread>
+#include <vector>
+#include "send_queue.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    // bounds the number of messages handed to the transport at once
+    static const size_t max_messages_per_write = 64;
+
+    std::shared_ptr<send_queue> send_queue::create(const writer& write, size_t backpressure_threshold)
+    {
+        return std::shared_ptr<send_queue>(new send_queue(write, backpressure_threshold));
+    }
+
+    send_queue::send_queue(const writer& write, size_t backpressure_threshold)
+        : m_write(write), m_writing(false), m_unwritten(0), m_queued_bytes(0), m_high_water_mark(0),
+        m_backpressure_threshold(backpressure_threshold), m_capacity_awaited(false)
+    { }
+
+    send_queue::~send_queue()
+    {
+        // a running writer keeps the queue alive so the messages left will never be written
+        message message;
+        while (m_messages.try_pop(message))
+        {
+            message.sent.set_exception(signalr_exception("the connection was destroyed before the data was sent"));
+        }
+    }
+
+    pplx::task<void> send_queue::enqueue(std::string data, transfer_format transfer_format)
+    {
+        const auto size = data.size();
+        pplx::task_completion_event<void> sent;
+
+        // counted before the message can be written so that the count never drops below 0
+        const auto queued_bytes = m_queued_bytes.fetch_add(size) + size;
+        auto high_water_mark = m_high_water_mark.load();
+        while (queued_bytes > high_water_mark && !m_high_water_mark.compare_exchange_weak(high_water_mark, queued_bytes))
+        { }
+
+        // counted before it is pushed so that the writer taking it cannot drop the count below 0
+        m_unwritten++;
+        m_messages.push(message{ std::move(data), transfer_format, sent, std::chrono::steady_clock::now() });
+
+        try_start_writing();
+
+        return pplx::create_task(sent);
+    }
+
+    pplx::task<void> send_queue::wait_for_capacity()
+    {
+        if (m_queued_bytes.load() < m_backpressure_threshold.load())
+        {
+            return pplx::task_from_result();
+        }
+
+        std::lock_guard<std::mutex> lock(m_capacity_lock);
+
+        // the writer checks the flag after updating the count, so either this sees the new count or the writer sees
+        // the flag
+        m_capacity_awaited = true;
+        if (m_queued_bytes.load() < m_backpressure_threshold.load())
+        {
+            return pplx::task_from_result();
+        }
+
+        return pplx::create_task(m_capacity_available);
+    }
+
+    void send_queue::set_backpressure_threshold(size_t threshold) noexcept
+    {
+        m_backpressure_threshold = threshold;
+    }
+
+    size_t send_queue::queued_bytes() const noexcept
+    {
+        return m_queued_bytes.load();
+    }
+
+    size_t send_queue::high_water_mark() const noexcept
+    {
+        return m_high_water_mark.load();
+    }
+
+    const histogram& send_queue::send_latency() const noexcept
+    {
+        return m_send_latency;
+    }
+
+    void send_queue::try_start_writing()
+    {
+        if (!m_writing.exchange(true))
+        {
+            write_pending();
+        }
+    }
+
+    // must only be called by the thread that set m_writing
+    void send_queue::write_pending()
+    {
+        auto queue = shared_from_this();
+        std::vector<pplx::task<void>> writes;
+
+        while (true)
+        {
+            // the writer keeps going on this thread as long as the transport accepts messages synchronously
+            bool writes_done = true;
+
+            message message;
+            while (writes.size() < max_messages_per_write && m_messages.try_pop(message))
+            {
+                m_unwritten--;
+
+                const auto size = message.data.size();
+                const auto queued_at = message.queued_at;
+                auto sent = message.sent;
+
+                pplx::task<void> write_task;
+                try
+                {
+                    write_task = m_write(message.data, message.format);
+                }
+                catch (const std::exception&)
+                {
+                    write_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                writes_done = writes_done && write_task.is_done();
+                writes.push_back(write_task.then([queue, sent, size, queued_at](pplx::task<void> previous_task)
+                {
+                    // released first so that a sender continuing after the send completed sees the capacity
+                    queue->message_completed(size);
+
+                    try
+                    {
+                        previous_task.get();
+                        queue->m_send_latency.record_since(queued_at);
+                        sent.set();
+                    }
+                    catch (const std::exception&)
+                    {
+                        sent.set_exception(std::current_exception());
+                    }
+                }));
+            }
+
+            if (writes.empty())
+            {
+                m_writing = false;
+
+                // a producer that pushed after the queue looked empty but saw the flag still set did not start
+                // writing. The count also includes messages that are about to be pushed, whose producers try to
+                // start writing once they pushed, so the thread that claims the flag again just looks again.
+                if (m_unwritten.load() == 0 || m_writing.exchange(true))
+                {
+                    return;
+                }
+
+                // lets a producer that was preempted between counting and pushing its message finish the push
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (!writes_done)
+            {
+                pplx::when_all(writes.begin(), writes.end())
+                    .then([queue]()
+                    {
+                        queue->write_pending();
+                    });
+
+                return;
+            }
+
+            writes.clear();
+        }
+    }
+
+    void send_queue::message_completed(size_t size)
+    {
+        const auto queued_bytes = m_queued_bytes.fetch_sub(size) - size;
+        if (!m_capacity_awaited.load() || queued_bytes >= m_backpressure_threshold.load())
+        {
+            return;
+        }
+
+        pplx::task_completion_event<void> capacity_available;
+
+        {
+            std::lock_guard<std::mutex> lock(m_capacity_lock);
+            if (!m_capacity_awaited)
+            {
+                return;
+            }
+
+            m_capacity_awaited = false;
+            capacity_available = m_capacity_available;
+            m_capacity_available = pplx::task_completion_event<void>();
+        }
+
+        capacity_available.set();
+    }
+}
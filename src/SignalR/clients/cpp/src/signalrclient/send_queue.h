@@ -0,0 +1,81 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "pplx/pplxtasks.h"
+#include "histogram.h"
+#include "mpsc_queue.h"
+#include "transfer_format.h"
+
+namespace signalr
+{
+    // Queue of outgoing messages of a connection drained by a single writer. Producers push messages into a lock-free
+    // queue and the producer finding no writer running becomes the writer. The writer hands all queued messages to
+    // the transport and waits for them to be sent before taking the next ones, so sending threads do not contend on
+    // the transport and messages are sent in the order they were queued. Queued bytes are counted until a message has
+    // been sent, which provides the high-water mark and the backpressure signal.
+    class send_queue : public std::enable_shared_from_this<send_queue>
+    {
+    public:
+        typedef std::function<pplx::task<void>(const std::string& data, transfer_format transfer_format)> writer;
+
+        static std::shared_ptr<send_queue> create(const writer& write, size_t backpressure_threshold);
+
+        send_queue(const send_queue&) = delete;
+        send_queue& operator=(const send_queue&) = delete;
+
+        ~send_queue();
+
+        // the returned task completes when the message has been sent
+        pplx::task<void> enqueue(std::string data, transfer_format transfer_format);
+
+        // completes when fewer bytes than the backpressure threshold are queued
+        pplx::task<void> wait_for_capacity();
+
+        void set_backpressure_threshold(size_t threshold) noexcept;
+
+        size_t queued_bytes() const noexcept;
+        // the largest number of bytes that were queued at the same time
+        size_t high_water_mark() const noexcept;
+        // microseconds from queueing a message until it has been sent
+        const histogram& send_latency() const noexcept;
+
+    private:
+        struct message
+        {
+            std::string data;
+            signalr::transfer_format format;
+            pplx::task_completion_event<void> sent;
+            std::chrono::steady_clock::time_point queued_at;
+        };
+
+        send_queue(const writer& write, size_t backpressure_threshold);
+
+        const writer m_write;
+        mpsc_queue<message> m_messages;
+        // set while a thread acts as the writer, which is the only thread allowed to take messages from the queue
+        std::atomic<bool> m_writing;
+        // messages queued but not taken by the writer yet, counted before they are pushed. Lets the writer find
+        // messages pushed while it stopped.
+        std::atomic<size_t> m_unwritten;
+        std::atomic<size_t> m_queued_bytes;
+        std::atomic<size_t> m_high_water_mark;
+        std::atomic<size_t> m_backpressure_threshold;
+        // only used when the threshold is exceeded
+        std::atomic<bool> m_capacity_awaited;
+        std::mutex m_capacity_lock;
+        pplx::task_completion_event<void> m_capacity_available;
+        histogram m_send_latency;
+
+        void try_start_writing();
+        void write_pending();
+        void message_completed(size_t size);
+    };
+}
@@ -0,0 +1,408 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include "signalrclient/serializer.h"
+#include "json_reader.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        [[noreturn]] void throw_unexpected(const char* expected);
+    }
+
+    argument_writer::argument_writer(std::string& buffer)
+        : m_buffer(buffer), m_needs_separator(false)
+    { }
+
+    void argument_writer::write_null()
+    {
+        begin_value();
+        m_buffer.append("null", 4);
+    }
+
+    void argument_writer::write_bool(bool value)
+    {
+        begin_value();
+        value ? m_buffer.append("true", 4) : m_buffer.append("false", 5);
+    }
+
+    void argument_writer::write_int64(long long value)
+    {
+        begin_value();
+        m_buffer.append(std::to_string(value));
+    }
+
+    void argument_writer::write_uint64(unsigned long long value)
+    {
+        begin_value();
+        m_buffer.append(std::to_string(value));
+    }
+
+    void argument_writer::write_double(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            write_null();
+            return;
+        }
+
+        begin_value();
+
+        // the shortest representation that round trips in the common case, all digits otherwise
+        char buffer[32];
+        auto length = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        if (std::strtod(buffer, nullptr) != value)
+        {
+            length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        }
+        m_buffer.append(buffer, length);
+    }
+
+    void argument_writer::write_string(const char* value, size_t length)
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+
+        begin_value();
+        m_buffer.push_back('"');
+
+        const auto end = value + length;
+        auto unescaped_start = value;
+        for (auto position = value; position < end; ++position)
+        {
+            const auto c = static_cast<unsigned char>(*position);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+
+            m_buffer.append(unescaped_start, position);
+            unescaped_start = position + 1;
+
+            m_buffer.push_back('\\');
+            switch (c)
+            {
+            case '"': m_buffer.push_back('"'); break;
+            case '\\': m_buffer.push_back('\\'); break;
+            case '\b': m_buffer.push_back('b'); break;
+            case '\f': m_buffer.push_back('f'); break;
+            case '\n': m_buffer.push_back('n'); break;
+            case '\r': m_buffer.push_back('r'); break;
+            case '\t': m_buffer.push_back('t'); break;
+            default:
+                m_buffer.append("u00", 3);
+                m_buffer.push_back(hex_digits[c >> 4]);
+                m_buffer.push_back(hex_digits[c & 0xF]);
+                break;
+            }
+        }
+
+        m_buffer.append(unescaped_start, end);
+        m_buffer.push_back('"');
+    }
+
+    void argument_writer::write_string(const std::string& value)
+    {
+        write_string(value.data(), value.size());
+    }
+
+    void argument_writer::write_raw(const char* json, size_t length)
+    {
+        begin_value();
+        m_buffer.append(json, length);
+    }
+
+    void argument_writer::begin_array()
+    {
+        begin_value();
+        m_buffer.push_back('[');
+        m_needs_separator = false;
+    }
+
+    void argument_writer::end_array()
+    {
+        m_buffer.push_back(']');
+        m_needs_separator = true;
+    }
+
+    void argument_writer::begin_object()
+    {
+        begin_value();
+        m_buffer.push_back('{');
+        m_needs_separator = false;
+    }
+
+    void argument_writer::end_object()
+    {
+        m_buffer.push_back('}');
+        m_needs_separator = true;
+    }
+
+    void argument_writer::write_name(const std::string& name)
+    {
+        write_string(name);
+        m_buffer.push_back(':');
+        m_needs_separator = false;
+    }
+
+    void argument_writer::begin_value()
+    {
+        if (m_needs_separator)
+        {
+            m_buffer.push_back(',');
+        }
+        m_needs_separator = true;
+    }
+
+    argument_reader::argument_reader(const char* data, size_t length)
+        : m_position(data), m_end(data + length), m_first(false)
+    { }
+
+    bool argument_reader::read_null()
+    {
+        if (peek() == 'n' && m_end - m_position >= 4 && std::memcmp(m_position, "null", 4) == 0)
+        {
+            m_position += 4;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool argument_reader::read_bool()
+    {
+        if (peek() == 't' && m_end - m_position >= 4 && std::memcmp(m_position, "true", 4) == 0)
+        {
+            m_position += 4;
+            return true;
+        }
+
+        if (peek() == 'f' && m_end - m_position >= 5 && std::memcmp(m_position, "false", 5) == 0)
+        {
+            m_position += 5;
+            return false;
+        }
+
+        throw_unexpected("a boolean");
+    }
+
+    long long argument_reader::read_int64()
+    {
+        const auto negative = peek() == '-';
+        if (negative)
+        {
+            ++m_position;
+        }
+
+        const auto magnitude = read_uint64();
+        const auto limit = static_cast<unsigned long long>((std::numeric_limits<long long>::max)()) + (negative ? 1 : 0);
+        if (magnitude > limit)
+        {
+            throw signalr_exception("number out of range");
+        }
+
+        return negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+    }
+
+    unsigned long long argument_reader::read_uint64()
+    {
+        const auto first = peek();
+        if (first < '0' || first > '9')
+        {
+            throw_unexpected("an integer");
+        }
+
+        const auto end = number_end();
+
+        unsigned long long value = 0;
+        for (; m_position < end; ++m_position)
+        {
+            if (*m_position < '0' || *m_position > '9')
+            {
+                throw_unexpected("an integer");
+            }
+
+            const auto digit = static_cast<unsigned long long>(*m_position - '0');
+            if (value > ((std::numeric_limits<unsigned long long>::max)() - digit) / 10)
+            {
+                throw signalr_exception("number out of range");
+            }
+            value = value * 10 + digit;
+        }
+
+        return value;
+    }
+
+    double argument_reader::read_double()
+    {
+        const auto first = peek();
+        if (first != '-' && (first < '0' || first > '9'))
+        {
+            throw_unexpected("a number");
+        }
+
+        // strtod needs a null terminated string and numbers are short enough for the copy not to matter
+        const auto end = number_end();
+        const std::string number(m_position, end);
+        char* parsed_end;
+        const auto value = std::strtod(number.c_str(), &parsed_end);
+        if (parsed_end != number.c_str() + number.size())
+        {
+            throw_unexpected("a number");
+        }
+
+        m_position = end;
+        return value;
+    }
+
+    std::string argument_reader::read_string()
+    {
+        if (peek() != '"')
+        {
+            throw_unexpected("a string");
+        }
+
+        json_reader::value_kind kind;
+        const auto start = m_position;
+        m_position = json_reader::skip_value(m_position, m_end, kind);
+        return json_reader::read_string(start, m_position - start);
+    }
+
+    std::string argument_reader::read_raw()
+    {
+        peek();
+
+        json_reader::value_kind kind;
+        const auto start = m_position;
+        m_position = json_reader::skip_value(m_position, m_end, kind);
+        return std::string(start, m_position);
+    }
+
+    void argument_reader::skip_value()
+    {
+        peek();
+
+        json_reader::value_kind kind;
+        m_position = json_reader::skip_value(m_position, m_end, kind);
+    }
+
+    void argument_reader::begin_array()
+    {
+        if (peek() != '[')
+        {
+            throw_unexpected("an array");
+        }
+
+        ++m_position;
+        m_first = true;
+    }
+
+    bool argument_reader::next_element()
+    {
+        if (peek() == ']')
+        {
+            ++m_position;
+            m_first = false;
+            return false;
+        }
+
+        if (!m_first)
+        {
+            if (peek() != ',')
+            {
+                throw_unexpected("',' or ']'");
+            }
+            ++m_position;
+        }
+
+        m_first = false;
+        return true;
+    }
+
+    void argument_reader::begin_object()
+    {
+        if (peek() != '{')
+        {
+            throw_unexpected("an object");
+        }
+
+        ++m_position;
+        m_first = true;
+    }
+
+    bool argument_reader::next_field(std::string& name)
+    {
+        if (peek() == '}')
+        {
+            ++m_position;
+            m_first = false;
+            return false;
+        }
+
+        if (!m_first)
+        {
+            if (peek() != ',')
+            {
+                throw_unexpected("',' or '}'");
+            }
+            ++m_position;
+        }
+
+        name = read_string();
+        if (peek() != ':')
+        {
+            throw_unexpected("':'");
+        }
+        ++m_position;
+
+        m_first = false;
+        return true;
+    }
+
+    void argument_reader::skip_whitespace() noexcept
+    {
+        while (m_position < m_end && (*m_position == ' ' || *m_position == '\t' || *m_position == '\n' || *m_position == '\r'))
+        {
+            ++m_position;
+        }
+    }
+
+    // returns the next non-whitespace character without consuming it
+    char argument_reader::peek()
+    {
+        skip_whitespace();
+        if (m_position == m_end)
+        {
+            throw signalr_exception("unexpected end of json");
+        }
+
+        return *m_position;
+    }
+
+    const char* argument_reader::number_end() const noexcept
+    {
+        auto position = m_position;
+        while (position < m_end && (*position == '-' || *position == '+' || *position == '.' || *position == 'e'
+            || *position == 'E' || (*position >= '0' && *position <= '9')))
+        {
+            ++position;
+        }
+        return position;
+    }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        void throw_unexpected(const char* expected)
+        {
+            throw signalr_exception(std::string("malformed json: expected ").append(expected));
+        }
+    }
+}
@@ -0,0 +1,220 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "server_sent_events_transport.h"
+#include "constants.h"
+#include "event_stream_parser.h"
+#include "signalrclient/signalr_exception.h"
+#include "signalrclient/web_exception.h"
+
+namespace signalr
+{
+    std::shared_ptr<transport> server_sent_events_transport::create(std::unique_ptr<web_request_factory> web_request_factory,
+        const signalr_client_config& signalr_client_config, const logger& logger,
+        const std::function<void(const message_buffer&)>& process_response_callback,
+        std::function<void(const std::exception&)> error_callback)
+    {
+        return std::shared_ptr<transport>(new server_sent_events_transport(std::move(web_request_factory),
+            signalr_client_config, logger, process_response_callback, error_callback));
+    }
+
+    server_sent_events_transport::server_sent_events_transport(std::unique_ptr<web_request_factory> web_request_factory,
+        const signalr_client_config& signalr_client_config, const logger& logger,
+        const std::function<void(const message_buffer&)>& process_response_callback,
+        std::function<void(const std::exception&)> error_callback)
+        : transport(logger, process_response_callback, error_callback), m_web_request_factory(std::move(web_request_factory)),
+        m_signalr_client_config(signalr_client_config)
+    {
+        // we use this cts to check if the transport is receiving so it should be
+        // initially cancelled to indicate that the transport is not receiving
+        m_receive_cts.cancel();
+    }
+
+    server_sent_events_transport::~server_sent_events_transport()
+    {
+        try
+        {
+            disconnect().get();
+        }
+        catch (...) // must not throw from the destructor
+        {}
+    }
+
+    transport_type server_sent_events_transport::get_transport_type() const noexcept
+    {
+        return transport_type::server_sent_events;
+    }
+
+    pplx::task<void> server_sent_events_transport::connect(const std::string& url)
+    {
+        std::lock_guard<std::mutex> stop_lock(m_start_stop_lock);
+
+        if (!m_receive_cts.get_token().is_canceled())
+        {
+            throw signalr_exception("transport already connected");
+        }
+
+        m_logger.log(trace_level::info,
+            std::string("[server-sent events transport] connecting to: ")
+            .append(url));
+
+        // the client is shared by the GET request receiving the events and the POST requests sending the data
+        auto http_client = http_client_pool::get_default().get_client(url, m_signalr_client_config);
+        m_sender = batching_sender::create(m_web_request_factory, url, m_signalr_client_config, http_client);
+
+        auto receive_config = m_signalr_client_config;
+        auto headers = receive_config.get_http_headers();
+        headers[_XPLATSTR("Accept")] = _XPLATSTR("text/event-stream");
+        receive_config.set_http_headers(headers);
+
+        auto request = m_web_request_factory->create_web_request(url);
+        request->set_method(utility::conversions::to_utf8string(web::http::methods::GET));
+        request->set_user_agent(USER_AGENT);
+        request->set_client_config(receive_config);
+        request->set_http_client(http_client);
+
+        pplx::cancellation_token_source receive_cts;
+        pplx::task_completion_event<void> connect_tce;
+
+        auto weak_transport = std::weak_ptr<server_sent_events_transport>(shared_from_this());
+        auto parser = std::make_shared<event_stream_parser>();
+
+        // chunks are passed on one after another so the messages are processed in the order they were received
+        auto on_data = [weak_transport, parser, receive_cts](const std::string& chunk)
+        {
+            auto transport = weak_transport.lock();
+            if (!transport || receive_cts.get_token().is_canceled())
+            {
+                return;
+            }
+
+            for (auto& message : parser->parse(chunk))
+            {
+                transport->process_response(message_buffer(std::move(message)));
+            }
+        };
+
+        // the server starts sending the response once the connection can be used
+        request->get_streaming_response(on_data, receive_cts.get_token())
+            .then([weak_transport, connect_tce, receive_cts](pplx::task<web_response> connect_task)
+            {
+                auto transport = weak_transport.lock();
+                if (!transport)
+                {
+                    connect_tce.set_exception(signalr_exception("the transport no longer exists"));
+                    return;
+                }
+
+                try
+                {
+                    const auto response = connect_task.get();
+                    if (response.status_code != 200)
+                    {
+                        std::stringstream oss;
+                        oss << "web exception - " << response.status_code << " " << response.reason_phrase;
+                        throw web_exception(oss.str(), response.status_code);
+                    }
+
+                    connect_tce.set();
+
+                    response.body.then([weak_transport, receive_cts](pplx::task<std::string> receive_task)
+                    {
+                        auto transport = weak_transport.lock();
+                        if (transport)
+                        {
+                            transport->receive_stopped(receive_task.then([](std::string) {}), receive_cts);
+                        }
+                    });
+                }
+                catch (const std::exception &e)
+                {
+                    transport->m_logger.log(
+                        trace_level::errors,
+                        std::string("[server-sent events transport] exception when connecting to the server: ")
+                        .append(e.what()));
+
+                    receive_cts.cancel();
+                    connect_tce.set_exception(std::current_exception());
+                }
+            });
+
+        m_receive_cts = receive_cts;
+
+        return pplx::create_task(connect_tce);
+    }
+
+    void server_sent_events_transport::receive_stopped(pplx::task<void> receive_task, const pplx::cancellation_token_source& cts)
+    {
+        try
+        {
+            receive_task.get();
+
+            if (!cts.get_token().is_canceled())
+            {
+                throw signalr_exception("the server closed the connection");
+            }
+        }
+        catch (const pplx::task_canceled&)
+        {
+            m_logger.log(trace_level::info,
+                std::string("[server-sent events transport] receive task canceled."));
+            return;
+        }
+        catch (const std::exception& e)
+        {
+            if (cts.get_token().is_canceled())
+            {
+                // the response was aborted because the transport was disconnected
+                return;
+            }
+
+            m_logger.log(
+                trace_level::errors,
+                std::string("[server-sent events transport] error receiving response: ")
+                .append(e.what()));
+
+            error(e);
+        }
+    }
+
+    pplx::task<void> server_sent_events_transport::send(const std::string &data, transfer_format transfer_format)
+    {
+        if (transfer_format == transfer_format::binary)
+        {
+            return pplx::task_from_exception<void>(
+                signalr_exception("the server-sent events transport does not support the binary transfer format"));
+        }
+
+        std::shared_ptr<batching_sender> sender;
+        {
+            std::lock_guard<std::mutex> lock(m_start_stop_lock);
+            sender = m_sender;
+        }
+
+        if (!sender)
+        {
+            return pplx::task_from_exception<void>(signalr_exception("cannot send data when the transport is not connected"));
+        }
+
+        return sender->send(data, transfer_format);
+    }
+
+    pplx::task<void> server_sent_events_transport::disconnect()
+    {
+        std::lock_guard<std::mutex> lock(m_start_stop_lock);
+
+        if (m_receive_cts.get_token().is_canceled())
+        {
+            return pplx::task_from_result();
+        }
+
+        m_logger.log(trace_level::info, std::string("[server-sent events transport] disconnecting"));
+
+        // aborting the streaming response closes the connection which tells the server that the client is gone
+        m_receive_cts.cancel();
+        m_sender->cancel_pending();
+
+        return pplx::task_from_result();
+    }
+}
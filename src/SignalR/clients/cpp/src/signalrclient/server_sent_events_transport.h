@@ -0,0 +1,57 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <mutex>
+#include "cpprest/http_client.h"
+#include "signalrclient/signalr_client_config.h"
+#include "batching_sender.h"
+#include "transport.h"
+#include "logger.h"
+#include "web_request_factory.h"
+
+namespace signalr
+{
+    // Receives messages as Server-Sent Events from a single streaming GET request whose response body is parsed as it
+    // is received. Messages are sent with POST requests. Server-Sent Events can only carry text so the transport does
+    // not support the binary transfer format.
+    class server_sent_events_transport : public transport, public std::enable_shared_from_this<server_sent_events_transport>
+    {
+    public:
+        static std::shared_ptr<transport> create(std::unique_ptr<web_request_factory> web_request_factory,
+            const signalr_client_config& signalr_client_config, const logger& logger,
+            const std::function<void(const message_buffer&)>& process_response_callback,
+            std::function<void(const std::exception&)> error_callback);
+
+        ~server_sent_events_transport();
+
+        server_sent_events_transport(const server_sent_events_transport&) = delete;
+
+        server_sent_events_transport& operator=(const server_sent_events_transport&) = delete;
+
+        pplx::task<void> connect(const std::string& url) override;
+
+        pplx::task<void> send(const std::string &data, transfer_format transfer_format) override;
+
+        pplx::task<void> disconnect() override;
+
+        transport_type get_transport_type() const noexcept override;
+
+    private:
+        server_sent_events_transport(std::unique_ptr<web_request_factory> web_request_factory,
+            const signalr_client_config& signalr_client_config, const logger& logger,
+            const std::function<void(const message_buffer&)>& process_response_callback,
+            std::function<void(const std::exception&)> error_callback);
+
+        // shared with the sender
+        std::shared_ptr<web_request_factory> m_web_request_factory;
+        signalr_client_config m_signalr_client_config;
+        std::mutex m_start_stop_lock;
+
+        pplx::cancellation_token_source m_receive_cts;
+        std::shared_ptr<batching_sender> m_sender;
+
+        void receive_stopped(pplx::task<void> receive_task, const pplx::cancellation_token_source& cts);
+    };
+}
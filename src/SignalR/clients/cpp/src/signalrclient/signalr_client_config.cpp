@@ -8,6 +8,16 @@
 
 namespace signalr
 {
+    signalr_client_config::signalr_client_config()
+        : m_http_client_pooling(true), m_hub_protocol(hub_protocol_type::json), m_stream_buffer_capacity(64), m_stream_upload_window(16),
+        m_send_batch_threshold(0), m_send_batch_window(5), m_send_backpressure_threshold(1024 * 1024),
+        m_transport_connect_timeout(5000), m_keep_alive_interval(15000), m_server_timeout(30000), m_invocation_timeout(0),
+        m_automatic_reconnect(false), m_reconnect_initial_delay(1000), m_reconnect_max_delay(30000), m_max_reconnect_attempts(10),
+        m_skip_negotiation(false), m_handler_dispatch_mode(handler_dispatch_mode::synchronous), m_max_pending_handlers(1024),
+        m_max_outstanding_invocations(0), m_invocation_admission_policy(invocation_admission_policy::reject),
+        m_max_queued_invocations(1024)
+    { }
+
     void signalr_client_config::set_proxy(const web::web_proxy &proxy)
     {
         m_http_client_config.set_proxy(proxy);
@@ -30,6 +40,16 @@ namespace signalr
         m_http_client_config = http_client_config;
     }
 
+    bool signalr_client_config::get_http_client_pooling() const noexcept
+    {
+        return m_http_client_pooling;
+    }
+
+    void signalr_client_config::set_http_client_pooling(bool http_client_pooling)
+    {
+        m_http_client_pooling = http_client_pooling;
+    }
+
     web::websockets::client::websocket_client_config signalr_client_config::get_websocket_client_config() const noexcept
     {
         return m_websocket_client_config;
@@ -49,4 +69,274 @@ namespace signalr
     {
         m_http_headers = http_headers;
     }
+
+    hub_protocol_type signalr_client_config::get_hub_protocol() const noexcept
+    {
+        return m_hub_protocol;
+    }
+
+    void signalr_client_config::set_hub_protocol(hub_protocol_type hub_protocol)
+    {
+        m_hub_protocol = hub_protocol;
+    }
+
+    size_t signalr_client_config::get_stream_buffer_capacity() const noexcept
+    {
+        return m_stream_buffer_capacity;
+    }
+
+    void signalr_client_config::set_stream_buffer_capacity(size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("capacity must be greater than 0");
+        }
+
+        m_stream_buffer_capacity = capacity;
+    }
+
+    size_t signalr_client_config::get_stream_upload_window() const noexcept
+    {
+        return m_stream_upload_window;
+    }
+
+    void signalr_client_config::set_stream_upload_window(size_t window)
+    {
+        if (window == 0)
+        {
+            throw std::invalid_argument("window must be greater than 0");
+        }
+
+        m_stream_upload_window = window;
+    }
+
+    size_t signalr_client_config::get_send_batch_threshold() const noexcept
+    {
+        return m_send_batch_threshold;
+    }
+
+    void signalr_client_config::set_send_batch_threshold(size_t threshold)
+    {
+        m_send_batch_threshold = threshold;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_send_batch_window() const noexcept
+    {
+        return m_send_batch_window;
+    }
+
+    void signalr_client_config::set_send_batch_window(std::chrono::milliseconds window)
+    {
+        if (window.count() < 0)
+        {
+            throw std::invalid_argument("window must not be negative");
+        }
+
+        m_send_batch_window = window;
+    }
+
+    size_t signalr_client_config::get_send_backpressure_threshold() const noexcept
+    {
+        return m_send_backpressure_threshold;
+    }
+
+    void signalr_client_config::set_send_backpressure_threshold(size_t threshold)
+    {
+        if (threshold == 0)
+        {
+            throw std::invalid_argument("threshold must be greater than 0");
+        }
+
+        m_send_backpressure_threshold = threshold;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_transport_connect_timeout() const noexcept
+    {
+        return m_transport_connect_timeout;
+    }
+
+    void signalr_client_config::set_transport_connect_timeout(std::chrono::milliseconds timeout)
+    {
+        if (timeout.count() <= 0)
+        {
+            throw std::invalid_argument("timeout must be greater than 0");
+        }
+
+        m_transport_connect_timeout = timeout;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_keep_alive_interval() const noexcept
+    {
+        return m_keep_alive_interval;
+    }
+
+    void signalr_client_config::set_keep_alive_interval(std::chrono::milliseconds interval)
+    {
+        if (interval.count() <= 0)
+        {
+            throw std::invalid_argument("interval must be greater than 0");
+        }
+
+        m_keep_alive_interval = interval;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_server_timeout() const noexcept
+    {
+        return m_server_timeout;
+    }
+
+    void signalr_client_config::set_server_timeout(std::chrono::milliseconds timeout)
+    {
+        if (timeout.count() <= 0)
+        {
+            throw std::invalid_argument("timeout must be greater than 0");
+        }
+
+        m_server_timeout = timeout;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_invocation_timeout() const noexcept
+    {
+        return m_invocation_timeout;
+    }
+
+    void signalr_client_config::set_invocation_timeout(std::chrono::milliseconds timeout)
+    {
+        if (timeout.count() < 0)
+        {
+            throw std::invalid_argument("timeout must not be negative");
+        }
+
+        m_invocation_timeout = timeout;
+    }
+
+    bool signalr_client_config::get_automatic_reconnect() const noexcept
+    {
+        return m_automatic_reconnect;
+    }
+
+    void signalr_client_config::set_automatic_reconnect(bool automatic_reconnect)
+    {
+        m_automatic_reconnect = automatic_reconnect;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_reconnect_initial_delay() const noexcept
+    {
+        return m_reconnect_initial_delay;
+    }
+
+    void signalr_client_config::set_reconnect_initial_delay(std::chrono::milliseconds delay)
+    {
+        if (delay.count() <= 0)
+        {
+            throw std::invalid_argument("delay must be greater than 0");
+        }
+
+        m_reconnect_initial_delay = delay;
+    }
+
+    std::chrono::milliseconds signalr_client_config::get_reconnect_max_delay() const noexcept
+    {
+        return m_reconnect_max_delay;
+    }
+
+    void signalr_client_config::set_reconnect_max_delay(std::chrono::milliseconds delay)
+    {
+        if (delay.count() <= 0)
+        {
+            throw std::invalid_argument("delay must be greater than 0");
+        }
+
+        m_reconnect_max_delay = delay;
+    }
+
+    unsigned int signalr_client_config::get_max_reconnect_attempts() const noexcept
+    {
+        return m_max_reconnect_attempts;
+    }
+
+    void signalr_client_config::set_max_reconnect_attempts(unsigned int max_attempts)
+    {
+        m_max_reconnect_attempts = max_attempts;
+    }
+
+    bool signalr_client_config::get_skip_negotiation() const noexcept
+    {
+        return m_skip_negotiation;
+    }
+
+    void signalr_client_config::set_skip_negotiation(bool skip_negotiation)
+    {
+        m_skip_negotiation = skip_negotiation;
+    }
+
+    handler_dispatch_mode signalr_client_config::get_handler_dispatch_mode() const noexcept
+    {
+        return m_handler_dispatch_mode;
+    }
+
+    void signalr_client_config::set_handler_dispatch_mode(handler_dispatch_mode mode)
+    {
+        m_handler_dispatch_mode = mode;
+    }
+
+    handler_executor signalr_client_config::get_handler_executor() const
+    {
+        return m_handler_executor;
+    }
+
+    void signalr_client_config::set_handler_executor(const handler_executor& executor)
+    {
+        m_handler_executor = executor;
+    }
+
+    size_t signalr_client_config::get_max_pending_handlers() const noexcept
+    {
+        return m_max_pending_handlers;
+    }
+
+    void signalr_client_config::set_max_pending_handlers(size_t max_pending_handlers)
+    {
+        if (max_pending_handlers == 0)
+        {
+            throw std::invalid_argument("max_pending_handlers must be greater than 0");
+        }
+
+        m_max_pending_handlers = max_pending_handlers;
+    }
+
+    size_t signalr_client_config::get_max_outstanding_invocations() const noexcept
+    {
+        return m_max_outstanding_invocations;
+    }
+
+    void signalr_client_config::set_max_outstanding_invocations(size_t max_outstanding_invocations)
+    {
+        m_max_outstanding_invocations = max_outstanding_invocations;
+    }
+
+    invocation_admission_policy signalr_client_config::get_invocation_admission_policy() const noexcept
+    {
+        return m_invocation_admission_policy;
+    }
+
+    void signalr_client_config::set_invocation_admission_policy(invocation_admission_policy policy)
+    {
+        m_invocation_admission_policy = policy;
+    }
+
+    size_t signalr_client_config::get_max_queued_invocations() const noexcept
+    {
+        return m_max_queued_invocations;
+    }
+
+    void signalr_client_config::set_max_queued_invocations(size_t max_queued_invocations)
+    {
+        if (max_queued_invocations == 0)
+        {
+            throw std::invalid_argument("max_queued_invocations must be greater than 0");
+        }
+
+        m_max_queued_invocations = max_queued_invocations;
+    }
 }
@@ -0,0 +1,70 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "signalrclient/stream_reader.h"
+#include "stream_reader_impl.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    stream_reader::stream_reader(std::shared_ptr<stream_reader_impl> impl)
+        : m_pImpl(std::move(impl))
+    { }
+
+    stream_reader::stream_reader(stream_reader&& other)
+        : m_pImpl(std::move(other.m_pImpl))
+    { }
+
+    stream_reader& stream_reader::operator=(stream_reader&& other)
+    {
+        if (this != &other)
+        {
+            if (m_pImpl)
+            {
+                m_pImpl->cancel();
+            }
+
+            m_pImpl = std::move(other.m_pImpl);
+        }
+
+        return *this;
+    }
+
+    // dropping the reader cancels the stream so that the server stops sending items nobody will read
+    stream_reader::~stream_reader()
+    {
+        if (m_pImpl)
+        {
+            m_pImpl->cancel();
+        }
+    }
+
+    pplx::task<bool> stream_reader::move_next()
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("move_next() cannot be called on uninitialized stream_reader instance");
+        }
+
+        return m_pImpl->move_next();
+    }
+
+    const web::json::value& stream_reader::current() const
+    {
+        if (!m_pImpl)
+        {
+            throw signalr_exception("current() cannot be called on uninitialized stream_reader instance");
+        }
+
+        return m_pImpl->current();
+    }
+
+    void stream_reader::cancel()
+    {
+        if (m_pImpl)
+        {
+            m_pImpl->cancel();
+        }
+    }
+}
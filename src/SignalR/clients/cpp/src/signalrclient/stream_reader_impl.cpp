@@ -0,0 +1,167 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "stream_reader_impl.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    stream_reader_impl::stream_reader_impl(size_t capacity)
+        : m_capacity(capacity > 0 ? capacity : 1), m_completed(false), m_cancelled(false), m_read_pending(false)
+    { }
+
+    void stream_reader_impl::add_item(const web::json::value& item)
+    {
+        pplx::task_completion_event<bool> pending_read;
+        bool overflow = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_completed || m_cancelled)
+            {
+                return;
+            }
+
+            if (m_read_pending)
+            {
+                // the consumer is already waiting so the item does not need to be buffered
+                m_current = item;
+                m_read_pending = false;
+                pending_read = m_pending_read;
+            }
+            else if (m_items.size() < m_capacity)
+            {
+                m_items.push_back(item);
+                return;
+            }
+            else
+            {
+                overflow = true;
+            }
+        }
+
+        if (!overflow)
+        {
+            pending_read.set(true);
+            return;
+        }
+
+        // only this stream fails, the other invocations and streams of the connection are not held up
+        finish(std::make_exception_ptr(signalr_exception(std::string("the stream buffer capacity (")
+            .append(std::to_string(m_capacity))
+            .append(") was exceeded because the stream was not read fast enough"))), false, true);
+    }
+
+    void stream_reader_impl::complete()
+    {
+        finish(nullptr, false, false);
+    }
+
+    void stream_reader_impl::complete(const std::exception_ptr& error)
+    {
+        finish(error, false, false);
+    }
+
+    void stream_reader_impl::cancel()
+    {
+        finish(nullptr, true, true);
+    }
+
+    void stream_reader_impl::finish(const std::exception_ptr& error, bool cancelled, bool cancel_on_server)
+    {
+        pplx::task_completion_event<bool> pending_read;
+        bool read_pending;
+        std::function<void()> cancel_handler;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_completed || m_cancelled)
+            {
+                return;
+            }
+
+            if (cancelled)
+            {
+                m_cancelled = true;
+                m_items.clear();
+            }
+            else
+            {
+                m_completed = true;
+                m_error = error;
+            }
+
+            if (cancel_on_server)
+            {
+                cancel_handler = m_cancel_handler;
+            }
+            m_cancel_handler = nullptr;
+            read_pending = m_read_pending;
+            m_read_pending = false;
+            pending_read = m_pending_read;
+        }
+
+        if (read_pending)
+        {
+            if (error)
+            {
+                pending_read.set_exception(error);
+            }
+            else
+            {
+                pending_read.set(false);
+            }
+        }
+
+        if (cancel_handler)
+        {
+            cancel_handler();
+        }
+    }
+
+    pplx::task<bool> stream_reader_impl::move_next()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (m_read_pending)
+        {
+            throw signalr_exception("move_next() cannot be called while the previous call has not completed");
+        }
+
+        if (!m_items.empty())
+        {
+            m_current = std::move(m_items.front());
+            m_items.pop_front();
+            return pplx::task_from_result(true);
+        }
+
+        if (m_error)
+        {
+            return pplx::task_from_exception<bool>(m_error);
+        }
+
+        if (m_completed || m_cancelled)
+        {
+            return pplx::task_from_result(false);
+        }
+
+        m_read_pending = true;
+        m_pending_read = pplx::task_completion_event<bool>();
+        return pplx::create_task(m_pending_read);
+    }
+
+    const web::json::value& stream_reader_impl::current() const
+    {
+        return m_current;
+    }
+
+    void stream_reader_impl::set_cancel_handler(const std::function<void()>& cancel_handler)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_cancel_handler = cancel_handler;
+    }
+}
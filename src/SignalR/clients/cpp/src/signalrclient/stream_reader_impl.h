@@ -0,0 +1,53 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "pplx/pplxtasks.h"
+#include "cpprest/json.h"
+
+namespace signalr
+{
+    // Bounded buffer between the receive loop producing stream items and the user consuming them. The producer never
+    // blocks since it shares the receive thread with every other invocation and stream of the connection. An item
+    // arriving while the buffer is full fails the stream with an overflow error instead, which also cancels it on the
+    // server through the cancel handler. Items buffered before are still read first.
+    class stream_reader_impl
+    {
+    public:
+        explicit stream_reader_impl(size_t capacity);
+
+        stream_reader_impl(const stream_reader_impl&) = delete;
+        stream_reader_impl& operator=(const stream_reader_impl&) = delete;
+
+        // producer side - invoked when messages for the stream are received
+        void add_item(const web::json::value& item);
+        void complete();
+        void complete(const std::exception_ptr& error);
+
+        // consumer side
+        pplx::task<bool> move_next();
+        const web::json::value& current() const;
+
+        // invoked when the stream is cancelled or overflows before it completed e.g. to notify the server
+        void set_cancel_handler(const std::function<void()>& cancel_handler);
+        void cancel();
+
+    private:
+        const size_t m_capacity;
+        std::deque<web::json::value> m_items;
+        web::json::value m_current;
+        bool m_completed;
+        bool m_cancelled;
+        std::exception_ptr m_error;
+        bool m_read_pending;
+        pplx::task_completion_event<bool> m_pending_read;
+        std::function<void()> m_cancel_handler;
+        std::mutex m_lock;
+
+        void finish(const std::exception_ptr& error, bool cancelled, bool cancel_on_server);
+    };
+}
@@ -0,0 +1,37 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "signalrclient/stream_writer.h"
+#include "stream_writer_impl.h"
+
+namespace signalr
+{
+    stream_writer::stream_writer()
+        : m_pImpl(std::make_shared<stream_writer_impl>())
+    { }
+
+    stream_writer::stream_writer(const stream_writer& other)
+        : m_pImpl(other.m_pImpl)
+    { }
+
+    stream_writer& stream_writer::operator=(const stream_writer& other)
+    {
+        m_pImpl = other.m_pImpl;
+        return *this;
+    }
+
+    // Do NOT remove this destructor. Letting the compiler generate and inline the default dtor may lead to
+    // undefinded behavior since we are using an incomplete type. More details here:  http://herbsutter.com/gotw/_100/
+    stream_writer::~stream_writer() = default;
+
+    pplx::task<void> stream_writer::write(const web::json::value& item)
+    {
+        return m_pImpl->write(item);
+    }
+
+    pplx::task<void> stream_writer::complete(const std::string& error)
+    {
+        return m_pImpl->complete(error);
+    }
+}
@@ -0,0 +1,203 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "stream_writer_impl.h"
+#include "signalrclient/signalr_exception.h"
+
+namespace signalr
+{
+    stream_writer_impl::stream_writer_impl()
+        : m_window(1), m_in_flight(0), m_bound(false), m_completed(false), m_sending(false)
+    { }
+
+    pplx::task<void> stream_writer_impl::write(const web::json::value& item)
+    {
+        pending_write pending;
+        pending.is_completion = false;
+        pending.item = item;
+        return enqueue(std::move(pending));
+    }
+
+    pplx::task<void> stream_writer_impl::complete(const std::string& error)
+    {
+        pending_write pending;
+        pending.is_completion = true;
+        pending.error = error;
+        return enqueue(std::move(pending));
+    }
+
+    pplx::task<void> stream_writer_impl::enqueue(pending_write&& pending)
+    {
+        auto task = pplx::create_task(pending.tce);
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_completed)
+            {
+                throw signalr_exception("the stream has already been completed");
+            }
+
+            if (m_error)
+            {
+                return pplx::task_from_exception<void>(m_error);
+            }
+
+            m_completed = pending.is_completion;
+            m_pending_writes.push_back(std::move(pending));
+        }
+
+        send_pending_writes();
+        return task;
+    }
+
+    void stream_writer_impl::bind(const std::string& stream_id, size_t window,
+        const std::function<pplx::task<void>(const hub_message&)>& send)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_bound)
+            {
+                throw signalr_exception("the stream has already been used for an invocation");
+            }
+
+            m_stream_id = stream_id;
+            m_window = window > 0 ? window : 1;
+            m_send = send;
+            m_bound = true;
+        }
+
+        send_pending_writes();
+    }
+
+    bool stream_writer_impl::is_bound() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        return m_bound;
+    }
+
+    void stream_writer_impl::abort(const std::exception_ptr& error)
+    {
+        std::deque<pending_write> pending_writes;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (!m_error)
+            {
+                m_error = error;
+            }
+
+            m_bound = true;
+            m_send = nullptr;
+            pending_writes.swap(m_pending_writes);
+        }
+
+        for (auto& pending : pending_writes)
+        {
+            pending.tce.set_exception(error);
+        }
+    }
+
+    // Only one thread sends at a time so that items reach the transport in the order they were written. Other threads
+    // leave their items in the queue for the sending thread to pick up.
+    void stream_writer_impl::send_pending_writes()
+    {
+        auto weak_writer = std::weak_ptr<stream_writer_impl>(shared_from_this());
+
+        while (true)
+        {
+            pending_write pending;
+            std::function<pplx::task<void>(const hub_message&)> send;
+            std::string stream_id;
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+
+                if (m_sending || !m_send || m_pending_writes.empty() || m_in_flight >= m_window)
+                {
+                    return;
+                }
+
+                m_sending = true;
+                m_in_flight++;
+                pending = std::move(m_pending_writes.front());
+                m_pending_writes.pop_front();
+                send = m_send;
+                stream_id = m_stream_id;
+            }
+
+            pplx::task<void> send_task;
+            try
+            {
+                send_task = pending.is_completion
+                    ? send(completion_message(stream_id, pending.error, web::json::value::null(), false))
+                    : send(stream_item_message(stream_id, pending.item));
+            }
+            catch (const std::exception&)
+            {
+                send_task = pplx::task_from_exception<void>(std::current_exception());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_sending = false;
+            }
+
+            // the item is handed over to the transport so the write is complete. The completion is only reported once
+            // it has been sent since nothing can be written after it
+            if (!pending.is_completion)
+            {
+                pending.tce.set();
+            }
+
+            auto tce = pending.tce;
+            auto is_completion = pending.is_completion;
+            send_task.then([weak_writer, tce, is_completion](pplx::task<void> previous_task)
+            {
+                std::exception_ptr error;
+                try
+                {
+                    previous_task.get();
+                }
+                catch (const std::exception&)
+                {
+                    error = std::current_exception();
+                }
+
+                if (is_completion)
+                {
+                    if (error)
+                    {
+                        tce.set_exception(error);
+                    }
+                    else
+                    {
+                        tce.set();
+                    }
+                }
+
+                auto writer = weak_writer.lock();
+                if (writer)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(writer->m_lock);
+                        writer->m_in_flight--;
+                    }
+
+                    if (error)
+                    {
+                        writer->abort(error);
+                    }
+                    else
+                    {
+                        writer->send_pending_writes();
+                    }
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,59 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "pplx/pplxtasks.h"
+#include "cpprest/json.h"
+#include "hub_message.h"
+
+namespace signalr
+{
+    // Queues the items written to an upload stream and hands them to the connection while keeping the number of
+    // items being sent within the window. Items written before the invocation was sent are kept until the writer is
+    // bound to the stream id of the invocation.
+    class stream_writer_impl : public std::enable_shared_from_this<stream_writer_impl>
+    {
+    public:
+        stream_writer_impl();
+
+        stream_writer_impl(const stream_writer_impl&) = delete;
+        stream_writer_impl& operator=(const stream_writer_impl&) = delete;
+
+        pplx::task<void> write(const web::json::value& item);
+        pplx::task<void> complete(const std::string& error);
+
+        // starts sending queued and subsequent items. A writer can only be used for a single invocation.
+        void bind(const std::string& stream_id, size_t window, const std::function<pplx::task<void>(const hub_message&)>& send);
+        bool is_bound() const;
+
+        // fails the pending and subsequent writes e.g. when the invocation could not be sent
+        void abort(const std::exception_ptr& error);
+
+    private:
+        struct pending_write
+        {
+            bool is_completion;
+            web::json::value item;
+            std::string error;
+            pplx::task_completion_event<void> tce;
+        };
+
+        std::deque<pending_write> m_pending_writes;
+        std::string m_stream_id;
+        size_t m_window;
+        size_t m_in_flight;
+        bool m_bound;
+        bool m_completed;
+        bool m_sending;
+        std::exception_ptr m_error;
+        std::function<pplx::task<void>(const hub_message&)> m_send;
+        mutable std::mutex m_lock;
+
+        pplx::task<void> enqueue(pending_write&& pending);
+        void send_pending_writes();
+    };
+}
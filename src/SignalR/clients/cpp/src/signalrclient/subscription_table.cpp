@@ -0,0 +1,147 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <stdexcept>
+#include "subscription_table.h"
+
+namespace signalr
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        const uint32_t seeds_per_size = 64;
+
+        char fold(char c) noexcept;
+    }
+
+    subscription_table::subscription_table()
+        : m_seed(0)
+    { }
+
+    subscription_table::subscription_table(const std::vector<std::pair<std::string, handler>>& subscriptions)
+        : m_seed(0)
+    {
+        for (const auto& subscription : subscriptions)
+        {
+            entry entry;
+            entry.folded_name.reserve(subscription.first.size());
+            for (auto c : subscription.first)
+            {
+                entry.folded_name.push_back(fold(c));
+            }
+            entry.callback = subscription.second;
+            m_entries.push_back(std::move(entry));
+        }
+
+        if (m_entries.empty())
+        {
+            return;
+        }
+
+        // the slot count is a power of two so the slot is picked with a mask. A few times more slots than names
+        // makes it likely that one of the first seeds has no collisions. If none does the table is doubled.
+        size_t slot_count = 4;
+        while (slot_count < m_entries.size() * 4)
+        {
+            slot_count *= 2;
+        }
+
+        for (;; slot_count *= 2)
+        {
+            for (uint32_t seed = 0; seed < seeds_per_size; seed++)
+            {
+                if (try_build(slot_count, seed))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    const subscription_table::handler* subscription_table::find(const char* name, size_t length) const noexcept
+    {
+        if (m_slots.empty())
+        {
+            return nullptr;
+        }
+
+        const auto index = m_slots[hash(name, length, m_seed) & (m_slots.size() - 1)];
+        if (index == 0)
+        {
+            return nullptr;
+        }
+
+        const auto& entry = m_entries[index - 1];
+        if (entry.folded_name.size() != length)
+        {
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < length; i++)
+        {
+            if (fold(name[i]) != entry.folded_name[i])
+            {
+                return nullptr;
+            }
+        }
+
+        return &entry.callback;
+    }
+
+    size_t subscription_table::size() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    // FNV-1a over the case folded name, the seed is mixed into the offset basis
+    uint32_t subscription_table::hash(const char* name, size_t length, uint32_t seed) noexcept
+    {
+        uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= static_cast<unsigned char>(fold(name[i]));
+            hash *= 16777619u;
+        }
+
+        // FNV-1a leaves the low bits poorly mixed for short inputs and only the low bits select the slot
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return hash;
+    }
+
+    bool subscription_table::try_build(size_t slot_count, uint32_t seed)
+    {
+        std::vector<uint32_t> slots(slot_count, 0);
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            const auto& name = m_entries[i].folded_name;
+            auto& slot = slots[hash(name.data(), name.size(), seed) & (slot_count - 1)];
+            if (slot != 0)
+            {
+                // no seed can separate equal names
+                if (m_entries[slot - 1].folded_name == name)
+                {
+                    throw std::invalid_argument("duplicate subscription: " + name);
+                }
+                return false;
+            }
+            slot = static_cast<uint32_t>(i + 1);
+        }
+
+        m_slots = std::move(slots);
+        m_seed = seed;
+        return true;
+    }
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        // ASCII only so that the result does not depend on the locale
+        char fold(char c) noexcept
+        {
+            return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lazy_json_value.h"
+
+namespace signalr
+{
+    // Immutable, case insensitive lookup table of the handlers registered with `hub_connection::on`. The table is built
+    // when the connection starts (handlers can only be registered while disconnected) using a perfect hash, i.e. a seed
+    // for which no two names fall into the same slot, so a lookup hashes the name once, checks a single slot and
+    // compares the bytes. Names are case folded as ASCII like `case_insensitive_equals` does for method names.
+    class subscription_table
+    {
+    public:
+        typedef std::function<void(const lazy_json_value&)> handler;
+
+        subscription_table();
+        // throws std::invalid_argument if two names only differ in case
+        explicit subscription_table(const std::vector<std::pair<std::string, handler>>& subscriptions);
+
+        // returns nullptr if there is no handler for the name
+        const handler* find(const char* name, size_t length) const noexcept;
+
+        size_t size() const noexcept;
+
+    private:
+        struct entry
+        {
+            std::string folded_name;
+            handler callback;
+        };
+
+        std::vector<entry> m_entries;
+        // index + 1 of the entry in each slot, 0 for empty slots
+        std::vector<uint32_t> m_slots;
+        uint32_t m_seed;
+
+        static uint32_t hash(const char* name, size_t length, uint32_t seed) noexcept;
+        bool try_build(size_t slot_count, uint32_t seed);
+    };
+}
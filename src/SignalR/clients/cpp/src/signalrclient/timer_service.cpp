@@ -0,0 +1,109 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "timer_service.h"
+
+namespace signalr
+{
+    timer_service::timer_service()
+        : m_next_timer_id(0), m_stopping(false)
+    { }
+
+    timer_service::~timer_service()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+        }
+
+        m_timers_changed.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    timer_service::timer_id timer_service::schedule(std::chrono::milliseconds delay, const std::function<void()>& callback)
+    {
+        const auto deadline = clock::now() + delay;
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        // the thread is only started when the first timer is scheduled
+        if (!m_thread.joinable())
+        {
+            m_thread = std::thread([this]() { run(); });
+        }
+
+        const auto timer_id = m_next_timer_id++;
+        m_timers.insert(std::make_pair(timer_key(deadline, timer_id), callback));
+        m_deadlines.insert(std::make_pair(timer_id, deadline));
+
+        // the thread only needs to wake up if the new timer is the next one to fire
+        if (m_timers.begin()->first.second == timer_id)
+        {
+            m_timers_changed.notify_one();
+        }
+
+        return timer_id;
+    }
+
+    bool timer_service::cancel(timer_id timer_id)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto deadline = m_deadlines.find(timer_id);
+        if (deadline == m_deadlines.end())
+        {
+            return false;
+        }
+
+        m_timers.erase(timer_key(deadline->second, timer_id));
+        m_deadlines.erase(deadline);
+        return true;
+    }
+
+    timer_service& timer_service::get_default()
+    {
+        static timer_service default_timer_service;
+        return default_timer_service;
+    }
+
+    void timer_service::run()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        while (!m_stopping)
+        {
+            if (m_timers.empty())
+            {
+                m_timers_changed.wait(lock);
+                continue;
+            }
+
+            auto next = m_timers.begin();
+            if (next->first.first > clock::now())
+            {
+                m_timers_changed.wait_until(lock, next->first.first);
+                continue;
+            }
+
+            auto callback = std::move(next->second);
+            m_deadlines.erase(next->first.second);
+            m_timers.erase(next);
+
+            lock.unlock();
+            try
+            {
+                callback();
+            }
+            catch (...)
+            {
+                // callbacks are expected to handle their own errors - an exception must not stop other timers
+            }
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace signalr
+{
+    // Runs callbacks after a delay. All timers are served by a single thread so connections don't need to block thread
+    // pool threads while waiting for a timeout. Callbacks are invoked on the timer thread and therefore must be short
+    // and must not block - longer work should be scheduled as a task.
+    class timer_service
+    {
+    public:
+        typedef uint64_t timer_id;
+
+        timer_service();
+        ~timer_service();
+
+        timer_service(const timer_service&) = delete;
+        timer_service& operator=(const timer_service&) = delete;
+
+        timer_id schedule(std::chrono::milliseconds delay, const std::function<void()>& callback);
+
+        // returns false if the timer has already fired or was cancelled before
+        bool cancel(timer_id timer_id);
+
+        // the instance shared by all connections in the process
+        static timer_service& get_default();
+
+    private:
+        typedef std::chrono::steady_clock clock;
+        typedef std::pair<clock::time_point, timer_id> timer_key;
+
+        std::map<timer_key, std::function<void()>> m_timers;
+        std::unordered_map<timer_id, clock::time_point> m_deadlines;
+        timer_id m_next_timer_id;
+        bool m_stopping;
+        std::mutex m_lock;
+        std::condition_variable m_timers_changed;
+        std::thread m_thread;
+
+        void run();
+    };
+}
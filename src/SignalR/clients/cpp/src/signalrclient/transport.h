@@ -5,7 +5,9 @@
 
 #include "pplx/pplxtasks.h"
 #include "signalrclient/transport_type.h"
+#include "transfer_format.h"
 #include "logger.h"
+#include "message_buffer.h"
 
 namespace signalr
 {
@@ -14,7 +16,7 @@ namespace signalr
     public:
         virtual pplx::task<void> connect(const std::string &url) = 0;
 
-        virtual pplx::task<void> send(const std::string &data) = 0;
+        virtual pplx::task<void> send(const std::string &data, transfer_format transfer_format) = 0;
 
         virtual pplx::task<void> disconnect() = 0;
 
@@ -23,16 +25,16 @@ namespace signalr
         virtual ~transport();
 
     protected:
-        transport(const logger& logger, const std::function<void(const std::string &)>& process_response_callback,
+        transport(const logger& logger, const std::function<void(const message_buffer&)>& process_response_callback,
             std::function<void(const std::exception&)> error_callback);
 
-        void process_response(const std::string &message);
+        void process_response(const message_buffer& message);
         void error(const std::exception &e);
 
         logger m_logger;
 
     private:
-        std::function<void(const std::string &)> m_process_response_callback;
+        std::function<void(const message_buffer&)> m_process_response_callback;
 
         std::function<void(const std::exception&)> m_error_callback;
     };
@@ -4,12 +4,15 @@
 #include "stdafx.h"
 #include "transport_factory.h"
 #include "websocket_transport.h"
+#include "server_sent_events_transport.h"
+#include "long_polling_transport.h"
+#include "make_unique.h"
 
 namespace signalr
 {
     std::shared_ptr<transport> transport_factory::create_transport(transport_type transport_type, const logger& logger,
         const signalr_client_config& signalr_client_config,
-        std::function<void(const std::string&)> process_response_callback,
+        std::function<void(const message_buffer&)> process_response_callback,
         std::function<void(const std::exception&)> error_callback)
     {
         if (transport_type == signalr::transport_type::websockets)
@@ -19,6 +22,18 @@ namespace signalr
                 logger, process_response_callback, error_callback);
         }
 
+        if (transport_type == signalr::transport_type::server_sent_events)
+        {
+            return server_sent_events_transport::create(std::make_unique<web_request_factory>(), signalr_client_config,
+                logger, process_response_callback, error_callback);
+        }
+
+        if (transport_type == signalr::transport_type::long_polling)
+        {
+            return long_polling_transport::create(std::make_unique<web_request_factory>(), signalr_client_config,
+                logger, process_response_callback, error_callback);
+        }
+
         throw std::runtime_error("not implemented");
     }
 
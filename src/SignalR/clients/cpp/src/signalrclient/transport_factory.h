@@ -15,7 +15,7 @@ namespace signalr
     public:
         virtual std::shared_ptr<transport> create_transport(transport_type transport_type, const logger& logger,
             const signalr_client_config& signalr_client_config,
-            std::function<void(const std::string&)> process_response_callback,
+            std::function<void(const message_buffer&)> process_response_callback,
             std::function<void(const std::exception&)> error_callback);
 
         virtual ~transport_factory();
@@ -7,8 +7,20 @@
 
 namespace signalr
 {
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        static pplx::task<void> read_body(Concurrency::streams::streambuf<uint8_t> body,
+            const std::shared_ptr<std::vector<uint8_t>>& buffer, const std::function<void(const std::string&)>& on_data,
+            const pplx::cancellation_token& cancellation_token);
+    }
+
     web_request::web_request(const std::string& url)
-        : m_url(url)
+        : m_url(url), m_http_client_pool(nullptr)
+    { }
+
+    web_request::web_request(const std::string& url, http_client_pool& http_client_pool)
+        : m_url(url), m_http_client_pool(&http_client_pool)
     { }
 
     void web_request::set_method(const std::string &method)
@@ -26,30 +38,118 @@ namespace signalr
         m_signalr_client_config = signalr_client_config;
     }
 
-    pplx::task<web_response> web_request::get_response()
+    void web_request::set_body(const std::string& body, const std::string& content_type)
     {
-        web::http::client::http_client client(utility::conversions::to_string_t(m_url), m_signalr_client_config.get_http_client_config());
+        m_body = body;
+        m_content_type = content_type;
+    }
 
-        m_request.headers() = m_signalr_client_config.get_http_headers();
-        if (!m_user_agent_string.empty())
-        {
-            m_request.headers()[_XPLATSTR("User-Agent")] = utility::conversions::to_string_t(m_user_agent_string);
-        }
+    void web_request::set_http_client(const std::shared_ptr<web::http::client::http_client>& http_client)
+    {
+        m_http_client = http_client;
+    }
 
-        return client.request(m_request)
+    pplx::task<web_response> web_request::get_response()
+    {
+        auto client = prepare_request();
+
+        return client->request(m_request)
             .then([](web::http::http_response response)
         {
             return web_response
             {
                 response.status_code(),
                 utility::conversions::to_utf8string(response.reason_phrase()),
-                response.extract_string().then([](const utility::string_t& body)
+                // the body is read as is because it may contain binary data (e.g. messagepack messages received
+                // with the long polling transport). Text sent by the server is utf8 encoded.
+                response.extract_vector().then([](const std::vector<unsigned char>& body)
                 {
-                    return utility::conversions::to_utf8string(body);
+                    return std::string(body.begin(), body.end());
                 })
             };
         });
     }
 
+    pplx::task<web_response> web_request::get_streaming_response(const std::function<void(const std::string&)>& on_data,
+        const pplx::cancellation_token& cancellation_token)
+    {
+        auto client = prepare_request();
+
+        return client->request(m_request, cancellation_token)
+            .then([on_data, cancellation_token](web::http::http_response response)
+        {
+            auto buffer = std::make_shared<std::vector<uint8_t>>(4096);
+
+            return web_response
+            {
+                response.status_code(),
+                utility::conversions::to_utf8string(response.reason_phrase()),
+                read_body(response.body().streambuf(), buffer, on_data, cancellation_token)
+                    .then([]() { return std::string(); })
+            };
+        });
+    }
+
+    std::shared_ptr<web::http::client::http_client> web_request::prepare_request()
+    {
+        auto client = m_http_client;
+        if (!client && m_http_client_pool)
+        {
+            client = m_http_client_pool->get_client(m_url, m_signalr_client_config);
+        }
+
+        if (client)
+        {
+            // shared clients are created for the base url of the server
+            m_request.set_request_uri(web::uri(utility::conversions::to_string_t(m_url)).resource());
+        }
+        else
+        {
+            client = std::make_shared<web::http::client::http_client>(
+                utility::conversions::to_string_t(m_url), m_signalr_client_config.get_http_client_config());
+        }
+
+        m_request.headers() = m_signalr_client_config.get_http_headers();
+        if (!m_user_agent_string.empty())
+        {
+            m_request.headers()[_XPLATSTR("User-Agent")] = utility::conversions::to_string_t(m_user_agent_string);
+        }
+
+        if (!m_content_type.empty())
+        {
+            // the body may contain binary data
+            m_request.set_body(std::vector<unsigned char>(m_body.begin(), m_body.end()));
+            m_request.headers().set_content_type(utility::conversions::to_string_t(m_content_type));
+        }
+
+        return client;
+    }
+
     web_request::~web_request() = default;
+
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        static pplx::task<void> read_body(Concurrency::streams::streambuf<uint8_t> body,
+            const std::shared_ptr<std::vector<uint8_t>>& buffer, const std::function<void(const std::string&)>& on_data,
+            const pplx::cancellation_token& cancellation_token)
+        {
+            // reading only what is already available (but at least one byte) passes data on as soon as it arrives
+            // instead of waiting until the buffer can be filled
+            const auto count = (std::min)((std::max)(body.in_avail(), static_cast<size_t>(1)), buffer->size());
+
+            return body.getn(buffer->data(), count)
+                .then([body, buffer, on_data, cancellation_token](size_t read)
+            {
+                if (read == 0)
+                {
+                    // the server has sent the whole body
+                    return pplx::task_from_result();
+                }
+
+                on_data(std::string(reinterpret_cast<const char*>(buffer->data()), read));
+                return read_body(body, buffer, on_data, cancellation_token);
+            }, cancellation_token);
+        }
+    }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "web_response.h"
+#include "http_client_pool.h"
 #include "signalrclient/signalr_client_config.h"
 
 namespace signalr
@@ -13,20 +14,41 @@ namespace signalr
     public:
         explicit web_request(const std::string& url);
 
+        // Requests without a client set with `set_http_client` are sent with a client from the pool
+        web_request(const std::string& url, http_client_pool& http_client_pool);
+
         virtual void set_method(const std::string &method);
         virtual void set_user_agent(const std::string &user_agent_string);
         virtual void set_client_config(const signalr_client_config& signalr_client_config);
+        virtual void set_body(const std::string& body, const std::string& content_type);
+
+        // Sends the request with the given client instead of creating a new client for this request. Sharing a client
+        // between requests keeps its connections to the server alive.
+        void set_http_client(const std::shared_ptr<web::http::client::http_client>& http_client);
 
         virtual pplx::task<web_response> get_response();
 
+        // Sends the request and reads the body of the response as it is received from the server. Each chunk of the
+        // body is passed to `on_data`. The body of the returned response completes with an empty string once the
+        // server has sent the whole body. The request, including reading the body, is aborted when the cancellation
+        // token is canceled.
+        virtual pplx::task<web_response> get_streaming_response(const std::function<void(const std::string&)>& on_data,
+            const pplx::cancellation_token& cancellation_token);
+
         web_request& operator=(const web_request&) = delete;
 
         virtual ~web_request();
 
     private:
+        std::shared_ptr<web::http::client::http_client> prepare_request();
+
         const std::string m_url;
         web::http::http_request m_request;
         std::string m_user_agent_string;
         signalr_client_config m_signalr_client_config;
+        std::string m_body;
+        std::string m_content_type;
+        std::shared_ptr<web::http::client::http_client> m_http_client;
+        http_client_pool* m_http_client_pool;
     };
 }
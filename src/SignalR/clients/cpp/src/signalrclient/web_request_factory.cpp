@@ -9,7 +9,8 @@ namespace signalr
 {
     std::unique_ptr<web_request> web_request_factory::create_web_request(const std::string& url)
     {
-        return std::make_unique<web_request>(url);
+        // requests share the clients of the process wide pool to reuse connections to the server
+        return std::make_unique<web_request>(url, http_client_pool::get_default());
     }
 
     web_request_factory::~web_request_factory()
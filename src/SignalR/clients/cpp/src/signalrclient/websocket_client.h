@@ -4,6 +4,8 @@
 #pragma once
 
 #include "pplx/pplxtasks.h"
+#include "transfer_format.h"
+#include "message_buffer.h"
 
 namespace signalr
 {
@@ -12,9 +14,9 @@ namespace signalr
     public:
         virtual pplx::task<void> connect(const std::string& url) = 0;
 
-        virtual pplx::task<void> send(const std::string& message) = 0;
+        virtual pplx::task<void> send(const std::string& message, transfer_format transfer_format) = 0;
 
-        virtual pplx::task<std::string> receive() = 0;
+        virtual pplx::task<message_buffer> receive() = 0;
 
         virtual pplx::task<void> close() = 0;
 
@@ -9,7 +9,7 @@
 namespace signalr
 {
     std::shared_ptr<transport> websocket_transport::create(const std::function<std::shared_ptr<websocket_client>()>& websocket_client_factory,
-        const logger& logger, const std::function<void(const std::string &)>& process_response_callback,
+        const logger& logger, const std::function<void(const message_buffer&)>& process_response_callback,
         std::function<void(const std::exception&)> error_callback)
     {
         return std::shared_ptr<transport>(
@@ -17,7 +17,7 @@ namespace signalr
     }
 
     websocket_transport::websocket_transport(const std::function<std::shared_ptr<websocket_client>()>& websocket_client_factory,
-        const logger& logger, const std::function<void(const std::string &)>& process_response_callback,
+        const logger& logger, const std::function<void(const message_buffer&)>& process_response_callback,
         std::function<void(const std::exception&)> error_callback)
         : transport(logger, process_response_callback, error_callback), m_websocket_client_factory(websocket_client_factory)
     {
@@ -97,10 +97,10 @@ namespace signalr
         }
     }
 
-    pplx::task<void> websocket_transport::send(const std::string &data)
+    pplx::task<void> websocket_transport::send(const std::string &data, transfer_format transfer_format)
     {
         // send will return a faulted task if client has disconnected
-        return safe_get_websocket_client()->send(data);
+        return safe_get_websocket_client()->send(data, transfer_format);
     }
 
     pplx::task<void> websocket_transport::disconnect()
@@ -160,7 +160,7 @@ namespace signalr
             // to `then` (note this is after the lambda body) and if the token is cancelled the continuation will not
             // run at all. The second - explicit - case happens if the token gets cancelled after the continuation has
             // been started in which case we just stop the loop by not scheduling another receive task.
-            .then([weak_transport, cts](std::string message)
+            .then([weak_transport, cts](message_buffer message)
             {
                 auto transport = weak_transport.lock();
                 if (transport)
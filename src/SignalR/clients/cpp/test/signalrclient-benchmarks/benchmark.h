@@ -0,0 +1,76 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarks
+{
+    enum class output_format
+    {
+        // aligned columns for reading
+        text,
+        // one json object per line for tracking results over time
+        json
+    };
+
+    inline output_format& selected_output_format()
+    {
+        static output_format format = output_format::text;
+        return format;
+    }
+
+    // Prints the average time per operation of a benchmark that ran `operations` operations in total on `thread_count`
+    // threads.
+    inline void report(const std::string& name, size_t thread_count, double operations, std::chrono::nanoseconds elapsed)
+    {
+        const auto ns_per_op = elapsed.count() / operations;
+        const auto ops_per_s = operations * 1e9 / elapsed.count();
+
+        if (selected_output_format() == output_format::json)
+        {
+            // benchmark names are plain identifiers and slashes so they do not need escaping
+            std::printf("{\"name\":\"%s\",\"threads\":%zu,\"operations\":%.0f,\"ns_per_op\":%.1f,\"ops_per_s\":%.0f}\n",
+                name.c_str(), thread_count, operations, ns_per_op, ops_per_s);
+        }
+        else
+        {
+            std::printf("%-60s %3zu threads %12.1f ns/op %14.0f ops/s\n", name.c_str(), thread_count, ns_per_op, ops_per_s);
+        }
+
+        std::fflush(stdout);
+    }
+
+    // Runs `operation` `iterations` times on each of `thread_count` threads and prints the average time per operation.
+    // The argument passed to the operation is the index of the thread running it.
+    inline void run(const std::string& name, size_t thread_count, size_t iterations, const std::function<void(size_t)>& operation)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; t++)
+        {
+            threads.push_back(std::thread([&operation, iterations, t]()
+            {
+                for (size_t i = 0; i < iterations; i++)
+                {
+                    operation(t);
+                }
+            }));
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        report(name, thread_count, static_cast<double>(thread_count * iterations),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "benchmark.h"
+#include "callback_manager.h"
+#include "legacy_callback_manager.h"
+
+namespace benchmarks
+{
+    namespace
+    {
+        const size_t iterations = 200000;
+
+        // register + complete as done for every hub invocation. The callback captures as much state as the callback
+        // created by hub_connection_impl::invoke so that copying it is not artificially cheap. The legacy manager
+        // passes json values, the slot table passes invocation results.
+        template<typename T, typename TArgument>
+        void run_register_invoke(const std::string& name, T& callback_manager, const TArgument& arguments, size_t thread_count)
+        {
+            auto state = std::make_shared<std::string>("result");
+
+            run(name, thread_count, iterations / thread_count, [&callback_manager, state, &arguments](size_t)
+            {
+                auto callback_id = callback_manager.register_callback([state](const TArgument&) {});
+                callback_manager.invoke_callback(callback_id, arguments, true);
+            });
+        }
+    }
+
+    void run_callback_manager_benchmarks()
+    {
+        const size_t thread_counts[] = { 1, 4, 16 };
+
+        for (auto thread_count : thread_counts)
+        {
+            legacy_callback_manager legacy;
+            run_register_invoke("callback_manager/register_invoke/legacy", legacy, web::json::value::number(42), thread_count);
+
+            signalr::callback_manager slot_table{ "" };
+            signalr::invocation_result result;
+            result.has_value = true;
+            result.value = web::json::value::number(42);
+            run_register_invoke("callback_manager/register_invoke/slot_table", slot_table, result, thread_count);
+        }
+    }
+}
@@ -0,0 +1,277 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include "benchmark.h"
+#include "event.h"
+#include "hub_connection_impl.h"
+#include "make_unique.h"
+#include "signalrclient/serializer.h"
+#include "test_transport_factory.h"
+#include "test_utils.h"
+#include "trace_log_writer.h"
+
+namespace benchmarks
+{
+    namespace
+    {
+        const size_t iterations = 20000;
+
+        // In-memory stand-in for a server behind the test websocket client. It answers the handshake, completes every
+        // invocation with its arguments as the result and lets benchmarks push messages to the client.
+        class echo_server
+        {
+        public:
+            echo_server()
+                : m_receive_pending(false), m_closed(false)
+            { }
+
+            void push(const std::string& message)
+            {
+                pplx::task_completion_event<std::string> receive;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (!m_receive_pending)
+                    {
+                        m_messages.push_back(message);
+                        return;
+                    }
+
+                    m_receive_pending = false;
+                    receive = m_receive;
+                }
+
+                receive.set(message);
+            }
+
+            pplx::task<std::string> receive()
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_closed)
+                {
+                    return pplx::task_from_exception<std::string>(std::runtime_error("the echo server has been closed"));
+                }
+
+                if (!m_messages.empty())
+                {
+                    auto message = std::move(m_messages.front());
+                    m_messages.pop_front();
+                    return pplx::task_from_result(message);
+                }
+
+                m_receive = pplx::task_completion_event<std::string>();
+                m_receive_pending = true;
+                return pplx::create_task(m_receive);
+            }
+
+            void on_message_sent(const std::string& message)
+            {
+                if (message.find("\"protocol\"") != std::string::npos)
+                {
+                    push("{}\x1e");
+                    return;
+                }
+
+                const std::string id_field("\"invocationId\":\"");
+                const auto id_start = message.find(id_field);
+                if (id_start == std::string::npos || message.find("\"type\":1") == std::string::npos)
+                {
+                    return;
+                }
+
+                const auto id_end = message.find('"', id_start + id_field.size());
+                push(std::string("{\"type\":3,\"invocationId\":\"")
+                    .append(message, id_start + id_field.size(), id_end - id_start - id_field.size())
+                    .append("\",\"result\":")
+                    .append(find_arguments(message))
+                    .append("}\x1e"));
+            }
+
+            void close()
+            {
+                pplx::task_completion_event<std::string> receive;
+                bool receive_pending;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_closed = true;
+                    receive_pending = m_receive_pending;
+                    m_receive_pending = false;
+                    receive = m_receive;
+                }
+
+                if (receive_pending)
+                {
+                    receive.set_exception(std::runtime_error("the echo server has been closed"));
+                }
+            }
+
+        private:
+            std::mutex m_lock;
+            std::deque<std::string> m_messages;
+            pplx::task_completion_event<std::string> m_receive;
+            bool m_receive_pending;
+            bool m_closed;
+
+            // the json array of arguments, skipping brackets inside of strings
+            static std::string find_arguments(const std::string& message)
+            {
+                const std::string arguments_field("\"arguments\":");
+                const auto start = message.find(arguments_field);
+                if (start == std::string::npos)
+                {
+                    return "null";
+                }
+
+                const auto arguments_start = start + arguments_field.size();
+                int depth = 0;
+                bool in_string = false;
+                for (auto i = arguments_start; i < message.size(); i++)
+                {
+                    const auto c = message[i];
+                    if (in_string)
+                    {
+                        if (c == '\\')
+                        {
+                            i++;
+                        }
+                        else if (c == '"')
+                        {
+                            in_string = false;
+                        }
+                    }
+                    else if (c == '"')
+                    {
+                        in_string = true;
+                    }
+                    else if (c == '[' || c == '{')
+                    {
+                        depth++;
+                    }
+                    else if ((c == ']' || c == '}') && --depth == 0)
+                    {
+                        return message.substr(arguments_start, i + 1 - arguments_start);
+                    }
+                }
+
+                return "null";
+            }
+        };
+
+        std::shared_ptr<signalr::hub_connection_impl> create_hub_connection(const std::shared_ptr<echo_server>& server)
+        {
+            auto websocket_client = create_test_websocket_client(
+                /* receive function */ [server]() { return server->receive(); },
+                /* send function */ [server](const std::string& message)
+                {
+                    server->on_message_sent(message);
+                    return pplx::task_from_result();
+                },
+                /* connect function */ [](const std::string&) { return pplx::task_from_result(); },
+                /* close function */ [server]()
+                {
+                    server->close();
+                    return pplx::task_from_result();
+                });
+
+            return signalr::hub_connection_impl::create("http://benchmark", signalr::trace_level::none,
+                std::make_shared<signalr::trace_log_writer>(), create_test_web_request_factory(),
+                std::make_unique<test_transport_factory>(websocket_client));
+        }
+
+        // frames are pushed by the server as fast as possible and counted by the handler, so the result is the time
+        // spent per received hub message
+        void run_process_message(size_t frames_per_message)
+        {
+            const size_t frame_count = 64000;
+            const auto message_count = frame_count / frames_per_message;
+
+            auto server = std::make_shared<echo_server>();
+            auto hub_connection = create_hub_connection(server);
+
+            std::atomic<size_t> frames_received(0);
+            signalr::event all_frames_received;
+            hub_connection->on_serialized("tick", [&frames_received, &all_frames_received, frame_count](const std::string&)
+            {
+                if (++frames_received == frame_count)
+                {
+                    all_frames_received.set();
+                }
+            });
+
+            hub_connection->start().get();
+
+            std::string message;
+            for (size_t i = 0; i < frames_per_message; i++)
+            {
+                message.append("{\"type\":1,\"target\":\"tick\",\"arguments\":[42,\"MSFT\",30.74]}\x1e");
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < message_count; i++)
+            {
+                server->push(message);
+            }
+
+            all_frames_received.wait(60000);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            report(std::string("hub_connection/process_message/").append(std::to_string(frames_per_message)).append("_frames_per_message"),
+                1, static_cast<double>(frames_received.load()), elapsed);
+
+            hub_connection->stop().get();
+        }
+    }
+
+    void run_hub_connection_benchmarks()
+    {
+        const size_t frames_per_message[] = { 1, 16, 64 };
+        for (auto frames : frames_per_message)
+        {
+            run_process_message(frames);
+        }
+
+        {
+            auto server = std::make_shared<echo_server>();
+            auto hub_connection = create_hub_connection(server);
+            hub_connection->start().get();
+
+            // the transport completes sends synchronously so this is the cost of writing and queueing the invocation
+            auto arguments = web::json::value::array();
+            arguments[0] = web::json::value::number(42);
+            arguments[1] = web::json::value::string(_XPLATSTR("MSFT"));
+            arguments[2] = web::json::value::number(30.74);
+            run("hub_connection/send/json_value_arguments", 1, iterations, [&hub_connection, &arguments](size_t)
+            {
+                hub_connection->send("method", arguments).get();
+            });
+
+            run("hub_connection/send/typed_arguments", 1, iterations, [&hub_connection](size_t)
+            {
+                hub_connection->send_serialized("method", signalr::details::serialize_arguments(42, std::string("MSFT"), 30.74)).get();
+            });
+
+            const size_t thread_counts[] = { 1, 4, 16 };
+            for (auto thread_count : thread_counts)
+            {
+                run("hub_connection/invoke/echo_round_trip/json_value_arguments", thread_count, iterations / thread_count,
+                    [&hub_connection, &arguments](size_t)
+                    {
+                        hub_connection->invoke("echo", arguments).get();
+                    });
+
+                run("hub_connection/invoke/echo_round_trip/typed_arguments", thread_count, iterations / thread_count,
+                    [&hub_connection](size_t)
+                    {
+                        hub_connection->invoke_serialized("echo",
+                            signalr::details::serialize_arguments(42, std::string("MSFT"), 30.74)).get();
+                    });
+            }
+
+            hub_connection->stop().get();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "benchmark.h"
+#include "json_hub_protocol.h"
+
+namespace benchmarks
+{
+    namespace
+    {
+        const size_t iterations = 20000;
+
+        // hub traffic recorded from the chat and stock ticker samples, record separators removed
+        const char* const recorded_messages[] =
+        {
+            "{\"type\":1,\"target\":\"broadcastMessage\",\"arguments\":[\"user42\",\"Hello everyone, the build is green again \\u2705\"]}",
+            "{\"type\":1,\"target\":\"updateStockPrice\",\"arguments\":[{\"symbol\":\"MSFT\",\"dayOpen\":30.31,\"dayLow\":30.05,\"dayHigh\":31.22,\"lastChange\":0.18,\"change\":0.43,\"percentChange\":0.0142,\"price\":30.74}]}",
+            "{\"type\":3,\"invocationId\":\"17\",\"result\":{\"id\":17,\"accepted\":true,\"tags\":[\"a\",\"b\",\"c\"],\"comment\":\"queued for processing\"}}",
+            "{\"type\":2,\"invocationId\":\"4\",\"item\":{\"sequence\":1024,\"values\":[0.1,0.2,0.3,0.4,0.5,0.6,0.7,0.8]}}",
+            "{\"type\":3,\"invocationId\":\"18\"}",
+            "{\"type\":6}",
+        };
+
+        void run_parse(const std::string& name, const std::function<void(const std::string&)>& parse)
+        {
+            std::vector<std::string> messages(std::begin(recorded_messages), std::end(recorded_messages));
+
+            run(name, 1, iterations, [&messages, &parse](size_t)
+            {
+                for (const auto& message : messages)
+                {
+                    parse(message);
+                }
+            });
+        }
+
+        void read_value(const signalr::hub_message& message)
+        {
+            switch (message.message_type)
+            {
+            case signalr::message_type::invocation:
+                static_cast<const signalr::hub_invocation_message&>(message).arguments.get();
+                break;
+            case signalr::message_type::stream_item:
+                static_cast<const signalr::stream_item_message&>(message).item.get();
+                break;
+            case signalr::message_type::completion:
+                static_cast<const signalr::completion_message&>(message).result.get();
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    void run_json_hub_protocol_benchmarks()
+    {
+        signalr::json_hub_protocol protocol;
+
+        // the DOM based parsing the on-demand reader replaced
+        run_parse("json_hub_protocol/parse/json_value", [](const std::string& message)
+        {
+            auto value = web::json::value::parse(utility::conversions::to_string_t(message));
+            value.at(_XPLATSTR("type")).as_integer();
+        });
+
+        // envelope only, as for messages without a handler or callback
+        run_parse("json_hub_protocol/parse/on_demand", [&protocol](const std::string& message)
+        {
+            protocol.parse_message(message.data(), message.size());
+        });
+
+        run_parse("json_hub_protocol/parse/on_demand_with_values", [&protocol](const std::string& message)
+        {
+            auto hub_message = protocol.parse_message(message.data(), message.size());
+            read_value(*hub_message);
+        });
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include "cpprest/json.h"
+
+namespace benchmarks
+{
+    // The mutex and string keyed map based callback_manager the slot table replaced. Kept as the baseline for the
+    // callback_manager benchmarks.
+    class legacy_callback_manager
+    {
+    public:
+        std::string register_callback(const std::function<void(const web::json::value&)>& callback)
+        {
+            auto callback_id = get_callback_id();
+
+            {
+                std::lock_guard<std::mutex> lock(m_map_lock);
+
+                m_callbacks.insert(std::make_pair(callback_id, callback));
+            }
+
+            return callback_id;
+        }
+
+        bool invoke_callback(const std::string& callback_id, const web::json::value& arguments, bool remove_callback)
+        {
+            std::function<void(const web::json::value& arguments)> callback;
+
+            {
+                std::lock_guard<std::mutex> lock(m_map_lock);
+
+                auto iter = m_callbacks.find(callback_id);
+                if (iter == m_callbacks.end())
+                {
+                    return false;
+                }
+
+                callback = iter->second;
+
+                if (remove_callback)
+                {
+                    m_callbacks.erase(callback_id);
+                }
+            }
+
+            callback(arguments);
+            return true;
+        }
+
+    private:
+        std::atomic<int> m_id { 0 };
+        std::unordered_map<std::string, std::function<void(const web::json::value&)>> m_callbacks;
+        std::mutex m_map_lock;
+
+        std::string get_callback_id()
+        {
+            const auto callback_id = m_id++;
+            std::stringstream ss;
+            ss << callback_id;
+            return ss.str();
+        }
+    };
+}
@@ -0,0 +1,48 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "benchmark.h"
+#include "logger.h"
+
+namespace benchmarks
+{
+    namespace
+    {
+        const size_t iterations = 200000;
+
+        // isolates the cost of formatting the entry from the cost of writing it
+        class discarding_log_writer : public signalr::log_writer
+        {
+        public:
+            void __cdecl write(const std::string&) override
+            { }
+        };
+    }
+
+    void run_logger_benchmarks()
+    {
+        const auto log_writer = std::make_shared<discarding_log_writer>();
+        const std::string message("processing message: {\"type\":1,\"target\":\"tick\",\"arguments\":[42]}");
+
+        signalr::logger disabled(log_writer, signalr::trace_level::none);
+        run("logger/log/disabled", 1, iterations, [&disabled, &message](size_t)
+        {
+            disabled.log(signalr::trace_level::messages, message);
+        });
+
+        // what call sites guarding expensive entries with is_enabled pay when logging is off
+        run("logger/is_enabled/disabled", 1, iterations, [&disabled](size_t)
+        {
+            if (disabled.is_enabled(signalr::trace_level::messages))
+            {
+                disabled.log(signalr::trace_level::messages, "unreachable");
+            }
+        });
+
+        signalr::logger enabled(log_writer, signalr::trace_level::all);
+        run("logger/log/enabled", 1, iterations, [&enabled, &message](size_t)
+        {
+            enabled.log(signalr::trace_level::messages, message);
+        });
+    }
+}
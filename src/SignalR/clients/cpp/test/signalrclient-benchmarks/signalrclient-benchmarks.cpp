@@ -0,0 +1,39 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include <cstdio>
+#include <cstring>
+#include "benchmark.h"
+
+namespace benchmarks
+{
+    void run_callback_manager_benchmarks();
+    void run_hub_connection_benchmarks();
+    void run_json_hub_protocol_benchmarks();
+    void run_logger_benchmarks();
+}
+
+// usage: signalrclient-benchmarks [--json]
+// --json prints one json object per benchmark instead of a table, for collecting results over time
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+        {
+            benchmarks::selected_output_format() = benchmarks::output_format::json;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    benchmarks::run_callback_manager_benchmarks();
+    benchmarks::run_json_hub_protocol_benchmarks();
+    benchmarks::run_logger_benchmarks();
+    benchmarks::run_hub_connection_benchmarks();
+
+    return 0;
+}
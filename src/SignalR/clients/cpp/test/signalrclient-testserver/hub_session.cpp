@@ -0,0 +1,376 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "hub_session.h"
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include "test_server.h"
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+
+namespace testserver
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        const char record_separator = '\x1e';
+        // half of the default server timeout of the client
+        const std::chrono::seconds ping_interval(15);
+
+        std::string to_message(const web::json::value& value)
+        {
+            return utility::conversions::to_utf8string(value.serialize()).append(1, record_separator);
+        }
+
+        std::string get_string(const web::json::value& object, const utility::char_t* field)
+        {
+            return object.has_field(field) && object.at(field).is_string()
+                ? utility::conversions::to_utf8string(object.at(field).as_string())
+                : std::string();
+        }
+
+        // hub methods are case insensitive
+        std::string to_lower(std::string value)
+        {
+            std::transform(value.begin(), value.end(), value.begin(), [](char c)
+            {
+                return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            });
+
+            return value;
+        }
+    }
+
+    hub_session::hub_session(asio::ip::tcp::socket socket, hub_type hub, const std::shared_ptr<test_server>& server)
+        : m_websocket(std::move(socket)), m_hub(hub), m_server(server), m_handshake_received(false),
+        m_ping_timer(m_websocket.get_executor()), m_closed(false)
+    { }
+
+    void hub_session::run(http::request<http::string_body> upgrade_request)
+    {
+        m_websocket.text(true);
+        m_websocket.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        m_websocket.async_accept(upgrade_request, beast::bind_front_handler(&hub_session::on_accept, shared_from_this()));
+    }
+
+    void hub_session::send(std::string message)
+    {
+        auto session = shared_from_this();
+        auto shared_message = std::make_shared<std::string>(std::move(message));
+        asio::post(m_websocket.get_executor(), [session, shared_message]()
+        {
+            session->queue_message(std::move(*shared_message));
+        });
+    }
+
+    void hub_session::abort()
+    {
+        auto session = shared_from_this();
+        asio::post(m_websocket.get_executor(), [session]()
+        {
+            beast::get_lowest_layer(session->m_websocket).close();
+        });
+    }
+
+    void hub_session::on_accept(beast::error_code error)
+    {
+        if (error)
+        {
+            return;
+        }
+
+        m_server->add_session(m_hub, shared_from_this());
+        schedule_ping();
+        read();
+    }
+
+    void hub_session::read()
+    {
+        m_websocket.async_read(m_read_buffer, beast::bind_front_handler(&hub_session::on_read, shared_from_this()));
+    }
+
+    void hub_session::on_read(beast::error_code error, size_t)
+    {
+        if (error)
+        {
+            close();
+            return;
+        }
+
+        m_partial_message.append(beast::buffers_to_string(m_read_buffer.data()));
+        m_read_buffer.consume(m_read_buffer.size());
+
+        // a frame may hold several messages and a message may span frames
+        size_t start = 0;
+        for (auto end = m_partial_message.find(record_separator); end != std::string::npos;
+            end = m_partial_message.find(record_separator, start))
+        {
+            process_message(m_partial_message.substr(start, end - start));
+            start = end + 1;
+        }
+
+        m_partial_message.erase(0, start);
+
+        if (!m_closed)
+        {
+            read();
+        }
+    }
+
+    void hub_session::queue_message(std::string message)
+    {
+        if (m_closed)
+        {
+            return;
+        }
+
+        // only one write may be in progress at a time
+        m_write_queue.push_back(std::move(message));
+        if (m_write_queue.size() == 1)
+        {
+            write_next();
+        }
+    }
+
+    void hub_session::write_next()
+    {
+        m_websocket.async_write(asio::buffer(m_write_queue.front()),
+            beast::bind_front_handler(&hub_session::on_write, shared_from_this()));
+    }
+
+    void hub_session::on_write(beast::error_code error, size_t)
+    {
+        if (error)
+        {
+            close();
+            return;
+        }
+
+        // the queue is kept when the session closes since the buffer of a write in progress must stay valid
+        m_write_queue.pop_front();
+        if (!m_closed && !m_write_queue.empty())
+        {
+            write_next();
+        }
+    }
+
+    void hub_session::schedule_ping()
+    {
+        auto session = shared_from_this();
+
+        m_ping_timer.expires_after(ping_interval);
+        m_ping_timer.async_wait([session](beast::error_code error)
+        {
+            if (!error && !session->m_closed)
+            {
+                session->queue_message(std::string("{\"type\":6}").append(1, record_separator));
+                session->schedule_ping();
+            }
+        });
+    }
+
+    void hub_session::close()
+    {
+        if (m_closed)
+        {
+            return;
+        }
+
+        m_closed = true;
+        m_ping_timer.cancel();
+        for (auto& stream : m_streams)
+        {
+            stream.second->cancel();
+        }
+        m_streams.clear();
+
+        m_server->remove_session(m_hub, this);
+
+        beast::error_code ignored;
+        beast::get_lowest_layer(m_websocket).socket().shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+    }
+
+    void hub_session::process_message(const std::string& message)
+    {
+        web::json::value value;
+        try
+        {
+            value = web::json::value::parse(utility::conversions::to_string_t(message));
+        }
+        catch (const std::exception&)
+        {
+            close();
+            return;
+        }
+
+        if (!m_handshake_received)
+        {
+            process_handshake(value);
+            return;
+        }
+
+        const auto type = value.has_field(_XPLATSTR("type")) ? value.at(_XPLATSTR("type")).as_integer() : 0;
+        switch (type)
+        {
+        case 1:
+            process_invocation(value);
+            break;
+        case 4:
+            process_stream_invocation(value);
+            break;
+        case 5:
+        {
+            // cancels a stream, other invocations complete right away so there is nothing to cancel
+            auto stream = m_streams.find(get_string(value, _XPLATSTR("invocationId")));
+            if (stream != m_streams.end())
+            {
+                stream->second->cancel();
+                m_streams.erase(stream);
+            }
+            break;
+        }
+        case 6:
+            break;
+        case 7:
+            close();
+            break;
+        default:
+            // stream items and completions of client streams are not used by the hubs
+            break;
+        }
+    }
+
+    void hub_session::process_handshake(const web::json::value& handshake)
+    {
+        m_handshake_received = true;
+
+        if (get_string(handshake, _XPLATSTR("protocol")) != "json")
+        {
+            queue_message(std::string("{\"error\":\"only the json protocol is supported\"}").append(1, record_separator));
+            return;
+        }
+
+        queue_message(std::string("{}").append(1, record_separator));
+    }
+
+    void hub_session::process_invocation(const web::json::value& invocation)
+    {
+        const auto invocation_id = get_string(invocation, _XPLATSTR("invocationId"));
+        const auto target = to_lower(get_string(invocation, _XPLATSTR("target")));
+        const auto arguments = invocation.has_field(_XPLATSTR("arguments"))
+            ? invocation.at(_XPLATSTR("arguments"))
+            : web::json::value::array();
+
+        // lets clients exercise reconnecting, the connection is dropped without completing the invocation
+        if (target == "abort")
+        {
+            beast::get_lowest_layer(m_websocket).close();
+            return;
+        }
+
+        switch (m_hub)
+        {
+        case hub_type::echo:
+        {
+            const auto& result = arguments.size() == 1 ? arguments.at(0) : arguments;
+            send_completion(invocation_id, &result, "");
+            break;
+        }
+        case hub_type::broadcast:
+        {
+            auto message = web::json::value::object();
+            message[_XPLATSTR("type")] = web::json::value::number(1);
+            message[_XPLATSTR("target")] = invocation.at(_XPLATSTR("target"));
+            message[_XPLATSTR("arguments")] = arguments;
+            m_server->broadcast(m_hub, to_message(message));
+
+            send_completion(invocation_id, nullptr, "");
+            break;
+        }
+        case hub_type::streaming:
+            send_completion(invocation_id, nullptr, "the streaming hub only has the 'counter' stream");
+            break;
+        }
+    }
+
+    void hub_session::process_stream_invocation(const web::json::value& invocation)
+    {
+        const auto invocation_id = get_string(invocation, _XPLATSTR("invocationId"));
+        const auto target = to_lower(get_string(invocation, _XPLATSTR("target")));
+        const auto arguments = invocation.has_field(_XPLATSTR("arguments"))
+            ? invocation.at(_XPLATSTR("arguments"))
+            : web::json::value::array();
+
+        if (m_hub != hub_type::streaming || target != "counter" || arguments.size() != 2 ||
+            !arguments.at(0).is_integer() || !arguments.at(1).is_integer())
+        {
+            send_completion(invocation_id, nullptr, "streams are counter(count, interval_ms) on the streaming hub");
+            return;
+        }
+
+        m_streams[invocation_id] = std::make_shared<asio::steady_timer>(m_websocket.get_executor());
+        send_stream_item(invocation_id, 0, arguments.at(0).as_integer(),
+            std::chrono::milliseconds((std::max)(arguments.at(1).as_integer(), 0)));
+    }
+
+    void hub_session::send_stream_item(const std::string& invocation_id, int item, int count, std::chrono::milliseconds interval)
+    {
+        auto stream = m_streams.find(invocation_id);
+        if (stream == m_streams.end())
+        {
+            // canceled
+            return;
+        }
+
+        if (item >= count)
+        {
+            m_streams.erase(stream);
+            send_completion(invocation_id, nullptr, "");
+            return;
+        }
+
+        auto message = web::json::value::object();
+        message[_XPLATSTR("type")] = web::json::value::number(2);
+        message[_XPLATSTR("invocationId")] = web::json::value::string(utility::conversions::to_string_t(invocation_id));
+        message[_XPLATSTR("item")] = web::json::value::number(item);
+        queue_message(to_message(message));
+
+        // without an interval the items are sent as fast as the socket accepts them, still yielding to other work
+        auto session = shared_from_this();
+        auto timer = stream->second;
+        timer->expires_after(interval);
+        timer->async_wait([session, invocation_id, item, count, interval](beast::error_code error)
+        {
+            if (!error)
+            {
+                session->send_stream_item(invocation_id, item + 1, count, interval);
+            }
+        });
+    }
+
+    // an empty invocation id means the client does not expect a completion
+    void hub_session::send_completion(const std::string& invocation_id, const web::json::value* result, const std::string& error)
+    {
+        if (invocation_id.empty())
+        {
+            return;
+        }
+
+        auto message = web::json::value::object();
+        message[_XPLATSTR("type")] = web::json::value::number(3);
+        message[_XPLATSTR("invocationId")] = web::json::value::string(utility::conversions::to_string_t(invocation_id));
+        if (!error.empty())
+        {
+            message[_XPLATSTR("error")] = web::json::value::string(utility::conversions::to_string_t(error));
+        }
+        else if (result != nullptr)
+        {
+            message[_XPLATSTR("result")] = *result;
+        }
+
+        queue_message(to_message(message));
+    }
+}
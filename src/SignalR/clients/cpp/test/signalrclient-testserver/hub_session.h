@@ -0,0 +1,77 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include "cpprest/json.h"
+
+namespace testserver
+{
+    class test_server;
+
+    enum class hub_type
+    {
+        // every invocation completes with its argument, or with all arguments if there are several
+        echo,
+        // invocations are sent to all connections of the hub
+        broadcast,
+        // `counter(count, interval_ms)` streams the numbers from 0 to count - 1
+        streaming
+    };
+
+    // A connection to a hub speaking the json hub protocol over a WebSocket. All handlers run on the strand of the
+    // socket so the session state needs no locking - other threads post to the strand.
+    class hub_session : public std::enable_shared_from_this<hub_session>
+    {
+    public:
+        hub_session(boost::asio::ip::tcp::socket socket, hub_type hub, const std::shared_ptr<test_server>& server);
+
+        hub_session(const hub_session&) = delete;
+        hub_session& operator=(const hub_session&) = delete;
+
+        void run(boost::beast::http::request<boost::beast::http::string_body> upgrade_request);
+
+        // may be called from any thread, `message` has to include the record separator
+        void send(std::string message);
+        // closes the socket without a close message, as if the network failed
+        void abort();
+
+    private:
+        boost::beast::websocket::stream<boost::beast::tcp_stream> m_websocket;
+        const hub_type m_hub;
+        const std::shared_ptr<test_server> m_server;
+        boost::beast::flat_buffer m_read_buffer;
+        // data of a message split across WebSocket frames
+        std::string m_partial_message;
+        bool m_handshake_received;
+        std::deque<std::string> m_write_queue;
+        boost::asio::steady_timer m_ping_timer;
+        // timers of the streams in progress by invocation id, removed when the stream completes or is canceled
+        std::unordered_map<std::string, std::shared_ptr<boost::asio::steady_timer>> m_streams;
+        bool m_closed;
+
+        void on_accept(boost::beast::error_code error);
+        void read();
+        void on_read(boost::beast::error_code error, size_t bytes_transferred);
+        void write_next();
+        void on_write(boost::beast::error_code error, size_t bytes_transferred);
+        void schedule_ping();
+        void close();
+
+        void process_message(const std::string& message);
+        void process_handshake(const web::json::value& handshake);
+        void process_invocation(const web::json::value& invocation);
+        void process_stream_invocation(const web::json::value& invocation);
+        void send_stream_item(const std::string& invocation_id, int item, int count, std::chrono::milliseconds interval);
+        void queue_message(std::string message);
+        void send_completion(const std::string& invocation_id, const web::json::value* result, const std::string& error);
+    };
+}
@@ -0,0 +1,82 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include "test_server.h"
+
+// usage: signalrclient-testserver [port=42524] [threads=<cores>] [abort_interval_ms=0]
+//   port               the port to listen on, on localhost only
+//   threads            the number of threads serving connections
+//   abort_interval_ms  drops all connections at this interval to exercise reconnecting, 0 disables it
+int main(int argc, char* argv[])
+{
+    unsigned short port = 42524;
+    unsigned int thread_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+    long abort_interval_ms = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const auto separator = argument.find('=');
+        const auto name = argument.substr(0, separator);
+        const auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+        try
+        {
+            if (name == "port")
+            {
+                port = static_cast<unsigned short>(std::stoul(value));
+            }
+            else if (name == "threads")
+            {
+                thread_count = (std::max)(static_cast<unsigned int>(std::stoul(value)), 1u);
+            }
+            else if (name == "abort_interval_ms")
+            {
+                abort_interval_ms = std::stol(value);
+            }
+            else
+            {
+                throw std::invalid_argument(argument);
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "usage: " << argv[0] << " [port=42524] [threads=<cores>] [abort_interval_ms=0]" << std::endl;
+            return 1;
+        }
+    }
+
+    boost::asio::io_context io_context(static_cast<int>(thread_count));
+
+    auto server = testserver::test_server::create(io_context, port, std::chrono::milliseconds(abort_interval_ms));
+    server->start();
+
+    boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([&io_context](const boost::system::error_code&, int)
+    {
+        io_context.stop();
+    });
+
+    std::cout << "listening on http://localhost:" << port << "/ with the hubs /echo, /broadcast and /streaming" << std::endl;
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < thread_count; i++)
+    {
+        threads.push_back(std::thread([&io_context]() { io_context.run(); }));
+    }
+
+    io_context.run();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return 0;
+}
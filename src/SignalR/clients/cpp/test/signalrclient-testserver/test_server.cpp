@@ -0,0 +1,263 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "test_server.h"
+#include <iostream>
+#include <boost/asio/strand.hpp>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+
+namespace testserver
+{
+    // unnamed namespace makes it invisble outside this translation unit
+    namespace
+    {
+        bool try_get_hub(const std::string& path, hub_type& hub)
+        {
+            if (path == "/echo")
+            {
+                hub = hub_type::echo;
+            }
+            else if (path == "/broadcast")
+            {
+                hub = hub_type::broadcast;
+            }
+            else if (path == "/streaming")
+            {
+                hub = hub_type::streaming;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        // Serves the negotiate requests of a connection and hands the socket over to a hub session when the client
+        // upgrades to a WebSocket.
+        class http_session : public std::enable_shared_from_this<http_session>
+        {
+        public:
+            http_session(tcp::socket socket, const std::shared_ptr<test_server>& server)
+                : m_stream(std::move(socket)), m_server(server)
+            { }
+
+            void read()
+            {
+                m_request = {};
+                http::async_read(m_stream, m_buffer, m_request,
+                    beast::bind_front_handler(&http_session::on_read, shared_from_this()));
+            }
+
+        private:
+            beast::tcp_stream m_stream;
+            const std::shared_ptr<test_server> m_server;
+            beast::flat_buffer m_buffer;
+            http::request<http::string_body> m_request;
+            std::shared_ptr<http::response<http::string_body>> m_response;
+
+            void on_read(beast::error_code error, size_t)
+            {
+                if (error)
+                {
+                    // includes the client closing the connection between requests
+                    return;
+                }
+
+                const auto target = m_request.target().to_string();
+                auto path = target.substr(0, target.find('?'));
+                while (path.size() > 1 && path.back() == '/')
+                {
+                    path.pop_back();
+                }
+
+                hub_type hub;
+                if (websocket::is_upgrade(m_request))
+                {
+                    if (try_get_hub(path, hub))
+                    {
+                        auto session = std::make_shared<hub_session>(m_stream.release_socket(), hub, m_server);
+                        session->run(std::move(m_request));
+                        return;
+                    }
+
+                    respond(http::status::not_found, "text/plain", "unknown hub");
+                    return;
+                }
+
+                const std::string negotiate_suffix("/negotiate");
+                if (m_request.method() == http::verb::post && path.size() > negotiate_suffix.size() &&
+                    path.compare(path.size() - negotiate_suffix.size(), negotiate_suffix.size(), negotiate_suffix) == 0 &&
+                    try_get_hub(path.substr(0, path.size() - negotiate_suffix.size()), hub))
+                {
+                    respond(http::status::ok, "application/json", std::string("{\"connectionId\":\"")
+                        .append(m_server->create_connection_id())
+                        .append("\",\"availableTransports\":[{\"transport\":\"WebSockets\",\"transferFormats\":[\"Text\"]}]}"));
+                    return;
+                }
+
+                respond(http::status::not_found, "text/plain", "not found");
+            }
+
+            void respond(http::status status, const std::string& content_type, std::string body)
+            {
+                m_response = std::make_shared<http::response<http::string_body>>(status, m_request.version());
+                m_response->set(http::field::content_type, content_type);
+                m_response->keep_alive(m_request.keep_alive());
+                m_response->body() = std::move(body);
+                m_response->prepare_payload();
+
+                http::async_write(m_stream, *m_response,
+                    beast::bind_front_handler(&http_session::on_write, shared_from_this()));
+            }
+
+            void on_write(beast::error_code error, size_t)
+            {
+                if (error)
+                {
+                    return;
+                }
+
+                if (!m_response->keep_alive())
+                {
+                    beast::error_code ignored;
+                    m_stream.socket().shutdown(tcp::socket::shutdown_send, ignored);
+                    return;
+                }
+
+                read();
+            }
+        };
+    }
+
+    std::shared_ptr<test_server> test_server::create(asio::io_context& io_context, unsigned short port,
+        std::chrono::milliseconds abort_interval)
+    {
+        return std::shared_ptr<test_server>(new test_server(io_context, port, abort_interval));
+    }
+
+    test_server::test_server(asio::io_context& io_context, unsigned short port, std::chrono::milliseconds abort_interval)
+        : m_io_context(io_context), m_acceptor(io_context, tcp::endpoint(asio::ip::make_address("127.0.0.1"), port)),
+        m_abort_interval(abort_interval), m_abort_timer(io_context), m_next_connection_id(0)
+    { }
+
+    void test_server::start()
+    {
+        accept();
+
+        if (m_abort_interval.count() > 0)
+        {
+            schedule_abort();
+        }
+    }
+
+    void test_server::accept()
+    {
+        auto server = shared_from_this();
+
+        // each connection gets its own strand so sessions run concurrently when the server runs on several threads
+        m_acceptor.async_accept(asio::make_strand(m_io_context), [server](beast::error_code error, tcp::socket socket)
+        {
+            if (error)
+            {
+                std::cerr << "accept failed: " << error.message() << std::endl;
+            }
+            else
+            {
+                std::make_shared<http_session>(std::move(socket), server)->read();
+            }
+
+            server->accept();
+        });
+    }
+
+    void test_server::schedule_abort()
+    {
+        auto server = shared_from_this();
+
+        m_abort_timer.expires_after(m_abort_interval);
+        m_abort_timer.async_wait([server](beast::error_code error)
+        {
+            if (!error)
+            {
+                server->abort_sessions();
+                server->schedule_abort();
+            }
+        });
+    }
+
+    std::string test_server::create_connection_id()
+    {
+        return std::string("connection-").append(std::to_string(++m_next_connection_id));
+    }
+
+    void test_server::add_session(hub_type hub, const std::shared_ptr<hub_session>& session)
+    {
+        std::lock_guard<std::mutex> lock(m_sessions_lock);
+        m_sessions[static_cast<int>(hub)].push_back(session);
+    }
+
+    void test_server::remove_session(hub_type hub, const hub_session* session)
+    {
+        std::lock_guard<std::mutex> lock(m_sessions_lock);
+        auto& sessions = m_sessions[static_cast<int>(hub)];
+        for (auto it = sessions.begin(); it != sessions.end();)
+        {
+            auto current = it->lock();
+            if (!current || current.get() == session)
+            {
+                it = sessions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void test_server::broadcast(hub_type hub, const std::string& message)
+    {
+        std::vector<std::weak_ptr<hub_session>> sessions;
+
+        {
+            std::lock_guard<std::mutex> lock(m_sessions_lock);
+            sessions = m_sessions[static_cast<int>(hub)];
+        }
+
+        for (const auto& weak_session : sessions)
+        {
+            auto session = weak_session.lock();
+            if (session)
+            {
+                session->send(message);
+            }
+        }
+    }
+
+    void test_server::abort_sessions()
+    {
+        std::vector<std::weak_ptr<hub_session>> sessions;
+
+        {
+            std::lock_guard<std::mutex> lock(m_sessions_lock);
+            for (const auto& hub_sessions : m_sessions)
+            {
+                sessions.insert(sessions.end(), hub_sessions.begin(), hub_sessions.end());
+            }
+        }
+
+        for (const auto& weak_session : sessions)
+        {
+            auto session = weak_session.lock();
+            if (session)
+            {
+                session->abort();
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include "hub_session.h"
+
+namespace testserver
+{
+    // Stand-in for the SignalR server used to test the client end to end without .NET. Serves the echo, broadcast and
+    // streaming hubs at /echo, /broadcast and /streaming with the negotiate endpoint and the WebSockets transport
+    // only. It can drop all connections at an interval to exercise reconnecting under load.
+    class test_server : public std::enable_shared_from_this<test_server>
+    {
+    public:
+        static std::shared_ptr<test_server> create(boost::asio::io_context& io_context, unsigned short port,
+            std::chrono::milliseconds abort_interval);
+
+        test_server(const test_server&) = delete;
+        test_server& operator=(const test_server&) = delete;
+
+        void start();
+
+        void add_session(hub_type hub, const std::shared_ptr<hub_session>& session);
+        void remove_session(hub_type hub, const hub_session* session);
+        void broadcast(hub_type hub, const std::string& message);
+        void abort_sessions();
+        std::string create_connection_id();
+
+    private:
+        test_server(boost::asio::io_context& io_context, unsigned short port, std::chrono::milliseconds abort_interval);
+
+        boost::asio::io_context& m_io_context;
+        boost::asio::ip::tcp::acceptor m_acceptor;
+        const std::chrono::milliseconds m_abort_interval;
+        boost::asio::steady_timer m_abort_timer;
+        std::atomic<unsigned long long> m_next_connection_id;
+        std::mutex m_sessions_lock;
+        std::vector<std::weak_ptr<hub_session>> m_sessions[3];
+
+        void accept();
+        void schedule_abort();
+    };
+}
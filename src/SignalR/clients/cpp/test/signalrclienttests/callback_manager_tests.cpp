@@ -2,33 +2,37 @@
 // Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
 
 #include "stdafx.h"
+#include <thread>
 #include "callback_manager.h"
+#include "signalrclient/signalr_exception.h"
 
 using namespace signalr;
-using namespace web;
 
 TEST(callback_manager_register_callback, register_returns_unique_callback_ids)
 {
-    callback_manager callback_mgr{ json::value::object() };
-    auto callback_id1 = callback_mgr.register_callback([](const json::value&){});
-    auto callback_id2 = callback_mgr.register_callback([](const web::json::value&){});
+    callback_manager callback_mgr{ "" };
+    auto callback_id1 = callback_mgr.register_callback([](const invocation_result&){});
+    auto callback_id2 = callback_mgr.register_callback([](const invocation_result&){});
 
     ASSERT_NE(callback_id1, callback_id2);
 }
 
 TEST(callback_manager_invoke_callback, invoke_callback_invokes_and_removes_callback_if_remove_callback_true)
 {
-    callback_manager callback_mgr{ json::value::object() };
+    callback_manager callback_mgr{ "" };
 
     std::string callback_argument{ "" };
 
     auto callback_id = callback_mgr.register_callback(
-        [&callback_argument](const json::value& argument)
+        [&callback_argument](const invocation_result& result)
         {
-            callback_argument = utility::conversions::to_utf8string(argument.serialize());
+            callback_argument = result.value.serialized();
         });
 
-    auto callback_found = callback_mgr.invoke_callback(callback_id, json::value::number(42), true);
+    invocation_result result;
+    result.has_value = true;
+    result.value = lazy_json_value::from_text("42");
+    auto callback_found = callback_mgr.invoke_callback(callback_id, result, true);
 
     ASSERT_TRUE(callback_found);
     ASSERT_EQ("42", callback_argument);
@@ -37,17 +41,20 @@ TEST(callback_manager_invoke_callback, invoke_callback_invokes_and_removes_callb
 
 TEST(callback_manager_invoke_callback, invoke_callback_invokes_and_does_not_remove_callback_if_remove_callback_false)
 {
-    callback_manager callback_mgr{ json::value::object() };
+    callback_manager callback_mgr{ "" };
 
     std::string callback_argument{ "" };
 
     auto callback_id = callback_mgr.register_callback(
-        [&callback_argument](const json::value& argument)
+        [&callback_argument](const invocation_result& result)
     {
-        callback_argument = utility::conversions::to_utf8string(argument.serialize());
+        callback_argument = result.value.serialized();
     });
 
-    auto callback_found = callback_mgr.invoke_callback(callback_id, json::value::number(42), false);
+    invocation_result result;
+    result.has_value = true;
+    result.value = lazy_json_value::from_text("42");
+    auto callback_found = callback_mgr.invoke_callback(callback_id, result, false);
 
     ASSERT_TRUE(callback_found);
     ASSERT_EQ("42", callback_argument);
@@ -56,8 +63,8 @@ TEST(callback_manager_invoke_callback, invoke_callback_invokes_and_does_not_remo
 
 TEST(callback_manager_ivoke_callback, invoke_callback_returns_false_for_invalid_callback_id)
 {
-    callback_manager callback_mgr{ json::value::object() };
-    auto callback_found = callback_mgr.invoke_callback("42", json::value::object(), true);
+    callback_manager callback_mgr{ "" };
+    auto callback_found = callback_mgr.invoke_callback("42", invocation_result(), true);
 
     ASSERT_FALSE(callback_found);
 }
@@ -67,10 +74,10 @@ TEST(callback_manager_remove, remove_removes_callback_and_returns_true_for_valid
     auto callback_called = false;
 
     {
-        callback_manager callback_mgr{ json::value::object() };
+        callback_manager callback_mgr{ "" };
 
         auto callback_id = callback_mgr.register_callback(
-            [&callback_called](const json::value&)
+            [&callback_called](const invocation_result&)
         {
             callback_called = true;
         });
@@ -83,26 +90,27 @@ TEST(callback_manager_remove, remove_removes_callback_and_returns_true_for_valid
 
 TEST(callback_manager_remove, remove_returns_false_for_invalid_callback_id)
 {
-    callback_manager callback_mgr{ json::value::object() };
+    callback_manager callback_mgr{ "" };
     ASSERT_FALSE(callback_mgr.remove_callback("42"));
 }
 
 TEST(callback_manager_clear, clear_invokes_all_callbacks)
 {
-    callback_manager callback_mgr{ json::value::object() };
+    callback_manager callback_mgr{ "" };
     auto invocation_count = 0;
 
     for (auto i = 0; i < 10; i++)
     {
         callback_mgr.register_callback(
-            [&invocation_count](const json::value& argument)
+            [&invocation_count](const invocation_result& result)
         {
             invocation_count++;
-            ASSERT_EQ(_XPLATSTR("42"), argument.serialize());
+            ASSERT_EQ("42", result.error);
+            ASSERT_FALSE(result.has_value);
         });
     }
 
-    callback_mgr.clear(json::value::number(42));
+    callback_mgr.clear("42");
 
     ASSERT_EQ(10, invocation_count);
 }
@@ -113,14 +121,14 @@ TEST(callback_manager_dtor, clear_invokes_all_callbacks)
     bool parameter_correct = true;
 
     {
-        callback_manager callback_mgr{ json::value::number(42) };
+        callback_manager callback_mgr{ "42" };
         for (auto i = 0; i < 10; i++)
         {
             callback_mgr.register_callback(
-                [&invocation_count, &parameter_correct](const json::value& argument)
+                [&invocation_count, &parameter_correct](const invocation_result& result)
             {
                 invocation_count++;
-                parameter_correct &= argument.serialize() == _XPLATSTR("42");
+                parameter_correct &= result.error == "42";
             });
         }
     }
@@ -128,3 +136,120 @@ TEST(callback_manager_dtor, clear_invokes_all_callbacks)
     ASSERT_EQ(10, invocation_count);
     ASSERT_TRUE(parameter_correct);
 }
+
+TEST(callback_manager_invoke_callback, invoke_callback_returns_false_for_id_of_removed_callback_after_slot_reused)
+{
+    callback_manager callback_mgr{ "" };
+
+    auto first_called = false;
+    auto first_id = callback_mgr.register_callback([&first_called](const invocation_result&) { first_called = true; });
+    ASSERT_TRUE(callback_mgr.remove_callback(first_id));
+
+    auto second_called = false;
+    auto second_id = callback_mgr.register_callback([&second_called](const invocation_result&) { second_called = true; });
+
+    ASSERT_NE(first_id, second_id);
+    ASSERT_FALSE(callback_mgr.invoke_callback(first_id, invocation_result(), true));
+    ASSERT_FALSE(first_called);
+    ASSERT_FALSE(second_called);
+
+    ASSERT_TRUE(callback_mgr.invoke_callback(second_id, invocation_result(), true));
+    ASSERT_TRUE(second_called);
+}
+
+TEST(callback_manager_invoke_callback, invoke_callback_returns_false_for_malformed_callback_id)
+{
+    callback_manager callback_mgr{ "" };
+    callback_mgr.register_callback([](const invocation_result&) {});
+
+    ASSERT_FALSE(callback_mgr.invoke_callback("", invocation_result(), true));
+    ASSERT_FALSE(callback_mgr.invoke_callback("abc", invocation_result(), true));
+    ASSERT_FALSE(callback_mgr.invoke_callback("-0", invocation_result(), true));
+    ASSERT_FALSE(callback_mgr.invoke_callback("99999999999999999999999", invocation_result(), true));
+}
+
+TEST(callback_manager_register_callback, register_grows_table_when_all_slots_in_use)
+{
+    callback_manager callback_mgr{ "" };
+    std::vector<std::string> callback_ids;
+    auto invocation_count = 0;
+
+    for (auto i = 0; i < 1000; i++)
+    {
+        callback_ids.push_back(callback_mgr.register_callback([&invocation_count](const invocation_result&) { invocation_count++; }));
+    }
+
+    for (const auto& callback_id : callback_ids)
+    {
+        ASSERT_TRUE(callback_mgr.invoke_callback(callback_id, invocation_result(), true));
+    }
+
+    ASSERT_EQ(1000, invocation_count);
+}
+
+TEST(callback_manager_invoke_callback, callbacks_can_be_registered_and_invoked_concurrently)
+{
+    callback_manager callback_mgr{ "" };
+    std::atomic<int> invocation_count{ 0 };
+
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&callback_mgr, &invocation_count]()
+        {
+            for (auto i = 0; i < 1000; i++)
+            {
+                auto callback_id = callback_mgr.register_callback([&invocation_count](const invocation_result&) { invocation_count++; });
+                callback_mgr.invoke_callback(callback_id, invocation_result(), true);
+            }
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(4000, invocation_count.load());
+}
+
+TEST(callback_manager_clear, callbacks_invoked_by_clear_can_use_callback_manager)
+{
+    callback_manager callback_mgr{ "" };
+    auto nested_registered = false;
+
+    callback_mgr.register_callback([&callback_mgr, &nested_registered](const invocation_result&)
+    {
+        // would deadlock if clear held a lock while invoking callbacks
+        auto callback_id = callback_mgr.register_callback([](const invocation_result&) {});
+        nested_registered = callback_mgr.remove_callback(callback_id);
+    });
+
+    callback_mgr.clear("");
+
+    ASSERT_TRUE(nested_registered);
+}
+
+TEST(callback_manager_register_callback, register_throws_when_max_callbacks_reached)
+{
+    callback_manager callback_mgr{ "" };
+    std::vector<std::string> callback_ids;
+
+    for (size_t i = 0; i < callback_manager::max_callbacks; i++)
+    {
+        callback_ids.push_back(callback_mgr.register_callback([](const invocation_result&) {}));
+    }
+
+    try
+    {
+        callback_mgr.register_callback([](const invocation_result&) {});
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the maximum number of pending invocations (65536) has been reached", e.what());
+    }
+
+    ASSERT_TRUE(callback_mgr.remove_callback(callback_ids.back()));
+    callback_mgr.register_callback([](const invocation_result&) {});
+}
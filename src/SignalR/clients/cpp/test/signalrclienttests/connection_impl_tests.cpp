@@ -6,6 +6,7 @@
 #include "test_web_request_factory.h"
 #include "test_websocket_client.h"
 #include "test_transport_factory.h"
+#include "websocket_transport.h"
 #include "connection_impl.h"
 #include "signalrclient/trace_level.h"
 #include "trace_log_writer.h"
@@ -23,6 +24,57 @@ static std::shared_ptr<connection_impl> create_connection(std::shared_ptr<websoc
         std::make_unique<test_transport_factory>(websocket_client));
 }
 
+// records the transports the connection tries to start. Only the transports in `working_transports` connect
+// successfully. Websocket transports are used in place of all transports.
+class fallback_transport_factory : public transport_factory
+{
+public:
+    explicit fallback_transport_factory(const std::vector<transport_type>& working_transports)
+        : m_working_transports(working_transports)
+    { }
+
+    std::shared_ptr<transport> create_transport(transport_type transport_type, const logger& logger,
+        const signalr_client_config&, std::function<void(const message_buffer&)> process_message_callback,
+        std::function<void(const std::exception&)> error_callback) override
+    {
+        requested_transports.push_back(transport_type);
+
+        auto works = std::find(m_working_transports.begin(), m_working_transports.end(), transport_type) != m_working_transports.end();
+        auto connect_urls = this->connect_urls;
+        auto websocket_client = create_test_websocket_client(
+            /* receive function */ []() { return pplx::task_from_result(std::string("")); },
+            /* send function */ [](const std::string&) { return pplx::task_from_result(); },
+            /* connect function */ [works, connect_urls](const std::string& url)
+            {
+                connect_urls->push_back(url);
+                return works
+                    ? pplx::task_from_result()
+                    : pplx::task_from_exception<void>(std::runtime_error("connect failed"));
+            });
+
+        return websocket_transport::create([websocket_client]() { return websocket_client; }, logger, process_message_callback, error_callback);
+    }
+
+    std::vector<transport_type> requested_transports;
+    std::shared_ptr<std::vector<std::string>> connect_urls = std::make_shared<std::vector<std::string>>();
+
+private:
+    std::vector<transport_type> m_working_transports;
+};
+
+static std::unique_ptr<web_request_factory> create_negotiate_web_request_factory(const std::string& available_transports)
+{
+    return std::make_unique<test_web_request_factory>([available_transports](const std::string& url)
+    {
+        auto response_body =
+            url.find("/negotiate") != std::string::npos
+            ? "{ \"connectionId\" : \"f7707523-307d-4cba-9abf-3eef701241e8\", \"availableTransports\": [ " + available_transports + " ] }"
+            : "";
+
+        return std::unique_ptr<web_request>(new web_request_stub((unsigned short)200, "OK", response_body));
+    });
+}
+
 TEST(connection_impl_connection_state, initial_connection_state_is_disconnected)
 {
     auto connection =
@@ -369,7 +421,7 @@ TEST(connection_impl_start, start_fails_if_negotiate_response_has_error)
     }
 }
 
-TEST(connection_impl_start, start_fails_if_negotiate_response_does_not_have_websockets)
+TEST(connection_impl_start, start_fails_if_negotiate_response_does_not_have_supported_transports)
 {
     std::shared_ptr<log_writer> writer(std::make_shared<memory_log_writer>());
 
@@ -377,7 +429,7 @@ TEST(connection_impl_start, start_fails_if_negotiate_response_does_not_have_webs
     {
         auto response_body =
             url.find("/negotiate") != std::string::npos
-            ? "{ \"availableTransports\": [ { \"transport\": \"ServerSentEvents\", \"transferFormats\": [ \"Text\" ] } ] }"
+            ? "{ \"availableTransports\": [ { \"transport\": \"UnknownTransport\", \"transferFormats\": [ \"Text\" ] } ] }"
             : "";
 
         return std::unique_ptr<web_request>(new web_request_stub((unsigned short)200, "OK", response_body));
@@ -401,7 +453,7 @@ TEST(connection_impl_start, start_fails_if_negotiate_response_does_not_have_webs
     }
     catch (const signalr_exception & e)
     {
-        ASSERT_STREQ("The server does not support WebSockets which is currently the only transport supported by this client.", e.what());
+        ASSERT_STREQ("The server does not support any of the transports supported by this client.", e.what());
     }
 }
 
@@ -437,8 +489,163 @@ TEST(connection_impl_start, start_fails_if_negotiate_response_does_not_have_tran
     }
     catch (const signalr_exception & e)
     {
-        ASSERT_STREQ("The server does not support WebSockets which is currently the only transport supported by this client.", e.what());
+        ASSERT_STREQ("The server does not support any of the transports supported by this client.", e.what());
+    }
+}
+
+TEST(connection_impl_start, start_falls_back_to_next_transport_if_transport_cannot_be_started)
+{
+    auto transport_factory = new fallback_transport_factory({ transport_type::long_polling });
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            create_negotiate_web_request_factory(
+                "{ \"transport\": \"LongPolling\", \"transferFormats\": [ \"Text\", \"Binary\" ] }, "
+                "{ \"transport\": \"WebSockets\", \"transferFormats\": [ \"Text\", \"Binary\" ] }, "
+                "{ \"transport\": \"ServerSentEvents\", \"transferFormats\": [ \"Text\" ] }"),
+            std::unique_ptr<signalr::transport_factory>(transport_factory));
+
+    connection->start().get();
+
+    ASSERT_EQ(connection_state::connected, connection->get_connection_state());
+    ASSERT_EQ(std::vector<transport_type>(
+        { transport_type::websockets, transport_type::server_sent_events, transport_type::long_polling }),
+        transport_factory->requested_transports);
+}
+
+TEST(connection_impl_start, start_negotiates_new_connection_id_before_falling_back_to_next_transport)
+{
+    auto negotiate_count = std::make_shared<std::atomic<int>>(0);
+    auto web_request_factory = std::make_unique<test_web_request_factory>([negotiate_count](const std::string& url)
+    {
+        auto response_body = url.find("/negotiate") != std::string::npos
+            ? "{ \"connectionId\" : \"connection-" + std::to_string(++(*negotiate_count)) + "\", \"availableTransports\": [ "
+                "{ \"transport\": \"WebSockets\", \"transferFormats\": [ \"Text\", \"Binary\" ] }, "
+                "{ \"transport\": \"ServerSentEvents\", \"transferFormats\": [ \"Text\" ] } ] }"
+            : "";
+
+        return std::unique_ptr<web_request>(new web_request_stub((unsigned short)200, "OK", response_body));
+    });
+
+    auto transport_factory = new fallback_transport_factory({ transport_type::server_sent_events });
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            std::move(web_request_factory), std::unique_ptr<signalr::transport_factory>(transport_factory));
+
+    connection->start().get();
+
+    ASSERT_EQ(2, negotiate_count->load());
+    ASSERT_EQ("connection-2", connection->get_connection_id());
+    ASSERT_EQ(2U, transport_factory->connect_urls->size());
+    ASSERT_NE(std::string::npos, (*transport_factory->connect_urls)[0].find("id=connection-1"));
+    ASSERT_NE(std::string::npos, (*transport_factory->connect_urls)[1].find("id=connection-2"));
+}
+
+TEST(connection_impl_start, start_skips_transports_not_supporting_transfer_format)
+{
+    auto transport_factory = new fallback_transport_factory({ transport_type::long_polling });
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            create_negotiate_web_request_factory(
+                "{ \"transport\": \"WebSockets\", \"transferFormats\": [ \"Text\" ] }, "
+                "{ \"transport\": \"ServerSentEvents\", \"transferFormats\": [ \"Text\" ] }, "
+                "{ \"transport\": \"LongPolling\", \"transferFormats\": [ \"Text\", \"Binary\" ] }"),
+            std::unique_ptr<signalr::transport_factory>(transport_factory));
+
+    connection->start(transfer_format::binary).get();
+
+    ASSERT_EQ(connection_state::connected, connection->get_connection_state());
+    ASSERT_EQ(std::vector<transport_type>({ transport_type::long_polling }), transport_factory->requested_transports);
+}
+
+TEST(connection_impl_start, start_fails_if_no_transport_can_be_started)
+{
+    auto transport_factory = new fallback_transport_factory({});
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            create_negotiate_web_request_factory(
+                "{ \"transport\": \"WebSockets\", \"transferFormats\": [ \"Text\" ] }, "
+                "{ \"transport\": \"LongPolling\", \"transferFormats\": [ \"Text\" ] }"),
+            std::unique_ptr<signalr::transport_factory>(transport_factory));
+
+    try
+    {
+        connection->start().get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const std::exception& e)
+    {
+        ASSERT_STREQ("connect failed", e.what());
     }
+
+    ASSERT_EQ(connection_state::disconnected, connection->get_connection_state());
+    ASSERT_EQ(std::vector<transport_type>({ transport_type::websockets, transport_type::long_polling }),
+        transport_factory->requested_transports);
+}
+
+TEST(connection_impl_start, start_fails_if_no_transport_supports_transfer_format)
+{
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            create_negotiate_web_request_factory("{ \"transport\": \"ServerSentEvents\", \"transferFormats\": [ \"Text\" ] }"),
+            std::make_unique<fallback_transport_factory>(std::vector<transport_type>()));
+
+    try
+    {
+        connection->start(transfer_format::binary).get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("The server does not support the transfer format required by the selected hub protocol.", e.what());
+    }
+}
+
+TEST(connection_impl_start, start_connects_to_websockets_endpoint_without_negotiating_if_negotiation_skipped)
+{
+    auto requests_count = std::make_shared<std::atomic<int>>(0);
+    auto web_request_factory = std::make_unique<test_web_request_factory>([requests_count](const std::string&)
+    {
+        ++(*requests_count);
+        return std::unique_ptr<web_request>(new web_request_stub((unsigned short)404, "Not Found"));
+    });
+
+    auto connect_url = std::make_shared<std::string>();
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [](const std::string&) { return pplx::task_from_result(); },
+        /* connect function */ [connect_url](const std::string& url)
+        {
+            *connect_url = url;
+            return pplx::task_from_result();
+        });
+
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+            std::move(web_request_factory), std::make_unique<test_transport_factory>(websocket_client));
+
+    signalr_client_config config;
+    config.set_skip_negotiation(true);
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    ASSERT_EQ(connection_state::connected, connection->get_connection_state());
+    ASSERT_EQ(0, requests_count->load());
+    ASSERT_EQ(0U, connect_url->find("ws://")) << *connect_url;
+    ASSERT_EQ(std::string::npos, connect_url->find("id=")) << *connect_url;
+}
+
+TEST(connection_impl_start, start_logs_duration_of_start_phases)
+{
+    std::shared_ptr<log_writer> writer(std::make_shared<memory_log_writer>());
+    auto connection = create_connection(create_test_websocket_client(), writer, trace_level::info);
+
+    connection->start().get();
+
+    auto log_entries = std::dynamic_pointer_cast<memory_log_writer>(writer)->get_log_entries();
+    ASSERT_EQ(1U, filter_vector(log_entries, "negotiate request completed in ").size()) << dump_vector(log_entries);
+    ASSERT_EQ(1U, filter_vector(log_entries, "the WebSockets transport connected in ").size()) << dump_vector(log_entries);
+    ASSERT_EQ(1U, filter_vector(log_entries, "connection started in ").size()) << dump_vector(log_entries);
 }
 
 TEST(connection_impl_start, start_fails_if_negotiate_response_is_invalid)
@@ -741,6 +948,37 @@ TEST(connection_impl_start, start_fails_if_connect_request_times_out)
     }
 }
 
+TEST(connection_impl_start, start_fails_if_connect_request_exceeds_configured_timeout)
+{
+    pplx::task_completion_event<void> tce;
+    auto websocket_client = std::make_shared<test_websocket_client>();
+    websocket_client->set_connect_function([tce](const std::string&) mutable
+    {
+        return pplx::task<void>(tce);
+    });
+
+    auto connection =
+        connection_impl::create(create_uri(), trace_level::none, std::make_shared<trace_log_writer>(),
+        create_test_web_request_factory(), std::make_unique<test_transport_factory>(websocket_client));
+
+    signalr_client_config config;
+    config.set_transport_connect_timeout(std::chrono::milliseconds(50));
+    connection->set_client_config(config);
+
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        connection->start().get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const signalr_exception &e)
+    {
+        ASSERT_STREQ("transport timed out when trying to connect", e.what());
+    }
+
+    ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(5000));
+}
+
 TEST(connection_impl_process_response, process_response_logs_messages)
 {
     std::shared_ptr<log_writer> writer(std::make_shared<memory_log_writer>());
@@ -789,6 +1027,191 @@ TEST(connection_impl_send, message_sent)
     ASSERT_EQ(message, actual_message);
 }
 
+TEST(connection_impl_send, wait_for_send_capacity_completes_once_queued_messages_sent)
+{
+    pplx::task_completion_event<void> send_completed;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [send_completed](const std::string&)
+    {
+        return pplx::create_task(send_completed);
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_backpressure_threshold(10);
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    auto sent = connection->send("more than ten bytes");
+    auto capacity_available = connection->wait_for_send_capacity();
+    ASSERT_FALSE(capacity_available.is_done());
+    ASSERT_EQ(19U, connection->get_send_queue_high_water_mark());
+
+    send_completed.set();
+    sent.get();
+    capacity_available.get();
+    ASSERT_EQ(19U, connection->get_send_queue_high_water_mark());
+}
+
+TEST(connection_impl_send, batched_messages_sent_in_single_frame_on_flush)
+{
+    std::vector<std::string> sent_messages;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [&sent_messages](const std::string& message)
+    {
+        sent_messages.push_back(message);
+        return pplx::task_from_result();
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_batch_threshold(1024);
+    config.set_send_batch_window(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    auto first_send = connection->send("A\x1e");
+    auto second_send = connection->send("B\x1e");
+    ASSERT_TRUE(sent_messages.empty());
+
+    connection->flush().get();
+    first_send.get();
+    second_send.get();
+
+    ASSERT_EQ(1U, sent_messages.size());
+    ASSERT_EQ("A\x1e" "B\x1e", sent_messages[0]);
+}
+
+TEST(connection_impl_send, metrics_count_sent_messages_and_frames_per_batch)
+{
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [](const std::string&) { return pplx::task_from_result(); });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_batch_threshold(1024);
+    config.set_send_batch_window(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    auto first_send = connection->send("A\x1e");
+    auto second_send = connection->send("BC\x1e");
+    connection->flush().get();
+    first_send.get();
+    second_send.get();
+
+    auto metrics = connection->get_metrics();
+    ASSERT_EQ(2U, metrics.messages_sent);
+    ASSERT_EQ(5U, metrics.bytes_sent);
+    ASSERT_EQ(1U, metrics.frames_per_batch.count);
+    ASSERT_EQ(2U, metrics.frames_per_batch.max);
+    ASSERT_EQ(1U, metrics.send_latency.count);
+    ASSERT_EQ(0U, metrics.reconnects);
+}
+
+TEST(connection_impl_send, batch_sent_when_threshold_reached)
+{
+    std::vector<std::string> sent_messages;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [&sent_messages](const std::string& message)
+    {
+        sent_messages.push_back(message);
+        return pplx::task_from_result();
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_batch_threshold(4);
+    config.set_send_batch_window(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    connection->send("AB\x1e");
+    connection->send("CD\x1e").get();
+
+    ASSERT_EQ(1U, sent_messages.size());
+    ASSERT_EQ("AB\x1e" "CD\x1e", sent_messages[0]);
+}
+
+TEST(connection_impl_send, batch_sent_when_window_elapsed)
+{
+    std::vector<std::string> sent_messages;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [&sent_messages](const std::string& message)
+    {
+        sent_messages.push_back(message);
+        return pplx::task_from_result();
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_batch_threshold(1024);
+    config.set_send_batch_window(std::chrono::milliseconds(10));
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    connection->send("A\x1e").get();
+
+    ASSERT_EQ(1U, sent_messages.size());
+    ASSERT_EQ("A\x1e", sent_messages[0]);
+}
+
+TEST(connection_impl_send, batched_messages_fail_when_connection_stopped)
+{
+    std::vector<std::string> sent_messages;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [&sent_messages](const std::string& message)
+    {
+        sent_messages.push_back(message);
+        return pplx::task_from_result();
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_send_batch_threshold(1024);
+    config.set_send_batch_window(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    connection->start().get();
+
+    auto send_task = connection->send("A\x1e");
+    connection->stop().get();
+
+    try
+    {
+        send_task.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the connection was stopped before the message was sent", e.what());
+    }
+
+    ASSERT_TRUE(sent_messages.empty());
+}
+
 TEST(connection_impl_send, send_throws_if_connection_not_connected)
 {
     auto connection =
@@ -885,6 +1308,51 @@ TEST(connection_impl_set_message_received, callback_invoked_when_message_receive
     ASSERT_EQ("Test", *message);
 }
 
+TEST(connection_impl_set_message_received, message_buffers_can_be_kept_after_callback_returns)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+        mutable {
+        std::string responses[]
+        {
+            "Test",
+            "release",
+            "{}"
+        };
+
+        call_number = std::min(call_number + 1, 2);
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto connection = create_connection(websocket_client);
+
+    auto messages = std::make_shared<std::vector<message_buffer>>();
+
+    auto message_received_event = std::make_shared<event>();
+    connection->set_message_received([messages, message_received_event](const message_buffer& m)
+    {
+        if (m.str() != "{}")
+        {
+            messages->push_back(m);
+        }
+
+        if (m.str() == "release")
+        {
+            message_received_event->set();
+        }
+    });
+
+    connection->start().get();
+
+    ASSERT_FALSE(message_received_event->wait(5000));
+
+    ASSERT_EQ(2U, messages->size());
+    ASSERT_EQ("Test", (*messages)[0].str());
+    ASSERT_EQ("release", (*messages)[1].str());
+}
+
 TEST(connection_impl_set_message_received, exception_from_callback_caught_and_logged)
 {
     int call_number = -1;
@@ -1528,3 +1996,237 @@ TEST(connection_id, connection_id_reset_when_starting_connection)
 
     ASSERT_EQ("", connection->get_connection_id());
 }
+
+// fails the first receive once the test signals that the connection has started. Receiving succeeds afterwards
+static std::function<pplx::task<std::string>()> create_receive_function_losing_connection(const std::shared_ptr<event>& started_event)
+{
+    auto receive_count = std::make_shared<std::atomic<int>>(0);
+    return [receive_count, started_event]()
+    {
+        if ((*receive_count)++ == 0)
+        {
+            started_event->wait(5000);
+            return pplx::task_from_exception<std::string>(std::runtime_error("connection reset"));
+        }
+
+        return pplx::task_from_result(std::string("{ }\x1e"));
+    };
+}
+
+static signalr_client_config create_reconnect_config(unsigned int max_attempts)
+{
+    signalr_client_config config;
+    config.set_automatic_reconnect(true);
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(1));
+    config.set_reconnect_max_delay(std::chrono::milliseconds(10));
+    config.set_max_reconnect_attempts(max_attempts);
+    return config;
+}
+
+TEST(connection_impl_reconnect, connection_disconnected_when_transport_lost_without_automatic_reconnect)
+{
+    auto started_event = std::make_shared<event>();
+    auto websocket_client = create_test_websocket_client(create_receive_function_losing_connection(started_event));
+    auto connection = create_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    auto disconnected_event = std::make_shared<event>();
+    connection->set_disconnected([disconnected_event]() { disconnected_event->set(); });
+
+    connection->start().get();
+    started_event->set();
+
+    ASSERT_FALSE(disconnected_event->wait(5000));
+    ASSERT_EQ(connection_state::disconnected, connection->get_connection_state());
+}
+
+TEST(connection_impl_reconnect, connection_reconnects_when_transport_lost)
+{
+    auto started_event = std::make_shared<event>();
+    auto connect_count = std::make_shared<std::atomic<int>>(0);
+    auto websocket_client = create_test_websocket_client(
+        create_receive_function_losing_connection(started_event),
+        /* send function */ [](const std::string&) { return pplx::task_from_result(); },
+        /* connect function */ [connect_count](const std::string&)
+        {
+            (*connect_count)++;
+            return pplx::task_from_result();
+        });
+
+    std::shared_ptr<log_writer> writer(std::make_shared<memory_log_writer>());
+    auto connection = create_connection(websocket_client, writer, trace_level::state_changes);
+    connection->set_client_config(create_reconnect_config(10));
+
+    auto reconnecting_invoked = std::make_shared<std::atomic<bool>>(false);
+    auto reconnected_event = std::make_shared<event>();
+    connection->set_reconnecting([reconnecting_invoked]() { *reconnecting_invoked = true; });
+    connection->set_reconnected([reconnected_event]() { reconnected_event->set(); });
+
+    connection->start().get();
+    started_event->set();
+
+    ASSERT_FALSE(reconnected_event->wait(5000));
+    ASSERT_TRUE(*reconnecting_invoked);
+    ASSERT_EQ(2, *connect_count);
+    ASSERT_EQ(connection_state::connected, connection->get_connection_state());
+
+    auto log_entries = std::dynamic_pointer_cast<memory_log_writer>(writer)->get_log_entries();
+    ASSERT_EQ(4U, log_entries.size()) << dump_vector(log_entries);
+    ASSERT_EQ("[state change] connected -> reconnecting\n", remove_date_from_log_entry(log_entries[2]));
+    ASSERT_EQ("[state change] reconnecting -> connected\n", remove_date_from_log_entry(log_entries[3]));
+
+    connection->stop().get();
+}
+
+TEST(connection_impl_reconnect, reconnect_negotiates_with_redirected_url)
+{
+    std::vector<std::string> negotiate_urls;
+    std::mutex negotiate_urls_lock;
+
+    auto web_request_factory = std::make_unique<test_web_request_factory>([&negotiate_urls, &negotiate_urls_lock](const std::string& url)
+    {
+        {
+            std::lock_guard<std::mutex> lock(negotiate_urls_lock);
+            negotiate_urls.push_back(url);
+        }
+
+        auto response_body = url.find("redirected") != std::string::npos
+            ? "{\"connectionId\" : \"f7707523-307d-4cba-9abf-3eef701241e8\", "
+            "\"availableTransports\" : [ { \"transport\": \"WebSockets\", \"transferFormats\": [ \"Text\", \"Binary\" ] } ] }"
+            : "{ \"url\": \"http://redirected\", \"accessToken\": \"secret\" }";
+
+        return std::unique_ptr<web_request>(new web_request_stub((unsigned short)200, "OK", response_body));
+    });
+
+    auto started_event = std::make_shared<event>();
+    auto websocket_client = create_test_websocket_client(create_receive_function_losing_connection(started_event));
+
+    auto connection = connection_impl::create(create_uri(), trace_level::none, std::make_shared<memory_log_writer>(),
+        std::move(web_request_factory), std::make_unique<test_transport_factory>(websocket_client));
+    connection->set_client_config(create_reconnect_config(10));
+
+    auto reconnected_event = std::make_shared<event>();
+    connection->set_reconnected([reconnected_event]() { reconnected_event->set(); });
+
+    connection->start().get();
+    started_event->set();
+
+    ASSERT_FALSE(reconnected_event->wait(5000));
+    connection->stop().get();
+
+    std::lock_guard<std::mutex> lock(negotiate_urls_lock);
+    ASSERT_EQ(3U, negotiate_urls.size());
+    ASSERT_EQ(std::string::npos, negotiate_urls[0].find("redirected"));
+    ASSERT_EQ(0U, negotiate_urls[1].find("http://redirected/negotiate"));
+    ASSERT_EQ(0U, negotiate_urls[2].find("http://redirected/negotiate"));
+}
+
+TEST(connection_impl_reconnect, connection_disconnected_after_max_reconnect_attempts)
+{
+    auto started_event = std::make_shared<event>();
+    auto connect_count = std::make_shared<std::atomic<int>>(0);
+    auto websocket_client = create_test_websocket_client(
+        create_receive_function_losing_connection(started_event),
+        /* send function */ [](const std::string&) { return pplx::task_from_result(); },
+        /* connect function */ [connect_count](const std::string&)
+        {
+            // only the initial connect succeeds
+            if ((*connect_count)++ == 0)
+            {
+                return pplx::task_from_result();
+            }
+
+            return pplx::task_from_exception<void>(std::runtime_error("connecting failed"));
+        });
+
+    auto connection = create_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+    connection->set_client_config(create_reconnect_config(3));
+
+    auto disconnected_event = std::make_shared<event>();
+    auto reconnected_invoked = std::make_shared<std::atomic<bool>>(false);
+    connection->set_disconnected([disconnected_event]() { disconnected_event->set(); });
+    connection->set_reconnected([reconnected_invoked]() { *reconnected_invoked = true; });
+
+    connection->start().get();
+    started_event->set();
+
+    ASSERT_FALSE(disconnected_event->wait(5000));
+    ASSERT_EQ(4, *connect_count);
+    ASSERT_FALSE(*reconnected_invoked);
+    ASSERT_EQ(connection_state::disconnected, connection->get_connection_state());
+}
+
+TEST(connection_impl_reconnect, stop_while_reconnecting_disconnects)
+{
+    auto started_event = std::make_shared<event>();
+    auto websocket_client = create_test_websocket_client(create_receive_function_losing_connection(started_event));
+    auto connection = create_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    // long enough for the connection to still be waiting for the first attempt when stopped
+    auto config = create_reconnect_config(10);
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(60000));
+    config.set_reconnect_max_delay(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    auto reconnecting_event = std::make_shared<event>();
+    auto disconnected_invoked = std::make_shared<std::atomic<bool>>(false);
+    connection->set_reconnecting([reconnecting_event]() { reconnecting_event->set(); });
+    connection->set_disconnected([disconnected_invoked]() { *disconnected_invoked = true; });
+
+    connection->start().get();
+    started_event->set();
+
+    ASSERT_FALSE(reconnecting_event->wait(5000));
+    ASSERT_EQ(connection_state::reconnecting, connection->get_connection_state());
+
+    connection->stop().get();
+
+    ASSERT_TRUE(*disconnected_invoked);
+    ASSERT_EQ(connection_state::disconnected, connection->get_connection_state());
+}
+
+TEST(connection_impl_reconnect, attempt_scheduled_before_stop_does_not_run_after_restart)
+{
+    auto lose_connection = std::make_shared<std::atomic<bool>>(false);
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [lose_connection]()
+        {
+            if (lose_connection->exchange(false))
+            {
+                return pplx::task_from_exception<std::string>(std::runtime_error("connection reset"));
+            }
+
+            return pplx::task_from_result(std::string("{ }\x1e"));
+        });
+    auto connection = create_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    auto config = create_reconnect_config(10);
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(200));
+    config.set_reconnect_max_delay(std::chrono::milliseconds(200));
+    connection->set_client_config(config);
+
+    auto reconnecting_event = std::make_shared<event>();
+    connection->set_reconnecting([reconnecting_event]() { reconnecting_event->set(); });
+
+    connection->start().get();
+    *lose_connection = true;
+    ASSERT_FALSE(reconnecting_event->wait(5000));
+    connection->stop().get();
+
+    // the attempt of the restarted connection is not due before the test ends
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(60000));
+    config.set_reconnect_max_delay(std::chrono::milliseconds(60000));
+    connection->set_client_config(config);
+
+    reconnecting_event = std::make_shared<event>();
+    connection->set_reconnecting([reconnecting_event]() { reconnecting_event->set(); });
+
+    connection->start().get();
+    *lose_connection = true;
+    ASSERT_FALSE(reconnecting_event->wait(5000));
+
+    // the attempt scheduled before stopping would have been due by now
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    ASSERT_EQ(connection_state::reconnecting, connection->get_connection_state());
+
+    connection->stop().get();
+}
@@ -0,0 +1,53 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "event_stream_parser.h"
+
+using namespace signalr;
+
+TEST(event_stream_parser_parse, returns_data_of_complete_events)
+{
+    event_stream_parser parser;
+
+    auto events = parser.parse("data: message1\n\ndata: message2\r\n\r\n");
+
+    ASSERT_EQ(2U, events.size());
+    ASSERT_EQ("message1", events[0]);
+    ASSERT_EQ("message2", events[1]);
+}
+
+TEST(event_stream_parser_parse, keeps_incomplete_events_until_completed)
+{
+    event_stream_parser parser;
+
+    ASSERT_TRUE(parser.parse("da").empty());
+    ASSERT_TRUE(parser.parse("ta: mess").empty());
+    ASSERT_TRUE(parser.parse("age\r").empty());
+    ASSERT_TRUE(parser.parse("\n").empty());
+
+    auto events = parser.parse("\n");
+
+    ASSERT_EQ(1U, events.size());
+    ASSERT_EQ("message", events[0]);
+}
+
+TEST(event_stream_parser_parse, joins_data_lines_of_an_event)
+{
+    event_stream_parser parser;
+
+    auto events = parser.parse("data: line1\ndata:line2\ndata\ndata:  line4\n\n");
+
+    ASSERT_EQ(1U, events.size());
+    ASSERT_EQ("line1\nline2\n\n line4", events[0]);
+}
+
+TEST(event_stream_parser_parse, ignores_comments_and_other_fields)
+{
+    event_stream_parser parser;
+
+    auto events = parser.parse(":\n\nevent: update\nid: 1\ndatum: x\ndata: message\n: comment\nretry: 10\n\n\n");
+
+    ASSERT_EQ(1U, events.size());
+    ASSERT_EQ("message", events[0]);
+}
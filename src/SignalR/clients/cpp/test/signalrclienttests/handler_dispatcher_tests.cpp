@@ -0,0 +1,165 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <thread>
+#include "handler_dispatcher.h"
+#include "memory_log_writer.h"
+#include "event.h"
+
+using namespace signalr;
+
+namespace
+{
+    std::shared_ptr<handler_dispatcher> create_dispatcher(handler_dispatch_mode mode, size_t max_pending = 1024,
+        const std::shared_ptr<log_writer>& writer = std::make_shared<memory_log_writer>())
+    {
+        return handler_dispatcher::create(mode, [](const std::function<void()>& work) { std::thread(work).detach(); },
+            max_pending, logger(writer, trace_level::all));
+    }
+}
+
+TEST(handler_dispatcher, serial_mode_runs_handlers_in_order)
+{
+    auto dispatcher = create_dispatcher(handler_dispatch_mode::serial);
+    auto order = std::make_shared<std::vector<int>>();
+    auto done = std::make_shared<event>();
+
+    for (int i = 0; i < 100; i++)
+    {
+        // different keys must not matter in the serial mode
+        dispatcher->dispatch(reinterpret_cast<const void*>(static_cast<intptr_t>(i % 3 + 1)), [order, done, i]()
+        {
+            order->push_back(i);
+            if (i == 99)
+            {
+                done->set();
+            }
+        });
+    }
+
+    ASSERT_FALSE(done->wait(5000));
+    ASSERT_EQ(100U, order->size());
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(i, (*order)[i]);
+    }
+}
+
+TEST(handler_dispatcher, parallel_mode_runs_handlers_concurrently)
+{
+    auto dispatcher = create_dispatcher(handler_dispatch_mode::parallel);
+    auto first_started = std::make_shared<event>();
+    auto second_finished = std::make_shared<event>();
+    auto first_finished = std::make_shared<event>();
+
+    dispatcher->dispatch(nullptr, [first_started, second_finished, first_finished]()
+    {
+        first_started->set();
+        // only finishes if the second handler runs while this one is still running
+        if (!second_finished->wait(5000))
+        {
+            first_finished->set();
+        }
+    });
+
+    ASSERT_FALSE(first_started->wait(5000));
+    dispatcher->dispatch(nullptr, [second_finished]() { second_finished->set(); });
+
+    ASSERT_FALSE(first_finished->wait(5000));
+}
+
+TEST(handler_dispatcher, keyed_serial_mode_orders_handlers_per_key_only)
+{
+    auto dispatcher = create_dispatcher(handler_dispatch_mode::keyed_serial);
+    int first_key, second_key;
+    auto release_first_key = std::make_shared<event>();
+    auto second_key_ran = std::make_shared<event>();
+    auto order = std::make_shared<std::vector<int>>();
+    auto done = std::make_shared<event>();
+
+    dispatcher->dispatch(&first_key, [release_first_key, order]()
+    {
+        release_first_key->wait(5000);
+        order->push_back(1);
+    });
+    dispatcher->dispatch(&first_key, [order, done]()
+    {
+        order->push_back(2);
+        done->set();
+    });
+
+    // the second key is not blocked by the handler waiting on the first key
+    dispatcher->dispatch(&second_key, [second_key_ran]() { second_key_ran->set(); });
+    ASSERT_FALSE(second_key_ran->wait(5000));
+
+    release_first_key->set();
+    ASSERT_FALSE(done->wait(5000));
+    ASSERT_EQ(std::vector<int>({ 1, 2 }), *order);
+}
+
+TEST(handler_dispatcher, dispatch_blocks_while_max_pending_handlers_are_queued)
+{
+    auto dispatcher = create_dispatcher(handler_dispatch_mode::serial, 2);
+    auto release = std::make_shared<event>();
+    auto third_dispatched = std::make_shared<event>();
+
+    dispatcher->dispatch(nullptr, [release]() { release->wait(5000); });
+    dispatcher->dispatch(nullptr, []() {});
+    ASSERT_EQ(2U, dispatcher->pending());
+
+    std::thread producer([dispatcher, third_dispatched]()
+    {
+        dispatcher->dispatch(nullptr, []() {});
+        third_dispatched->set();
+    });
+
+    ASSERT_TRUE(third_dispatched->wait(100) != 0);
+
+    release->set();
+    ASSERT_FALSE(third_dispatched->wait(5000));
+    producer.join();
+}
+
+TEST(handler_dispatcher, exception_thrown_by_handler_is_logged_and_next_handler_runs)
+{
+    auto writer = std::make_shared<memory_log_writer>();
+    auto dispatcher = create_dispatcher(handler_dispatch_mode::serial, 1024, writer);
+    auto done = std::make_shared<event>();
+
+    dispatcher->dispatch(nullptr, []() { throw std::runtime_error("oops"); });
+    dispatcher->dispatch(nullptr, [done]() { done->set(); });
+
+    ASSERT_FALSE(done->wait(5000));
+
+    auto log_entries = writer->get_log_entries();
+    ASSERT_EQ(1U, log_entries.size());
+    ASSERT_NE(std::string::npos, log_entries[0].find("hub method handler threw an exception: oops"));
+}
+
+TEST(handler_dispatcher, handlers_rejected_by_executor_do_not_count_as_pending)
+{
+    handler_dispatch_mode modes[] = { handler_dispatch_mode::serial, handler_dispatch_mode::parallel,
+        handler_dispatch_mode::keyed_serial };
+
+    for (auto mode : modes)
+    {
+        auto writer = std::make_shared<memory_log_writer>();
+        auto dispatcher = handler_dispatcher::create(mode,
+            [](const std::function<void()>&) { throw std::runtime_error("executor is shut down"); },
+            2, logger(writer, trace_level::all));
+
+        // would block forever on the third call if rejected handlers kept counting against the maximum
+        for (int i = 0; i < 3; i++)
+        {
+            dispatcher->dispatch(nullptr, []() {});
+        }
+
+        ASSERT_EQ(0U, dispatcher->pending());
+
+        auto log_entries = writer->get_log_entries();
+        ASSERT_EQ(3U, log_entries.size());
+        ASSERT_NE(std::string::npos, log_entries[0].find(
+            "handler executor threw an exception, 1 hub method invocation was not handled: executor is shut down"));
+    }
+}
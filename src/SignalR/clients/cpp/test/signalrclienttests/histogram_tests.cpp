@@ -0,0 +1,101 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <thread>
+#include <vector>
+#include "histogram.h"
+
+using namespace signalr;
+
+TEST(histogram, snapshot_of_empty_histogram)
+{
+    histogram histogram;
+    auto snapshot = histogram.snapshot();
+
+    ASSERT_EQ(0U, snapshot.count);
+    ASSERT_EQ(0U, snapshot.sum);
+    ASSERT_EQ(0U, snapshot.min);
+    ASSERT_EQ(0U, snapshot.max);
+    ASSERT_TRUE(snapshot.buckets.empty());
+    ASSERT_EQ(0U, snapshot.value_at_percentile(50));
+}
+
+TEST(histogram, small_values_are_exact)
+{
+    histogram histogram;
+    for (uint64_t value = 0; value < 16; value++)
+    {
+        histogram.record(value);
+    }
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(16U, snapshot.count);
+    ASSERT_EQ(120U, snapshot.sum);
+    ASSERT_EQ(0U, snapshot.min);
+    ASSERT_EQ(15U, snapshot.max);
+    ASSERT_EQ(16U, snapshot.buckets.size());
+    for (uint64_t value = 0; value < 16; value++)
+    {
+        ASSERT_EQ(value, snapshot.buckets[value].first);
+        ASSERT_EQ(1U, snapshot.buckets[value].second);
+    }
+}
+
+TEST(histogram, large_values_are_within_bucket_precision)
+{
+    const uint64_t values[] = { 16, 17, 1000, 123456, 1ULL << 40, UINT64_MAX };
+
+    for (auto value : values)
+    {
+        histogram histogram;
+        histogram.record(value);
+
+        auto snapshot = histogram.snapshot();
+        ASSERT_EQ(1U, snapshot.buckets.size());
+        ASSERT_GE(snapshot.buckets[0].first, value);
+        ASSERT_LE(snapshot.buckets[0].first - value, value / 8);
+        ASSERT_EQ(value, snapshot.value_at_percentile(100));
+    }
+}
+
+TEST(histogram, value_at_percentile)
+{
+    histogram histogram;
+    for (uint64_t value = 1; value <= 100; value++)
+    {
+        histogram.record(value);
+    }
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(1U, snapshot.value_at_percentile(0));
+    ASSERT_EQ(51U, snapshot.value_at_percentile(50));
+    ASSERT_EQ(100U, snapshot.value_at_percentile(100));
+    ASSERT_LE(99U, snapshot.value_at_percentile(99));
+}
+
+TEST(histogram, concurrent_records_are_all_counted)
+{
+    histogram histogram;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&histogram, i]()
+        {
+            for (uint64_t value = 0; value < 10000; value++)
+            {
+                histogram.record(value * (i + 1));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(40000U, snapshot.count);
+    ASSERT_EQ(0U, snapshot.min);
+    ASSERT_EQ(39996U, snapshot.max);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "http_client_pool.h"
+
+using namespace signalr;
+using namespace web::http::client;
+
+TEST(http_client_pool_get_client, returns_same_client_for_same_base_url_and_config)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", signalr_client_config());
+    auto client2 = pool.get_client("http://fakeuri.org/connect?id=42", signalr_client_config());
+
+    ASSERT_EQ(client1, client2);
+    ASSERT_EQ(1U, pool.size());
+}
+
+TEST(http_client_pool_get_client, returns_different_clients_for_different_base_urls)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", signalr_client_config());
+    auto client2 = pool.get_client("http://fakeuri.org:8080/negotiate", signalr_client_config());
+    auto client3 = pool.get_client("https://fakeuri.org/negotiate", signalr_client_config());
+
+    ASSERT_NE(client1, client2);
+    ASSERT_NE(client1, client3);
+    ASSERT_NE(client2, client3);
+    ASSERT_EQ(3U, pool.size());
+}
+
+TEST(http_client_pool_get_client, returns_different_clients_for_different_configs)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    http_client_config http_config;
+    http_config.set_timeout(std::chrono::seconds(100));
+    signalr_client_config config;
+    config.set_http_client_config(http_config);
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", signalr_client_config());
+    auto client2 = pool.get_client("http://fakeuri.org/negotiate", config);
+
+    ASSERT_NE(client1, client2);
+    ASSERT_EQ(2U, pool.size());
+}
+
+TEST(http_client_pool_get_client, does_not_share_clients_using_credentials)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    signalr_client_config config;
+    config.set_credentials(web::credentials(_XPLATSTR("user"), _XPLATSTR("password")));
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", config);
+    auto client2 = pool.get_client("http://fakeuri.org/negotiate", config);
+
+    ASSERT_NE(client1, client2);
+    ASSERT_EQ(0U, pool.size());
+}
+
+TEST(http_client_pool_get_client, does_not_share_clients_using_oauth)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    http_client_config http_config;
+    web::http::oauth2::experimental::oauth2_config oauth2(_XPLATSTR("key"), _XPLATSTR("secret"),
+        _XPLATSTR("http://fakeuri.org/auth"), _XPLATSTR("http://fakeuri.org/token"), _XPLATSTR("http://fakeuri.org/"));
+    oauth2.set_token(web::http::oauth2::experimental::oauth2_token(_XPLATSTR("token")));
+    http_config.set_oauth2(oauth2);
+    signalr_client_config config;
+    config.set_http_client_config(http_config);
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", config);
+    auto client2 = pool.get_client("http://fakeuri.org/negotiate", config);
+
+    ASSERT_NE(client1, client2);
+    ASSERT_EQ(0U, pool.size());
+}
+
+TEST(http_client_pool_get_client, does_not_share_clients_if_pooling_disabled)
+{
+    http_client_pool pool(4, std::chrono::minutes(1));
+
+    signalr_client_config config;
+    config.set_http_client_pooling(false);
+
+    auto client1 = pool.get_client("http://fakeuri.org/negotiate", config);
+    auto client2 = pool.get_client("http://fakeuri.org/negotiate", config);
+
+    ASSERT_NE(client1, client2);
+    ASSERT_EQ(0U, pool.size());
+}
+
+TEST(http_client_pool_get_client, evicts_least_recently_used_client_when_full)
+{
+    http_client_pool pool(2, std::chrono::minutes(1));
+
+    auto client1 = pool.get_client("http://fakeuri1.org/", signalr_client_config());
+    auto client2 = pool.get_client("http://fakeuri2.org/", signalr_client_config());
+    ASSERT_EQ(client1, pool.get_client("http://fakeuri1.org/", signalr_client_config()));
+
+    pool.get_client("http://fakeuri3.org/", signalr_client_config());
+
+    ASSERT_EQ(2U, pool.size());
+    ASSERT_EQ(client1, pool.get_client("http://fakeuri1.org/", signalr_client_config()));
+    ASSERT_NE(client2, pool.get_client("http://fakeuri2.org/", signalr_client_config()));
+}
+
+TEST(http_client_pool_get_client, evicts_idle_clients)
+{
+    http_client_pool pool(4, std::chrono::milliseconds(10));
+
+    auto client = pool.get_client("http://fakeuri.org/", signalr_client_config());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    ASSERT_EQ(0U, pool.size());
+    ASSERT_NE(client, pool.get_client("http://fakeuri.org/", signalr_client_config()));
+}
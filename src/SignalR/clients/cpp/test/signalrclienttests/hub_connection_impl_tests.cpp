@@ -73,6 +73,25 @@ TEST(start, start_sends_handshake)
     ASSERT_EQ(connection_state::connected, hub_connection->get_connection_state());
 }
 
+TEST(start, start_sends_messagepack_handshake_when_messagepack_protocol_selected)
+{
+    auto message = std::make_shared<std::string>();
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [message](const std::string& msg) { *message = msg; return pplx::task_from_result(); });
+    auto hub_connection = create_hub_connection(websocket_client);
+
+    signalr_client_config config;
+    config.set_hub_protocol(hub_protocol_type::messagepack);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    ASSERT_EQ("{\"protocol\":\"messagepack\",\"version\":1}\x1e", *message);
+
+    ASSERT_EQ(connection_state::connected, hub_connection->get_connection_state());
+}
+
 TEST(start, start_waits_for_handshake_response)
 {
     pplx::task_completion_event<void> tce;
@@ -309,6 +328,213 @@ TEST(hub_invocation, hub_connection_invokes_users_code_on_hub_invocations)
     ASSERT_EQ("[\"message\",1]", *payload);
 }
 
+TEST(hub_invocation, hub_connection_passes_serialized_arguments_to_serialized_handlers)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+    mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 1, \"target\": \"broadcast\", \"arguments\": [ \"message\", 1 ] }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+
+    auto payload = std::make_shared<std::string>();
+    auto on_broadcast_event = std::make_shared<event>();
+    hub_connection->on_serialized("broadcast", [on_broadcast_event, payload](const std::string& arguments)
+    {
+        *payload = arguments;
+        on_broadcast_event->set();
+    });
+
+    hub_connection->start().get();
+    ASSERT_FALSE(on_broadcast_event->wait(5000));
+
+    // the arguments are passed as received
+    ASSERT_EQ("[ \"message\", 1 ]", *payload);
+}
+
+TEST(hub_invocation, hub_connection_invokes_users_code_for_messages_split_across_frames)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+    mutable {
+        std::string responses[]
+        {
+            "{ }\x1e{ \"type\": 1, \"target\": \"BROAD",
+            "cast\", \"arguments\": [ \"mess",
+            "age\", 1 ] }\x1e",
+            ""
+        };
+
+        call_number = std::min(call_number + 1, 3);
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+
+    auto payload = std::make_shared<std::string>();
+    auto on_broadcast_event = std::make_shared<event>();
+    hub_connection->on("broadCAST", [on_broadcast_event, payload](const json::value& message)
+    {
+        *payload = utility::conversions::to_utf8string(message.serialize());
+        on_broadcast_event->set();
+    });
+
+    hub_connection->start().get();
+    ASSERT_FALSE(on_broadcast_event->wait(5000));
+
+    ASSERT_EQ("[\"message\",1]", *payload);
+}
+
+TEST(hub_invocation, malformed_message_does_not_prevent_processing_remaining_messages)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+    mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "[ 42 ]\x1e{ \"type\": 1, \"target\": \"BROADcast\", \"arguments\": [ \"message\", 1 ] }\x1e",
+            ""
+        };
+
+        call_number = std::min(call_number + 1, 2);
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto writer = std::shared_ptr<log_writer>{ std::make_shared<memory_log_writer>() };
+    auto hub_connection = create_hub_connection(websocket_client, writer, trace_level::errors);
+
+    auto payload = std::make_shared<std::string>();
+    auto on_broadcast_event = std::make_shared<event>();
+    hub_connection->on("broadCAST", [on_broadcast_event, payload](const json::value& message)
+    {
+        *payload = utility::conversions::to_utf8string(message.serialize());
+        on_broadcast_event->set();
+    });
+
+    hub_connection->start().get();
+    ASSERT_FALSE(on_broadcast_event->wait(5000));
+
+    ASSERT_EQ("[\"message\",1]", *payload);
+
+    auto log_entries = std::dynamic_pointer_cast<memory_log_writer>(writer)->get_log_entries();
+    ASSERT_EQ(1U, log_entries.size()) << dump_vector(log_entries);
+    ASSERT_EQ("[error       ] error occured when parsing response: unexpected response received from the server: [ 42 ]. response: [ 42 ]\n",
+        remove_date_from_log_entry(log_entries[0]));
+}
+
+TEST(hub_invocation, slow_handler_does_not_stall_receiving_in_parallel_dispatch_mode)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+    mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 1, \"target\": \"first\", \"arguments\": [] }\x1e",
+            "{ \"type\": 1, \"target\": \"second\", \"arguments\": [] }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 2);
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_handler_dispatch_mode(handler_dispatch_mode::parallel);
+    hub_connection->set_client_config(config);
+
+    auto second_received_event = std::make_shared<event>();
+    auto first_finished_event = std::make_shared<event>();
+    hub_connection->on("first", [second_received_event, first_finished_event](const json::value&)
+    {
+        // would never be signalled if handlers were invoked on the receive loop
+        if (!second_received_event->wait(5000))
+        {
+            first_finished_event->set();
+        }
+    });
+    hub_connection->on("second", [second_received_event](const json::value&) { second_received_event->set(); });
+
+    hub_connection->start().get();
+    ASSERT_FALSE(first_finished_event->wait(5000));
+
+    hub_connection->stop().get();
+}
+
+TEST(hub_invocation, server_timeout_does_not_elapse_while_dispatching_blocks)
+{
+    auto stop_receiving_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, stop_receiving_event]()
+    mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 1, \"target\": \"first\", \"arguments\": [] }\x1e"
+            "{ \"type\": 1, \"target\": \"second\", \"arguments\": [] }\x1e"
+        };
+
+        if (++call_number < 2)
+        {
+            return pplx::task_from_result(responses[call_number]);
+        }
+
+        return pplx::create_task([stop_receiving_event]()
+        {
+            stop_receiving_event->wait(5000);
+            return std::string("");
+        });
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_handler_dispatch_mode(handler_dispatch_mode::parallel);
+    config.set_max_pending_handlers(1);
+    config.set_server_timeout(std::chrono::milliseconds(100));
+    hub_connection->set_client_config(config);
+
+    auto disconnected_event = std::make_shared<event>();
+    hub_connection->set_disconnected([disconnected_event]() { disconnected_event->set(); });
+
+    auto first_release_event = std::make_shared<event>();
+    auto second_invoked_event = std::make_shared<event>();
+    hub_connection->on("first", [first_release_event](const json::value&) { first_release_event->wait(5000); });
+    hub_connection->on("second", [second_invoked_event](const json::value&) { second_invoked_event->set(); });
+
+    hub_connection->start().get();
+
+    // dispatching the second invocation blocks the receive thread until the first handler finished
+    ASSERT_NE(0U, disconnected_event->wait(500));
+
+    first_release_event->set();
+    ASSERT_FALSE(second_invoked_event->wait(5000));
+    ASSERT_EQ(connection_state::connected, hub_connection->get_connection_state());
+
+    stop_receiving_event->set();
+    hub_connection->stop().get();
+}
+
 TEST(send, creates_correct_payload)
 {
     std::string payload;
@@ -400,41 +626,7 @@ TEST(invoke, creates_correct_payload)
     ASSERT_EQ("{\"arguments\":[],\"invocationId\":\"0\",\"target\":\"method\",\"type\":1}\x1e", payload);
 }
 
-TEST(invoke, callback_not_called_if_send_throws)
-{
-    bool handshakeReceived = false;
-    auto websocket_client = create_test_websocket_client(
-        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
-        /* send function */[handshakeReceived](const std::string&) mutable
-        {
-            if (handshakeReceived)
-            {
-                return pplx::task_from_exception<void>(std::runtime_error("error"));
-            }
-            handshakeReceived = true;
-            return pplx::task_from_result();
-        });
-
-    auto hub_connection = create_hub_connection(websocket_client);
-    hub_connection->start().get();
-
-    try
-    {
-        hub_connection->invoke("method", json::value::array()).get();
-        ASSERT_TRUE(false); // exception expected but not thrown
-    }
-    catch (const std::runtime_error& e)
-    {
-        ASSERT_STREQ("error", e.what());
-    }
-
-    // stop completes all outstanding callbacks so if we did not remove a callback when `invoke_void` failed an
-    // unobserved exception exception would be thrown. Note that this would happen on a different thread and would
-    // crash the process
-    hub_connection->stop().get();
-}
-
-TEST(invoke, invoke_returns_value_returned_from_the_server)
+TEST(invoke, invoke_returns_value_returned_from_the_server_with_messagepack_protocol)
 {
     auto callback_registered_event = std::make_shared<event>();
 
@@ -445,7 +637,8 @@ TEST(invoke, invoke_returns_value_returned_from_the_server)
         std::string responses[]
         {
             "{ }\x1e",
-            "{ \"type\": 3, \"invocationId\": \"0\", \"result\": \"abc\" }\x1e"
+            // [3, {}, "0", 3, "abc"]
+            std::string("\x0a\x95\x03\x80\xa1" "0" "\x03\xa3" "abc", 11)
         };
 
         call_number = std::min(call_number + 1, 1);
@@ -459,6 +652,10 @@ TEST(invoke, invoke_returns_value_returned_from_the_server)
     });
 
     auto hub_connection = create_hub_connection(websocket_client);
+    signalr_client_config config;
+    config.set_hub_protocol(hub_protocol_type::messagepack);
+    hub_connection->set_client_config(config);
+
     auto result = hub_connection->start()
         .then([hub_connection, callback_registered_event]()
         {
@@ -470,7 +667,7 @@ TEST(invoke, invoke_returns_value_returned_from_the_server)
     ASSERT_EQ(_XPLATSTR("\"abc\""), result.serialize());
 }
 
-TEST(invoke, invoke_propagates_errors_from_server_as_hub_exceptions)
+TEST(stream, stream_returns_items_sent_by_the_server)
 {
     auto callback_registered_event = std::make_shared<event>();
 
@@ -481,10 +678,12 @@ TEST(invoke, invoke_propagates_errors_from_server_as_hub_exceptions)
         std::string responses[]
         {
             "{ }\x1e",
-            "{ \"type\": 3, \"invocationId\": \"0\", \"error\": \"Ooops\" }\x1e"
+            "{ \"type\": 2, \"invocationId\": \"0\", \"item\": 1 }\x1e{ \"type\": 2, \"invocationId\": \"0\", \"item\": \"abc\" }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\" }\x1e",
+            ""
         };
 
-        call_number = std::min(call_number + 1, 1);
+        call_number = std::min(call_number + 1, 3);
 
         if (call_number > 0)
         {
@@ -495,25 +694,19 @@ TEST(invoke, invoke_propagates_errors_from_server_as_hub_exceptions)
     });
 
     auto hub_connection = create_hub_connection(websocket_client);
-    try
-    {
-        hub_connection->start()
-            .then([hub_connection, callback_registered_event]()
-        {
-            auto t = hub_connection->invoke("method", json::value::array());
-            callback_registered_event->set();
-            return t;
-        }).get();
+    hub_connection->start().get();
 
-        ASSERT_TRUE(false); // exception expected but not thrown
-    }
-    catch (const hub_exception& e)
-    {
-        ASSERT_STREQ("\"Ooops\"", e.what());
-    }
+    auto reader = hub_connection->stream("method", json::value::array());
+    callback_registered_event->set();
+
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(_XPLATSTR("1"), reader.current().serialize());
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(_XPLATSTR("\"abc\""), reader.current().serialize());
+    ASSERT_FALSE(reader.move_next().get());
 }
 
-TEST(invoke, unblocks_task_when_server_completes_call)
+TEST(stream, stream_propagates_errors_from_server_as_hub_exceptions)
 {
     auto callback_registered_event = std::make_shared<event>();
 
@@ -524,10 +717,11 @@ TEST(invoke, unblocks_task_when_server_completes_call)
         std::string responses[]
         {
             "{ }\x1e",
-            "{ \"type\": 3, \"invocationId\": \"0\" }\x1e"
+            "{ \"type\": 3, \"invocationId\": \"0\", \"error\": \"Ooops\" }\x1e",
+            ""
         };
 
-        call_number = std::min(call_number + 1, 1);
+        call_number = std::min(call_number + 1, 2);
 
         if (call_number > 0)
         {
@@ -538,35 +732,718 @@ TEST(invoke, unblocks_task_when_server_completes_call)
     });
 
     auto hub_connection = create_hub_connection(websocket_client);
-    hub_connection->start()
-        .then([hub_connection, callback_registered_event]()
-    {
-        auto t = hub_connection->invoke("method", json::value::array());
-        callback_registered_event->set();
-        return t;
-    }).get();
+    hub_connection->start().get();
 
-    // should not block
-    ASSERT_TRUE(true);
+    auto reader = hub_connection->stream("method", json::value::array());
+    callback_registered_event->set();
+
+    try
+    {
+        reader.move_next().get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const hub_exception& e)
+    {
+        ASSERT_STREQ("\"Ooops\"", e.what());
+    }
 }
 
-TEST(receive, logs_if_callback_for_given_id_not_found)
+TEST(stream, dropping_reader_sends_cancel_invocation)
 {
-    auto message_received_event = std::make_shared<event>();
-    auto handshake_sent = std::make_shared<event>();
+    std::vector<std::string> payloads;
+    std::mutex payloads_lock;
 
-    int call_number = -1;
     auto websocket_client = create_test_websocket_client(
-        /* receive function */ [call_number, message_received_event, handshake_sent]()
-        mutable {
-        std::string responses[]
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */[&payloads, &payloads_lock](const std::string& m)
         {
-            "{ }\x1e",
-            "{ \"type\": 3, \"invocationId\": \"0\" }\x1e",
-            "{}"
-        };
-
-        handshake_sent->wait(1000);
+            std::lock_guard<std::mutex> lock(payloads_lock);
+            payloads.push_back(m);
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    {
+        auto reader = hub_connection->stream("method", json::value::array());
+    }
+
+    std::lock_guard<std::mutex> lock(payloads_lock);
+    ASSERT_EQ(3U, payloads.size());
+    ASSERT_EQ("{\"arguments\":[],\"invocationId\":\"0\",\"target\":\"method\",\"type\":4}\x1e", payloads[1]);
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":5}\x1e", payloads[2]);
+}
+
+TEST(send, sends_upload_stream_items_after_invocation)
+{
+    std::vector<std::string> payloads;
+    std::mutex payloads_lock;
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */[&payloads, &payloads_lock](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(payloads_lock);
+            payloads.push_back(m);
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    stream_writer writer;
+    hub_connection->send("upload", json::value::array(), std::vector<stream_writer>{ writer }).get();
+    writer.write(json::value::number(1)).get();
+    writer.complete().get();
+
+    std::lock_guard<std::mutex> lock(payloads_lock);
+    ASSERT_EQ(4U, payloads.size());
+    ASSERT_EQ("{\"arguments\":[],\"streamIds\":[\"0\"],\"target\":\"upload\",\"type\":1}\x1e", payloads[1]);
+    ASSERT_EQ("{\"invocationId\":\"0\",\"item\":1,\"type\":2}\x1e", payloads[2]);
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":3}\x1e", payloads[3]);
+}
+
+TEST(send, throws_if_upload_stream_already_used)
+{
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    stream_writer writer;
+    hub_connection->send("upload", json::value::array(), std::vector<stream_writer>{ writer }).get();
+
+    try
+    {
+        hub_connection->send("upload", json::value::array(), std::vector<stream_writer>{ writer });
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the stream has already been used for an invocation", e.what());
+    }
+}
+
+TEST(invoke, callback_not_called_if_send_throws)
+{
+    bool handshakeReceived = false;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */[handshakeReceived](const std::string&) mutable
+        {
+            if (handshakeReceived)
+            {
+                return pplx::task_from_exception<void>(std::runtime_error("error"));
+            }
+            handshakeReceived = true;
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    try
+    {
+        hub_connection->invoke("method", json::value::array()).get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const std::runtime_error& e)
+    {
+        ASSERT_STREQ("error", e.what());
+    }
+
+    // stop completes all outstanding callbacks so if we did not remove a callback when `invoke_void` failed an
+    // unobserved exception exception would be thrown. Note that this would happen on a different thread and would
+    // crash the process
+    hub_connection->stop().get();
+}
+
+TEST(invoke, invoke_returns_value_returned_from_the_server)
+{
+    auto callback_registered_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\", \"result\": \"abc\" }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    auto result = hub_connection->start()
+        .then([hub_connection, callback_registered_event]()
+        {
+            auto t = hub_connection->invoke("method", json::value::array());
+            callback_registered_event->set();
+            return t;
+        }).get();
+
+    ASSERT_EQ(_XPLATSTR("\"abc\""), result.serialize());
+}
+
+TEST(invoke, invoke_serialized_returns_serialized_value_returned_from_the_server)
+{
+    auto callback_registered_event = std::make_shared<event>();
+    auto payload = std::make_shared<std::string>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\", \"result\": { \"a\": [1, 2] } }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    },
+        /* send function */ [payload](const std::string& m)
+    {
+        *payload = m;
+        return pplx::task_from_result();
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    auto result = hub_connection->start()
+        .then([hub_connection, callback_registered_event]()
+        {
+            auto t = hub_connection->invoke_serialized("method", "[\"x\",1]");
+            callback_registered_event->set();
+            return t;
+        }).get();
+
+    ASSERT_EQ("{\"arguments\":[\"x\",1],\"invocationId\":\"0\",\"target\":\"method\",\"type\":1}\x1e", *payload);
+    ASSERT_EQ("{ \"a\": [1, 2] }", result);
+}
+
+TEST(invoke, invoke_prepared_sends_invocation_and_returns_result)
+{
+    auto callback_registered_event = std::make_shared<event>();
+    auto payload = std::make_shared<std::string>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\", \"result\": 42 }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    },
+        /* send function */ [payload](const std::string& m)
+    {
+        *payload = m;
+        return pplx::task_from_result();
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    auto prepared = std::make_shared<prepared_invocation_impl>("method");
+    auto result = hub_connection->start()
+        .then([hub_connection, prepared, callback_registered_event]()
+        {
+            auto t = hub_connection->invoke_prepared(prepared, "[1]");
+            callback_registered_event->set();
+            return t;
+        }).get();
+
+    ASSERT_EQ("{\"arguments\":[1],\"invocationId\":\"0\",\"target\":\"method\",\"type\":1}\x1e", *payload);
+    ASSERT_EQ("42", result);
+}
+
+TEST(invoke, invoke_propagates_errors_from_server_as_hub_exceptions)
+{
+    auto callback_registered_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\", \"error\": \"Ooops\" }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    try
+    {
+        hub_connection->start()
+            .then([hub_connection, callback_registered_event]()
+        {
+            auto t = hub_connection->invoke("method", json::value::array());
+            callback_registered_event->set();
+            return t;
+        }).get();
+
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const hub_exception& e)
+    {
+        ASSERT_STREQ("\"Ooops\"", e.what());
+    }
+}
+
+TEST(invoke, unblocks_task_when_server_completes_call)
+{
+    auto callback_registered_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\" }\x1e"
+        };
+
+        call_number = std::min(call_number + 1, 1);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start()
+        .then([hub_connection, callback_registered_event]()
+    {
+        auto t = hub_connection->invoke("method", json::value::array());
+        callback_registered_event->set();
+        return t;
+    }).get();
+
+    // should not block
+    ASSERT_TRUE(true);
+}
+
+TEST(invoke, invoke_fails_and_sends_cancel_invocation_when_invocation_timeout_elapses)
+{
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+    auto cancel_sent_event = std::make_shared<event>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [payloads, payloads_lock, cancel_sent_event](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            if (m.find("\"type\":5") != std::string::npos)
+            {
+                cancel_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_invocation_timeout(std::chrono::milliseconds(10));
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    try
+    {
+        hub_connection->invoke("method", json::value::array()).get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the invocation timed out after 10 ms", e.what());
+    }
+
+    ASSERT_FALSE(cancel_sent_event->wait(5000));
+
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_EQ(3U, payloads->size());
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":5}\x1e", (*payloads)[2]);
+}
+
+TEST(invoke, invoke_canceled_and_sends_cancel_invocation_when_token_canceled)
+{
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+    auto cancel_sent_event = std::make_shared<event>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [payloads, payloads_lock, cancel_sent_event](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            if (m.find("\"type\":5") != std::string::npos)
+            {
+                cancel_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+    hub_connection->start().get();
+
+    pplx::cancellation_token_source cts;
+    auto invoke_task = hub_connection->invoke("method", json::value::array(), std::vector<stream_writer>(),
+        std::chrono::milliseconds(0), cts.get_token());
+    cts.cancel();
+
+    ASSERT_THROW(invoke_task.get(), pplx::task_canceled);
+    ASSERT_FALSE(cancel_sent_event->wait(5000));
+
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_EQ(3U, payloads->size());
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":5}\x1e", (*payloads)[2]);
+}
+
+TEST(invoke, invoke_with_canceled_token_sends_nothing)
+{
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [payloads, payloads_lock](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+    hub_connection->start().get();
+
+    pplx::cancellation_token_source cts;
+    cts.cancel();
+
+    ASSERT_THROW(hub_connection->invoke("method", json::value::array(), std::vector<stream_writer>(),
+        std::chrono::milliseconds(0), cts.get_token()).get(), pplx::task_canceled);
+    ASSERT_THROW(hub_connection->invoke_serialized("method", "[]", std::chrono::milliseconds(0), cts.get_token()).get(),
+        pplx::task_canceled);
+    ASSERT_EQ(0U, hub_connection->get_outstanding_invocations());
+
+    // only the handshake was sent
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_EQ(1U, payloads->size());
+}
+
+TEST(invoke, invoke_rejected_when_max_outstanding_invocations_reached)
+{
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_max_outstanding_invocations(2);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto invoke_task1 = hub_connection->invoke("method", json::value::array());
+    auto invoke_task2 = hub_connection->invoke("method", json::value::array());
+    ASSERT_EQ(2U, hub_connection->get_outstanding_invocations());
+
+    try
+    {
+        hub_connection->invoke("method", json::value::array()).get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the maximum number of outstanding invocations (2) has been reached", e.what());
+    }
+
+    hub_connection->stop().get();
+
+    ASSERT_THROW(invoke_task1.get(), hub_exception);
+    ASSERT_THROW(invoke_task2.get(), hub_exception);
+    ASSERT_EQ(0U, hub_connection->get_outstanding_invocations());
+}
+
+TEST(invoke, invoke_queued_without_blocking_when_max_outstanding_invocations_reached)
+{
+    auto first_invoked_event = std::make_shared<event>();
+    auto second_sent_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, first_invoked_event, second_sent_event]()
+        mutable {
+            std::string responses[]
+            {
+                "{ }\x1e",
+                "{ \"type\": 3, \"invocationId\": \"0\", \"result\": 1 }\x1e",
+                "{ \"type\": 3, \"invocationId\": \"1\", \"result\": 2 }\x1e",
+                ""
+            };
+
+            call_number = std::min(call_number + 1, 3);
+
+            if (call_number == 1)
+            {
+                first_invoked_event->wait();
+            }
+            else if (call_number == 2)
+            {
+                second_sent_event->wait();
+            }
+
+            return pplx::task_from_result(responses[call_number]);
+        },
+        /* send function */ [second_sent_event](const std::string& m)
+        {
+            if (m.find("\"invocationId\":\"1\"") != std::string::npos)
+            {
+                second_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_max_outstanding_invocations(1);
+    config.set_invocation_admission_policy(invocation_admission_policy::wait);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto invoke_task1 = hub_connection->invoke("method", json::value::array());
+    auto invoke_task2 = hub_connection->invoke("method", json::value::array());
+    ASSERT_EQ(1U, hub_connection->get_outstanding_invocations());
+    ASSERT_FALSE(invoke_task2.is_done());
+
+    // the second invocation is sent once the result of the first one is received
+    first_invoked_event->set();
+    ASSERT_EQ(_XPLATSTR("1"), invoke_task1.get().serialize());
+    ASSERT_EQ(_XPLATSTR("2"), invoke_task2.get().serialize());
+}
+
+TEST(invoke, queued_invocation_canceled_before_it_is_sent)
+{
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [payloads, payloads_lock](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_max_outstanding_invocations(1);
+    config.set_invocation_admission_policy(invocation_admission_policy::wait);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto invoke_task1 = hub_connection->invoke("method", json::value::array());
+
+    pplx::cancellation_token_source cts;
+    auto invoke_task2 = hub_connection->invoke("method", json::value::array(), std::vector<stream_writer>(),
+        std::chrono::milliseconds(0), cts.get_token());
+    ASSERT_EQ(1U, hub_connection->get_metrics().queued_invocations);
+
+    cts.cancel();
+
+    // the queued invocation fails right away and is removed from the queue without being sent
+    ASSERT_THROW(invoke_task2.get(), pplx::task_canceled);
+    ASSERT_EQ(0U, hub_connection->get_metrics().queued_invocations);
+    ASSERT_EQ(1U, hub_connection->get_outstanding_invocations());
+
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_EQ(2U, payloads->size());
+}
+
+TEST(invoke, invoke_rejected_when_max_queued_invocations_reached)
+{
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_max_outstanding_invocations(1);
+    config.set_invocation_admission_policy(invocation_admission_policy::wait);
+    config.set_max_queued_invocations(1);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto invoke_task1 = hub_connection->invoke("method", json::value::array());
+    auto invoke_task2 = hub_connection->invoke("method", json::value::array());
+
+    try
+    {
+        hub_connection->invoke("method", json::value::array()).get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the maximum number of queued invocations (1) has been reached", e.what());
+    }
+
+    auto metrics = hub_connection->get_metrics();
+    ASSERT_EQ(1U, metrics.outstanding_invocations);
+    ASSERT_EQ(1U, metrics.queued_invocations);
+}
+
+TEST(invoke, invoke_sheds_oldest_invocation_when_max_outstanding_invocations_reached)
+{
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+    auto cancel_sent_event = std::make_shared<event>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */ [payloads, payloads_lock, cancel_sent_event](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            if (m.find("\"type\":5") != std::string::npos)
+            {
+                cancel_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_max_outstanding_invocations(1);
+    config.set_invocation_admission_policy(invocation_admission_policy::shed_oldest);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto invoke_task1 = hub_connection->invoke("method", json::value::array());
+    auto invoke_task2 = hub_connection->invoke("method", json::value::array());
+
+    try
+    {
+        invoke_task1.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const hub_exception& e)
+    {
+        ASSERT_STREQ("\"invocation was shed to make room for a newer invocation\"", e.what());
+    }
+
+    ASSERT_FALSE(cancel_sent_event->wait(5000));
+    ASSERT_EQ(1U, hub_connection->get_outstanding_invocations());
+    ASSERT_FALSE(invoke_task2.is_done());
+
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_NE(payloads->end(), std::find(payloads->begin(), payloads->end(), "{\"invocationId\":\"0\",\"type\":5}\x1e"));
+}
+
+TEST(invoke, metrics_record_invocation_round_trip_and_handler_execution_time)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+        mutable {
+            std::string responses[]
+            {
+                "{ }\x1e",
+                "{ \"type\": 1, \"target\": \"BROADcast\", \"arguments\": [ ] }\x1e",
+                "{ \"type\": 3, \"invocationId\": \"0\", \"result\": 42 }\x1e"
+            };
+
+            call_number = std::min(call_number + 1, 2);
+
+            return pplx::task_from_result(responses[call_number]);
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    auto handler_invoked = std::make_shared<event>();
+    hub_connection->on("broadcast", [handler_invoked](const json::value&)
+    {
+        handler_invoked->set();
+    });
+
+    hub_connection->start().get();
+    hub_connection->invoke("method", json::value::array()).get();
+    ASSERT_FALSE(handler_invoked->wait(5000));
+
+    auto metrics = hub_connection->get_metrics();
+    ASSERT_EQ(1U, metrics.invocation_round_trip.count);
+    ASSERT_LE(1U, metrics.handler_execution_time.count);
+    ASSERT_EQ(0U, metrics.outstanding_invocations);
+    ASSERT_LE(2U, metrics.messages_sent);
+    ASSERT_LE(3U, metrics.messages_received);
+}
+
+TEST(receive, logs_if_callback_for_given_id_not_found)
+{
+    auto message_received_event = std::make_shared<event>();
+    auto handshake_sent = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, message_received_event, handshake_sent]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\" }\x1e",
+            "{}"
+        };
+
+        handshake_sent->wait(1000);
 
         call_number = std::min(call_number + 1, 2);
 
@@ -590,9 +1467,10 @@ TEST(receive, logs_if_callback_for_given_id_not_found)
     ASSERT_FALSE(message_received_event->wait(5000));
 
     auto log_entries = std::dynamic_pointer_cast<memory_log_writer>(writer)->get_log_entries();
-    ASSERT_TRUE(log_entries.size() > 1);
+    auto callback_entries = filter_vector(log_entries, "no callback found");
+    ASSERT_EQ(1U, callback_entries.size()) << dump_vector(log_entries);
 
-    auto entry = remove_date_from_log_entry(log_entries[2]);
+    auto entry = remove_date_from_log_entry(callback_entries[0]);
     ASSERT_EQ("[info        ] no callback found for id: 0\n", entry) << dump_vector(log_entries);
 }
 
@@ -736,3 +1614,350 @@ TEST(invoke, send_throws_when_the_underlying_connection_is_not_valid)
         ASSERT_STREQ("cannot send data when the connection is not in the connected state. current connection state: disconnected", e.what());
     }
 }
+
+TEST(keep_alive, ping_sent_when_no_message_sent_within_keep_alive_interval)
+{
+    auto ping_sent_event = std::make_shared<event>();
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ []() { return pplx::task_from_result(std::string("{ }\x1e")); },
+        /* send function */[ping_sent_event](const std::string& m)
+        {
+            if (m == "{\"type\":6}\x1e")
+            {
+                ping_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    signalr_client_config config;
+    config.set_keep_alive_interval(std::chrono::milliseconds(50));
+    hub_connection->set_client_config(config);
+    hub_connection->start().get();
+
+    ASSERT_FALSE(ping_sent_event->wait(5000));
+}
+
+TEST(keep_alive, connection_stopped_when_server_timeout_elapses)
+{
+    auto stop_receiving_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, stop_receiving_event]()
+        mutable {
+            if (++call_number == 0)
+            {
+                return pplx::task_from_result(std::string("{ }\x1e"));
+            }
+
+            // the server goes silent after the handshake
+            return pplx::create_task([stop_receiving_event]()
+            {
+                stop_receiving_event->wait(5000);
+                return std::string("");
+            });
+        });
+
+    std::shared_ptr<log_writer> writer(std::make_shared<memory_log_writer>());
+    auto hub_connection = create_hub_connection(websocket_client, writer, trace_level::errors);
+    signalr_client_config config;
+    config.set_server_timeout(std::chrono::milliseconds(100));
+    hub_connection->set_client_config(config);
+
+    auto disconnected_event = std::make_shared<event>();
+    hub_connection->set_disconnected([disconnected_event]() { disconnected_event->set(); });
+
+    hub_connection->start().get();
+
+    ASSERT_FALSE(disconnected_event->wait(5000));
+    stop_receiving_event->set();
+
+    auto log_entries = std::dynamic_pointer_cast<memory_log_writer>(writer)->get_log_entries();
+    ASSERT_FALSE(log_entries.empty());
+    ASSERT_EQ("[error       ] server timeout (100 ms) elapsed without receiving a message from the server.\n",
+        remove_date_from_log_entry(log_entries[0])) << dump_vector(log_entries);
+}
+
+TEST(stream, stream_fails_without_blocking_receive_when_reader_is_full)
+{
+    auto callback_registered_event = std::make_shared<event>();
+    auto cancel_sent_event = std::make_shared<event>();
+    auto payloads = std::make_shared<std::vector<std::string>>();
+    auto payloads_lock = std::make_shared<std::mutex>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+            if (++call_number == 0)
+            {
+                return pplx::task_from_result(std::string("{ }\x1e"));
+            }
+
+            if (call_number == 1)
+            {
+                callback_registered_event->wait();
+                return pplx::task_from_result(std::string(
+                    "{ \"type\": 2, \"invocationId\": \"0\", \"item\": 1 }\x1e"
+                    "{ \"type\": 2, \"invocationId\": \"0\", \"item\": 2 }\x1e"
+                    "{ \"type\": 3, \"invocationId\": \"0\" }\x1e"
+                    "{ \"type\": 3, \"invocationId\": \"1\", \"result\": 42 }\x1e"));
+            }
+
+            return pplx::task_from_result(std::string("{ \"type\": 6 }\x1e"));
+        },
+        /* send function */ [payloads, payloads_lock, cancel_sent_event](const std::string& m)
+        {
+            std::lock_guard<std::mutex> lock(*payloads_lock);
+            payloads->push_back(m);
+            if (m.find("\"type\":5") != std::string::npos)
+            {
+                cancel_sent_event->set();
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+    signalr_client_config config;
+    config.set_stream_buffer_capacity(1);
+    hub_connection->set_client_config(config);
+
+    hub_connection->start().get();
+
+    auto reader = hub_connection->stream("method", json::value::array());
+    auto invoke_task = hub_connection->invoke("method", json::value::array());
+    callback_registered_event->set();
+
+    // the result of the invocation is received although the items of the stream are not read
+    ASSERT_EQ(_XPLATSTR("42"), invoke_task.get().serialize());
+    ASSERT_FALSE(cancel_sent_event->wait(5000));
+
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(_XPLATSTR("1"), reader.current().serialize());
+    ASSERT_THROW(reader.move_next().get(), signalr_exception);
+    ASSERT_EQ(connection_state::connected, hub_connection->get_connection_state());
+
+    std::lock_guard<std::mutex> lock(*payloads_lock);
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":5}\x1e", payloads->back());
+}
+
+TEST(keep_alive, connection_stopped_when_close_message_received)
+{
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+        mutable {
+            std::string responses[]
+            {
+                "{ }\x1e",
+                "{ \"type\": 7, \"error\": \"server shutting down\" }\x1e",
+                "{ }\x1e"
+            };
+
+            call_number = std::min(call_number + 1, 2);
+            return pplx::task_from_result(responses[call_number]);
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+
+    auto disconnected_event = std::make_shared<event>();
+    hub_connection->set_disconnected([disconnected_event]() { disconnected_event->set(); });
+
+    hub_connection->start().get();
+
+    ASSERT_FALSE(disconnected_event->wait(5000));
+}
+
+TEST(reconnect, hub_connection_repeats_handshake_and_keeps_subscriptions_after_reconnecting)
+{
+    auto started_event = std::make_shared<event>();
+    auto call_number = std::make_shared<std::atomic<int>>(-1);
+    auto handshake_count = std::make_shared<std::atomic<int>>(0);
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, started_event]()
+        {
+            const auto current_call = ++(*call_number);
+            if (current_call == 1)
+            {
+                started_event->wait(5000);
+                return pplx::task_from_exception<std::string>(std::runtime_error("connection reset"));
+            }
+
+            return pplx::task_from_result(std::string(current_call < 3
+                ? "{ }\x1e"
+                : "{ \"type\": 1, \"target\": \"broadcast\", \"arguments\": [ \"message\" ] }\x1e"));
+        },
+        /* send function */ [handshake_count](const std::string& m)
+        {
+            if (m.find("{\"protocol\"") == 0)
+            {
+                (*handshake_count)++;
+            }
+            return pplx::task_from_result();
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_automatic_reconnect(true);
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(1));
+    hub_connection->set_client_config(config);
+
+    auto on_broadcast_event = std::make_shared<event>();
+    hub_connection->on("broadcast", [on_broadcast_event](const json::value&) { on_broadcast_event->set(); });
+
+    auto reconnected_event = std::make_shared<event>();
+    hub_connection->set_reconnected([reconnected_event]() { reconnected_event->set(); });
+
+    hub_connection->start().get();
+    auto pending_invocation = hub_connection->invoke("method", json::value::array());
+    started_event->set();
+
+    ASSERT_FALSE(reconnected_event->wait(5000));
+    ASSERT_FALSE(on_broadcast_event->wait(5000));
+    ASSERT_EQ(2, *handshake_count);
+
+    try
+    {
+        pending_invocation.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("\"connection was lost before invocation result was received\"", e.what());
+    }
+
+    hub_connection->stop().get();
+}
+
+TEST(reconnect, partial_message_from_lost_transport_is_discarded)
+{
+    auto call_number = std::make_shared<std::atomic<int>>(-1);
+
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number]()
+        {
+            const auto current_call = ++(*call_number);
+            if (current_call == 0)
+            {
+                return pplx::task_from_result(std::string("{ }\x1e{ \"type\": 1, \"target\": \"broad"));
+            }
+
+            if (current_call == 1)
+            {
+                return pplx::task_from_exception<std::string>(std::runtime_error("connection reset"));
+            }
+
+            return pplx::task_from_result(std::string(current_call == 2
+                ? "{ }\x1e"
+                : "{ \"type\": 1, \"target\": \"broadcast\", \"arguments\": [ \"message\" ] }\x1e"));
+        });
+
+    auto hub_connection = create_hub_connection(websocket_client, std::make_shared<memory_log_writer>(), trace_level::none);
+
+    signalr_client_config config;
+    config.set_automatic_reconnect(true);
+    config.set_reconnect_initial_delay(std::chrono::milliseconds(1));
+    hub_connection->set_client_config(config);
+
+    auto on_broadcast_event = std::make_shared<event>();
+    hub_connection->on("broadcast", [on_broadcast_event](const json::value&) { on_broadcast_event->set(); });
+
+    auto reconnected_event = std::make_shared<event>();
+    hub_connection->set_reconnected([reconnected_event]() { reconnected_event->set(); });
+
+    hub_connection->start().get();
+
+    // the handshake response of the new transport would not parse if it were appended to the partial message
+    ASSERT_FALSE(reconnected_event->wait(5000));
+    ASSERT_FALSE(on_broadcast_event->wait(5000));
+
+    hub_connection->stop().get();
+}
+
+TEST(invoke, invoke_fails_when_result_cannot_be_parsed)
+{
+    auto callback_registered_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 3, \"invocationId\": \"0\", \"result\": [ 1, , 2 ] }\x1e",
+            ""
+        };
+
+        call_number = std::min(call_number + 1, 2);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    auto invocation = hub_connection->invoke("method", json::value::array());
+    callback_registered_event->set();
+
+    try
+    {
+        invocation.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_EQ(0U, std::string(e.what()).find("the invocation result could not be parsed: ")) << e.what();
+    }
+}
+
+TEST(stream, stream_fails_when_item_cannot_be_parsed)
+{
+    auto callback_registered_event = std::make_shared<event>();
+
+    int call_number = -1;
+    auto websocket_client = create_test_websocket_client(
+        /* receive function */ [call_number, callback_registered_event]()
+        mutable {
+        std::string responses[]
+        {
+            "{ }\x1e",
+            "{ \"type\": 2, \"invocationId\": \"0\", \"item\": { \"a\": } }\x1e",
+            ""
+        };
+
+        call_number = std::min(call_number + 1, 2);
+
+        if (call_number > 0)
+        {
+            callback_registered_event->wait();
+        }
+
+        return pplx::task_from_result(responses[call_number]);
+    });
+
+    auto hub_connection = create_hub_connection(websocket_client);
+    hub_connection->start().get();
+
+    auto reader = hub_connection->stream("method", json::value::array());
+    callback_registered_event->set();
+
+    try
+    {
+        reader.move_next().get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const hub_exception& e)
+    {
+        ASSERT_NE(std::string::npos, std::string(e.what()).find("the stream item could not be parsed: ")) << e.what();
+    }
+}
@@ -0,0 +1,310 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <cstring>
+#include "json_hub_protocol.h"
+#include "messagepack_hub_protocol.h"
+#include "messagepack.h"
+#include "signalrclient/signalr_exception.h"
+
+using namespace signalr;
+using namespace web;
+
+TEST(json_hub_protocol, write_invocation_creates_correct_payload)
+{
+    json_hub_protocol protocol;
+    auto arguments = json::value::array(1);
+    arguments[0] = json::value::number(42);
+
+    auto payload = protocol.write_message(hub_invocation_message("1", "method", arguments));
+
+    ASSERT_EQ("{\"arguments\":[42],\"invocationId\":\"1\",\"target\":\"method\",\"type\":1}\x1e", payload);
+}
+
+TEST(json_hub_protocol, parse_messages_parses_all_messages_in_payload)
+{
+    json_hub_protocol protocol;
+
+    auto messages = protocol.parse_messages(
+        "{\"type\":1,\"target\":\"broadcast\",\"arguments\":[\"message\"]}\x1e"
+        "{\"type\":3,\"invocationId\":\"0\",\"result\":\"abc\"}\x1e"
+        "{\"type\":6}\x1e");
+
+    ASSERT_EQ(3U, messages.size());
+
+    ASSERT_EQ(message_type::invocation, messages[0]->message_type);
+    auto invocation = static_cast<hub_invocation_message*>(messages[0].get());
+    ASSERT_EQ("broadcast", invocation->target);
+    ASSERT_EQ(_XPLATSTR("[\"message\"]"), invocation->arguments.get().serialize());
+
+    ASSERT_EQ(message_type::completion, messages[1]->message_type);
+    auto completion = static_cast<completion_message*>(messages[1].get());
+    ASSERT_EQ("0", completion->invocation_id);
+    ASSERT_TRUE(completion->has_result);
+    ASSERT_EQ(_XPLATSTR("\"abc\""), completion->result.get().serialize());
+
+    ASSERT_EQ(message_type::ping, messages[2]->message_type);
+}
+
+TEST(json_hub_protocol, parse_messages_skips_unknown_message_types)
+{
+    json_hub_protocol protocol;
+
+    auto messages = protocol.parse_messages("{\"type\":42}\x1e{\"type\":6}\x1e");
+
+    ASSERT_EQ(1U, messages.size());
+    ASSERT_EQ(message_type::ping, messages[0]->message_type);
+}
+
+TEST(json_hub_protocol, parse_message_parses_arguments_only_when_read)
+{
+    json_hub_protocol protocol;
+    const std::string payload = "{\"arguments\":[{\"text\":\"hi\"}],\"target\":\"br\\u006fadcast\",\"type\":1}";
+
+    auto message = protocol.parse_message(payload.data(), payload.size());
+
+    auto invocation = static_cast<hub_invocation_message*>(message.get());
+    ASSERT_EQ("broadcast", invocation->target);
+    ASSERT_FALSE(invocation->arguments.is_parsed());
+    ASSERT_EQ(_XPLATSTR("hi"), invocation->arguments.get().at(0).at(_XPLATSTR("text")).as_string());
+    ASSERT_TRUE(invocation->arguments.is_parsed());
+}
+
+TEST(json_hub_protocol, parse_message_throws_for_missing_type)
+{
+    json_hub_protocol protocol;
+    const std::string payload = "{\"target\":\"broadcast\"}";
+
+    try
+    {
+        protocol.parse_message(payload.data(), payload.size());
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("field 'type' not found", e.what());
+    }
+}
+
+TEST(hub_protocol, invocation_writer_writes_same_payload_as_write_message)
+{
+    const hub_protocol_type protocol_types[] = { hub_protocol_type::json, hub_protocol_type::messagepack };
+    for (auto protocol_type : protocol_types)
+    {
+        auto protocol = hub_protocol::create(protocol_type);
+        auto writer = protocol->create_invocation_writer("some \"method\"");
+
+        ASSERT_EQ(protocol->write_message(hub_invocation_message("12", "some \"method\"", lazy_json_value::from_text("[1,\"a\"]"))),
+            writer->write("12", "[1,\"a\"]"));
+        ASSERT_EQ(protocol->write_message(hub_invocation_message("", "some \"method\"", lazy_json_value::from_text("[]"))),
+            writer->write("", "[]"));
+    }
+}
+
+TEST(messagepack, values_round_trip)
+{
+    auto value = json::value::parse(_XPLATSTR(
+        "{\"array\":[1,-1,-33,200,-200,70000,-70000,5000000000,-5000000000,1.5],\"bool\":true,\"null\":null,\"string\":\"abc\"}"));
+
+    std::string buffer;
+    messagepack::write_value(buffer, value);
+
+    messagepack::reader reader(buffer.data(), buffer.size());
+    auto result = reader.read_value();
+
+    ASSERT_TRUE(reader.at_end());
+    ASSERT_EQ(value.serialize(), result.serialize());
+}
+
+TEST(messagepack, json_text_is_written_like_parsed_value)
+{
+    const utility::string_t texts[] =
+    {
+        _XPLATSTR("[1,-1,-33,200,-200,70000,-70000,5000000000,-5000000000,1.5,-2.5e3]"),
+        _XPLATSTR("{\"array\":[],\"bool\":false,\"null\":null,\"object\":{\"a\":true},\"string\":\"abc\"}"),
+        _XPLATSTR(" [ \"escaped \\\"\\u00e9\" , \"a string longer than thirty one bytes\" ] "),
+        _XPLATSTR("[[[[]]],{}]")
+    };
+
+    for (const auto& text : texts)
+    {
+        std::string expected;
+        messagepack::write_value(expected, json::value::parse(text));
+
+        const auto utf8_text = utility::conversions::to_utf8string(text);
+        std::string buffer;
+        messagepack::write_json(buffer, utf8_text.data(), utf8_text.size());
+
+        ASSERT_EQ(expected, buffer);
+    }
+}
+
+TEST(messagepack, write_json_writes_containers_with_many_elements)
+{
+    std::string text("[");
+    for (auto i = 0; i < 70000; i++)
+    {
+        text.append(i == 0 ? "1" : ",1");
+    }
+    text.append("]");
+
+    std::string expected;
+    messagepack::write_value(expected, json::value::parse(utility::conversions::to_string_t(text)));
+
+    std::string buffer;
+    messagepack::write_json(buffer, text.data(), text.size());
+
+    ASSERT_EQ(expected, buffer);
+}
+
+TEST(messagepack, write_json_throws_for_malformed_json)
+{
+    const char* texts[] = { "", "[1,]", "[1 2]", "{\"a\" 1}", "{1:2}", "[nul]", "[1.2.3]", "[-]", "[1]]", "[\"a" };
+
+    for (auto text : texts)
+    {
+        std::string buffer;
+        ASSERT_THROW(messagepack::write_json(buffer, text, std::strlen(text)), signalr_exception) << text;
+    }
+}
+
+TEST(messagepack, reader_throws_for_container_length_exceeding_data)
+{
+    // an array32 and a map32 claiming 2^32 - 1 elements followed by only a few bytes
+    const std::string payloads[] =
+    {
+        std::string("\xdd\xff\xff\xff\xff\x01\x02", 7),
+        std::string("\xdf\xff\xff\xff\xff\x01\x02", 7),
+        std::string("\x91\xdc\x00\x03\x01\x02", 6)
+    };
+
+    for (const auto& payload : payloads)
+    {
+        try
+        {
+            messagepack::reader(payload.data(), payload.size()).read_value();
+            ASSERT_TRUE(false); // exception expected but not thrown
+        }
+        catch (const signalr_exception& e)
+        {
+            ASSERT_STREQ("messagepack container length exceeds the remaining data", e.what());
+        }
+
+        ASSERT_THROW(messagepack::reader(payload.data(), payload.size()).skip(), signalr_exception);
+    }
+}
+
+TEST(messagepack, reader_throws_for_deeply_nested_data)
+{
+    // max_depth nested arrays are fine, one more is not
+    const std::string nested(messagepack::reader::max_depth, '\x91');
+    const auto allowed = nested + '\xc0';
+    const auto too_deep = nested + "\x91\xc0";
+
+    messagepack::reader reader(allowed.data(), allowed.size());
+    reader.read_value();
+    ASSERT_TRUE(reader.at_end());
+
+    messagepack::reader skip_reader(allowed.data(), allowed.size());
+    skip_reader.skip();
+    ASSERT_TRUE(skip_reader.at_end());
+
+    try
+    {
+        messagepack::reader(too_deep.data(), too_deep.size()).read_value();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("messagepack data is nested too deeply", e.what());
+    }
+
+    ASSERT_THROW(messagepack::reader(too_deep.data(), too_deep.size()).skip(), signalr_exception);
+}
+
+TEST(messagepack, length_prefix_round_trips)
+{
+    size_t lengths[] = { 0, 127, 128, 16383, 16384, 2097152 };
+    for (auto length : lengths)
+    {
+        std::string buffer;
+        messagepack::write_length_prefix(buffer, length);
+
+        size_t payload_length, prefix_length;
+        ASSERT_TRUE(messagepack::try_read_length_prefix(buffer.data(), buffer.size(), payload_length, prefix_length));
+        ASSERT_EQ(length, payload_length);
+        ASSERT_EQ(buffer.size(), prefix_length);
+
+        ASSERT_FALSE(messagepack::try_read_length_prefix(buffer.data(), buffer.size() - 1, payload_length, prefix_length));
+    }
+}
+
+TEST(messagepack_hub_protocol, write_invocation_creates_correct_payload)
+{
+    messagepack_hub_protocol protocol;
+
+    auto payload = protocol.write_message(hub_invocation_message("", "m", json::value::array()));
+
+    // length, [1, {}, nil, "m", []]
+    ASSERT_EQ(std::string("\x07\x95\x01\x80\xc0\xa1m\x90", 8), payload);
+}
+
+TEST(messagepack_hub_protocol, parse_messages_parses_completion_and_invocation)
+{
+    messagepack_hub_protocol protocol;
+
+    // [3, {}, "1", 3, 42] followed by [1, {}, nil, "m", ["a"]]
+    auto messages = protocol.parse_messages(std::string(
+        "\x07\x95\x03\x80\xa1" "1" "\x03\x2a"
+        "\x09\x95\x01\x80\xc0\xa1m\x91\xa1" "a", 18));
+
+    ASSERT_EQ(2U, messages.size());
+
+    ASSERT_EQ(message_type::completion, messages[0]->message_type);
+    auto completion = static_cast<completion_message*>(messages[0].get());
+    ASSERT_EQ("1", completion->invocation_id);
+    ASSERT_TRUE(completion->has_result);
+    ASSERT_EQ(_XPLATSTR("42"), completion->result.get().serialize());
+
+    ASSERT_EQ(message_type::invocation, messages[1]->message_type);
+    auto invocation = static_cast<hub_invocation_message*>(messages[1].get());
+    ASSERT_EQ("m", invocation->target);
+    ASSERT_EQ(_XPLATSTR("[\"a\"]"), invocation->arguments.get().serialize());
+}
+
+TEST(messagepack_hub_protocol, written_messages_can_be_parsed)
+{
+    messagepack_hub_protocol protocol;
+
+    auto payload = protocol.write_message(completion_message("7", "error", json::value::null(), false))
+        + protocol.write_message(ping_message())
+        + protocol.write_message(close_message("bye", true));
+
+    auto messages = protocol.parse_messages(payload);
+
+    ASSERT_EQ(3U, messages.size());
+    auto completion = static_cast<completion_message*>(messages[0].get());
+    ASSERT_EQ("7", completion->invocation_id);
+    ASSERT_EQ("error", completion->error);
+    ASSERT_FALSE(completion->has_result);
+    ASSERT_EQ(message_type::ping, messages[1]->message_type);
+    auto close = static_cast<close_message*>(messages[2].get());
+    ASSERT_EQ("bye", close->error);
+    ASSERT_TRUE(close->allow_reconnect);
+}
+
+TEST(messagepack_hub_protocol, parse_messages_throws_for_truncated_message)
+{
+    messagepack_hub_protocol protocol;
+
+    try
+    {
+        protocol.parse_messages(std::string("\x06\x95\x03", 3));
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("incomplete message received from the server", e.what());
+    }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "invocation_deadline.h"
+#include "signalrclient/signalr_exception.h"
+#include "event.h"
+
+using namespace signalr;
+
+TEST(invocation_deadline, create_returns_null_without_timeout_or_cancelable_token)
+{
+    ASSERT_EQ(nullptr, invocation_deadline::create(std::chrono::milliseconds(0), pplx::cancellation_token::none()));
+}
+
+TEST(invocation_deadline, expires_with_signalr_exception_when_timeout_elapses)
+{
+    auto expired = std::make_shared<event>();
+    auto error = std::make_shared<std::exception_ptr>();
+
+    auto deadline = invocation_deadline::create(std::chrono::milliseconds(10), pplx::cancellation_token::none());
+    deadline->arm([expired, error](const std::exception_ptr& e)
+    {
+        *error = e;
+        expired->set();
+    });
+
+    ASSERT_FALSE(expired->wait(5000));
+
+    try
+    {
+        std::rethrow_exception(*error);
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the invocation timed out after 10 ms", e.what());
+    }
+}
+
+TEST(invocation_deadline, expires_with_task_canceled_when_token_canceled)
+{
+    pplx::cancellation_token_source cts;
+    auto error = std::make_shared<std::exception_ptr>();
+    int expire_count = 0;
+
+    auto deadline = invocation_deadline::create(std::chrono::milliseconds(0), cts.get_token());
+    deadline->arm([error, &expire_count](const std::exception_ptr& e)
+    {
+        *error = e;
+        expire_count++;
+    });
+
+    cts.cancel();
+
+    ASSERT_EQ(1, expire_count);
+    ASSERT_THROW(std::rethrow_exception(*error), pplx::task_canceled);
+}
+
+TEST(invocation_deadline, expires_right_away_if_token_already_canceled)
+{
+    pplx::cancellation_token_source cts;
+    cts.cancel();
+    int expire_count = 0;
+
+    auto deadline = invocation_deadline::create(std::chrono::milliseconds(0), cts.get_token());
+    deadline->arm([&expire_count](const std::exception_ptr&) { expire_count++; });
+
+    ASSERT_EQ(1, expire_count);
+}
+
+TEST(invocation_deadline, does_not_expire_after_disarm)
+{
+    pplx::cancellation_token_source cts;
+    auto expired = std::make_shared<event>();
+
+    auto deadline = invocation_deadline::create(std::chrono::milliseconds(10), cts.get_token());
+    deadline->arm([expired](const std::exception_ptr&) { expired->set(); });
+    deadline->disarm();
+
+    cts.cancel();
+    ASSERT_TRUE(expired->wait(100) != 0);
+}
@@ -0,0 +1,238 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "invocation_limiter.h"
+#include "signalrclient/signalr_exception.h"
+
+using namespace signalr;
+
+namespace
+{
+    // for invocations that are admitted right away
+    std::shared_ptr<invocation_limiter::admission> admit(const std::shared_ptr<invocation_limiter>& limiter,
+        std::string& shed_invocation_id)
+    {
+        std::shared_ptr<invocation_limiter::admission> result;
+        limiter->admit([&result, &shed_invocation_id](const std::shared_ptr<invocation_limiter::admission>& admission,
+            const std::string& shed)
+        {
+            result = admission;
+            shed_invocation_id = shed;
+        });
+        return result;
+    }
+}
+
+TEST(invocation_limiter, counts_outstanding_invocations_without_limit)
+{
+    auto limiter = invocation_limiter::create(0, invocation_admission_policy::reject, 16);
+    std::string shed_invocation_id;
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    auto admission2 = admit(limiter, shed_invocation_id);
+    ASSERT_EQ(2U, limiter->outstanding());
+    ASSERT_TRUE(shed_invocation_id.empty());
+
+    admission1.reset();
+    ASSERT_EQ(1U, limiter->outstanding());
+    admission2.reset();
+    ASSERT_EQ(0U, limiter->outstanding());
+}
+
+TEST(invocation_limiter, reject_throws_when_limit_reached)
+{
+    auto limiter = invocation_limiter::create(2, invocation_admission_policy::reject, 16);
+    std::string shed_invocation_id;
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    auto admission2 = admit(limiter, shed_invocation_id);
+
+    try
+    {
+        admit(limiter, shed_invocation_id);
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the maximum number of outstanding invocations (2) has been reached", e.what());
+    }
+
+    ASSERT_EQ(2U, limiter->outstanding());
+
+    admission1.reset();
+    auto admission3 = admit(limiter, shed_invocation_id);
+    ASSERT_EQ(2U, limiter->outstanding());
+}
+
+TEST(invocation_limiter, wait_queues_invocations_until_invocation_completes)
+{
+    auto limiter = invocation_limiter::create(1, invocation_admission_policy::wait, 16);
+    std::string shed_invocation_id;
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    admission1->set_invocation_id("0");
+
+    std::vector<std::shared_ptr<invocation_limiter::admission>> admitted;
+    auto admit_into_vector = [&admitted](const std::shared_ptr<invocation_limiter::admission>& admission, const std::string&)
+    {
+        admitted.push_back(admission);
+    };
+
+    // the caller is not blocked
+    limiter->admit(admit_into_vector);
+    limiter->admit(admit_into_vector);
+    ASSERT_TRUE(admitted.empty());
+    ASSERT_EQ(1U, limiter->outstanding());
+
+    // invocations are admitted in order from the thread releasing an admission
+    admission1.reset();
+    ASSERT_EQ(1U, admitted.size());
+    ASSERT_EQ(1U, limiter->outstanding());
+
+    admitted[0].reset();
+    ASSERT_EQ(2U, admitted.size());
+
+    admitted[1].reset();
+    ASSERT_EQ(0U, limiter->outstanding());
+}
+
+TEST(invocation_limiter, wait_does_not_overtake_queued_invocations)
+{
+    auto limiter = invocation_limiter::create(1, invocation_admission_policy::wait, 16);
+    std::string shed_invocation_id;
+
+    std::vector<std::shared_ptr<invocation_limiter::admission>> admitted;
+    auto admit_into_vector = [&admitted](const std::shared_ptr<invocation_limiter::admission>& admission, const std::string&)
+    {
+        admitted.push_back(admission);
+    };
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    limiter->admit(admit_into_vector);
+    admission1.reset();
+    ASSERT_EQ(1U, admitted.size());
+
+    // a new invocation is queued behind the invocations that are already waiting
+    limiter->admit(admit_into_vector);
+    ASSERT_EQ(1U, admitted.size());
+
+    admitted[0].reset();
+    ASSERT_EQ(2U, admitted.size());
+    admitted.clear();
+}
+
+TEST(invocation_limiter, shed_oldest_returns_oldest_invocation_id)
+{
+    auto limiter = invocation_limiter::create(2, invocation_admission_policy::shed_oldest, 16);
+    std::string shed_invocation_id;
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    admission1->set_invocation_id("1");
+    auto admission2 = admit(limiter, shed_invocation_id);
+    admission2->set_invocation_id("2");
+
+    auto admission3 = admit(limiter, shed_invocation_id);
+    admission3->set_invocation_id("3");
+    ASSERT_EQ("1", shed_invocation_id);
+    ASSERT_EQ(2U, limiter->outstanding());
+
+    // the shed invocation no longer counts when its callback is released
+    admission1.reset();
+    ASSERT_EQ(2U, limiter->outstanding());
+
+    auto admission4 = admit(limiter, shed_invocation_id);
+    ASSERT_EQ("2", shed_invocation_id);
+}
+
+TEST(invocation_limiter, shed_oldest_waits_for_invocations_being_registered)
+{
+    auto limiter = invocation_limiter::create(1, invocation_admission_policy::shed_oldest, 16);
+    std::string shed_invocation_id;
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+
+    std::shared_ptr<invocation_limiter::admission> waiter_admission;
+    std::string waiter_shed_invocation_id;
+    limiter->admit([&waiter_admission, &waiter_shed_invocation_id](
+        const std::shared_ptr<invocation_limiter::admission>& admission, const std::string& shed_invocation_id)
+    {
+        waiter_admission = admission;
+        waiter_shed_invocation_id = shed_invocation_id;
+    });
+    ASSERT_FALSE(waiter_admission);
+
+    admission1->set_invocation_id("7");
+
+    ASSERT_TRUE(waiter_admission != nullptr);
+    ASSERT_EQ("7", waiter_shed_invocation_id);
+    ASSERT_EQ(1U, limiter->outstanding());
+}
+
+TEST(invocation_limiter, wait_rejects_invocations_when_queue_is_full)
+{
+    auto limiter = invocation_limiter::create(1, invocation_admission_policy::wait, 2);
+    std::string shed_invocation_id;
+
+    std::vector<std::shared_ptr<invocation_limiter::admission>> admitted;
+    auto admit_into_vector = [&admitted](const std::shared_ptr<invocation_limiter::admission>& admission, const std::string&)
+    {
+        admitted.push_back(admission);
+    };
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    ASSERT_NE(0U, limiter->admit(admit_into_vector));
+    ASSERT_NE(0U, limiter->admit(admit_into_vector));
+    ASSERT_EQ(2U, limiter->queued());
+
+    try
+    {
+        limiter->admit(admit_into_vector);
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the maximum number of queued invocations (2) has been reached", e.what());
+    }
+
+    ASSERT_EQ(2U, limiter->queued());
+    ASSERT_EQ(1U, limiter->outstanding());
+
+    admission1.reset();
+    ASSERT_EQ(1U, admitted.size());
+    ASSERT_EQ(1U, limiter->queued());
+
+    admitted[0].reset();
+    ASSERT_EQ(2U, admitted.size());
+    ASSERT_EQ(0U, limiter->queued());
+    admitted.clear();
+}
+
+TEST(invocation_limiter, withdrawn_invocations_are_not_admitted)
+{
+    auto limiter = invocation_limiter::create(1, invocation_admission_policy::wait, 16);
+    std::string shed_invocation_id;
+
+    std::vector<std::shared_ptr<invocation_limiter::admission>> admitted;
+    auto admit_into_vector = [&admitted](const std::shared_ptr<invocation_limiter::admission>& admission, const std::string&)
+    {
+        admitted.push_back(admission);
+    };
+
+    auto admission1 = admit(limiter, shed_invocation_id);
+    const auto ticket1 = limiter->admit(admit_into_vector);
+    const auto ticket2 = limiter->admit(admit_into_vector);
+    ASSERT_NE(ticket1, ticket2);
+
+    ASSERT_TRUE(limiter->withdraw(ticket1));
+    ASSERT_FALSE(limiter->withdraw(ticket1));
+    ASSERT_EQ(1U, limiter->queued());
+
+    admission1.reset();
+    ASSERT_EQ(1U, admitted.size());
+    ASSERT_EQ(0U, limiter->queued());
+
+    // an admitted invocation can no longer be withdrawn
+    ASSERT_FALSE(limiter->withdraw(ticket2));
+    admitted.clear();
+}
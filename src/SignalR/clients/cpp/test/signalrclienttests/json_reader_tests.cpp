@@ -0,0 +1,120 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "json_reader.h"
+#include "signalrclient/signalr_exception.h"
+
+using namespace signalr;
+
+namespace
+{
+    std::string value_of(const json_reader::field& field)
+    {
+        return std::string(field.value, field.value_length);
+    }
+}
+
+TEST(json_reader, reads_top_level_fields)
+{
+    const std::string json = " { \"type\" : 1, \"target\":\"method\",\"flag\":true,\"nothing\":null,\"arguments\":[1,{\"a\":[]}] } ";
+    json_reader reader(json.data(), json.size());
+    json_reader::field field;
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_TRUE(field.name_equals("type", 4));
+    ASSERT_EQ(json_reader::value_kind::number, field.kind);
+    ASSERT_EQ("1", value_of(field));
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_TRUE(field.name_equals("target", 6));
+    ASSERT_EQ(json_reader::value_kind::string, field.kind);
+    ASSERT_EQ("\"method\"", value_of(field));
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_EQ(json_reader::value_kind::literal, field.kind);
+    ASSERT_EQ("true", value_of(field));
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_EQ(json_reader::value_kind::literal, field.kind);
+    ASSERT_EQ("null", value_of(field));
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_TRUE(field.name_equals("arguments", 9));
+    ASSERT_EQ(json_reader::value_kind::array, field.kind);
+    ASSERT_EQ("[1,{\"a\":[]}]", value_of(field));
+
+    ASSERT_FALSE(reader.read_field(field));
+    ASSERT_FALSE(reader.read_field(field));
+}
+
+TEST(json_reader, skips_brackets_and_quotes_inside_strings)
+{
+    // long enough for the strings to span multiple 16 byte blocks
+    const std::string arguments = "[\"a string with ] and } and an escaped \\\" quote\",{\"nested\":[\"[{\",\"\\\\\"]}]";
+    const std::string json = "{\"arguments\":" + arguments + ",\"type\":1}";
+    json_reader reader(json.data(), json.size());
+    json_reader::field field;
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_EQ(arguments, value_of(field));
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_TRUE(field.name_equals("type", 4));
+    ASSERT_FALSE(reader.read_field(field));
+}
+
+TEST(json_reader, read_string_decodes_escape_sequences)
+{
+    const std::string value = "\"a\\\"b\\\\c\\/d\\n\\t\\u0041\\u00e9\\u20ac\\ud83d\\ude00 and some more text\"";
+
+    ASSERT_EQ("a\"b\\c/d\n\tA\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 and some more text",
+        json_reader::read_string(value.data(), value.size()));
+}
+
+TEST(json_reader, compares_escaped_field_names)
+{
+    const std::string json = "{\"t\\u0079pe\":1}";
+    json_reader reader(json.data(), json.size());
+    json_reader::field field;
+
+    ASSERT_TRUE(reader.read_field(field));
+    ASSERT_TRUE(field.name_escaped);
+    ASSERT_TRUE(field.name_equals("type", 4));
+}
+
+TEST(json_reader, throws_for_malformed_json)
+{
+    const std::string payloads[] = { "{\"type\":1", "{\"type\" 1}", "{\"type\":1,}", "{\"target\":\"abc}", "{\"arguments\":[1,2}",
+        "{\"type\":nope}" };
+
+    for (const auto& payload : payloads)
+    {
+        try
+        {
+            json_reader reader(payload.data(), payload.size());
+            json_reader::field field;
+            while (reader.read_field(field)) {}
+            ASSERT_TRUE(false) << payload; // exception expected but not thrown
+        }
+        catch (const signalr_exception& e)
+        {
+            ASSERT_EQ(0U, std::string(e.what()).find("malformed json: ")) << payload;
+        }
+    }
+}
+
+TEST(json_reader, throws_if_data_is_not_an_object)
+{
+    const std::string payload = "[1]";
+
+    try
+    {
+        json_reader reader(payload.data(), payload.size());
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("unexpected response received from the server: [1]", e.what());
+    }
+}
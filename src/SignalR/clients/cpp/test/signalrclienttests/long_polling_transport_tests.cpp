@@ -0,0 +1,211 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "test_utils.h"
+#include "recording_web_request_factory.h"
+#include "trace_log_writer.h"
+#include "memory_log_writer.h"
+#include "long_polling_transport.h"
+#include "signalrclient/signalr_exception.h"
+#include "signalrclient/web_exception.h"
+
+using namespace signalr;
+
+static std::shared_ptr<transport> create_long_polling_transport(std::unique_ptr<web_request_factory> web_request_factory,
+    const std::function<void(const std::string&)>& process_response = [](const std::string&) {},
+    const std::function<void(const std::exception&)>& error = [](const std::exception&) {})
+{
+    return long_polling_transport::create(std::move(web_request_factory), signalr_client_config(),
+        logger(std::make_shared<trace_log_writer>(), trace_level::none), process_response, error);
+}
+
+TEST(long_polling_transport_connect, connect_polls_the_server)
+{
+    auto polled_event = std::make_shared<event>();
+    recording_web_request_factory factory([polled_event](web_request_stub& request, int count)
+    {
+        if (request.m_method == "GET" && count > 0)
+        {
+            polled_event->set();
+        }
+    });
+
+    auto transport = create_long_polling_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    ASSERT_FALSE(polled_event->wait(5000));
+    ASSERT_EQ(transport_type::long_polling, transport->get_transport_type());
+
+    auto requests = factory.get_requests();
+    ASSERT_EQ("GET http://fakeuri.org/connect?id=42", requests[0]);
+}
+
+TEST(long_polling_transport_connect, connect_propagates_exceptions)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int)
+    {
+        request.m_status_code = 404;
+        request.m_reason_phrase = "Not Found";
+    });
+
+    auto transport = create_long_polling_transport(factory.create());
+
+    try
+    {
+        transport->connect("http://fakeuri.org/connect?id=42").get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const web_exception& e)
+    {
+        ASSERT_STREQ("web exception - 404 Not Found", e.what());
+        ASSERT_EQ(404, e.status_code());
+    }
+}
+
+TEST(long_polling_transport_receive, responses_processed_in_order)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int count)
+    {
+        if (request.m_method == "GET" && count > 0)
+        {
+            request.m_response_body = std::to_string(count);
+        }
+    });
+
+    std::mutex responses_lock;
+    std::vector<std::string> responses;
+    auto all_received_event = std::make_shared<event>();
+
+    auto transport = create_long_polling_transport(factory.create(),
+        [&responses_lock, &responses, all_received_event](const std::string& response)
+        {
+            std::lock_guard<std::mutex> lock(responses_lock);
+            responses.push_back(response);
+            if (responses.size() == 100)
+            {
+                all_received_event->set();
+            }
+        });
+
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+    ASSERT_FALSE(all_received_event->wait(5000));
+    transport->disconnect().get();
+
+    std::lock_guard<std::mutex> lock(responses_lock);
+    for (size_t i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(std::to_string(i + 1), responses[i]);
+    }
+}
+
+TEST(long_polling_transport_receive, error_reported_when_server_closes_the_connection)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int count)
+    {
+        if (request.m_method == "GET" && count > 0)
+        {
+            request.m_status_code = 204;
+        }
+    });
+
+    auto error_event = std::make_shared<event>();
+    auto error_message = std::make_shared<std::string>();
+    auto transport = create_long_polling_transport(factory.create(), [](const std::string&) {},
+        [error_event, error_message](const std::exception& e)
+        {
+            *error_message = e.what();
+            error_event->set();
+        });
+
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    ASSERT_FALSE(error_event->wait(5000));
+    ASSERT_EQ("the server closed the connection", *error_message);
+}
+
+TEST(long_polling_transport_send, data_sent_while_request_in_progress_sent_in_single_request)
+{
+    auto post_started_event = std::make_shared<event>();
+    auto complete_post_event = std::make_shared<event>();
+    recording_web_request_factory factory([post_started_event, complete_post_event](web_request_stub& request, int count)
+    {
+        if (request.m_method == "POST" && count == 0)
+        {
+            post_started_event->set();
+            complete_post_event->wait(5000);
+        }
+        else if (request.m_method == "GET" && count > 0)
+        {
+            // keeps the poll outstanding without spinning
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    auto transport = create_long_polling_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    auto first_send = pplx::create_task([transport]() { return transport->send("a", transfer_format::text); });
+    ASSERT_FALSE(post_started_event->wait(5000));
+
+    auto second_send = transport->send("b", transfer_format::text);
+    auto third_send = transport->send("c", transfer_format::text);
+    complete_post_event->set();
+
+    first_send.get();
+    second_send.get();
+    third_send.get();
+
+    auto requests = filter_vector(factory.get_requests(), "POST");
+    ASSERT_EQ(2U, requests.size()) << dump_vector(requests);
+    ASSERT_EQ("POST http://fakeuri.org/connect?id=42 a", requests[0]);
+    ASSERT_EQ("POST http://fakeuri.org/connect?id=42 bc", requests[1]);
+
+    transport->disconnect().get();
+}
+
+TEST(long_polling_transport_send, send_propagates_errors)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int)
+    {
+        if (request.m_method == "POST")
+        {
+            request.m_status_code = 404;
+            request.m_reason_phrase = "Not Found";
+        }
+    });
+
+    auto transport = create_long_polling_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    try
+    {
+        transport->send("a", transfer_format::text).get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const web_exception& e)
+    {
+        ASSERT_STREQ("web exception - 404 Not Found", e.what());
+    }
+
+    transport->disconnect().get();
+}
+
+TEST(long_polling_transport_disconnect, disconnect_sends_delete_request)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int)
+    {
+        if (request.m_method == "DELETE")
+        {
+            request.m_status_code = 202;
+        }
+    });
+
+    auto transport = create_long_polling_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+    transport->disconnect().get();
+
+    auto requests = filter_vector(factory.get_requests(), "DELETE");
+    ASSERT_EQ(1U, requests.size()) << dump_vector(requests);
+    ASSERT_EQ("DELETE http://fakeuri.org/connect?id=42", requests[0]);
+}
@@ -0,0 +1,40 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "message_buffer.h"
+
+using namespace signalr;
+
+TEST(message_buffer, copies_share_data)
+{
+    // long enough to not be stored inline by the string
+    std::string data(1024, 'x');
+    const auto data_ptr = data.data();
+
+    message_buffer buffer(std::move(data));
+    auto copy = buffer;
+
+    ASSERT_EQ(data_ptr, buffer.data());
+    ASSERT_EQ(buffer.data(), copy.data());
+    ASSERT_EQ(1024U, copy.size());
+}
+
+TEST(message_buffer, default_buffer_is_empty)
+{
+    message_buffer buffer;
+
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ(0U, buffer.size());
+    ASSERT_EQ("", buffer.str());
+}
+
+TEST(message_buffer, can_be_consumed_as_string)
+{
+    std::string received;
+    std::function<void(const message_buffer&)> callback = [&received](const std::string& message) { received = message; };
+
+    callback(message_buffer(std::string("message")));
+
+    ASSERT_EQ("message", received);
+}
@@ -0,0 +1,110 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "message_framer.h"
+#include "json_hub_protocol.h"
+#include "messagepack_hub_protocol.h"
+
+using namespace signalr;
+
+namespace
+{
+    std::vector<std::string> read_messages(message_framer& framer, const hub_protocol& protocol, const std::string& data)
+    {
+        std::vector<std::string> messages;
+
+        framer.begin(data.data(), data.size());
+        const char* message;
+        size_t message_length;
+        while (framer.try_read_message(protocol, message, message_length))
+        {
+            messages.push_back(std::string(message, message_length));
+        }
+        framer.end();
+
+        return messages;
+    }
+}
+
+TEST(message_framer, returns_views_into_received_data)
+{
+    json_hub_protocol protocol;
+    message_framer framer;
+    std::string data{ "{\"type\":6}\x1e{\"type\":7}\x1e" };
+
+    framer.begin(data.data(), data.size());
+
+    const char* message;
+    size_t message_length;
+    ASSERT_TRUE(framer.try_read_message(protocol, message, message_length));
+    ASSERT_EQ(data.data(), message);
+    ASSERT_EQ(10U, message_length);
+
+    ASSERT_TRUE(framer.try_read_message(protocol, message, message_length));
+    ASSERT_EQ(data.data() + 11, message);
+    ASSERT_EQ(10U, message_length);
+
+    ASSERT_FALSE(framer.try_read_message(protocol, message, message_length));
+    framer.end();
+
+    ASSERT_EQ(0U, framer.buffered_size());
+}
+
+TEST(message_framer, keeps_incomplete_message_until_next_frame)
+{
+    json_hub_protocol protocol;
+    message_framer framer;
+
+    auto messages = read_messages(framer, protocol, "{\"type\":6}\x1e{\"ty");
+    ASSERT_EQ(1U, messages.size());
+    ASSERT_EQ("{\"type\":6}", messages[0]);
+    ASSERT_EQ(4U, framer.buffered_size());
+
+    messages = read_messages(framer, protocol, "pe\":");
+    ASSERT_EQ(0U, messages.size());
+    ASSERT_EQ(8U, framer.buffered_size());
+
+    messages = read_messages(framer, protocol, "7}\x1e{\"type\":6}\x1e");
+    ASSERT_EQ(2U, messages.size());
+    ASSERT_EQ("{\"type\":7}", messages[0]);
+    ASSERT_EQ("{\"type\":6}", messages[1]);
+    ASSERT_EQ(0U, framer.buffered_size());
+}
+
+TEST(message_framer, keeps_incomplete_length_prefixed_message_until_next_frame)
+{
+    messagepack_hub_protocol protocol;
+    message_framer framer;
+
+    // the length prefix of the second message is split across frames
+    std::string length_prefix{ "\x82\x01", 2 };
+    auto messages = read_messages(framer, protocol, std::string("\x02\x91\x06", 3) + length_prefix[0]);
+    ASSERT_EQ(1U, messages.size());
+    ASSERT_EQ(std::string("\x91\x06", 2), messages[0]);
+    ASSERT_EQ(1U, framer.buffered_size());
+
+    messages = read_messages(framer, protocol, length_prefix.substr(1) + std::string(100, '\xc0'));
+    ASSERT_EQ(0U, messages.size());
+
+    messages = read_messages(framer, protocol, std::string(30, '\xc0'));
+    ASSERT_EQ(1U, messages.size());
+    ASSERT_EQ(130U, messages[0].size());
+    ASSERT_EQ(0U, framer.buffered_size());
+}
+
+TEST(message_framer, reset_drops_buffered_data)
+{
+    json_hub_protocol protocol;
+    message_framer framer;
+
+    read_messages(framer, protocol, "{\"type\":");
+    ASSERT_EQ(8U, framer.buffered_size());
+
+    framer.reset();
+    ASSERT_EQ(0U, framer.buffered_size());
+
+    auto messages = read_messages(framer, protocol, "{\"type\":6}\x1e");
+    ASSERT_EQ(1U, messages.size());
+    ASSERT_EQ("{\"type\":6}", messages[0]);
+}
@@ -0,0 +1,87 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <thread>
+#include <vector>
+#include "mpsc_queue.h"
+
+using namespace signalr;
+
+TEST(mpsc_queue, try_pop_returns_false_for_empty_queue)
+{
+    mpsc_queue<int> queue;
+
+    int value;
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue, values_popped_in_order_pushed)
+{
+    mpsc_queue<std::string> queue;
+    queue.push("a");
+    queue.push("b");
+
+    std::string value;
+    ASSERT_FALSE(queue.empty());
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ("a", value);
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ("b", value);
+    ASSERT_FALSE(queue.try_pop(value));
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(mpsc_queue, values_pushed_concurrently_are_popped_once_and_in_order_per_producer)
+{
+    const int producer_count = 8;
+    const int values_per_producer = 10000;
+
+    mpsc_queue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producer_count; producer++)
+    {
+        producers.push_back(std::thread([&queue, producer]()
+        {
+            for (int i = 0; i < values_per_producer; i++)
+            {
+                queue.push(std::make_pair(producer, i));
+            }
+        }));
+    }
+
+    std::vector<int> next_value(producer_count, 0);
+    int popped = 0;
+    std::pair<int, int> value;
+    while (popped < producer_count * values_per_producer)
+    {
+        if (queue.try_pop(value))
+        {
+            ASSERT_EQ(next_value[value.first], value.second);
+            next_value[value.first]++;
+            popped++;
+        }
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    ASSERT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue, destructor_releases_values_not_popped)
+{
+    auto value = std::make_shared<int>(42);
+
+    {
+        mpsc_queue<std::shared_ptr<int>> queue;
+        queue.push(value);
+        queue.push(value);
+        ASSERT_EQ(3, value.use_count());
+    }
+
+    ASSERT_EQ(1, value.use_count());
+}
@@ -0,0 +1,53 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <climits>
+#include <set>
+#include "reconnect_backoff.h"
+
+using namespace signalr;
+
+TEST(reconnect_backoff, delay_bound_doubles_with_each_attempt)
+{
+    reconnect_backoff backoff(std::chrono::milliseconds(100), std::chrono::milliseconds(10000));
+
+    ASSERT_EQ(100, backoff.get_delay_bound(0).count());
+    ASSERT_EQ(200, backoff.get_delay_bound(1).count());
+    ASSERT_EQ(400, backoff.get_delay_bound(2).count());
+    ASSERT_EQ(6400, backoff.get_delay_bound(6).count());
+}
+
+TEST(reconnect_backoff, delay_bound_does_not_exceed_max_delay)
+{
+    reconnect_backoff backoff(std::chrono::milliseconds(100), std::chrono::milliseconds(1000));
+
+    ASSERT_EQ(1000, backoff.get_delay_bound(4).count());
+    ASSERT_EQ(1000, backoff.get_delay_bound(1000).count());
+    ASSERT_EQ(1000, backoff.get_delay_bound(UINT_MAX).count());
+}
+
+TEST(reconnect_backoff, delays_are_within_bound)
+{
+    reconnect_backoff backoff(std::chrono::milliseconds(100), std::chrono::milliseconds(1000));
+
+    for (unsigned int attempt = 0; attempt < 1000; attempt++)
+    {
+        const auto delay = backoff.next_delay(attempt);
+        ASSERT_GE(delay.count(), 0);
+        ASSERT_LE(delay.count(), backoff.get_delay_bound(attempt).count());
+    }
+}
+
+TEST(reconnect_backoff, delays_are_spread_across_clients)
+{
+    // clients that lost their connections at the same time must not pick the same delays
+    std::set<long long> delays;
+    for (unsigned int seed = 0; seed < 100; seed++)
+    {
+        reconnect_backoff backoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(30000), seed);
+        delays.insert(backoff.next_delay(5).count());
+    }
+
+    ASSERT_GT(delays.size(), 90U);
+}
@@ -0,0 +1,38 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "recording_web_request_factory.h"
+
+recording_web_request_factory::recording_web_request_factory(std::function<void(web_request_stub&, int)> respond)
+    : m_requests(std::make_shared<requests>()), m_respond(respond)
+{ }
+
+std::unique_ptr<web_request_factory> recording_web_request_factory::create()
+{
+    auto recorded_requests = m_requests;
+    auto respond = m_respond;
+    return std::make_unique<test_web_request_factory>([recorded_requests, respond](const std::string& url)
+    {
+        auto request = new web_request_stub((unsigned short)200, "OK");
+        request->on_get_response = [recorded_requests, respond, url](web_request_stub& stub)
+        {
+            int count;
+            {
+                std::lock_guard<std::mutex> lock(recorded_requests->lock);
+                count = recorded_requests->counts[stub.m_method]++;
+                recorded_requests->entries.push_back(stub.m_method + " " + url + (stub.m_body.empty() ? "" : " " + stub.m_body));
+            }
+
+            respond(stub, count);
+        };
+
+        return std::unique_ptr<web_request>(request);
+    });
+}
+
+std::vector<std::string> recording_web_request_factory::get_requests()
+{
+    std::lock_guard<std::mutex> lock(m_requests->lock);
+    return m_requests->entries;
+}
@@ -0,0 +1,33 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include "test_web_request_factory.h"
+
+using namespace signalr;
+
+// records the requests sent by the transports. Responses are provided by `respond` which is called with the method of
+// the request and the number of requests sent before with that method
+class recording_web_request_factory
+{
+public:
+    explicit recording_web_request_factory(std::function<void(web_request_stub&, int)> respond);
+
+    std::unique_ptr<web_request_factory> create();
+
+    std::vector<std::string> get_requests();
+
+private:
+    struct requests
+    {
+        std::mutex lock;
+        std::map<std::string, int> counts;
+        std::vector<std::string> entries;
+    };
+
+    std::shared_ptr<requests> m_requests;
+    std::function<void(web_request_stub&, int)> m_respond;
+};
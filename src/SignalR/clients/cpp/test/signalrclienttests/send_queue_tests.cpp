@@ -0,0 +1,198 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <algorithm>
+#include <thread>
+#include "send_queue.h"
+
+using namespace signalr;
+
+TEST(send_queue, messages_written_in_order_by_a_single_writer)
+{
+    const int producer_count = 8;
+    const int messages_per_producer = 100;
+
+    std::mutex written_lock;
+    std::vector<std::string> written;
+    std::atomic<int> active_writers(0);
+    std::atomic<bool> concurrent_write(false);
+
+    auto queue = send_queue::create([&](const std::string& data, transfer_format)
+    {
+        if (active_writers++ != 0)
+        {
+            concurrent_write = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(written_lock);
+            written.push_back(data);
+        }
+
+        active_writers--;
+        return pplx::task_from_result();
+    }, 1024);
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producer_count; producer++)
+    {
+        producers.push_back(std::thread([queue, producer]()
+        {
+            std::vector<pplx::task<void>> sends;
+            for (int i = 0; i < messages_per_producer; i++)
+            {
+                sends.push_back(queue->enqueue(std::to_string(producer) + ":" + std::to_string(i), transfer_format::text));
+            }
+
+            pplx::when_all(sends.begin(), sends.end()).get();
+        }));
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    ASSERT_FALSE(concurrent_write);
+    ASSERT_EQ(static_cast<size_t>(producer_count * messages_per_producer), written.size());
+
+    std::vector<int> next_message(producer_count, 0);
+    for (const auto& message : written)
+    {
+        const auto separator = message.find(':');
+        const auto producer = std::stoi(message.substr(0, separator));
+        ASSERT_EQ(next_message[producer], std::stoi(message.substr(separator + 1)));
+        next_message[producer]++;
+    }
+}
+
+TEST(send_queue, high_water_mark_is_largest_number_of_bytes_queued)
+{
+    pplx::task_completion_event<void> write_completed;
+    auto queue = send_queue::create([write_completed](const std::string&, transfer_format)
+    {
+        return pplx::create_task(write_completed);
+    }, 1024);
+
+    auto first_sent = queue->enqueue("abc", transfer_format::text);
+    auto second_sent = queue->enqueue("de", transfer_format::text);
+
+    ASSERT_EQ(5U, queue->queued_bytes());
+    ASSERT_EQ(5U, queue->high_water_mark());
+
+    write_completed.set();
+    first_sent.get();
+    second_sent.get();
+
+    ASSERT_EQ(0U, queue->queued_bytes());
+    ASSERT_EQ(5U, queue->high_water_mark());
+}
+
+TEST(send_queue, wait_for_capacity_completes_when_queued_bytes_drop_below_threshold)
+{
+    pplx::task_completion_event<void> write_completed;
+    auto queue = send_queue::create([write_completed](const std::string&, transfer_format)
+    {
+        return pplx::create_task(write_completed);
+    }, 4);
+
+    ASSERT_TRUE(queue->wait_for_capacity().is_done());
+
+    auto sent = queue->enqueue("12345", transfer_format::text);
+    auto capacity_available = queue->wait_for_capacity();
+    ASSERT_FALSE(capacity_available.is_done());
+
+    write_completed.set();
+    sent.get();
+    capacity_available.get();
+
+    ASSERT_TRUE(queue->wait_for_capacity().is_done());
+}
+
+TEST(send_queue, failed_write_fails_send_and_next_message_is_written)
+{
+    int call_number = 0;
+    auto queue = send_queue::create([&call_number](const std::string&, transfer_format)
+    {
+        if (call_number++ == 0)
+        {
+            return pplx::task_from_exception<void>(std::runtime_error("error"));
+        }
+
+        return pplx::task_from_result();
+    }, 1024);
+
+    auto first_sent = queue->enqueue("first", transfer_format::text);
+    auto second_sent = queue->enqueue("second", transfer_format::text);
+
+    try
+    {
+        first_sent.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const std::runtime_error& e)
+    {
+        ASSERT_STREQ("error", e.what());
+    }
+
+    second_sent.get();
+    ASSERT_EQ(2, call_number);
+    ASSERT_EQ(0U, queue->queued_bytes());
+}
+
+TEST(send_queue, writer_does_not_recurse_when_producers_race_with_it)
+{
+    // more producers than cores get preempted while queueing, which is when the writer takes messages whose producers
+    // have not finished queueing them. The writer must keep looking in the same frame instead of restarting itself.
+    const auto producer_count = std::max(8U, 4 * std::thread::hardware_concurrency());
+    const size_t messages_per_producer = 2000;
+
+    std::atomic<size_t> written(0);
+    std::atomic<size_t> deepest_recursion(0);
+
+    auto queue = send_queue::create([&](const std::string&, transfer_format)
+    {
+        // the writer calls the transport from the same frame for as long as it runs on a thread
+        static thread_local const char* writer_frame = nullptr;
+        char frame;
+        if (writer_frame == nullptr || &frame > writer_frame)
+        {
+            writer_frame = &frame;
+        }
+
+        const auto depth = static_cast<size_t>(writer_frame - &frame);
+        auto deepest = deepest_recursion.load();
+        while (depth > deepest && !deepest_recursion.compare_exchange_weak(deepest, depth))
+        { }
+
+        written++;
+        std::this_thread::yield();
+        return pplx::task_from_result();
+    }, 1024);
+
+    std::vector<std::thread> producers;
+    for (unsigned int producer = 0; producer < producer_count; producer++)
+    {
+        producers.push_back(std::thread([queue, messages_per_producer]()
+        {
+            std::vector<pplx::task<void>> sends;
+            for (size_t i = 0; i < messages_per_producer; i++)
+            {
+                sends.push_back(queue->enqueue("message", transfer_format::text));
+                std::this_thread::yield();
+            }
+
+            pplx::when_all(sends.begin(), sends.end()).get();
+        }));
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    ASSERT_EQ(producer_count * messages_per_producer, written.load());
+    ASSERT_EQ(0U, queue->queued_bytes());
+    ASSERT_EQ(0U, deepest_recursion.load());
+}
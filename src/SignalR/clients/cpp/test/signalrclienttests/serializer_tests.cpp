@@ -0,0 +1,147 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "signalrclient/serializer.h"
+
+using namespace signalr;
+
+namespace
+{
+    struct point
+    {
+        int x;
+        std::string label;
+    };
+}
+
+namespace signalr
+{
+    template<>
+    struct serializer<point>
+    {
+        static void write(argument_writer& writer, const point& value)
+        {
+            writer.begin_object();
+            writer.write_name("label");
+            writer.write_string(value.label);
+            writer.write_name("x");
+            writer.write_int64(value.x);
+            writer.end_object();
+        }
+
+        static point read(argument_reader& reader)
+        {
+            point value{ 0, "" };
+            reader.begin_object();
+            std::string name;
+            while (reader.next_field(name))
+            {
+                if (name == "x")
+                {
+                    value.x = serializer<int>::read(reader);
+                }
+                else if (name == "label")
+                {
+                    value.label = reader.read_string();
+                }
+                else
+                {
+                    reader.skip_value();
+                }
+            }
+            return value;
+        }
+    };
+}
+
+TEST(serializer, serialize_arguments_writes_json_array)
+{
+    const std::vector<int> numbers{ 1, -2 };
+
+    auto arguments = details::serialize_arguments(std::string("a\"b\n"), "literal", 42, -7LL, 1.5, true, numbers,
+        std::vector<std::string>(), point{ 3, "p" });
+
+    ASSERT_EQ("[\"a\\\"b\\n\",\"literal\",42,-7,1.5,true,[1,-2],[],{\"label\":\"p\",\"x\":3}]", arguments);
+}
+
+TEST(serializer, serialize_arguments_writes_empty_array_without_arguments)
+{
+    ASSERT_EQ("[]", details::serialize_arguments());
+}
+
+TEST(serializer, write_escapes_control_characters)
+{
+    std::string json;
+    argument_writer writer(json);
+    writer.write_string(std::string("\x01\t\xc3\xa9", 4));
+
+    ASSERT_EQ("\"\\u0001\\t\xc3\xa9\"", json);
+}
+
+TEST(serializer, invoke_handler_decodes_arguments)
+{
+    std::string text;
+    long long number = 0;
+    double fraction = 0;
+    std::vector<point> points;
+
+    std::function<void(const std::string&, long long, double, std::vector<point>)> handler =
+        [&](const std::string& t, long long n, double f, std::vector<point> p)
+    {
+        text = t;
+        number = n;
+        fraction = f;
+        points = p;
+    };
+
+    details::invoke_handler(handler,
+        " [ \"a\\u00e9\" , -9007199254740993, 2.5e-1, [ { \"x\": 1, \"ignored\": { \"a\": [ 1 ] }, \"label\": \"one\" } ], \"extra\" ] ");
+
+    ASSERT_EQ("a\xc3\xa9", text);
+    ASSERT_EQ(-9007199254740993LL, number);
+    ASSERT_EQ(0.25, fraction);
+    ASSERT_EQ(1U, points.size());
+    ASSERT_EQ(1, points[0].x);
+    ASSERT_EQ("one", points[0].label);
+}
+
+TEST(serializer, invoke_handler_throws_for_missing_arguments)
+{
+    std::function<void(int, int)> handler = [](int, int) {};
+
+    try
+    {
+        details::invoke_handler(handler, "[1]");
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the invocation has fewer arguments than the handler", e.what());
+    }
+}
+
+TEST(serializer, read_throws_for_unexpected_values)
+{
+    std::function<void(int)> handler = [](int) {};
+
+    const std::string arguments[] = { "[\"1\"]", "[1.5]", "[3000000000]" };
+    for (const auto& argument : arguments)
+    {
+        try
+        {
+            details::invoke_handler(handler, argument);
+            ASSERT_TRUE(false) << argument; // exception expected but not thrown
+        }
+        catch (const signalr_exception&)
+        { }
+    }
+}
+
+TEST(serializer, result_reader_decodes_result)
+{
+    argument_reader reader("null", 4);
+    ASSERT_TRUE(reader.read_null());
+
+    ASSERT_EQ(std::vector<int>({ 4, 5 }), details::result_reader<std::vector<int>>::read("[4,5]"));
+}
@@ -0,0 +1,195 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "test_utils.h"
+#include "recording_web_request_factory.h"
+#include "trace_log_writer.h"
+#include "server_sent_events_transport.h"
+#include "signalrclient/signalr_exception.h"
+#include "signalrclient/web_exception.h"
+
+using namespace signalr;
+
+static std::shared_ptr<transport> create_server_sent_events_transport(std::unique_ptr<web_request_factory> web_request_factory,
+    const std::function<void(const std::string&)>& process_response = [](const std::string&) {},
+    const std::function<void(const std::exception&)>& error = [](const std::exception&) {})
+{
+    return server_sent_events_transport::create(std::move(web_request_factory), signalr_client_config(),
+        logger(std::make_shared<trace_log_writer>(), trace_level::none), process_response, error);
+}
+
+// keeps the response streaming until `close_event` is set
+static void keep_streaming(web_request_stub& request, const std::shared_ptr<event>& close_event,
+    const std::vector<std::string>& chunks = {})
+{
+    request.on_read_body = [close_event, chunks](const std::string&, const std::function<void(const std::string&)>& on_data)
+    {
+        for (const auto& chunk : chunks)
+        {
+            on_data(chunk);
+        }
+
+        close_event->wait(5000);
+    };
+}
+
+TEST(server_sent_events_transport_connect, connect_requests_event_stream)
+{
+    auto close_event = std::make_shared<event>();
+    auto accept_header = std::make_shared<utility::string_t>();
+    recording_web_request_factory factory([close_event, accept_header](web_request_stub& request, int)
+    {
+        auto headers = request.m_signalr_client_config.get_http_headers();
+        *accept_header = headers[_XPLATSTR("Accept")];
+        keep_streaming(request, close_event);
+    });
+
+    auto transport = create_server_sent_events_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+    transport->disconnect().get();
+    close_event->set();
+
+    auto requests = factory.get_requests();
+    ASSERT_EQ(1U, requests.size()) << dump_vector(requests);
+    ASSERT_EQ("GET http://fakeuri.org/connect?id=42", requests[0]);
+    ASSERT_EQ(_XPLATSTR("text/event-stream"), *accept_header);
+    ASSERT_EQ(transport_type::server_sent_events, transport->get_transport_type());
+}
+
+TEST(server_sent_events_transport_connect, connect_propagates_exceptions)
+{
+    recording_web_request_factory factory([](web_request_stub& request, int)
+    {
+        request.m_status_code = 404;
+        request.m_reason_phrase = "Not Found";
+    });
+
+    auto transport = create_server_sent_events_transport(factory.create());
+
+    try
+    {
+        transport->connect("http://fakeuri.org/connect?id=42").get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const web_exception& e)
+    {
+        ASSERT_STREQ("web exception - 404 Not Found", e.what());
+    }
+}
+
+TEST(server_sent_events_transport_receive, events_split_across_chunks_processed_in_order)
+{
+    auto close_event = std::make_shared<event>();
+    recording_web_request_factory factory([close_event](web_request_stub& request, int)
+    {
+        keep_streaming(request, close_event, { "data: message1\r\n\r\ndata: mess", "age2\r\n", "\r\ndata: message3\r\n\r\n" });
+    });
+
+    auto messages = std::make_shared<std::vector<std::string>>();
+    auto messages_received_event = std::make_shared<event>();
+    auto transport = create_server_sent_events_transport(factory.create(),
+        [messages, messages_received_event](const std::string& message)
+        {
+            messages->push_back(message);
+            if (messages->size() == 3)
+            {
+                messages_received_event->set();
+            }
+        });
+
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    ASSERT_FALSE(messages_received_event->wait(5000));
+    ASSERT_EQ(std::vector<std::string>({ "message1", "message2", "message3" }), *messages);
+
+    transport->disconnect().get();
+    close_event->set();
+}
+
+TEST(server_sent_events_transport_receive, error_reported_when_server_closes_the_connection)
+{
+    recording_web_request_factory factory([](web_request_stub&, int) {});
+
+    auto error_message = std::make_shared<std::string>();
+    auto error_event = std::make_shared<event>();
+    auto transport = create_server_sent_events_transport(factory.create(),
+        [](const std::string&) {},
+        [error_message, error_event](const std::exception& e)
+        {
+            *error_message = e.what();
+            error_event->set();
+        });
+
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    ASSERT_FALSE(error_event->wait(5000));
+    ASSERT_EQ("the server closed the connection", *error_message);
+}
+
+TEST(server_sent_events_transport_send, send_posts_data)
+{
+    auto close_event = std::make_shared<event>();
+    recording_web_request_factory factory([close_event](web_request_stub& request, int)
+    {
+        keep_streaming(request, close_event);
+    });
+
+    auto transport = create_server_sent_events_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+    transport->send("a", transfer_format::text).get();
+    transport->disconnect().get();
+    close_event->set();
+
+    auto requests = filter_vector(factory.get_requests(), "POST");
+    ASSERT_EQ(1U, requests.size()) << dump_vector(requests);
+    ASSERT_EQ("POST http://fakeuri.org/connect?id=42 a", requests[0]);
+}
+
+TEST(server_sent_events_transport_send, send_fails_for_binary_data)
+{
+    auto close_event = std::make_shared<event>();
+    recording_web_request_factory factory([close_event](web_request_stub& request, int)
+    {
+        keep_streaming(request, close_event);
+    });
+
+    auto transport = create_server_sent_events_transport(factory.create());
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+
+    try
+    {
+        transport->send("a", transfer_format::binary).get();
+        ASSERT_TRUE(false); // exception not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the server-sent events transport does not support the binary transfer format", e.what());
+    }
+
+    transport->disconnect().get();
+    close_event->set();
+}
+
+TEST(server_sent_events_transport_disconnect, no_error_reported_when_response_ends_after_disconnect)
+{
+    auto close_event = std::make_shared<event>();
+    recording_web_request_factory factory([close_event](web_request_stub& request, int)
+    {
+        keep_streaming(request, close_event);
+    });
+
+    auto error_event = std::make_shared<event>();
+    auto transport = create_server_sent_events_transport(factory.create(),
+        [](const std::string&) {},
+        [error_event](const std::exception&)
+        {
+            error_event->set();
+        });
+
+    transport->connect("http://fakeuri.org/connect?id=42").get();
+    transport->disconnect().get();
+    close_event->set();
+
+    ASSERT_TRUE(error_event->wait(100));
+}
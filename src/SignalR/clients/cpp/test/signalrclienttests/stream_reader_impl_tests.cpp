@@ -0,0 +1,122 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "stream_reader_impl.h"
+#include "signalrclient/hub_exception.h"
+#include "signalrclient/signalr_exception.h"
+
+using namespace signalr;
+using namespace web;
+
+TEST(stream_reader_impl, move_next_returns_buffered_items_in_order)
+{
+    stream_reader_impl reader(10);
+    reader.add_item(json::value::number(1));
+    reader.add_item(json::value::number(2));
+
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(1, reader.current().as_integer());
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(2, reader.current().as_integer());
+}
+
+TEST(stream_reader_impl, pending_move_next_completed_when_item_added)
+{
+    stream_reader_impl reader(10);
+
+    auto move_next_task = reader.move_next();
+    ASSERT_FALSE(move_next_task.is_done());
+
+    reader.add_item(json::value::number(42));
+
+    ASSERT_TRUE(move_next_task.get());
+    ASSERT_EQ(42, reader.current().as_integer());
+}
+
+TEST(stream_reader_impl, move_next_returns_false_after_buffered_items_when_completed)
+{
+    stream_reader_impl reader(10);
+    reader.add_item(json::value::number(1));
+    reader.complete();
+
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_FALSE(reader.move_next().get());
+    ASSERT_FALSE(reader.move_next().get());
+}
+
+TEST(stream_reader_impl, move_next_throws_after_buffered_items_when_completed_with_error)
+{
+    stream_reader_impl reader(10);
+    reader.add_item(json::value::number(1));
+    reader.complete(std::make_exception_ptr(hub_exception("stream failed")));
+
+    ASSERT_TRUE(reader.move_next().get());
+
+    try
+    {
+        reader.move_next().get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const hub_exception& e)
+    {
+        ASSERT_STREQ("stream failed", e.what());
+    }
+}
+
+TEST(stream_reader_impl, add_item_fails_stream_without_blocking_when_buffer_is_full)
+{
+    stream_reader_impl reader(1);
+
+    int cancel_count = 0;
+    reader.set_cancel_handler([&cancel_count]() { cancel_count++; });
+
+    reader.add_item(json::value::number(1));
+    reader.add_item(json::value::number(2));
+    reader.add_item(json::value::number(3));
+    reader.complete();
+
+    // the stream is cancelled on the server and fails after the item that was buffered
+    ASSERT_EQ(1, cancel_count);
+    ASSERT_TRUE(reader.move_next().get());
+    ASSERT_EQ(1, reader.current().as_integer());
+
+    try
+    {
+        reader.move_next().get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the stream buffer capacity (1) was exceeded because the stream was not read fast enough", e.what());
+    }
+}
+
+TEST(stream_reader_impl, cancel_invokes_cancel_handler_once)
+{
+    stream_reader_impl reader(1);
+    reader.add_item(json::value::number(1));
+
+    int cancel_count = 0;
+    reader.set_cancel_handler([&cancel_count]() { cancel_count++; });
+
+    reader.cancel();
+    reader.cancel();
+    reader.add_item(json::value::number(2));
+
+    ASSERT_EQ(1, cancel_count);
+    ASSERT_FALSE(reader.move_next().get());
+}
+
+TEST(stream_reader_impl, cancel_handler_not_invoked_after_completion)
+{
+    stream_reader_impl reader(1);
+
+    bool cancelled = false;
+    reader.set_cancel_handler([&cancelled]() { cancelled = true; });
+
+    reader.complete();
+    reader.cancel();
+
+    ASSERT_FALSE(cancelled);
+}
@@ -0,0 +1,148 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include <thread>
+#include "stream_writer_impl.h"
+#include "json_hub_protocol.h"
+#include "signalrclient/signalr_exception.h"
+
+using namespace signalr;
+using namespace web;
+
+namespace
+{
+    // records the sent messages and lets the test decide when each send completes
+    struct test_sender
+    {
+        std::mutex lock;
+        std::vector<std::string> messages;
+        std::vector<pplx::task_completion_event<void>> sends;
+
+        std::function<pplx::task<void>(const hub_message&)> create_send_function()
+        {
+            return [this](const hub_message& message)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                messages.push_back(json_hub_protocol().write_message(message));
+                sends.push_back(pplx::task_completion_event<void>());
+                return pplx::create_task(sends.back());
+            };
+        }
+
+        size_t count()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            return messages.size();
+        }
+
+        void complete_send(size_t index)
+        {
+            pplx::task_completion_event<void> tce;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                tce = sends[index];
+            }
+            tce.set();
+        }
+    };
+
+    void wait_for_count(test_sender& sender, size_t count)
+    {
+        for (int wait_time_ms = 5; wait_time_ms < 1000 && sender.count() < count; wait_time_ms <<= 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait_time_ms));
+        }
+    }
+}
+
+TEST(stream_writer_impl, items_written_before_bind_are_sent_after_bind)
+{
+    auto writer = std::make_shared<stream_writer_impl>();
+    auto write_task = writer->write(json::value::number(1));
+    ASSERT_FALSE(write_task.is_done());
+
+    test_sender sender;
+    writer->bind("7", 4, sender.create_send_function());
+
+    write_task.get();
+    ASSERT_EQ(1U, sender.count());
+    ASSERT_EQ("{\"invocationId\":\"7\",\"item\":1,\"type\":2}\x1e", sender.messages[0]);
+}
+
+TEST(stream_writer_impl, writes_wait_for_room_in_the_window)
+{
+    auto writer = std::make_shared<stream_writer_impl>();
+    test_sender sender;
+    writer->bind("0", 2, sender.create_send_function());
+
+    writer->write(json::value::number(1)).get();
+    writer->write(json::value::number(2)).get();
+    auto third_write = writer->write(json::value::number(3));
+
+    ASSERT_FALSE(third_write.is_done());
+    ASSERT_EQ(2U, sender.count());
+
+    sender.complete_send(0);
+    third_write.get();
+
+    wait_for_count(sender, 3);
+    ASSERT_EQ(3U, sender.count());
+    ASSERT_EQ("{\"invocationId\":\"0\",\"item\":3,\"type\":2}\x1e", sender.messages[2]);
+}
+
+TEST(stream_writer_impl, complete_sends_completion_after_items)
+{
+    auto writer = std::make_shared<stream_writer_impl>();
+    test_sender sender;
+    writer->bind("0", 1, sender.create_send_function());
+
+    writer->write(json::value::number(1)).get();
+    auto complete_task = writer->complete("");
+    ASSERT_EQ(1U, sender.count());
+
+    sender.complete_send(0);
+    wait_for_count(sender, 2);
+    ASSERT_EQ(2U, sender.count());
+    ASSERT_EQ("{\"invocationId\":\"0\",\"type\":3}\x1e", sender.messages[1]);
+
+    ASSERT_FALSE(complete_task.is_done());
+    sender.complete_send(1);
+    complete_task.get();
+}
+
+TEST(stream_writer_impl, write_throws_after_complete)
+{
+    auto writer = std::make_shared<stream_writer_impl>();
+    writer->complete("");
+
+    try
+    {
+        writer->write(json::value::number(1));
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const signalr_exception& e)
+    {
+        ASSERT_STREQ("the stream has already been completed", e.what());
+    }
+}
+
+TEST(stream_writer_impl, abort_fails_pending_and_subsequent_writes)
+{
+    auto writer = std::make_shared<stream_writer_impl>();
+    auto write_task = writer->write(json::value::number(1));
+
+    writer->abort(std::make_exception_ptr(std::runtime_error("send failed")));
+
+    try
+    {
+        write_task.get();
+        ASSERT_TRUE(false); // exception expected but not thrown
+    }
+    catch (const std::runtime_error& e)
+    {
+        ASSERT_STREQ("send failed", e.what());
+    }
+
+    ASSERT_THROW(writer->write(json::value::number(2)).get(), std::runtime_error);
+}
@@ -0,0 +1,83 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "subscription_table.h"
+
+using namespace signalr;
+
+namespace
+{
+    subscription_table::handler create_handler(std::string& called, const std::string& name)
+    {
+        return [&called, name](const lazy_json_value&) { called = name; };
+    }
+}
+
+TEST(subscription_table, find_is_case_insensitive)
+{
+    std::string called;
+    subscription_table table({ { "broadcast", create_handler(called, "broadcast") }, { "Send", create_handler(called, "Send") } });
+
+    const std::string name = "BroadCast";
+    auto handler = table.find(name.data(), name.size());
+    ASSERT_NE(nullptr, handler);
+    (*handler)(lazy_json_value::from_text("[]"));
+    ASSERT_EQ("broadcast", called);
+
+    handler = table.find("SEND", 4);
+    ASSERT_NE(nullptr, handler);
+    (*handler)(lazy_json_value::from_text("[]"));
+    ASSERT_EQ("Send", called);
+}
+
+TEST(subscription_table, find_returns_null_for_unknown_names)
+{
+    std::string called;
+    subscription_table table({ { "broadcast", create_handler(called, "broadcast") } });
+
+    ASSERT_EQ(nullptr, table.find("broadcas", 8));
+    ASSERT_EQ(nullptr, table.find("broadcast2", 10));
+    ASSERT_EQ(nullptr, table.find("xroadcast", 9));
+    ASSERT_EQ(nullptr, table.find("", 0));
+}
+
+TEST(subscription_table, empty_table_finds_nothing)
+{
+    subscription_table table;
+
+    ASSERT_EQ(0U, table.size());
+    ASSERT_EQ(nullptr, table.find("method", 6));
+}
+
+TEST(subscription_table, finds_all_of_many_names)
+{
+    std::string called;
+    std::vector<std::pair<std::string, subscription_table::handler>> subscriptions;
+    for (int i = 0; i < 200; i++)
+    {
+        const auto name = "method" + std::to_string(i);
+        subscriptions.push_back(std::make_pair(name, create_handler(called, name)));
+    }
+
+    subscription_table table(subscriptions);
+
+    ASSERT_EQ(200U, table.size());
+    for (const auto& subscription : subscriptions)
+    {
+        auto handler = table.find(subscription.first.data(), subscription.first.size());
+        ASSERT_NE(nullptr, handler);
+        (*handler)(lazy_json_value::from_text("[]"));
+        ASSERT_EQ(subscription.first, called);
+    }
+
+    ASSERT_EQ(nullptr, table.find("method200", 9));
+}
+
+TEST(subscription_table, throws_for_names_differing_only_in_case)
+{
+    std::string called;
+
+    ASSERT_THROW(subscription_table({ { "method", create_handler(called, "a") }, { "METHOD", create_handler(called, "b") } }),
+        std::invalid_argument);
+}
@@ -15,7 +15,7 @@ public:
 
     std::shared_ptr<transport> create_transport(transport_type transport_type, const logger& logger,
         const signalr_client_config& signalr_client_config,
-        std::function<void(const std::string&)> process_message_callback,
+        std::function<void(const message_buffer&)> process_message_callback,
         std::function<void(const std::exception&)> error_callback) override;
 
 private:
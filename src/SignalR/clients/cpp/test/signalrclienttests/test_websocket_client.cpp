@@ -17,14 +17,15 @@ pplx::task<void> test_websocket_client::connect(const std::string& url)
     return m_connect_function(url);
 }
 
-pplx::task<void> test_websocket_client::send(const std::string &msg)
+pplx::task<void> test_websocket_client::send(const std::string &msg, transfer_format)
 {
     return m_send_function(msg);
 }
 
-pplx::task<std::string> test_websocket_client::receive()
+pplx::task<message_buffer> test_websocket_client::receive()
 {
-    return pplx::create_task([this]() { return m_receive_function(); });
+    return pplx::create_task([this]() { return m_receive_function(); })
+        .then([](std::string message) { return message_buffer(std::move(message)); });
 }
 
 pplx::task<void> test_websocket_client::close()
@@ -15,9 +15,9 @@ public:
 
     pplx::task<void> connect(const std::string& url) override;
 
-    pplx::task<void> send(const std::string& msg) override;
+    pplx::task<void> send(const std::string& msg, transfer_format transfer_format) override;
 
-    pplx::task<std::string> receive() override;
+    pplx::task<message_buffer> receive() override;
 
     pplx::task<void> close() override;
 
@@ -0,0 +1,83 @@
+// Copyright (c) .NET Foundation. All rights reserved.
+// Licensed under the Apache License, Version 2.0. See License.txt in the project root for license information.
+
+#include "stdafx.h"
+#include "timer_service.h"
+#include "event.h"
+
+using namespace signalr;
+
+TEST(timer_service, schedule_invokes_callback_after_delay)
+{
+    timer_service timer_service;
+    event timer_fired;
+
+    const auto start = std::chrono::steady_clock::now();
+    timer_service.schedule(std::chrono::milliseconds(50), [&timer_fired]() { timer_fired.set(); });
+
+    ASSERT_FALSE(timer_fired.wait(5000));
+    ASSERT_TRUE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+TEST(timer_service, timers_fire_in_deadline_order)
+{
+    timer_service timer_service;
+    std::mutex lock;
+    std::vector<int> order;
+    event all_fired;
+
+    auto record = [&lock, &order, &all_fired](int value)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        order.push_back(value);
+        if (order.size() == 3)
+        {
+            all_fired.set();
+        }
+    };
+
+    timer_service.schedule(std::chrono::milliseconds(60), [record]() { record(3); });
+    timer_service.schedule(std::chrono::milliseconds(20), [record]() { record(1); });
+    timer_service.schedule(std::chrono::milliseconds(40), [record]() { record(2); });
+
+    ASSERT_FALSE(all_fired.wait(5000));
+    ASSERT_EQ((std::vector<int>{ 1, 2, 3 }), order);
+}
+
+TEST(timer_service, cancelled_timer_does_not_fire)
+{
+    timer_service timer_service;
+    std::atomic<bool> cancelled_fired(false);
+    event other_fired;
+
+    auto timer_id = timer_service.schedule(std::chrono::milliseconds(20), [&cancelled_fired]() { cancelled_fired = true; });
+    timer_service.schedule(std::chrono::milliseconds(50), [&other_fired]() { other_fired.set(); });
+
+    ASSERT_TRUE(timer_service.cancel(timer_id));
+    ASSERT_FALSE(timer_service.cancel(timer_id));
+
+    ASSERT_FALSE(other_fired.wait(5000));
+    ASSERT_FALSE(cancelled_fired);
+}
+
+TEST(timer_service, cancel_returns_false_after_timer_fired)
+{
+    timer_service timer_service;
+    event timer_fired;
+
+    auto timer_id = timer_service.schedule(std::chrono::milliseconds(0), [&timer_fired]() { timer_fired.set(); });
+
+    ASSERT_FALSE(timer_fired.wait(5000));
+    ASSERT_FALSE(timer_service.cancel(timer_id));
+}
+
+TEST(timer_service, exception_thrown_by_callback_does_not_stop_other_timers)
+{
+    timer_service timer_service;
+    event timer_fired;
+
+    timer_service.schedule(std::chrono::milliseconds(0), []() { throw std::runtime_error("error"); });
+    timer_service.schedule(std::chrono::milliseconds(10), [&timer_fired]() { timer_fired.set(); });
+
+    ASSERT_FALSE(timer_fired.wait(5000));
+}
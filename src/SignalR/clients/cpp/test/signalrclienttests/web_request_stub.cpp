@@ -23,6 +23,12 @@ void web_request_stub::set_client_config(const signalr_client_config& config)
     m_signalr_client_config = config;
 }
 
+void web_request_stub::set_body(const std::string& body, const std::string& content_type)
+{
+    m_body = body;
+    m_content_type = content_type;
+}
+
 pplx::task<web_response> web_request_stub::get_response()
 {
     on_get_response(*this);
@@ -30,3 +36,20 @@ pplx::task<web_response> web_request_stub::get_response()
     return pplx::task_from_result<web_response>(
         web_response{ m_status_code, m_reason_phrase, pplx::task_from_result<std::string>(m_response_body) });
 }
+
+pplx::task<web_response> web_request_stub::get_streaming_response(const std::function<void(const std::string&)>& on_data,
+    const pplx::cancellation_token&)
+{
+    on_get_response(*this);
+
+    // the request may no longer exist when the body is read
+    auto on_read_body = this->on_read_body;
+    auto response_body = m_response_body;
+
+    return pplx::task_from_result<web_response>(
+        web_response{ m_status_code, m_reason_phrase, pplx::create_task([on_read_body, response_body, on_data]()
+        {
+            on_read_body(response_body, on_data);
+            return std::string();
+        }) });
+}
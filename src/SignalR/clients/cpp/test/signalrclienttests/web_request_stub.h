@@ -15,14 +15,28 @@ struct web_request_stub : public web_request
     std::string m_response_body;
     std::string m_method;
     std::string m_user_agent_string;
+    std::string m_body;
+    std::string m_content_type;
     signalr_client_config m_signalr_client_config;
     std::function<void(web_request_stub&)> on_get_response = [](web_request_stub&){};
+    // invoked when the body of a streaming response is read. By default the response body is passed on as one chunk
+    std::function<void(const std::string&, const std::function<void(const std::string&)>&)> on_read_body =
+        [](const std::string& response_body, const std::function<void(const std::string&)>& on_data)
+        {
+            if (!response_body.empty())
+            {
+                on_data(response_body);
+            }
+        };
 
     web_request_stub(unsigned short status_code, const std::string& reason_phrase, const std::string& response_body = "");
 
     virtual void set_method(const std::string &method) override;
     virtual void set_user_agent(const std::string &user_agent_string) override;
     virtual void set_client_config(const signalr_client_config& client_config) override;
+    virtual void set_body(const std::string& body, const std::string& content_type) override;
 
     virtual pplx::task<web_response> get_response() override;
+    virtual pplx::task<web_response> get_streaming_response(const std::function<void(const std::string&)>& on_data,
+        const pplx::cancellation_token& cancellation_token) override;
 };
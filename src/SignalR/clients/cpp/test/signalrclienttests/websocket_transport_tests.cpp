@@ -144,7 +144,7 @@ TEST(websocket_transport_send, send_creates_and_sends_websocket_messages)
         [](const std::string&){}, [](const std::exception&){});
 
     ws_transport->connect("ws://url")
-        .then([ws_transport](){ return ws_transport->send("ABC"); })
+        .then([ws_transport](){ return ws_transport->send("ABC", transfer_format::text); })
         .wait();
 
     ASSERT_TRUE(send_called);